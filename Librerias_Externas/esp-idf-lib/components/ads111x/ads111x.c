@@ -85,11 +85,22 @@ const float ads111x_gain_values[] = {
     [ADS111X_GAIN_0V256_3] = 0.256
 };
 
+/*
+ * Config and threshold registers only change when written, so they are served
+ * from the register cache. OS bit of the config register is read from the bus.
+ */
+static const i2c_dev_reg_desc_t regs[] = {
+    { .reg = REG_CONVERSION, .size = 2, .volatile_reg = true },
+    { .reg = REG_CONFIG,     .size = 2 },
+    { .reg = REG_THRESH_L,   .size = 2 },
+    { .reg = REG_THRESH_H,   .size = 2 },
+};
+
 static esp_err_t read_reg(i2c_dev_t *dev, uint8_t reg, uint16_t *val)
 {
     uint8_t buf[2];
     esp_err_t res;
-    if ((res = i2c_dev_read_reg(dev, reg, buf, 2)) != ESP_OK)
+    if ((res = i2c_dev_read_reg_cached(dev, reg, buf, 2)) != ESP_OK)
     {
         ESP_LOGE(TAG, "Could not read from register 0x%02x", reg);
         return res;
@@ -103,7 +114,7 @@ static esp_err_t write_reg(i2c_dev_t *dev, uint8_t reg, uint16_t val)
 {
     uint8_t buf[2] = { val >> 8, val };
     esp_err_t res;
-    if ((res = i2c_dev_write_reg(dev, reg, buf, 2)) != ESP_OK)
+    if ((res = i2c_dev_write_reg_cached(dev, reg, buf, 2)) != ESP_OK)
     {
         ESP_LOGE(TAG, "Could not write 0x%04x to register 0x%02x", val, reg);
         return res;
@@ -120,7 +131,15 @@ static esp_err_t read_conf_bits(i2c_dev_t *dev, uint8_t offs, uint16_t mask,
     uint16_t val;
 
     I2C_DEV_TAKE_MUTEX(dev);
-    I2C_DEV_CHECK(dev, read_reg(dev, REG_CONFIG, &val));
+    if (offs == OS_OFFSET)
+    {
+        // Conversion status, never cached
+        uint8_t buf[2];
+        I2C_DEV_CHECK(dev, i2c_dev_read_reg(dev, REG_CONFIG, buf, 2));
+        val = (buf[0] << 8) | buf[1];
+    }
+    else
+        I2C_DEV_CHECK(dev, read_reg(dev, REG_CONFIG, &val));
     I2C_DEV_GIVE_MUTEX(dev);
 
     ESP_LOGD(TAG, "Got config value: 0x%04x", val);
@@ -139,6 +158,8 @@ static esp_err_t write_conf_bits(i2c_dev_t *dev, uint16_t val, uint8_t offs,
 
     I2C_DEV_TAKE_MUTEX(dev);
     I2C_DEV_CHECK(dev, read_reg(dev, REG_CONFIG, &old));
+    // Writing OS bit starts a conversion, so it is only set by ads111x_start_conversion()
+    old &= ~(OS_MASK << OS_OFFSET);
     I2C_DEV_CHECK(dev, write_reg(dev, REG_CONFIG, (old & ~(mask << offs)) | (val << offs)));
     I2C_DEV_GIVE_MUTEX(dev);
 
@@ -175,6 +196,8 @@ esp_err_t ads111x_init_desc(i2c_dev_t *dev, uint8_t addr, i2c_port_t port,
 #if HELPER_TARGET_IS_ESP32
     dev->cfg.master.clk_speed = I2C_FREQ_HZ;
 #endif
+    CHECK(i2c_dev_cache_init(dev, regs, sizeof(regs) / sizeof(regs[0])));
+
     return i2c_dev_create_mutex(dev);
 }
 
@@ -182,6 +205,8 @@ esp_err_t ads111x_free_desc(i2c_dev_t *dev)
 {
     CHECK_ARG(dev);
 
+    i2c_dev_cache_free(dev);
+
     return i2c_dev_delete_mutex(dev);
 }
 
@@ -249,6 +274,22 @@ esp_err_t ads111x_set_input_mux(i2c_dev_t *dev, ads111x_mux_t mux)
     return write_conf_bits(dev, mux, MUX_OFFSET, MUX_MASK);
 }
 
+esp_err_t ads111x_set_input(i2c_dev_t *dev, ads111x_mux_t mux, ads111x_gain_t gain)
+{
+    CHECK_ARG(dev);
+
+    uint16_t conf;
+
+    I2C_DEV_TAKE_MUTEX(dev);
+    I2C_DEV_CHECK(dev, read_reg(dev, REG_CONFIG, &conf));
+    conf &= ~((OS_MASK << OS_OFFSET) | (MUX_MASK << MUX_OFFSET) | (PGA_MASK << PGA_OFFSET));
+    conf |= ((mux & MUX_MASK) << MUX_OFFSET) | ((gain & PGA_MASK) << PGA_OFFSET);
+    I2C_DEV_CHECK(dev, write_reg(dev, REG_CONFIG, conf));
+    I2C_DEV_GIVE_MUTEX(dev);
+
+    return ESP_OK;
+}
+
 esp_err_t ads111x_get_mode(i2c_dev_t *dev, ads111x_mode_t *mode)
 {
     READ_CONFIG(MODE_OFFSET, MODE_MASK, mode);
@@ -268,6 +268,18 @@ esp_err_t ads111x_get_input_mux(i2c_dev_t *dev, ads111x_mux_t *mux);
  */
 esp_err_t ads111x_set_input_mux(i2c_dev_t *dev, ads111x_mux_t mux);
 
+/**
+ * @brief Configure the input multiplexer and the gain amplifier at once
+ *
+ * ADS1115 only. Both fields are changed with a single register write.
+ *
+ * @param dev Device descriptor
+ * @param mux Input multiplexer configuration
+ * @param gain Gain value
+ * @return `ESP_OK` on success
+ */
+esp_err_t ads111x_set_input(i2c_dev_t *dev, ads111x_mux_t mux, ads111x_gain_t gain);
+
 /**
  * @brief Read the device operating mode
  *
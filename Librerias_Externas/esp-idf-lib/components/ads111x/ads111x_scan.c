@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2016 Ruslan V. Uss <unclerus@gmail.com>
+ * Copyright (c) 2020 Lucio Tarantino <https://github.com/dianlight>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of itscontributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file ads111x_scan.c
+ *
+ * Continuous conversion scan of ADS111x channels
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#include <string.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_idf_lib_helpers.h>
+#include "ads111x_scan.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static const char *TAG = "ads111x_scan";
+
+// ADS111x samples per second, ADS101x rates are higher
+static const uint16_t rates[] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+
+static void alert_isr(void *arg)
+{
+    ads111x_scan_t *scan = (ads111x_scan_t *)arg;
+    BaseType_t woken = pdFALSE;
+
+    if (!scan->running)
+        return;
+
+    // single slot: if the task is late by more than one conversion
+    // period, the next edge overwrites it, see ads111x_sample_t
+    scan->ready_time = esp_timer_get_time();
+    vTaskNotifyGiveFromISR(scan->task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void store(ads111x_scan_t *scan, int16_t value, int64_t timestamp)
+{
+    ads111x_scan_buffer_t *b = &scan->buffers[scan->current];
+    ads111x_sample_t sample = { .value = value, .timestamp = timestamp };
+
+    xSemaphoreTake(scan->lock, portMAX_DELAY);
+    if (b->head - b->tail == ADS111X_SCAN_BUF_SIZE)
+    {
+        // drop oldest sample
+        b->tail++;
+        b->overruns++;
+    }
+    b->buf[b->head++ % ADS111X_SCAN_BUF_SIZE] = sample;
+    xSemaphoreGive(scan->lock);
+
+    if (scan->config.callback)
+        scan->config.callback(scan->current, &sample, scan->config.callback_arg);
+}
+
+static void scan_task(void *arg)
+{
+    ads111x_scan_t *scan = (ads111x_scan_t *)arg;
+    const ads111x_scan_config_t *c = &scan->config;
+    TickType_t timeout = pdMS_TO_TICKS(2000 / rates[c->rate] + 10);
+
+    while (scan->running)
+    {
+        if (!ulTaskNotifyTake(pdTRUE, timeout))
+        {
+            ESP_LOGW(TAG, "No ALERT/RDY pulse from device 0x%02x", scan->dev->addr);
+            continue;
+        }
+        if (!scan->running)
+            break;
+
+        int64_t timestamp = scan->ready_time;
+        int16_t value;
+        esp_err_t res = c->ads101x
+                ? ads101x_get_value(scan->dev, &value)
+                : ads111x_get_value(scan->dev, &value);
+        if (res != ESP_OK)
+            continue;
+
+        if (++scan->conversions > c->discard)
+            store(scan, value, timestamp);
+
+        if (c->channel_count > 1 && scan->conversions >= (size_t)c->discard + c->samples)
+        {
+            scan->current = (scan->current + 1) % c->channel_count;
+            scan->conversions = 0;
+            const ads111x_scan_channel_t *ch = &scan->channels[scan->current];
+            if (ads111x_set_input(scan->dev, ch->mux, ch->gain) != ESP_OK)
+                ESP_LOGE(TAG, "Could not switch to channel %u", (unsigned)scan->current);
+        }
+    }
+
+    xSemaphoreGive(scan->stopped);
+    vTaskDelete(NULL);
+}
+
+static void free_sync(ads111x_scan_t *scan)
+{
+    if (scan->lock)
+        vSemaphoreDelete(scan->lock);
+    if (scan->stopped)
+        vSemaphoreDelete(scan->stopped);
+    scan->lock = NULL;
+    scan->stopped = NULL;
+}
+
+static esp_err_t setup_device(ads111x_scan_t *scan)
+{
+    i2c_dev_t *dev = scan->dev;
+
+    // Conversion ready mode: MSB of high threshold set, MSB of low threshold cleared
+    CHECK(ads111x_set_mode(dev, ADS111X_MODE_SINGLE_SHOT));
+    CHECK(ads111x_set_data_rate(dev, scan->config.rate));
+    CHECK(ads111x_set_comp_high_thresh(dev, INT16_MIN));
+    CHECK(ads111x_set_comp_low_thresh(dev, 0));
+    CHECK(ads111x_set_comp_mode(dev, ADS111X_COMP_MODE_NORMAL));
+    CHECK(ads111x_set_comp_polarity(dev, ADS111X_COMP_POLARITY_LOW));
+    CHECK(ads111x_set_comp_latch(dev, ADS111X_COMP_LATCH_DISABLED));
+    CHECK(ads111x_set_comp_queue(dev, ADS111X_COMP_QUEUE_1));
+
+    return ads111x_set_input(dev, scan->channels[0].mux, scan->channels[0].gain);
+}
+
+static esp_err_t setup_gpio(ads111x_scan_t *scan)
+{
+    gpio_num_t gpio = scan->config.alert_gpio;
+
+    esp_err_t res = gpio_install_isr_service(0);
+    if (res != ESP_OK && res != ESP_ERR_INVALID_STATE)
+        return res;
+
+    // ALERT/RDY is an open-drain output
+    CHECK(gpio_set_direction(gpio, GPIO_MODE_INPUT));
+    CHECK(gpio_set_pull_mode(gpio, GPIO_PULLUP_ONLY));
+    CHECK(gpio_set_intr_type(gpio, GPIO_INTR_NEGEDGE));
+    CHECK(gpio_isr_handler_add(gpio, alert_isr, scan));
+#if HELPER_TARGET_IS_ESP32
+    CHECK(gpio_intr_enable(gpio));
+#endif
+
+    return ESP_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+esp_err_t ads111x_scan_start(ads111x_scan_t *scan, i2c_dev_t *dev, const ads111x_scan_config_t *config)
+{
+    CHECK_ARG(scan && dev && config && config->channels && config->samples
+            && config->channel_count && config->channel_count <= ADS111X_SCAN_MAX_CHANNELS
+            && config->rate <= ADS111X_DATA_RATE_860);
+
+    memset(scan, 0, sizeof(ads111x_scan_t));
+    scan->dev = dev;
+    scan->config = *config;
+    memcpy(scan->channels, config->channels, config->channel_count * sizeof(ads111x_scan_channel_t));
+    scan->config.channels = scan->channels;
+
+    esp_err_t res;
+    if ((res = setup_device(scan)) != ESP_OK)
+        return res;
+
+    scan->lock = xSemaphoreCreateMutex();
+    scan->stopped = xSemaphoreCreateBinary();
+    if (!scan->lock || !scan->stopped)
+    {
+        free_sync(scan);
+        return ESP_ERR_NO_MEM;
+    }
+
+    scan->running = true;
+    if (xTaskCreate(scan_task, TAG, ADS111X_SCAN_STACK_SIZE, scan, config->task_priority, &scan->task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Could not create scan task");
+        free_sync(scan);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if ((res = setup_gpio(scan)) != ESP_OK
+            || (res = ads111x_set_mode(dev, ADS111X_MODE_CONTINUOUS)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Could not start scan: %d", res);
+        ads111x_scan_stop(scan);
+        return res;
+    }
+
+    ESP_LOGD(TAG, "Scanning %u channels at %u SPS", (unsigned)config->channel_count, rates[config->rate]);
+
+    return ESP_OK;
+}
+
+esp_err_t ads111x_scan_stop(ads111x_scan_t *scan)
+{
+    CHECK_ARG(scan && scan->running);
+
+    // stop ALERT/RDY interrupts and conversions before the task exits, so
+    // the ISR never notifies a deleted task
+    gpio_set_intr_type(scan->config.alert_gpio, GPIO_INTR_DISABLE);
+    gpio_isr_handler_remove(scan->config.alert_gpio);
+    esp_err_t res = ads111x_set_mode(scan->dev, ADS111X_MODE_SINGLE_SHOT);
+
+    scan->running = false;
+    xTaskNotifyGive(scan->task);
+    xSemaphoreTake(scan->stopped, portMAX_DELAY);
+    free_sync(scan);
+
+    return res;
+}
+
+esp_err_t ads111x_scan_read(ads111x_scan_t *scan, size_t channel, ads111x_sample_t *samples, size_t len, size_t *count)
+{
+    CHECK_ARG(scan && scan->lock && channel < scan->config.channel_count && samples && count);
+
+    ads111x_scan_buffer_t *b = &scan->buffers[channel];
+
+    xSemaphoreTake(scan->lock, portMAX_DELAY);
+    size_t n = 0;
+    for (; n < len && b->tail != b->head; n++)
+        samples[n] = b->buf[b->tail++ % ADS111X_SCAN_BUF_SIZE];
+    xSemaphoreGive(scan->lock);
+
+    *count = n;
+
+    return ESP_OK;
+}
+
+esp_err_t ads111x_scan_get_last(ads111x_scan_t *scan, size_t channel, ads111x_sample_t *sample)
+{
+    CHECK_ARG(scan && scan->lock && channel < scan->config.channel_count && sample);
+
+    ads111x_scan_buffer_t *b = &scan->buffers[channel];
+    esp_err_t res = ESP_OK;
+
+    xSemaphoreTake(scan->lock, portMAX_DELAY);
+    if (b->head)
+        *sample = b->buf[(b->head - 1) % ADS111X_SCAN_BUF_SIZE];
+    else
+        res = ESP_ERR_NOT_FOUND;
+    xSemaphoreGive(scan->lock);
+
+    return res;
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2016 Ruslan V. Uss <unclerus@gmail.com>
+ * Copyright (c) 2020 Lucio Tarantino <https://github.com/dianlight>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of itscontributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file ads111x_scan.h
+ * @defgroup ads111x_scan ads111x_scan
+ * @{
+ *
+ * @brief Continuous conversion scan of ADS111x channels.
+ *
+ * The device runs in continuous conversion mode with ALERT/RDY configured
+ * as conversion ready output. Every ALERT/RDY pulse is timestamped by the
+ * GPIO interrupt handler and wakes up the scan task, which reads the
+ * conversion register and switches to the next channel of the list when
+ * needed. Samples are kept in a buffer per channel.
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#ifndef __ADS111X_SCAN_H__
+#define __ADS111X_SCAN_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <driver/gpio.h>
+#include "ads111x.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADS111X_SCAN_MAX_CHANNELS 8    //!< Maximum number of channels in scan list
+#define ADS111X_SCAN_BUF_SIZE     16   //!< Samples buffered per channel, must be a power of two
+#define ADS111X_SCAN_STACK_SIZE   2560 //!< Scan task stack size
+
+/**
+ * Scan channel
+ */
+typedef struct
+{
+    ads111x_mux_t mux;
+    ads111x_gain_t gain;
+} ads111x_scan_channel_t;
+
+/**
+ * Sample
+ *
+ * Only the time of the last ALERT/RDY pulse is kept. If the scan task is
+ * delayed by more than one conversion period (possible at 475 and 860 SPS
+ * with a busy I2C bus or CPU), conversions are lost and the timestamp may be
+ * up to one period newer than the value.
+ */
+typedef struct
+{
+    int16_t value;     //!< Conversion result, use ::ads111x_gain_values[] for real voltage
+    int64_t timestamp; //!< Time of the ALERT/RDY pulse, microseconds since boot
+} ads111x_sample_t;
+
+/**
+ * Callback called from the scan task for every stored sample
+ */
+typedef void (*ads111x_scan_callback_t)(size_t channel, const ads111x_sample_t *sample, void *arg);
+
+/**
+ * Scan configuration
+ */
+typedef struct
+{
+    gpio_num_t alert_gpio;                 //!< GPIO connected to ALERT/RDY pin
+    ads111x_data_rate_t rate;              //!< Data rate
+    bool ads101x;                          //!< Device is ADS101x (12 bits)
+    uint8_t discard;                       //!< Conversions dropped after a channel switch
+    uint8_t samples;                       //!< Conversions stored before switching to next channel
+    const ads111x_scan_channel_t *channels;
+    size_t channel_count;
+    ads111x_scan_callback_t callback;      //!< Optional, may be NULL
+    void *callback_arg;
+    UBaseType_t task_priority;
+} ads111x_scan_config_t;
+
+/**
+ * Buffered samples of a channel
+ */
+typedef struct
+{
+    ads111x_sample_t buf[ADS111X_SCAN_BUF_SIZE];
+    size_t head;       //!< Samples stored since start
+    size_t tail;       //!< Samples read since start
+    uint32_t overruns; //!< Samples dropped because buffer was full
+} ads111x_scan_buffer_t;
+
+/**
+ * Scan descriptor
+ */
+typedef struct
+{
+    i2c_dev_t *dev;
+    ads111x_scan_config_t config;
+    ads111x_scan_channel_t channels[ADS111X_SCAN_MAX_CHANNELS];
+    ads111x_scan_buffer_t buffers[ADS111X_SCAN_MAX_CHANNELS];
+    size_t current;             //!< Channel being converted
+    size_t conversions;         //!< Conversions since last channel switch
+    volatile int64_t ready_time; //!< Time of the last ALERT/RDY pulse
+    volatile bool running;
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t stopped;
+    TaskHandle_t task;
+} ads111x_scan_t;
+
+/**
+ * @brief Start scanning channels
+ *
+ * Device is switched to continuous conversion mode, comparator thresholds
+ * and queue are overwritten to use ALERT/RDY as conversion ready output.
+ *
+ * In continuous mode a conversion in progress is not restarted when the
+ * input is changed, so at least one conversion should be discarded after
+ * each channel switch (`discard` >= 1).
+ *
+ * While the scan is running, other functions of the device must not be
+ * called.
+ *
+ * @param scan Scan descriptor
+ * @param dev Device descriptor, initialized with ::ads111x_init_desc()
+ * @param config Scan configuration, channel list is copied
+ * @return `ESP_OK` on success
+ */
+esp_err_t ads111x_scan_start(ads111x_scan_t *scan, i2c_dev_t *dev, const ads111x_scan_config_t *config);
+
+/**
+ * @brief Stop scanning channels
+ *
+ * Disables ALERT/RDY interrupt, puts the device back to single-shot mode
+ * and waits for the scan task to exit.
+ *
+ * @param scan Scan descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t ads111x_scan_stop(ads111x_scan_t *scan);
+
+/**
+ * @brief Take buffered samples of a channel
+ *
+ * @param scan Scan descriptor
+ * @param channel Channel index in scan list
+ * @param[out] samples Buffer for samples
+ * @param len Buffer length, samples
+ * @param[out] count Number of samples copied to buffer
+ * @return `ESP_OK` on success
+ */
+esp_err_t ads111x_scan_read(ads111x_scan_t *scan, size_t channel, ads111x_sample_t *samples, size_t len, size_t *count);
+
+/**
+ * @brief Get last sample of a channel, without taking it from buffer
+ *
+ * @param scan Scan descriptor
+ * @param channel Channel index in scan list
+ * @param[out] sample Last sample
+ * @return `ESP_OK` on success, `ESP_ERR_NOT_FOUND` if channel has no samples yet
+ */
+esp_err_t ads111x_scan_get_last(ads111x_scan_t *scan, size_t channel, ads111x_sample_t *sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __ADS111X_SCAN_H__ */
@@ -1,2 +1,7 @@
 COMPONENT_ADD_INCLUDEDIRS = .
-COMPONENT_DEPENDS = i2cdev log esp_idf_lib_helpers
+
+ifdef CONFIG_IDF_TARGET_ESP8266
+COMPONENT_DEPENDS = i2cdev log esp_idf_lib_helpers esp8266 freertos
+else
+COMPONENT_DEPENDS = i2cdev log esp_idf_lib_helpers driver freertos
+endif
@@ -23,8 +23,53 @@
 
 #include "color.h"
 #include <math.h>
+#include <string.h>
 #include <lib8tion.h>
 
+/*
+ * SWAR helpers: 8-bit math on every byte of a 32-bit word at once.
+ * Results are bit-exact with scale8() and qadd8().
+ */
+
+static inline uint32_t swar_scale8(uint32_t w, fract8 scale)
+{
+    // even and odd bytes are scaled in 16-bit lanes, 255 * 256 never overflows a lane
+    uint32_t s = (uint32_t)scale + 1;
+    return ((((w & 0x00ff00ff) * s) >> 8) & 0x00ff00ff) | ((((w >> 8) & 0x00ff00ff) * s) & 0xff00ff00);
+}
+
+static inline uint32_t swar_qadd8(uint32_t a, uint32_t b)
+{
+    uint32_t s = (a & 0x7f7f7f7f) + (b & 0x7f7f7f7f);
+    // carry out of bit 7 of every byte
+    uint32_t c = ((a & b) | ((a | b) & s)) & 0x80808080;
+    return (s ^ ((a ^ b) & 0x80808080)) | ((c >> 7) * 0xff);
+}
+
+static inline uint32_t load32(const uint8_t *p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline void store32(uint8_t *p, uint32_t w)
+{
+    memcpy(p, &w, sizeof(w));
+}
+
+static inline uint32_t px_load(const rgb_t *p)
+{
+    return (uint32_t)p->r | ((uint32_t)p->g << 8) | ((uint32_t)p->b << 16);
+}
+
+static inline void px_store(rgb_t *p, uint32_t w)
+{
+    p->r = (uint8_t)w;
+    p->g = (uint8_t)(w >> 8);
+    p->b = (uint8_t)(w >> 16);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #define APPLY_DIMMING(X) (X)
@@ -131,6 +176,26 @@ rgb_t hsv2rgb_spectrum(hsv_t hsv)
     return hsv2rgb_raw(hsv);
 }
 
+// Bit offsets of the rising and falling ramps in a px_load() word by hue
+// section, hues 0xC0..0xFF fall into section 2 as in hsv2rgb_raw()
+static const uint8_t raw_rampup_shift[4] = { 8, 16, 0, 0 };
+static const uint8_t raw_rampdown_shift[4] = { 0, 8, 16, 16 };
+
+static inline uint32_t raw_px(hsv_t hsv)
+{
+    uint8_t brightness_floor = (hsv.val * (255 - hsv.sat)) / 256;
+    uint8_t color_amplitude = hsv.val - brightness_floor;
+    uint8_t section = hsv.hue / HSV_SECTION_3;
+    uint8_t offset = hsv.hue % HSV_SECTION_3;
+
+    uint32_t rampup = (offset * color_amplitude) / (256 / 4);
+    uint32_t rampdown = (((HSV_SECTION_3 - 1) - offset) * color_amplitude) / (256 / 4);
+
+    return brightness_floor * 0x010101
+        + (rampup << raw_rampup_shift[section])
+        + (rampdown << raw_rampdown_shift[section]);
+}
+
 #define K255 255
 #define K171 171
 #define K170 170
@@ -349,87 +414,97 @@ rgb_t hsv2rgb_rainbow(hsv_t hsv)
     return rgb_from_values(r, g, b);
 }
 
-#define FIXFRAC8(N,D) (((N) * 256) / (D))
-
-// This function is only an approximation, and it is not
-// nearly as fast as the normal HSV-to-RGB conversion.
-// See extended notes in the .h file.
-hsv_t rgb2hsv_approximate(rgb_t rgb)
+// hsv2rgb_rainbow() of fully saturated and bright hues, packed as px_load()
+static const uint32_t rainbow_hue_table[256] = {
+    0x0000ff, 0x0002fd, 0x0005fa, 0x0008f7, 0x000af5, 0x000df2, 0x0010ef, 0x0012ed,
+    0x0015ea, 0x0018e7, 0x001ae5, 0x001de2, 0x0020df, 0x0022dd, 0x0025da, 0x0028d7,
+    0x002bd4, 0x002dd2, 0x0030cf, 0x0033cc, 0x0035ca, 0x0038c7, 0x003bc4, 0x003dc2,
+    0x0040bf, 0x0043bc, 0x0045ba, 0x0048b7, 0x004bb4, 0x004db2, 0x0050af, 0x0053ac,
+    0x0055ab, 0x0057ab, 0x005aab, 0x005dab, 0x005fab, 0x0062ab, 0x0065ab, 0x0067ab,
+    0x006aab, 0x006dab, 0x006fab, 0x0072ab, 0x0075ab, 0x0077ab, 0x007aab, 0x007dab,
+    0x0080ab, 0x0082ab, 0x0085ab, 0x0088ab, 0x008aab, 0x008dab, 0x0090ab, 0x0092ab,
+    0x0095ab, 0x0098ab, 0x009aab, 0x009dab, 0x00a0ab, 0x00a2ab, 0x00a5ab, 0x00a8ab,
+    0x00aaab, 0x00aca6, 0x00afa1, 0x00b29b, 0x00b496, 0x00b791, 0x00ba8b, 0x00bc86,
+    0x00bf81, 0x00c27b, 0x00c476, 0x00c771, 0x00ca6b, 0x00cc66, 0x00cf61, 0x00d25b,
+    0x00d556, 0x00d751, 0x00da4b, 0x00dd46, 0x00df41, 0x00e23b, 0x00e536, 0x00e731,
+    0x00ea2b, 0x00ed26, 0x00ef21, 0x00f21b, 0x00f516, 0x00f711, 0x00fa0b, 0x00fd06,
+    0x00ff00, 0x02fd00, 0x05fa00, 0x08f700, 0x0af500, 0x0df200, 0x10ef00, 0x12ed00,
+    0x15ea00, 0x18e700, 0x1ae500, 0x1de200, 0x20df00, 0x22dd00, 0x25da00, 0x28d700,
+    0x2bd400, 0x2dd200, 0x30cf00, 0x33cc00, 0x35ca00, 0x38c700, 0x3bc400, 0x3dc200,
+    0x40bf00, 0x43bc00, 0x45ba00, 0x48b700, 0x4bb400, 0x4db200, 0x50af00, 0x53ac00,
+    0x55ab00, 0x5aa600, 0x5fa100, 0x659b00, 0x6a9600, 0x6f9100, 0x758b00, 0x7a8600,
+    0x7f8100, 0x857b00, 0x8a7600, 0x8f7100, 0x956b00, 0x9a6600, 0x9f6100, 0xa55b00,
+    0xaa5600, 0xaf5100, 0xb54b00, 0xba4600, 0xbf4100, 0xc53b00, 0xca3600, 0xcf3100,
+    0xd52b00, 0xda2600, 0xdf2100, 0xe51b00, 0xea1600, 0xef1100, 0xf50b00, 0xfa0600,
+    0xff0000, 0xfd0002, 0xfa0005, 0xf70008, 0xf5000a, 0xf2000d, 0xef0010, 0xed0012,
+    0xea0015, 0xe70018, 0xe5001a, 0xe2001d, 0xdf0020, 0xdd0022, 0xda0025, 0xd70028,
+    0xd4002b, 0xd2002d, 0xcf0030, 0xcc0033, 0xca0035, 0xc70038, 0xc4003b, 0xc2003d,
+    0xbf0040, 0xbc0043, 0xba0045, 0xb70048, 0xb4004b, 0xb2004d, 0xaf0050, 0xac0053,
+    0xab0055, 0xa90057, 0xa6005a, 0xa3005d, 0xa1005f, 0x9e0062, 0x9b0065, 0x990067,
+    0x96006a, 0x93006d, 0x91006f, 0x8e0072, 0x8b0075, 0x890077, 0x86007a, 0x83007d,
+    0x800080, 0x7e0082, 0x7b0085, 0x780088, 0x76008a, 0x73008d, 0x700090, 0x6e0092,
+    0x6b0095, 0x680098, 0x66009a, 0x63009d, 0x6000a0, 0x5e00a2, 0x5b00a5, 0x5800a8,
+    0x5500aa, 0x5300ac, 0x5000af, 0x4d00b2, 0x4b00b4, 0x4800b7, 0x4500ba, 0x4300bc,
+    0x4000bf, 0x3d00c2, 0x3b00c4, 0x3800c7, 0x3500ca, 0x3300cc, 0x3000cf, 0x2d00d2,
+    0x2a00d5, 0x2800d7, 0x2500da, 0x2200dd, 0x2000df, 0x1d00e2, 0x1a00e5, 0x1800e7,
+    0x1500ea, 0x1200ed, 0x1000ef, 0x0d00f2, 0x0a00f5, 0x0800f7, 0x0500fa, 0x0200fd
+};
+
+// hsv2rgb_rainbow(): desaturation and value scaling are done on all channels
+// at once, scale8(x, 255) == x and scale8(x, 0) == 0 remove the special cases.
+static inline uint32_t rainbow_px(hsv_t hsv)
 {
-    uint8_t r = rgb.r;
-    uint8_t g = rgb.g;
-    uint8_t b = rgb.b;
-    uint8_t h, s, v;
-
-    // find desaturation
-    uint8_t desat = 255;
-    if (r < desat) desat = r;
-    if (g < desat) desat = g;
-    if (b < desat) desat = b;
-
-    // remove saturation from all channels
-    r -= desat;
-    g -= desat;
-    b -= desat;
-
-    s = 255 - desat;
-    if (s != 255)
-    {
-        // undo 'dimming' of saturation
-        s = 255 - sqrt16((255 - s) * 256);
-    }
-    // without lib8tion: float ... ew ... sqrt... double ew, or rather, ew ^ 0.5
-    // if( s != 255 ) s = (255 - (256.0 * sqrt( (float)(255-s) / 256.0)));
-
-    // at least one channel is now zero
-    // if all three channels are zero, we had a
-    // shade of gray.
-    if ((r + g + b) == 0)
-    {
-        // we pick hue zero for no special reason
-        hsv_t res = {
-           .h = 0, .s = 0, .v = 255 - s
-        };
-        return res;
-    }
-
-    // scale all channels up to compensate for desaturation
-    if (s < 255)
-    {
-        if (s == 0)
-            s = 1;
-        uint32_t scaleup = 65535 / (s);
-        r = ((uint32_t) (r) * scaleup) / 256;
-        g = ((uint32_t) (g) * scaleup) / 256;
-        b = ((uint32_t) (b) * scaleup) / 256;
-    }
-
-    uint16_t total = r + g + b;
+    uint8_t desat = scale8_video(255 - hsv.sat, 255 - hsv.sat);
+    uint32_t w = swar_scale8(rainbow_hue_table[hsv.hue], 255 - desat) + desat * 0x010101;
+    return swar_scale8(w, scale8_video(hsv.val, hsv.val));
+}
 
-    // scale all channels up to compensate for low values
-    if (total < 255)
-    {
-        if (total == 0)
-            total = 1;
-        uint32_t scaleup = 65535 / (total);
-        r = ((uint32_t) (r) * scaleup) / 256;
-        g = ((uint32_t) (g) * scaleup) / 256;
-        b = ((uint32_t) (b) * scaleup) / 256;
-    }
+#define FIXFRAC8(N,D) (((N) * 256) / (D))
 
-    if (total > 255)
-    {
-        v = 255;
-    }
-    else
-    {
-        v = qadd8(desat, total);
-        // undo 'dimming' of brightness
-        if (v != 255)
-            v = sqrt16(v * 256);
-        // without lib8tion: float ... ew ... sqrt... double ew, or rather, ew ^ 0.5
-        // if( v != 255) v = (256.0 * sqrt( (float)(v) / 256.0));
-    }
+// sqrt16(i * 256), undoes 'dimming' of saturation and brightness
+static const uint8_t undim8_table[256] = {
+      0,  16,  22,  27,  32,  35,  39,  42,  45,  48,  50,  53,  55,  57,  59,  61,
+     64,  65,  67,  69,  71,  73,  75,  76,  78,  80,  81,  83,  84,  86,  87,  89,
+     90,  91,  93,  94,  96,  97,  98,  99, 101, 102, 103, 104, 106, 107, 108, 109,
+    110, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126,
+    128, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142,
+    143, 144, 144, 145, 146, 147, 148, 149, 150, 150, 151, 152, 153, 154, 155, 155,
+    156, 157, 158, 159, 160, 160, 161, 162, 163, 163, 164, 165, 166, 167, 167, 168,
+    169, 170, 170, 171, 172, 173, 173, 174, 175, 176, 176, 177, 178, 178, 179, 180,
+    181, 181, 182, 183, 183, 184, 185, 185, 186, 187, 187, 188, 189, 189, 190, 191,
+    192, 192, 193, 193, 194, 195, 195, 196, 197, 197, 198, 199, 199, 200, 201, 201,
+    202, 203, 203, 204, 204, 205, 206, 206, 207, 208, 208, 209, 209, 210, 211, 211,
+    212, 212, 213, 214, 214, 215, 215, 216, 217, 217, 218, 218, 219, 219, 220, 221,
+    221, 222, 222, 223, 224, 224, 225, 225, 226, 226, 227, 227, 228, 229, 229, 230,
+    230, 231, 231, 232, 232, 233, 234, 234, 235, 235, 236, 236, 237, 237, 238, 238,
+    239, 240, 240, 241, 241, 242, 242, 243, 243, 244, 244, 245, 245, 246, 246, 247,
+    247, 248, 248, 249, 249, 250, 250, 251, 251, 252, 252, 253, 253, 254, 254, 255
+};
+
+// 65535 / i, 65535 for i = 0
+static const uint16_t recip16_table[256] = {
+    65535, 65535, 32767, 21845, 16383, 13107, 10922,  9362,  8191,  7281,  6553,  5957,  5461,  5041,  4681,  4369,
+     4095,  3855,  3640,  3449,  3276,  3120,  2978,  2849,  2730,  2621,  2520,  2427,  2340,  2259,  2184,  2114,
+     2047,  1985,  1927,  1872,  1820,  1771,  1724,  1680,  1638,  1598,  1560,  1524,  1489,  1456,  1424,  1394,
+     1365,  1337,  1310,  1285,  1260,  1236,  1213,  1191,  1170,  1149,  1129,  1110,  1092,  1074,  1057,  1040,
+     1023,  1008,   992,   978,   963,   949,   936,   923,   910,   897,   885,   873,   862,   851,   840,   829,
+      819,   809,   799,   789,   780,   771,   762,   753,   744,   736,   728,   720,   712,   704,   697,   689,
+      682,   675,   668,   661,   655,   648,   642,   636,   630,   624,   618,   612,   606,   601,   595,   590,
+      585,   579,   574,   569,   564,   560,   555,   550,   546,   541,   537,   532,   528,   524,   520,   516,
+      511,   508,   504,   500,   496,   492,   489,   485,   481,   478,   474,   471,   468,   464,   461,   458,
+      455,   451,   448,   445,   442,   439,   436,   434,   431,   428,   425,   422,   420,   417,   414,   412,
+      409,   407,   404,   402,   399,   397,   394,   392,   390,   387,   385,   383,   381,   378,   376,   374,
+      372,   370,   368,   366,   364,   362,   360,   358,   356,   354,   352,   350,   348,   346,   344,   343,
+      341,   339,   337,   336,   334,   332,   330,   329,   327,   326,   324,   322,   321,   319,   318,   316,
+      315,   313,   312,   310,   309,   307,   306,   304,   303,   302,   300,   299,   297,   296,   295,   293,
+      292,   291,   289,   288,   287,   286,   284,   283,   282,   281,   280,   278,   277,   276,   275,   274,
+      273,   271,   270,   269,   268,   267,   266,   265,   264,   263,   262,   261,   260,   259,   258,   257
+};
+
+// Hue of a color with at least one zero channel
+static inline uint8_t rgb2hsv_hue(uint8_t r, uint8_t g, uint8_t b)
+{
+    uint8_t h;
 
     // since this wasn't a pure shade of gray,
     // the interesting question is what hue is it
@@ -522,9 +597,79 @@ hsv_t rgb2hsv_approximate(rgb_t rgb)
         }
     }
 
-    h += 1;
+    return h + 1;
+}
+
+// Divisions and sqrt16() are replaced with table lookups, zero saturation is
+// mapped to 1 by the reciprocal table.
+static inline hsv_t rgb2hsv_approx(rgb_t rgb)
+{
+    uint8_t r = rgb.r;
+    uint8_t g = rgb.g;
+    uint8_t b = rgb.b;
+    uint8_t s, v;
+
+    // find desaturation
+    uint8_t desat = 255;
+    if (r < desat) desat = r;
+    if (g < desat) desat = g;
+    if (b < desat) desat = b;
+
+    // remove saturation from all channels
+    r -= desat;
+    g -= desat;
+    b -= desat;
+
+    // undo 'dimming' of saturation
+    s = 255 - undim8_table[desat];
+
+    // at least one channel is now zero
+    // if all three channels are zero, we had a
+    // shade of gray.
+    if ((r + g + b) == 0)
+    {
+        // we pick hue zero for no special reason
+        hsv_t res = {
+           .h = 0, .s = 0, .v = 255 - s
+        };
+        return res;
+    }
 
-    return hsv_from_values(h, s, v);
+    // scale all channels up to compensate for desaturation
+    if (s < 255)
+    {
+        uint32_t scaleup = recip16_table[s];
+        r = ((uint32_t) (r) * scaleup) / 256;
+        g = ((uint32_t) (g) * scaleup) / 256;
+        b = ((uint32_t) (b) * scaleup) / 256;
+    }
+
+    uint16_t total = r + g + b;
+
+    // scale all channels up to compensate for low values
+    if (total < 255)
+    {
+        if (total == 0)
+            total = 1;
+        uint32_t scaleup = recip16_table[total];
+        r = ((uint32_t) (r) * scaleup) / 256;
+        g = ((uint32_t) (g) * scaleup) / 256;
+        b = ((uint32_t) (b) * scaleup) / 256;
+        // undo 'dimming' of brightness
+        v = undim8_table[qadd8(desat, total)];
+    }
+    else
+        v = 255;
+
+    return hsv_from_values(rgb2hsv_hue(r, g, b), s, v);
+}
+
+// This function is only an approximation, and it is not
+// nearly as fast as the normal HSV-to-RGB conversion.
+// See extended notes in the .h file.
+hsv_t rgb2hsv_approximate(rgb_t rgb)
+{
+    return rgb2hsv_approx(rgb);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -755,7 +900,7 @@ void rgb_fill_gradient_hsv(rgb_t *target, size_t startpos, hsv_t startcolor, siz
     accum88 val88 = startcolor.val << 8;
     for (size_t i = startpos; i <= endpos; ++i)
     {
-        target[i] = hsv2rgb_rainbow(hsv_from_values(hue88 >> 8, sat88 >> 8, val88 >> 8));
+        px_store(&target[i], rainbow_px(hsv_from_values(hue88 >> 8, sat88 >> 8, val88 >> 8)));
         hue88 += huedelta87;
         sat88 += satdelta87;
         val88 += valdelta87;
@@ -997,16 +1142,15 @@ void blur1d(rgb_t *leds, size_t num_leds, fract8 blur_amount)
 {
     uint8_t keep = 255 - blur_amount;
     uint8_t seep = blur_amount >> 1;
-    rgb_t carryover = rgb_from_code(0);
+    uint32_t carryover = 0;
     for (size_t i = 0; i < num_leds; ++i)
     {
-        rgb_t cur = leds[i];
-        rgb_t part = cur;
-        part = rgb_scale(part, seep);
-        cur = rgb_add_rgb(rgb_scale(cur, keep), carryover);
+        uint32_t cur = px_load(&leds[i]);
+        uint32_t part = swar_scale8(cur, seep);
+        cur = swar_qadd8(swar_scale8(cur, keep), carryover);
         if (i)
-            leds[i - 1] = rgb_add_rgb(leds[i - 1], part);
-        leds[i] = cur;
+            px_store(&leds[i - 1], swar_qadd8(px_load(&leds[i - 1]), part));
+        px_store(&leds[i], cur);
         carryover = part;
     }
 }
@@ -1069,6 +1213,186 @@ void blur2d(rgb_t *leds, size_t width, size_t height, fract8 blur_amount, xy_to_
     blur_columns(leds, width, height, blur_amount, xy, ctx);
 }
 
+void blur_rows_linear(rgb_t *leds, size_t width, size_t height, fract8 blur_amount)
+{
+    for (size_t row = 0; row < height; row++)
+        blur1d(leds + row * width, width, blur_amount);
+}
+
+// columns are processed in stripes of this number of 32-bit words
+#define BLUR_STRIPE_WORDS 16
+
+void blur_columns_linear(rgb_t *leds, size_t width, size_t height, fract8 blur_amount)
+{
+    // Same math as blur_columns(), but all channels of a row are independent,
+    // so the row is processed as a byte stream, four bytes at a time
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    uint8_t *buf = (uint8_t *)leds;
+    size_t stride = width * sizeof(rgb_t);
+    size_t words = stride / sizeof(uint32_t);
+
+    for (size_t first = 0; first < words; first += BLUR_STRIPE_WORDS)
+    {
+        size_t num = words - first < BLUR_STRIPE_WORDS ? words - first : BLUR_STRIPE_WORDS;
+        uint32_t carryover[BLUR_STRIPE_WORDS] = { 0 };
+        for (size_t row = 0; row < height; row++)
+        {
+            uint8_t *p = buf + row * stride + first * sizeof(uint32_t);
+            for (size_t i = 0; i < num; i++, p += sizeof(uint32_t))
+            {
+                uint32_t cur = load32(p);
+                uint32_t part = swar_scale8(cur, seep);
+                cur = swar_qadd8(swar_scale8(cur, keep), carryover[i]);
+                if (row)
+                    store32(p - stride, swar_qadd8(load32(p - stride), part));
+                store32(p, cur);
+                carryover[i] = part;
+            }
+        }
+    }
+
+    // remaining bytes of each row
+    for (size_t col = words * sizeof(uint32_t); col < stride; col++)
+    {
+        uint8_t carryover = 0;
+        for (size_t row = 0; row < height; row++)
+        {
+            uint8_t *p = buf + row * stride + col;
+            uint8_t part = scale8(*p, seep);
+            uint8_t cur = qadd8(scale8(*p, keep), carryover);
+            if (row)
+                *(p - stride) = qadd8(*(p - stride), part);
+            *p = cur;
+            carryover = part;
+        }
+    }
+}
+
+void blur2d_linear(rgb_t *leds, size_t width, size_t height, fract8 blur_amount)
+{
+    blur_rows_linear(leds, width, height, blur_amount);
+    blur_columns_linear(leds, width, height, blur_amount);
+}
+
+void xy_map_fill(uint16_t *map, size_t width, size_t height, xy_to_offs_cb xy, void *ctx)
+{
+    for (size_t y = 0; y < height; y++)
+        for (size_t x = 0; x < width; x++)
+            map[y * width + x] = (uint16_t)xy(ctx, x, y);
+}
+
+static void blur_map_line(rgb_t *leds, const uint16_t *map, size_t step, size_t num, uint8_t keep, uint8_t seep)
+{
+    uint32_t carryover = 0;
+    for (size_t i = 0; i < num; i++, map += step)
+    {
+        uint32_t cur = px_load(&leds[*map]);
+        uint32_t part = swar_scale8(cur, seep);
+        cur = swar_qadd8(swar_scale8(cur, keep), carryover);
+        if (i)
+            px_store(&leds[*(map - step)], swar_qadd8(px_load(&leds[*(map - step)]), part));
+        px_store(&leds[*map], cur);
+        carryover = part;
+    }
+}
+
+void blur2d_map(rgb_t *leds, size_t width, size_t height, fract8 blur_amount, const uint16_t *map)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    for (size_t row = 0; row < height; row++)
+        blur_map_line(leds, map + row * width, 1, width, keep, seep);
+    for (size_t col = 0; col < width; col++)
+        blur_map_line(leds, map + col, width, height, keep, seep);
+}
+
+void rgb_fade_array(rgb_t *leds, size_t num, uint8_t fade_factor)
+{
+    uint8_t scale = ~fade_factor;
+    uint8_t *p = (uint8_t *)leds;
+    uint8_t *end = p + num * sizeof(rgb_t);
+
+    for (; p + sizeof(uint32_t) <= end; p += sizeof(uint32_t))
+        store32(p, swar_scale8(load32(p), scale));
+    for (; p < end; p++)
+        *p = scale8(*p, scale);
+}
+
+void xrgb_fade_array(xrgb_t *leds, size_t num, uint8_t fade_factor)
+{
+    uint8_t scale = ~fade_factor;
+    for (size_t i = 0; i < num; i++)
+        leds[i] = swar_scale8(leds[i], scale);
+}
+
+static void xrgb_blur_line(xrgb_t *leds, size_t step, size_t num, uint8_t keep, uint8_t seep)
+{
+    uint32_t carryover = 0;
+    for (size_t i = 0; i < num; i++, leds += step)
+    {
+        uint32_t cur = *leds;
+        uint32_t part = swar_scale8(cur, seep);
+        cur = swar_qadd8(swar_scale8(cur, keep), carryover);
+        if (i)
+            *(leds - step) = swar_qadd8(*(leds - step), part);
+        *leds = cur;
+        carryover = part;
+    }
+}
+
+void xrgb_blur2d_linear(xrgb_t *leds, size_t width, size_t height, fract8 blur_amount)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    for (size_t row = 0; row < height; row++)
+        xrgb_blur_line(leds + row * width, 1, width, keep, seep);
+    for (size_t col = 0; col < width; col++)
+        xrgb_blur_line(leds + col, width, height, keep, seep);
+}
+
+void rgb_to_xrgb_array(xrgb_t *dst, const rgb_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+        dst[i] = rgb_to_xrgb(src[i]);
+}
+
+void xrgb_to_rgb_array(rgb_t *dst, const xrgb_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+        dst[i] = xrgb_to_rgb(src[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void hsv2rgb_rainbow_array(rgb_t *dst, const hsv_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+        px_store(&dst[i], rainbow_px(src[i]));
+}
+
+void hsv2rgb_spectrum_array(rgb_t *dst, const hsv_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+    {
+        hsv_t hsv = src[i];
+        hsv.hue = scale8(hsv.hue, HUE_MAX_RAW);
+        px_store(&dst[i], raw_px(hsv));
+    }
+}
+
+void hsv2rgb_raw_array(rgb_t *dst, const hsv_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+        px_store(&dst[i], raw_px(src[i]));
+}
+
+void rgb2hsv_approximate_array(hsv_t *dst, const rgb_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+        dst[i] = rgb2hsv_approx(src[i]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 uint8_t apply_gamma2brightness(uint8_t brightness, float gamma)
@@ -1100,3 +1424,87 @@ rgb_t apply_gamma2rgb_channels(rgb_t c, float gamma_r, float gamma_g, float gamm
     };
     return res;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// apply_gamma2brightness(i, 2.2)
+const uint8_t gamma8_table_2_2[256] = {
+      0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,
+      2,   2,   3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,
+      6,   6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,
+     12,  12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,
+     19,  20,  21,  21,  22,  22,  23,  23,  24,  25,  25,  26,  27,  27,  28,  29,
+     29,  30,  31,  31,  32,  33,  33,  34,  35,  36,  36,  37,  38,  39,  40,  40,
+     41,  42,  43,  44,  45,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,
+     55,  56,  57,  58,  59,  60,  61,  62,  63,  65,  66,  67,  68,  69,  70,  71,
+     72,  73,  74,  75,  77,  78,  79,  80,  81,  82,  84,  85,  86,  87,  88,  90,
+     91,  92,  93,  95,  96,  97,  99, 100, 101, 103, 104, 105, 107, 108, 109, 111,
+    112, 114, 115, 117, 118, 119, 121, 122, 124, 125, 127, 128, 130, 131, 133, 135,
+    136, 138, 139, 141, 142, 144, 146, 147, 149, 151, 152, 154, 156, 157, 159, 161,
+    162, 164, 166, 168, 169, 171, 173, 175, 176, 178, 180, 182, 184, 186, 187, 189,
+    191, 193, 195, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 233, 235, 237, 239, 241, 244, 246, 248, 250, 252, 255
+};
+
+// apply_gamma2brightness(i, 2.8)
+const uint8_t gamma8_table_2_8[256] = {
+      0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,
+      2,   2,   2,   2,   2,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,   5,
+      5,   5,   5,   6,   6,   6,   6,   7,   7,   7,   7,   8,   8,   8,   9,   9,
+      9,  10,  10,  11,  11,  11,  12,  12,  12,  13,  13,  14,  14,  15,  15,  16,
+     16,  17,  17,  18,  18,  19,  19,  20,  20,  21,  21,  22,  23,  23,  24,  24,
+     25,  26,  26,  27,  28,  28,  29,  30,  30,  31,  32,  33,  33,  34,  35,  36,
+     37,  37,  38,  39,  40,  41,  42,  42,  43,  44,  45,  46,  47,  48,  49,  50,
+     51,  52,  53,  54,  55,  56,  57,  58,  59,  61,  62,  63,  64,  65,  66,  67,
+     69,  70,  71,  72,  74,  75,  76,  77,  79,  80,  81,  83,  84,  86,  87,  88,
+     90,  91,  93,  94,  96,  97,  99, 100, 102, 103, 105, 107, 108, 110, 111, 113,
+    115, 116, 118, 120, 122, 123, 125, 127, 129, 130, 132, 134, 136, 138, 140, 142,
+    144, 146, 148, 150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, 175,
+    177, 179, 181, 184, 186, 188, 191, 193, 195, 198, 200, 202, 205, 207, 210, 212,
+    215, 217, 220, 222, 225, 227, 230, 233, 235, 238, 241, 243, 246, 249, 252, 255
+};
+
+static void gamma_channel_init(uint8_t *table, float gamma, uint8_t correction)
+{
+    const uint8_t *precalc = NULL;
+    if (gamma == 2.2f)
+        precalc = gamma8_table_2_2;
+    else if (gamma == 2.8f)
+        precalc = gamma8_table_2_8;
+
+    for (size_t i = 0; i < 256; i++)
+    {
+        uint8_t v = precalc ? precalc[i] : apply_gamma2brightness(i, gamma);
+        table[i] = correction == 255 ? v : scale8_video(v, correction);
+    }
+}
+
+void rgb_lut_init(rgb_lut_t *lut, float gamma_r, float gamma_g, float gamma_b, rgb_t correction)
+{
+    gamma_channel_init(lut->r, gamma_r, correction.r);
+    gamma_channel_init(lut->g, gamma_g, correction.g);
+    gamma_channel_init(lut->b, gamma_b, correction.b);
+}
+
+void rgb_lut_apply_array(const rgb_lut_t *lut, rgb_t *dst, const rgb_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+    {
+        dst[i].r = lut->r[src[i].r];
+        dst[i].g = lut->g[src[i].g];
+        dst[i].b = lut->b[src[i].b];
+    }
+}
+
+void gamma8_apply_array(const uint8_t *table, rgb_t *dst, const rgb_t *src, size_t num)
+{
+    for (size_t i = 0; i < num; i++)
+    {
+        dst[i].r = table[src[i].r];
+        dst[i].g = table[src[i].g];
+        dst[i].b = table[src[i].b];
+    }
+}
@@ -127,6 +127,52 @@ rgb_t hsv2rgb_raw(hsv_t hsv);
  */
 hsv_t rgb2hsv_approximate(rgb_t rgb);
 
+/**
+ * @brief Convert an array of HSV colors to RGB using balanced rainbow
+ *
+ * Same result as ::hsv2rgb_rainbow() for every color. Hue is looked up in a
+ * table, saturation and value are applied to all channels at once without
+ * branches.
+ *
+ * @param dst   Destination array, can be the same memory as \p src
+ * @param src   Source array
+ * @param num   Number of colors
+ */
+void hsv2rgb_rainbow_array(rgb_t *dst, const hsv_t *src, size_t num);
+
+/**
+ * @brief Convert an array of HSV colors to RGB using mathematically straight spectrum
+ *
+ * Same result as ::hsv2rgb_spectrum() for every color.
+ *
+ * @param dst   Destination array, can be the same memory as \p src
+ * @param src   Source array
+ * @param num   Number of colors
+ */
+void hsv2rgb_spectrum_array(rgb_t *dst, const hsv_t *src, size_t num);
+
+/**
+ * @brief Convert an array of HSV colors to RGB using spectrum
+ *
+ * Same result as ::hsv2rgb_raw() for every color.
+ *
+ * @param dst   Destination array, can be the same memory as \p src
+ * @param src   Source array
+ * @param num   Number of colors
+ */
+void hsv2rgb_raw_array(rgb_t *dst, const hsv_t *src, size_t num);
+
+/**
+ * @brief Recover approximate HSV values from an array of RGB colors
+ *
+ * Same result as ::rgb2hsv_approximate() for every color.
+ *
+ * @param dst   Destination array, can be the same memory as \p src
+ * @param src   Source array
+ * @param num   Number of colors
+ */
+void rgb2hsv_approximate_array(hsv_t *dst, const rgb_t *src, size_t num);
+
 /**
  * @brief Approximates a 'black body radiation' spectrum for a given 'heat' level.
  *
@@ -336,6 +382,71 @@ void blur_rows(rgb_t *leds, size_t width, size_t height, fract8 blur_amount, xy_
  */
 void blur2d(rgb_t *leds, size_t width, size_t height, fract8 blur_amount, xy_to_offs_cb xy, void *ctx);
 
+/**
+ * @brief Perform a blur1d on each row of a row-major matrix
+ *
+ * Same as ::blur_rows() with `offs = y * width + x`, without callbacks.
+ */
+void blur_rows_linear(rgb_t *leds, size_t width, size_t height, fract8 blur_amount);
+
+/**
+ * @brief Perform a blur1d on each column of a row-major matrix
+ *
+ * Same as ::blur_columns() with `offs = y * width + x`. Rows are processed
+ * as contiguous byte streams, four channels at a time.
+ */
+void blur_columns_linear(rgb_t *leds, size_t width, size_t height, fract8 blur_amount);
+
+/**
+ * @brief Two-dimensional blur filter for a row-major matrix
+ *
+ * Same as ::blur2d() with `offs = y * width + x`, but much faster.
+ */
+void blur2d_linear(rgb_t *leds, size_t width, size_t height, fract8 blur_amount);
+
+/**
+ * @brief Precalculate pixel offsets of a matrix (serpentine, irregular, ...)
+ *
+ * Fills \p map with `width * height` offsets, `map[y * width + x] = xy(ctx, x, y)`,
+ * for use with ::blur2d_map().
+ */
+void xy_map_fill(uint16_t *map, size_t width, size_t height, xy_to_offs_cb xy, void *ctx);
+
+/**
+ * @brief Two-dimensional blur filter using precalculated offsets
+ *
+ * Same as ::blur2d(), but offsets are taken from \p map filled by ::xy_map_fill()
+ * instead of calling callback twice per pixel.
+ */
+void blur2d_map(rgb_t *leds, size_t width, size_t height, fract8 blur_amount, const uint16_t *map);
+
+/**
+ * @brief rgb_fade() for an array of RGB colors
+ */
+void rgb_fade_array(rgb_t *leds, size_t num, uint8_t fade_factor);
+
+/**
+ * @brief rgb_fade() for an array of packed XRGB colors
+ */
+void xrgb_fade_array(xrgb_t *leds, size_t num, uint8_t fade_factor);
+
+/**
+ * @brief Two-dimensional blur filter for a row-major matrix of packed XRGB colors
+ *
+ * Same as ::blur2d_linear(), one word load and store per pixel.
+ */
+void xrgb_blur2d_linear(xrgb_t *leds, size_t width, size_t height, fract8 blur_amount);
+
+/**
+ * @brief Convert an array of RGB colors to packed XRGB colors
+ */
+void rgb_to_xrgb_array(xrgb_t *dst, const rgb_t *src, size_t num);
+
+/**
+ * @brief Convert an array of packed XRGB colors to RGB colors
+ */
+void xrgb_to_rgb_array(rgb_t *dst, const xrgb_t *src, size_t num);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Gamma functions
 
@@ -349,6 +460,8 @@ uint8_t apply_gamma2brightness(uint8_t brightness, float gamma);
 
 /**
  * @brief Single gamma adjustment to each channel of a RGB color.
+ *
+ * Calls powf() for every channel, use ::rgb_lut_t to adjust many colors.
  */
 rgb_t apply_gamma2rgb(rgb_t c, float gamma);
 
@@ -357,6 +470,87 @@ rgb_t apply_gamma2rgb(rgb_t c, float gamma);
  */
 rgb_t apply_gamma2rgb_channels(rgb_t c, float gamma_r, float gamma_g, float gamma_b);
 
+////////////////////////////////////////////////////////////////////////////////
+// Gamma lookup tables
+
+/**
+ * Precalculated gamma table, same values as apply_gamma2brightness(i, 2.2)
+ */
+extern const uint8_t gamma8_table_2_2[256];
+
+/**
+ * Precalculated gamma table, same values as apply_gamma2brightness(i, 2.8)
+ */
+extern const uint8_t gamma8_table_2_8[256];
+
+/**
+ * Per-channel lookup table with gamma and color correction (white balance)
+ */
+typedef struct
+{
+    uint8_t r[256];
+    uint8_t g[256];
+    uint8_t b[256];
+} rgb_lut_t;
+
+/**
+ * @brief Build a lookup table with gamma and color correction for each channel
+ *
+ * Each channel is gamma-adjusted as apply_gamma2brightness() does and then
+ * scaled by the correspondent channel of \p correction. Tables for gamma
+ * 2.2 and 2.8 are copied from precalculated ones, without calling powf().
+ *
+ * @param lut        Lookup table to fill
+ * @param gamma_r    Gamma for red channel
+ * @param gamma_g    Gamma for green channel
+ * @param gamma_b    Gamma for blue channel
+ * @param correction Color correction, `{ .r = 255, .g = 255, .b = 255 }` for none
+ */
+void rgb_lut_init(rgb_lut_t *lut, float gamma_r, float gamma_g, float gamma_b, rgb_t correction);
+
+/**
+ * @brief Build a lookup table with single gamma for all channels and no color correction
+ */
+static inline void rgb_lut_init_gamma(rgb_lut_t *lut, float gamma)
+{
+    rgb_t white = { .r = 255, .g = 255, .b = 255 };
+    rgb_lut_init(lut, gamma, gamma, gamma, white);
+}
+
+/**
+ * @brief Apply lookup table to a single RGB color
+ */
+static inline rgb_t rgb_lut_apply(const rgb_lut_t *lut, rgb_t c)
+{
+    rgb_t res = {
+        .r = lut->r[c.r],
+        .g = lut->g[c.g],
+        .b = lut->b[c.b],
+    };
+    return res;
+}
+
+/**
+ * @brief Apply lookup table to an array of RGB colors
+ *
+ * @param lut  Lookup table
+ * @param dst  Destination array, can be the same as \p src
+ * @param src  Source array
+ * @param num  Number of colors
+ */
+void rgb_lut_apply_array(const rgb_lut_t *lut, rgb_t *dst, const rgb_t *src, size_t num);
+
+/**
+ * @brief Apply single-channel table (e.g. ::gamma8_table_2_2) to all channels
+ *        of an array of RGB colors
+ *
+ * @param table 256-entry table
+ * @param dst   Destination array, can be the same as \p src
+ * @param src   Source array
+ * @param num   Number of colors
+ */
+void gamma8_apply_array(const uint8_t *table, rgb_t *dst, const rgb_t *src, size_t num);
+
 #ifdef __cplusplus
 }
 #endif
@@ -94,6 +94,22 @@ static inline uint32_t rgb_to_code(rgb_t color)
     return ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
 }
 
+/// Packed 32-bit color 0x00RRGGBB (XRGB). Unlike rgb_t it is word-aligned,
+/// so arrays of it can be processed with one load and one store per pixel
+typedef uint32_t xrgb_t;
+
+/// Convert RGB color to packed XRGB color
+static inline xrgb_t rgb_to_xrgb(rgb_t color)
+{
+    return rgb_to_code(color);
+}
+
+/// Convert packed XRGB color to RGB color, X byte is ignored
+static inline rgb_t xrgb_to_rgb(xrgb_t color)
+{
+    return rgb_from_code(color);
+}
+
 /// Add a constant to each channel of RGB color,
 /// saturating at 0xFF
 static inline rgb_t rgb_add(rgb_t a, uint8_t val)
@@ -48,6 +48,10 @@
 #include <esp_idf_lib_helpers.h>
 #include "ds18x20.h"
 
+#if HELPER_TARGET_IS_ESP32
+#include <onewire_rmt.h>
+#endif
+
 #define ds18x20_WRITE_SCRATCHPAD 0x4E
 #define ds18x20_READ_SCRATCHPAD  0xBE
 #define ds18x20_COPY_SCRATCHPAD  0x48
@@ -76,6 +80,29 @@ static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
 
 static const char *TAG = "ds18x20";
 
+// Write a command and apply strong pullup right after it, as needed by
+// parasite-powered devices.
+static void write_and_power(gpio_num_t pin, uint8_t cmd)
+{
+#if HELPER_TARGET_IS_ESP32
+    // RMT transport blocks until the transmission is done, so it can't run
+    // in a critical section
+    if (onewire_rmt_attached(pin))
+    {
+        onewire_write(pin, cmd);
+        onewire_power(pin);
+        return;
+    }
+#endif
+
+    PORT_ENTER_CRITICAL;
+    onewire_write(pin, cmd);
+    // For parasitic devices, power must be applied within 10us after issuing
+    // the command.
+    onewire_power(pin);
+    PORT_EXIT_CRITICAL;
+}
+
 esp_err_t ds18x20_measure(gpio_num_t pin, ds18x20_addr_t addr, bool wait)
 {
     if (!onewire_reset(pin))
@@ -86,12 +113,7 @@ esp_err_t ds18x20_measure(gpio_num_t pin, ds18x20_addr_t addr, bool wait)
     else
         onewire_select(pin, addr);
 
-    PORT_ENTER_CRITICAL;
-    onewire_write(pin, ds18x20_CONVERT_T);
-    // For parasitic devices, power must be applied within 10us after issuing
-    // the convert command.
-    onewire_power(pin);
-    PORT_EXIT_CRITICAL;
+    write_and_power(pin, ds18x20_CONVERT_T);
 
     if (wait)
     {
@@ -162,12 +184,7 @@ esp_err_t ds18x20_copy_scratchpad(gpio_num_t pin, ds18x20_addr_t addr)
     else
         onewire_select(pin, addr);
 
-    PORT_ENTER_CRITICAL;
-    onewire_write(pin, ds18x20_COPY_SCRATCHPAD);
-    // For parasitic devices, power must be applied within 10us after issuing
-    // the convert command.
-    onewire_power(pin);
-    PORT_EXIT_CRITICAL;
+    write_and_power(pin, ds18x20_COPY_SCRATCHPAD);
 
     // And then it needs to keep that power up for 10ms.
     SLEEP_MS(10);
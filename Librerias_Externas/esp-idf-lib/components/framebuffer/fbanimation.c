@@ -32,6 +32,7 @@
  */
 #include <esp_err.h>
 #include <esp_log.h>
+#include <string.h>
 #include "fbanimation.h"
 
 static const char *TAG = "animation";
@@ -39,24 +40,147 @@ static const char *TAG = "animation";
 #define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
 
+static void update_stats(fb_animation_t *animation, esp_err_t res, int64_t draw_us, int64_t render_us)
+{
+    uint32_t frame_ms = (uint32_t)((draw_us + render_us) / 1000);
+    size_t bin = 0;
+    while (frame_ms && bin < FB_ANIMATION_HIST_BINS - 1)
+    {
+        frame_ms >>= 1;
+        bin++;
+    }
+
+    portENTER_CRITICAL(&animation->lock);
+    fb_animation_stats_t *stats = &animation->stats;
+    if (res == ESP_ERR_INVALID_STATE)
+        // framebuffer is locked by renderer of previous frame
+        stats->dropped++;
+    else if (res != ESP_OK)
+        stats->errors++;
+    else
+    {
+        stats->frames++;
+        stats->draw_us_total += draw_us;
+        stats->render_us_total += render_us;
+        if (draw_us > stats->draw_us_max)
+            stats->draw_us_max = draw_us;
+        if (render_us > stats->render_us_max)
+            stats->render_us_max = render_us;
+        stats->frame_hist[bin]++;
+    }
+    portEXIT_CRITICAL(&animation->lock);
+}
+
+static void render_frame(fb_animation_t *animation, int64_t draw_us)
+{
+    int64_t start = esp_timer_get_time();
+    esp_err_t res = fb_render(animation->fb, animation->render_ctx);
+    int64_t render_us = esp_timer_get_time() - start;
+    if (res != ESP_OK && res != ESP_ERR_INVALID_STATE)
+        ESP_LOGE(TAG, "Error rendering frame %d (%s)", res, esp_err_to_name(res));
+    update_stats(animation, res, draw_us, render_us);
+}
+
+static void render_task(void *arg)
+{
+    fb_animation_t *animation = (fb_animation_t *)arg;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // exit request is checked between frames only, so the task never
+        // dies inside fb_render() holding the framebuffer mutex
+        if (animation->render_exit)
+            break;
+        render_frame(animation, animation->draw_us);
+    }
+
+    xSemaphoreGive(animation->render_done);
+    vTaskDelete(NULL);
+}
+
 static void display_frame(void *ctx)
 {
     fb_animation_t *animation = (fb_animation_t *)ctx;
 
+    // fb_animation_stop() and fb_animation_play() wait for the frame in
+    // progress, so they cannot interleave with rescheduling below
+    xSemaphoreTake(animation->ctrl, portMAX_DELAY);
+    if (!animation->playing)
+    {
+        xSemaphoreGive(animation->ctrl);
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+
+    // skip frames whose deadlines are already missed
+    if (start - animation->deadline >= animation->period_us)
+    {
+        uint32_t skipped = (start - animation->deadline) / animation->period_us;
+        animation->deadline += (int64_t)skipped * animation->period_us;
+        animation->fb->frame_num += skipped;
+        portENTER_CRITICAL(&animation->lock);
+        animation->stats.dropped += skipped;
+        portEXIT_CRITICAL(&animation->lock);
+    }
+
     // run effect
     esp_err_t res = animation->draw ? animation->draw(animation->fb) : ESP_FAIL;
+    int64_t draw_us = esp_timer_get_time() - start;
     if (res != ESP_OK)
     {
-        ESP_LOGE(TAG, "Error running effect %d (%s)", res, esp_err_to_name(res));
-        return;
+        if (res != ESP_ERR_INVALID_STATE)
+            ESP_LOGE(TAG, "Error running effect %d (%s)", res, esp_err_to_name(res));
+        update_stats(animation, res, draw_us, 0);
     }
     // render frame
-    res = fb_render(animation->fb, animation->render_ctx);
-    if (res != ESP_OK)
+    else if (animation->render_task)
     {
-        ESP_LOGE(TAG, "Error rendering frame %d (%s)", res, esp_err_to_name(res));
-        return;
+        animation->draw_us = draw_us;
+        xTaskNotifyGive(animation->render_task);
     }
+    else
+        render_frame(animation, draw_us);
+
+    // schedule next frame
+    animation->deadline += animation->period_us;
+    int64_t delay = animation->deadline - esp_timer_get_time();
+    esp_timer_start_once(animation->timer, delay > 0 ? delay : 0);
+    xSemaphoreGive(animation->ctrl);
+}
+
+static void timer_barrier(void *ctx)
+{
+    xSemaphoreGive((SemaphoreHandle_t)ctx);
+}
+
+// Wait for timer callbacks which are already dispatched. Callbacks are run
+// one by one from esp_timer task, so when a new timer fires, previous
+// callbacks have returned.
+static esp_err_t wait_timer_callbacks(void)
+{
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    if (!done)
+        return ESP_ERR_NO_MEM;
+
+    esp_timer_handle_t barrier;
+    esp_timer_create_args_t timer_args = {
+        .arg = done,
+        .callback = timer_barrier,
+        .dispatch_method = ESP_TIMER_TASK,
+    };
+    esp_err_t res = esp_timer_create(&timer_args, &barrier);
+    if (res == ESP_OK)
+    {
+        res = esp_timer_start_once(barrier, 0);
+        if (res == ESP_OK)
+            xSemaphoreTake(done, portMAX_DELAY);
+        esp_timer_delete(barrier);
+    }
+    vSemaphoreDelete(done);
+
+    return res;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -67,34 +191,127 @@ esp_err_t fb_animation_init(fb_animation_t *animation, framebuffer_t *fb)
 
     animation->fb = fb;
     animation->timer = NULL;
+    animation->draw = NULL;
+    animation->playing = false;
+    animation->render_task = NULL;
+    animation->render_done = NULL;
+    animation->render_exit = false;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    animation->lock = lock;
+    memset(&animation->stats, 0, sizeof(animation->stats));
     esp_timer_create_args_t timer_args = {
         .arg = animation,
         .callback = display_frame,
         .dispatch_method = ESP_TIMER_TASK,
     };
-    return esp_timer_create(&timer_args, &animation->timer);
+    animation->ctrl = xSemaphoreCreateMutex();
+    if (!animation->ctrl)
+        return ESP_ERR_NO_MEM;
+    esp_err_t res = esp_timer_create(&timer_args, &animation->timer);
+    if (res != ESP_OK)
+    {
+        vSemaphoreDelete(animation->ctrl);
+        animation->ctrl = NULL;
+    }
+    return res;
+}
+
+esp_err_t fb_animation_set_render_task(fb_animation_t *animation, BaseType_t core_id, UBaseType_t priority,
+        uint32_t stack_size)
+{
+    CHECK_ARG(animation && !animation->render_task && !animation->playing);
+
+    animation->render_done = xSemaphoreCreateBinary();
+    if (!animation->render_done)
+        return ESP_ERR_NO_MEM;
+    animation->render_exit = false;
+    if (xTaskCreatePinnedToCore(render_task, "fb_render", stack_size, animation, priority,
+                                &animation->render_task, core_id) != pdPASS)
+    {
+        animation->render_task = NULL;
+        vSemaphoreDelete(animation->render_done);
+        animation->render_done = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
 }
 
 esp_err_t fb_animation_play(fb_animation_t *animation, uint8_t fps, fb_draw_cb_t draw, void *render_ctx)
 {
     CHECK_ARG(animation && fps && draw);
 
+    xSemaphoreTake(animation->ctrl, portMAX_DELAY);
+    // restart if already playing
+    esp_timer_stop(animation->timer);
     animation->render_ctx = render_ctx;
     animation->draw = draw;
-    return esp_timer_start_periodic(animation->timer, 1000000 / fps);
+    animation->period_us = 1000000 / fps;
+    animation->deadline = esp_timer_get_time() + animation->period_us;
+    animation->playing = true;
+    esp_err_t res = esp_timer_start_once(animation->timer, animation->period_us);
+    if (res != ESP_OK)
+        animation->playing = false;
+    xSemaphoreGive(animation->ctrl);
+
+    return res;
 }
 
 esp_err_t fb_animation_stop(fb_animation_t *animation)
 {
     CHECK_ARG(animation);
 
-    return esp_timer_stop(animation->timer);
+    xSemaphoreTake(animation->ctrl, portMAX_DELAY);
+    animation->playing = false;
+    // timer is not running when stopped between frames
+    esp_timer_stop(animation->timer);
+    xSemaphoreGive(animation->ctrl);
+
+    return ESP_OK;
+}
+
+esp_err_t fb_animation_get_stats(fb_animation_t *animation, fb_animation_stats_t *stats)
+{
+    CHECK_ARG(animation && stats);
+
+    portENTER_CRITICAL(&animation->lock);
+    *stats = animation->stats;
+    portEXIT_CRITICAL(&animation->lock);
+
+    return ESP_OK;
+}
+
+esp_err_t fb_animation_reset_stats(fb_animation_t *animation)
+{
+    CHECK_ARG(animation);
+
+    portENTER_CRITICAL(&animation->lock);
+    memset(&animation->stats, 0, sizeof(animation->stats));
+    portEXIT_CRITICAL(&animation->lock);
+
+    return ESP_OK;
 }
 
 esp_err_t fb_animation_free(fb_animation_t *animation)
 {
     CHECK_ARG(animation);
 
-    esp_timer_stop(animation->timer);
-    return esp_timer_delete(animation->timer);
+    fb_animation_stop(animation);
+    // a callback may be dispatched already and wait for ctrl mutex
+    CHECK(wait_timer_callbacks());
+    if (animation->render_task)
+    {
+        // let render task finish current frame and exit by itself
+        animation->render_exit = true;
+        xTaskNotifyGive(animation->render_task);
+        xSemaphoreTake(animation->render_done, portMAX_DELAY);
+        vSemaphoreDelete(animation->render_done);
+        animation->render_done = NULL;
+        animation->render_task = NULL;
+    }
+    esp_err_t res = esp_timer_delete(animation->timer);
+    vSemaphoreDelete(animation->ctrl);
+    animation->ctrl = NULL;
+
+    return res;
 }
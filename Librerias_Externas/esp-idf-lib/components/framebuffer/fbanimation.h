@@ -36,6 +36,8 @@
 #define __FBANIMATION_H__
 
 #include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "framebuffer.h"
 
 #ifdef __cplusplus
@@ -47,6 +49,28 @@ extern "C" {
  */
 typedef esp_err_t (*fb_draw_cb_t)(framebuffer_t *fb);
 
+/**
+ * Number of bins in frame time histogram. Bin 0 counts frames faster than
+ * 1 ms, bin N counts frames from 2^(N-1) to 2^N ms, last bin counts all
+ * slower frames.
+ */
+#define FB_ANIMATION_HIST_BINS 8
+
+/**
+ * Animation statistics
+ */
+typedef struct
+{
+    uint32_t frames;                            ///< Number of drawn and rendered frames
+    uint32_t dropped;                           ///< Number of frames skipped due to missed deadlines or busy renderer
+    uint32_t errors;                            ///< Number of failed draws and renders
+    uint32_t draw_us_max;                       ///< Longest draw time, us
+    uint32_t render_us_max;                     ///< Longest render (flush) time, us
+    uint64_t draw_us_total;                     ///< Sum of draw times, us
+    uint64_t render_us_total;                   ///< Sum of render times, us
+    uint32_t frame_hist[FB_ANIMATION_HIST_BINS]; ///< Histogram of draw + render times
+} fb_animation_stats_t;
+
 /**
  * Animation descriptor
  */
@@ -56,6 +80,16 @@ typedef struct
     void *render_ctx;          ///< Renderer context
     esp_timer_handle_t timer;  ///< Animation timer
     fb_draw_cb_t draw;         ///< Draw function
+    uint32_t period_us;        ///< Frame period, us
+    int64_t deadline;          ///< Time of next frame since boot, us
+    int64_t draw_us;           ///< Draw time of frame passed to render task
+    volatile bool playing;     ///< true while animation is playing
+    SemaphoreHandle_t ctrl;    ///< Play/stop mutex, held by timer callback during frame
+    TaskHandle_t render_task;  ///< Render task or NULL to render from timer callback
+    SemaphoreHandle_t render_done; ///< Given by render task on exit
+    volatile bool render_exit; ///< Render task exit request
+    portMUX_TYPE lock;         ///< Statistics lock
+    fb_animation_stats_t stats; ///< Statistics, see ::fb_animation_get_stats()
 } fb_animation_t;
 
 /**
@@ -67,9 +101,31 @@ typedef struct
  */
 esp_err_t fb_animation_init(fb_animation_t *animation, framebuffer_t *fb);
 
+/**
+ * @brief Render frames from separate task pinned to CPU core
+ *
+ * By default frames are drawn and rendered from esp_timer task. With render
+ * task the timer callback only draws the frame, so slow flushes (long
+ * LED strips, SPI/I2C displays) do not delay other timers and next frame
+ * drawing. Must be called before ::fb_animation_play().
+ *
+ * @param animation     Animation descriptor
+ * @param core_id       CPU core for render task or tskNO_AFFINITY
+ * @param priority      Render task priority
+ * @param stack_size    Render task stack size
+ * @return              ESP_OK on success
+ */
+esp_err_t fb_animation_set_render_task(fb_animation_t *animation, BaseType_t core_id, UBaseType_t priority,
+        uint32_t stack_size);
+
 /**
  * @brief Play animation
  *
+ * Frames are paced by absolute deadlines: if drawing and rendering take
+ * longer than a frame period, missed frames are skipped and counted as
+ * dropped, and `fb->frame_num` is advanced by the number of skipped frames,
+ * so effects depending on it keep their speed.
+ *
  * @param animation     Animation descriptor
  * @param fps           Target FPS
  * @param draw          Function for drawing on a framebuffer
@@ -81,13 +137,36 @@ esp_err_t fb_animation_play(fb_animation_t *animation, uint8_t fps, fb_draw_cb_t
 /**
  * @brief Stop playing animation
  *
+ * Waits for the frame in progress to be drawn, so it must not be called
+ * from the draw function. Same applies to ::fb_animation_play() and
+ * ::fb_animation_free().
+ *
  * @param animation     Animation descriptor
  * @return              ESP_OK on success
  */
 esp_err_t fb_animation_stop(fb_animation_t *animation);
 
 /**
- * @brief Create animation based on LED effect
+ * @brief Get animation statistics
+ *
+ * @param animation     Animation descriptor
+ * @param[out] stats    Statistics
+ * @return              ESP_OK on success
+ */
+esp_err_t fb_animation_get_stats(fb_animation_t *animation, fb_animation_stats_t *stats);
+
+/**
+ * @brief Reset animation statistics
+ *
+ * @param animation     Animation descriptor
+ * @return              ESP_OK on success
+ */
+esp_err_t fb_animation_reset_stats(fb_animation_t *animation);
+
+/**
+ * @brief Stop animation and free resources
+ *
+ * Render task, if any, finishes current frame before exit.
  *
  * @param animation     Animation descriptor
  * @return              ESP_OK on success
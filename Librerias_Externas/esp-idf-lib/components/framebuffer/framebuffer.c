@@ -31,32 +31,62 @@
  * MIT Licensed as described in the file LICENSE
  */
 #include <stdlib.h>
+#include <string.h>
 #include "framebuffer.h"
 
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
 #define CHECK(x) do { esp_err_t __; if ((__ = (x)) != ESP_OK) return __; } while (0)
 
-static size_t xy(void *ctx, size_t x, size_t y)
+#define FB_PIXELS(fb) ((fb)->format == FB_FORMAT_XRGB ? (void *)(fb)->data_xrgb : (void *)(fb)->data)
+
+static inline void reset_dirty(framebuffer_t *fb)
+{
+    fb->dirty.x0 = fb->width;
+    fb->dirty.y0 = fb->height;
+    fb->dirty.x1 = 0;
+    fb->dirty.y1 = 0;
+}
+
+static inline void mark_dirty(framebuffer_t *fb, size_t x0, size_t y0, size_t x1, size_t y1)
 {
-    framebuffer_t *fb = (framebuffer_t *)ctx;
-    return y * fb->width + x;
+    if (x0 < fb->dirty.x0) fb->dirty.x0 = x0;
+    if (y0 < fb->dirty.y0) fb->dirty.y0 = y0;
+    if (x1 > fb->dirty.x1) fb->dirty.x1 = x1;
+    if (y1 > fb->dirty.y1) fb->dirty.y1 = y1;
 }
 
+#define MARK_ALL_DIRTY(fb) mark_dirty((fb), 0, 0, (fb)->width, (fb)->height)
+
 esp_err_t fb_init(framebuffer_t *fb, size_t width, size_t height, fb_render_cb_t render_cb)
 {
-    CHECK_ARG(fb && width && height && render_cb);
+    return fb_init_format(fb, width, height, FB_FORMAT_RGB, render_cb);
+}
+
+esp_err_t fb_init_format(framebuffer_t *fb, size_t width, size_t height, fb_format_t format, fb_render_cb_t render_cb)
+{
+    CHECK_ARG(fb && width && height && render_cb
+              && (format == FB_FORMAT_RGB || format == FB_FORMAT_XRGB));
 
     fb->width = width;
     fb->height = height;
+    fb->format = format;
     fb->frame_num = 0;
     fb->last_frame_us = 0;
     fb->render = render_cb;
     fb->internal = NULL;
+    fb->dirty.x0 = fb->dirty.y0 = 0;
+    fb->dirty.x1 = width;
+    fb->dirty.y1 = height;
+    fb->data = NULL;
+    fb->data_xrgb = NULL;
     fb->mutex = xSemaphoreCreateMutex();
     if (!fb->mutex)
         return ESP_ERR_NO_MEM;
-    fb->data = calloc(1, FB_SIZE(fb));
-    if (!fb->data)
+    if (format == FB_FORMAT_XRGB)
+        fb->data_xrgb = calloc(1, FB_SIZE(fb));
+    else
+        fb->data = calloc(1, FB_SIZE(fb));
+    if (!FB_PIXELS(fb))
         return ESP_ERR_NO_MEM;
 
     return ESP_OK;
@@ -68,6 +98,8 @@ esp_err_t fb_free(framebuffer_t *fb)
 
     if (fb->data)
         free(fb->data);
+    if (fb->data_xrgb)
+        free(fb->data_xrgb);
     if (fb->mutex)
         vSemaphoreDelete(fb->mutex);
 
@@ -76,48 +108,80 @@ esp_err_t fb_free(framebuffer_t *fb)
 
 esp_err_t fb_render(framebuffer_t *fb, void *render_ctx)
 {
-    CHECK_ARG(fb && fb->data && fb->render);
+    CHECK_ARG(fb && FB_PIXELS(fb) && fb->render);
 
     if (xSemaphoreTake(fb->mutex, 0) != pdTRUE)
         return ESP_ERR_INVALID_STATE;
-    CHECK(fb->render(fb, render_ctx));
+    esp_err_t res = fb->render(fb, render_ctx);
+    if (res == ESP_OK)
+        reset_dirty(fb);
     xSemaphoreGive(fb->mutex);
+    CHECK(res);
 
     return ESP_OK;
 }
 
 esp_err_t fb_set_pixel_rgb(framebuffer_t *fb, size_t x, size_t y, rgb_t color)
 {
-    CHECK_ARG(fb && fb->data && x < fb->width && y < fb->height);
+    CHECK_ARG(fb && FB_PIXELS(fb) && x < fb->width && y < fb->height);
 
-    fb->data[FB_OFFSET(fb, x, y)] = color;
+    size_t offs = FB_OFFSET(fb, x, y);
+    if (fb->format == FB_FORMAT_XRGB)
+    {
+        xrgb_t c = rgb_to_xrgb(color);
+        if (fb->data_xrgb[offs] == c)
+            return ESP_OK;
+        fb->data_xrgb[offs] = c;
+    }
+    else
+    {
+        if (fb->data[offs].r == color.r && fb->data[offs].g == color.g && fb->data[offs].b == color.b)
+            return ESP_OK;
+        fb->data[offs] = color;
+    }
+    mark_dirty(fb, x, y, x + 1, y + 1);
 
     return ESP_OK;
 }
 
 esp_err_t fb_set_pixel_hsv(framebuffer_t *fb, size_t x, size_t y, hsv_t color)
 {
-    CHECK_ARG(fb && fb->data && x < fb->width && y < fb->height);
+    CHECK_ARG(fb && FB_PIXELS(fb) && x < fb->width && y < fb->height);
 
-    fb->data[FB_OFFSET(fb, x, y)] = hsv2rgb_rainbow(color);
-
-    return ESP_OK;
+    return fb_set_pixel_rgb(fb, x, y, hsv2rgb_rainbow(color));
 }
 
 esp_err_t fb_get_pixel_rgb(framebuffer_t *fb, size_t x, size_t y, rgb_t *color)
 {
-    CHECK_ARG(color && fb && fb->data && x < fb->width && y < fb->height);
+    CHECK_ARG(color && fb && FB_PIXELS(fb) && x < fb->width && y < fb->height);
 
-    *color = fb->data[FB_OFFSET(fb, x, y)];
+    if (fb->format == FB_FORMAT_XRGB)
+        *color = xrgb_to_rgb(fb->data_xrgb[FB_OFFSET(fb, x, y)]);
+    else
+        *color = fb->data[FB_OFFSET(fb, x, y)];
 
     return ESP_OK;
 }
 
 esp_err_t fb_get_pixel_hsv(framebuffer_t *fb, size_t x, size_t y, hsv_t *color)
 {
-    CHECK_ARG(color && fb && fb->data && x < fb->width && y < fb->height);
+    CHECK_ARG(color && fb && FB_PIXELS(fb) && x < fb->width && y < fb->height);
+
+    rgb_t rgb;
+    CHECK(fb_get_pixel_rgb(fb, x, y, &rgb));
+    *color = rgb2hsv_approximate(rgb);
+
+    return ESP_OK;
+}
+
+esp_err_t fb_get_pixels_rgb(framebuffer_t *fb, size_t start, size_t len, rgb_t *dst)
+{
+    CHECK_ARG(dst && fb && FB_PIXELS(fb) && start + len <= fb->width * fb->height);
 
-    *color = rgb2hsv_approximate(fb->data[FB_OFFSET(fb, x, y)]);
+    if (fb->format == FB_FORMAT_XRGB)
+        xrgb_to_rgb_array(dst, fb->data_xrgb + start, len);
+    else
+        memcpy(dst, fb->data + start, len * sizeof(rgb_t));
 
     return ESP_OK;
 }
@@ -126,7 +190,7 @@ esp_err_t fb_get_pixel_hsv(framebuffer_t *fb, size_t x, size_t y, hsv_t *color)
 
 esp_err_t fb_set_pixelf_rgb(framebuffer_t *fb, float x, float y, rgb_t color)
 {
-    CHECK_ARG(fb && fb->data);
+    CHECK_ARG(fb && FB_PIXELS(fb));
 
     // extract the fractional parts and derive their inverses
     uint8_t xx = (x - (int)x) * 255;
@@ -164,44 +228,50 @@ esp_err_t fb_set_pixelf_hsv(framebuffer_t *fb, float x, float y, hsv_t color)
 
 esp_err_t fb_clear(framebuffer_t *fb)
 {
-    CHECK_ARG(fb && fb->data);
+    CHECK_ARG(fb && FB_PIXELS(fb));
 
-    memset(fb->data, 0, FB_SIZE(fb));
+    memset(FB_PIXELS(fb), 0, FB_SIZE(fb));
+    MARK_ALL_DIRTY(fb);
 
     return ESP_OK;
 }
 
 esp_err_t fb_shift(framebuffer_t *fb, size_t offs, fb_shift_direction_t dir)
 {
-    CHECK_ARG(fb && fb->data && offs);
+    CHECK_ARG(fb && FB_PIXELS(fb) && offs);
 
     if (((dir == FB_SHIFT_LEFT || dir == FB_SHIFT_RIGHT) && offs >= fb->width)
             || ((dir == FB_SHIFT_UP || dir == FB_SHIFT_DOWN) && offs >= fb->height))
         return ESP_OK;
 
+    uint8_t *data = FB_PIXELS(fb);
+    size_t px = FB_PIXEL_SIZE(fb);
+    MARK_ALL_DIRTY(fb);
+    size_t row_size = fb->width * px;
+
     switch (dir)
     {
         case FB_SHIFT_LEFT:
             for (size_t row = 0; row < fb->height; row++)
-                memmove(fb->data + row * fb->width,
-                        fb->data + row * fb->width + offs,
-                        sizeof(rgb_t) * (fb->width - offs));
+                memmove(data + row * row_size,
+                        data + row * row_size + offs * px,
+                        px * (fb->width - offs));
             break;
         case FB_SHIFT_RIGHT:
             for (size_t row = 0; row < fb->height; row++)
-                memmove(fb->data + row * fb->width + offs,
-                        fb->data + row * fb->width,
-                        sizeof(rgb_t) * (fb->width - offs));
+                memmove(data + row * row_size + offs * px,
+                        data + row * row_size,
+                        px * (fb->width - offs));
             break;
         case FB_SHIFT_UP:
-            memmove(fb->data + offs * fb->width,
-                    fb->data,
-                    FB_SIZE(fb) - offs * fb->width * sizeof(rgb_t));
+            memmove(data + offs * row_size,
+                    data,
+                    FB_SIZE(fb) - offs * row_size);
             break;
         case FB_SHIFT_DOWN:
-            memmove(fb->data,
-                    fb->data + offs * fb->width,
-                    FB_SIZE(fb) - offs * fb->width * sizeof(rgb_t));
+            memmove(data,
+                    data + offs * row_size,
+                    FB_SIZE(fb) - offs * row_size);
             break;
     }
 
@@ -210,23 +280,50 @@ esp_err_t fb_shift(framebuffer_t *fb, size_t offs, fb_shift_direction_t dir)
 
 esp_err_t fb_fade(framebuffer_t *fb, uint8_t scale)
 {
-    CHECK_ARG(fb && fb->data);
+    CHECK_ARG(fb && FB_PIXELS(fb));
 
-    for (size_t i = 0; i < fb->width * fb->height; i++)
-        fb->data[i] = rgb_fade(fb->data[i], scale);
+    MARK_ALL_DIRTY(fb);
+    if (fb->format == FB_FORMAT_XRGB)
+        xrgb_fade_array(fb->data_xrgb, fb->width * fb->height, scale);
+    else
+        rgb_fade_array(fb->data, fb->width * fb->height, scale);
 
     return ESP_OK;
 }
 
 esp_err_t fb_blur2d(framebuffer_t *fb, fract8 amount)
 {
-    CHECK_ARG(fb && fb->data);
+    CHECK_ARG(fb && FB_PIXELS(fb));
 
-    blur2d(fb->data, fb->width, fb->height, amount, xy, fb);
+    MARK_ALL_DIRTY(fb);
+    if (fb->format == FB_FORMAT_XRGB)
+        xrgb_blur2d_linear(fb->data_xrgb, fb->width, fb->height, amount);
+    else
+        blur2d_linear(fb->data, fb->width, fb->height, amount);
 
     return ESP_OK;
 }
 
+esp_err_t fb_mark_dirty(framebuffer_t *fb, size_t x, size_t y, size_t width, size_t height)
+{
+    CHECK_ARG(fb && x < fb->width && y < fb->height && width && height);
+
+    mark_dirty(fb, x, y,
+               width > fb->width - x ? fb->width : x + width,
+               height > fb->height - y ? fb->height : y + height);
+
+    return ESP_OK;
+}
+
+bool fb_get_dirty(framebuffer_t *fb, fb_rect_t *rect)
+{
+    if (!fb || fb->dirty.x0 >= fb->dirty.x1 || fb->dirty.y0 >= fb->dirty.y1)
+        return false;
+    if (rect)
+        *rect = fb->dirty;
+    return true;
+}
+
 esp_err_t fb_begin(framebuffer_t *fb)
 {
     CHECK_ARG(fb);
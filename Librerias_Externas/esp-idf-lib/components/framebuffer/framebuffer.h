@@ -46,7 +46,17 @@ extern "C" {
 
 #define FB_OFFSET(fb, x, y) ((fb)->width * (y) + (x))
 
-#define FB_SIZE(fb) ((fb)->width * (fb)->height * sizeof(rgb_t))
+#define FB_PIXEL_SIZE(fb) ((fb)->format == FB_FORMAT_XRGB ? sizeof(xrgb_t) : sizeof(rgb_t))
+
+#define FB_SIZE(fb) ((fb)->width * (fb)->height * FB_PIXEL_SIZE(fb))
+
+/**
+ * Pixel storage format
+ */
+typedef enum {
+    FB_FORMAT_RGB = 0,  ///< rgb_t pixels in fb->data
+    FB_FORMAT_XRGB,     ///< Word-aligned xrgb_t pixels in fb->data_xrgb, faster fade/blur/shift
+} fb_format_t;
 
 typedef enum {
     FB_SHIFT_LEFT  = 0,
@@ -55,6 +65,15 @@ typedef enum {
     FB_SHIFT_DOWN
 } fb_shift_direction_t;
 
+/**
+ * Rectangular region of framebuffer, `x1` and `y1` are exclusive
+ */
+typedef struct
+{
+    size_t x0, y0;
+    size_t x1, y1;
+} fb_rect_t;
+
 typedef struct framebuffer_s framebuffer_t;
 
 /**
@@ -67,13 +86,16 @@ typedef esp_err_t (*fb_render_cb_t)(framebuffer_t *fb, void *arg);
  */
 struct framebuffer_s
 {
-    rgb_t *data;                   ///< RGB framebuffer
+    rgb_t *data;                   ///< RGB framebuffer, NULL for ::FB_FORMAT_XRGB
+    xrgb_t *data_xrgb;             ///< XRGB framebuffer, NULL for ::FB_FORMAT_RGB
+    fb_format_t format;            ///< Pixel storage format
     size_t width;                  ///< Framebuffer width
     size_t height;                 ///< Framebuffer height
     size_t frame_num;              ///< Number of rendered frames
     uint64_t last_frame_us;        ///< Time of last rendered frame since boot in microseconds
     fb_render_cb_t render;         ///< See ::fb_render()
     uint8_t *internal;             ///< Buffer for effect settings, internal vars, palettes and so on
+    fb_rect_t dirty;               ///< Bounding box of pixels changed since last render, see ::fb_get_dirty()
     SemaphoreHandle_t mutex;
 };
 
@@ -89,6 +111,22 @@ struct framebuffer_s
  */
 esp_err_t fb_init(framebuffer_t *fb, size_t width, size_t height, fb_render_cb_t render_cb);
 
+/**
+ * @brief Initialize framebuffer with selected pixel storage format
+ *
+ * With ::FB_FORMAT_XRGB the renderer must read pixels from fb->data_xrgb
+ * (or with ::fb_get_pixels_rgb()), conversion is done only there.
+ *
+ * @param fb        Framebuffer descriptor
+ * @param width     Frame width in pixels
+ * @param height    Frame height in pixels
+ * @param format    Pixel storage format
+ * @param render_cb Renderer callback function
+ *
+ * @return          ESP_OK on success
+ */
+esp_err_t fb_init_format(framebuffer_t *fb, size_t width, size_t height, fb_format_t format, fb_render_cb_t render_cb);
+
 /**
  * @brief Free Framebuffer descriptor buffers
  *
@@ -101,7 +139,9 @@ esp_err_t fb_free(framebuffer_t *fb);
  * @brief Render frambuffer to actual display or LED strip
  *
  * Rendering is performed by calling the callback function with passing
- * it as arguments \p fb and \p ctx
+ * it as arguments \p fb and \p ctx. Callback can use ::fb_get_dirty()
+ * to send only changed part of the frame. Dirty region is reset after
+ * successful rendering.
  *
  * @param fb   Framebuffer descriptor
  * @param ctx  Argument to pass to callback
@@ -175,6 +215,19 @@ esp_err_t fb_get_pixel_rgb(framebuffer_t *fb, size_t x, size_t y, rgb_t *color);
  */
 esp_err_t fb_get_pixel_hsv(framebuffer_t *fb, size_t x, size_t y, hsv_t *color);
 
+/**
+ * @brief Get RGB colors of a range of framebuffer pixels
+ *
+ * Pixels are taken in row-major order, converting them from XRGB if needed.
+ *
+ * @param fb          Framebuffer descriptor
+ * @param start       Offset of first pixel, see FB_OFFSET()
+ * @param len         Number of pixels
+ * @param[out] dst    RGB colors
+ * @return            ESP_OK on success
+ */
+esp_err_t fb_get_pixels_rgb(framebuffer_t *fb, size_t start, size_t len, rgb_t *dst);
+
 /**
  * @brief Clear framebuffer
  *
@@ -221,6 +274,32 @@ esp_err_t fb_fade(framebuffer_t *fb, uint8_t scale);
  */
 esp_err_t fb_blur2d(framebuffer_t *fb, fract8 amount);
 
+/**
+ * @brief Mark region of framebuffer as changed
+ *
+ * Pixel functions do it automatically, call it after modifying
+ * fb->data or fb->data_xrgb directly.
+ *
+ * @param fb        Framebuffer descriptor
+ * @param x         X coordinate of region
+ * @param y         Y coordinate of region
+ * @param width     Region width
+ * @param height    Region height
+ * @return          ESP_OK on success
+ */
+esp_err_t fb_mark_dirty(framebuffer_t *fb, size_t x, size_t y, size_t width, size_t height);
+
+/**
+ * @brief Get region of framebuffer changed since last render
+ *
+ * Whole frame is dirty after initialization.
+ *
+ * @param fb          Framebuffer descriptor
+ * @param[out] rect   Bounding box of changed pixels
+ * @return            true if there are changed pixels
+ */
+bool fb_get_dirty(framebuffer_t *fb, fb_rect_t *rect);
+
 /**
  * @brief Start frame rendering
  *
@@ -215,3 +215,20 @@ esp_err_t ht16k33_ram_write(i2c_dev_t* dev, uint8_t* data)
 
     return ESP_OK;
 }
+
+esp_err_t ht16k33_ram_write_range(i2c_dev_t* dev, uint8_t offset, const uint8_t* data, size_t len)
+{
+    CHECK_ARG(dev && data && len);
+    CHECK_ARG(offset < HT16K33_RAM_SIZE_BYTES && len <= HT16K33_RAM_SIZE_BYTES - offset);
+
+    // Display RAM address pointer is auto-incremented after each byte.
+    uint8_t cmd_seq[HT16K33_SET_RAM_CMD_SIZE_BYTES];
+    cmd_seq[0] = HT16K33_CMD_RAM_SET_POINTER << 4 | offset;
+    memcpy(cmd_seq + 1, data, len);
+
+    I2C_DEV_TAKE_MUTEX(dev);
+    I2C_DEV_CHECK(dev, i2c_dev_write(dev, NULL, 0, cmd_seq, len + 1));
+    I2C_DEV_GIVE_MUTEX(dev);
+
+    return ESP_OK;
+}
@@ -113,6 +113,16 @@ esp_err_t ht16k33_display_setup(i2c_dev_t *dev, uint8_t on_flag,
  */
 esp_err_t ht16k33_ram_write(i2c_dev_t *dev, uint8_t *data);
 
+/**
+ * @brief Write part of RAM, e.g. only changed rows of display.
+ *
+ * @param offset First RAM byte to write, 0..HT16K33_RAM_SIZE_BYTES - 1.
+ * @param data Bytes to write.
+ * @param len Number of bytes, up to HT16K33_RAM_SIZE_BYTES - offset.
+ * @return ESP_OK to indicate success
+ */
+esp_err_t ht16k33_ram_write_range(i2c_dev_t *dev, uint8_t offset, const uint8_t *data, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,6 +34,7 @@
  *
  * BSD Licensed as described in the file LICENSE
  */
+#include <string.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <esp_timer.h>
@@ -46,45 +47,93 @@
 
 #if HELPER_TARGET_IS_ESP32
 static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#define ENTER_CRITICAL() portENTER_CRITICAL(&mux)
+#define EXIT_CRITICAL() portEXIT_CRITICAL(&mux)
+#define ENTER_CRITICAL_ISR() portENTER_CRITICAL_ISR(&mux)
+#define EXIT_CRITICAL_ISR() portEXIT_CRITICAL_ISR(&mux)
+#elif HELPER_TARGET_IS_ESP8266
+#define ENTER_CRITICAL() portENTER_CRITICAL()
+#define EXIT_CRITICAL() portEXIT_CRITICAL()
+#define ENTER_CRITICAL_ISR() portENTER_CRITICAL()
+#define EXIT_CRITICAL_ISR() portEXIT_CRITICAL()
 #endif
 
-static uint32_t read_raw(gpio_num_t dout, gpio_num_t pd_sck, hx711_gain_t gain)
+// One PD_SCK pulse, returns DOUT sampled while PD_SCK is high.
+// If PD_SCK stays high for more than 60 us, HX711 enters power down mode,
+// so in ISR context each high period is guarded from higher priority
+// interrupts.
+static inline uint32_t pulse(gpio_num_t dout, gpio_num_t pd_sck, bool isr)
 {
-#if HELPER_TARGET_IS_ESP32
-    portENTER_CRITICAL(&mux);
-#elif HELPER_TARGET_IS_ESP8266
-    portENTER_CRITICAL();
-#endif
+    if (isr)
+        ENTER_CRITICAL_ISR();
+    gpio_set_level(pd_sck, 1);
+    ets_delay_us(1);
+    uint32_t bit = gpio_get_level(dout);
+    gpio_set_level(pd_sck, 0);
+    if (isr)
+        EXIT_CRITICAL_ISR();
+    ets_delay_us(1);
+
+    return bit;
+}
 
+static uint32_t shift_out(gpio_num_t dout, gpio_num_t pd_sck, hx711_gain_t gain, bool isr)
+{
     // read data
     uint32_t data = 0;
     for (size_t i = 0; i < 24; i++)
-    {
-        gpio_set_level(pd_sck, 1);
-        ets_delay_us(1);
-        data |= gpio_get_level(dout) << (23 - i);
-        gpio_set_level(pd_sck, 0);
-        ets_delay_us(1);
-    }
+        data |= pulse(dout, pd_sck, isr) << (23 - i);
 
     // config gain + channel for next read
     for (size_t i = 0; i <= gain; i++)
-    {
-        gpio_set_level(pd_sck, 1);
-        ets_delay_us(1);
-        gpio_set_level(pd_sck, 0);
-        ets_delay_us(1);
-    }
+        pulse(dout, pd_sck, isr);
 
-#if HELPER_TARGET_IS_ESP32
-    portEXIT_CRITICAL(&mux);
-#elif HELPER_TARGET_IS_ESP8266
-    portEXIT_CRITICAL();
-#endif
+    return data;
+}
+
+static uint32_t read_raw(gpio_num_t dout, gpio_num_t pd_sck, hx711_gain_t gain)
+{
+    ENTER_CRITICAL();
+    uint32_t data = shift_out(dout, pd_sck, gain, false);
+    EXIT_CRITICAL();
 
     return data;
 }
 
+static int32_t to_signed(uint32_t raw)
+{
+    if (raw & 0x800000)
+        raw |= 0xff000000;
+
+    return *((int32_t *)&raw);
+}
+
+static void stream_isr(void *arg)
+{
+    hx711_stream_t *stream = (hx711_stream_t *)arg;
+    hx711_t *dev = stream->dev;
+
+    // DOUT toggles while data is shifted out, then stays high until the
+    // next conversion is ready. Higher priority interrupts can still
+    // preempt this handler, so each PD_SCK high pulse is shifted out in
+    // a critical section.
+    gpio_set_intr_type(dev->dout, GPIO_INTR_DISABLE);
+    int32_t sample = to_signed(shift_out(dev->dout, dev->pd_sck, dev->gain, true));
+
+    ENTER_CRITICAL_ISR();
+    if (stream->head - stream->tail == HX711_STREAM_BUF_SIZE)
+    {
+        // drop oldest sample
+        stream->tail++;
+        stream->overruns++;
+    }
+    stream->buf[stream->head++ % HX711_STREAM_BUF_SIZE] = sample;
+    stream->filtered = hx711_filter_update(&stream->filter, sample);
+    EXIT_CRITICAL_ISR();
+
+    gpio_set_intr_type(dev->dout, GPIO_INTR_LOW_LEVEL);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 esp_err_t hx711_init(hx711_t *dev)
@@ -147,10 +196,7 @@ esp_err_t hx711_read_data(hx711_t *dev, int32_t *data)
 {
     CHECK_ARG(dev && data);
 
-    uint32_t raw = read_raw(dev->dout, dev->pd_sck, dev->gain);
-    if (raw & 0x800000)
-        raw |= 0xff000000;
-    *data = *((int32_t *)&raw);
+    *data = to_signed(read_raw(dev->dout, dev->pd_sck, dev->gain));
 
     return ESP_OK;
 }
@@ -171,3 +217,146 @@ esp_err_t hx711_read_average(hx711_t *dev, size_t times, int32_t *data)
 
     return ESP_OK;
 }
+
+esp_err_t hx711_stream_start(hx711_stream_t *stream, hx711_t *dev, const hx711_filter_config_t *filter)
+{
+    CHECK_ARG(stream && dev && filter);
+
+    memset(stream, 0, sizeof(hx711_stream_t));
+    stream->dev = dev;
+    stream->cal = (hx711_calibration_t)HX711_CALIBRATION_DEFAULT;
+    CHECK_ARG(hx711_filter_init(&stream->filter, filter));
+
+    esp_err_t res = gpio_install_isr_service(0);
+    if (res != ESP_OK && res != ESP_ERR_INVALID_STATE)
+        return res;
+
+    CHECK(gpio_set_intr_type(dev->dout, GPIO_INTR_DISABLE));
+    CHECK(gpio_isr_handler_add(dev->dout, stream_isr, stream));
+    stream->running = true;
+    CHECK(gpio_set_intr_type(dev->dout, GPIO_INTR_LOW_LEVEL));
+#if HELPER_TARGET_IS_ESP32
+    CHECK(gpio_intr_enable(dev->dout));
+#endif
+
+    return ESP_OK;
+}
+
+esp_err_t hx711_stream_stop(hx711_stream_t *stream)
+{
+    CHECK_ARG(stream && stream->running);
+
+    CHECK(gpio_set_intr_type(stream->dev->dout, GPIO_INTR_DISABLE));
+    CHECK(gpio_isr_handler_remove(stream->dev->dout));
+    stream->running = false;
+
+    return ESP_OK;
+}
+
+esp_err_t hx711_stream_set_filter(hx711_stream_t *stream, const hx711_filter_config_t *filter)
+{
+    CHECK_ARG(stream && filter);
+
+    hx711_filter_t f;
+    CHECK_ARG(hx711_filter_init(&f, filter));
+
+    ENTER_CRITICAL();
+    stream->filter = f;
+    EXIT_CRITICAL();
+
+    return ESP_OK;
+}
+
+esp_err_t hx711_stream_read(hx711_stream_t *stream, int32_t *data, size_t len, size_t *count)
+{
+    CHECK_ARG(stream && data && count);
+
+    ENTER_CRITICAL();
+    size_t n = 0;
+    for (; n < len && stream->tail != stream->head; n++)
+        data[n] = stream->buf[stream->tail++ % HX711_STREAM_BUF_SIZE];
+    EXIT_CRITICAL();
+
+    *count = n;
+
+    return ESP_OK;
+}
+
+esp_err_t hx711_stream_get(hx711_stream_t *stream, int32_t *raw, int32_t *value)
+{
+    CHECK_ARG(stream);
+
+    ENTER_CRITICAL();
+    bool ready = stream->filter.count > 0;
+    int32_t filtered = stream->filtered;
+    hx711_calibration_t cal = stream->cal;
+    EXIT_CRITICAL();
+
+    if (!ready)
+        return ESP_ERR_INVALID_STATE;
+
+    if (raw)
+        *raw = filtered;
+    if (value)
+        *value = hx711_calibration_apply(&cal, filtered);
+
+    return ESP_OK;
+}
+
+esp_err_t hx711_stream_tare(hx711_stream_t *stream)
+{
+    CHECK_ARG(stream);
+
+    esp_err_t res = ESP_OK;
+    ENTER_CRITICAL();
+    if (hx711_filter_settled(&stream->filter))
+        stream->cal.offset = stream->filtered;
+    else
+        res = ESP_ERR_INVALID_STATE;
+    EXIT_CRITICAL();
+
+    return res;
+}
+
+esp_err_t hx711_stream_calibrate(hx711_stream_t *stream, int32_t value)
+{
+    CHECK_ARG(stream);
+
+    ENTER_CRITICAL();
+    bool settled = hx711_filter_settled(&stream->filter);
+    int32_t filtered = stream->filtered;
+    hx711_calibration_t cal = stream->cal;
+    EXIT_CRITICAL();
+
+    if (!settled)
+        return ESP_ERR_INVALID_STATE;
+    CHECK_ARG(hx711_calibration_set_scale(&cal, filtered, value));
+
+    ENTER_CRITICAL();
+    stream->cal.scale_q16 = cal.scale_q16;
+    EXIT_CRITICAL();
+
+    return ESP_OK;
+}
+
+esp_err_t hx711_stream_set_calibration(hx711_stream_t *stream, const hx711_calibration_t *cal)
+{
+    CHECK_ARG(stream && cal && cal->scale_q16);
+
+    ENTER_CRITICAL();
+    stream->cal = *cal;
+    EXIT_CRITICAL();
+
+    return ESP_OK;
+}
+
+esp_err_t hx711_stream_get_calibration(hx711_stream_t *stream, hx711_calibration_t *cal)
+{
+    CHECK_ARG(stream && cal);
+
+    ENTER_CRITICAL();
+    *cal = stream->cal;
+    EXIT_CRITICAL();
+
+    return ESP_OK;
+}
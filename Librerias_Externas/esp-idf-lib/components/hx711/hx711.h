@@ -42,6 +42,7 @@
 #include <driver/gpio.h>
 #include <stdbool.h>
 #include <esp_err.h>
+#include "hx711_filter.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,6 +67,27 @@ typedef struct
     hx711_gain_t gain;
 } hx711_t;
 
+/**
+ * Size of the stream buffer of raw samples, must be a power of two
+ */
+#define HX711_STREAM_BUF_SIZE 32
+
+/**
+ * Stream descriptor
+ */
+typedef struct
+{
+    hx711_t *dev;
+    int32_t buf[HX711_STREAM_BUF_SIZE]; //!< Raw samples, circular
+    size_t head;                        //!< Samples written since start
+    size_t tail;                        //!< Samples read since start
+    uint32_t overruns;                  //!< Samples dropped because buffer was full
+    hx711_filter_t filter;
+    hx711_calibration_t cal;
+    int32_t filtered;                   //!< Last filter output
+    bool running;
+} hx711_stream_t;
+
 /**
  * @brief Initialize device
  *
@@ -134,6 +156,105 @@ esp_err_t hx711_read_data(hx711_t *dev, int32_t *data);
  */
 esp_err_t hx711_read_average(hx711_t *dev, size_t times, int32_t *data);
 
+/**
+ * @brief Start reading samples in background
+ *
+ * Each sample is shifted out by the DOUT interrupt handler as soon as the
+ * conversion is ready, about 60 us per sample. Raw samples are queued in
+ * the stream buffer and fed to the filter. No task is used, so the device
+ * can run at 80 SPS (RATE pin high) without blocking anyone.
+ *
+ * The interrupt is level triggered so a sample that was ready before the
+ * stream started is not missed. GPIO ISR service is installed if needed.
+ *
+ * While the stream is running, other functions of the device must not be
+ * called. Calibration is reset to ::HX711_CALIBRATION_DEFAULT, restore it
+ * with ::hx711_stream_set_calibration().
+ *
+ * @param stream Stream descriptor
+ * @param dev Device descriptor, initialized
+ * @param filter Filter configuration
+ * @return `ESP_OK` on success
+ */
+esp_err_t hx711_stream_start(hx711_stream_t *stream, hx711_t *dev, const hx711_filter_config_t *filter);
+
+/**
+ * @brief Stop reading samples in background
+ *
+ * @param stream Stream descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t hx711_stream_stop(hx711_stream_t *stream);
+
+/**
+ * @brief Change stream filter
+ *
+ * Filter is restarted, previous samples are dropped.
+ *
+ * @param stream Stream descriptor
+ * @param filter Filter configuration
+ * @return `ESP_OK` on success
+ */
+esp_err_t hx711_stream_set_filter(hx711_stream_t *stream, const hx711_filter_config_t *filter);
+
+/**
+ * @brief Take raw samples from stream buffer
+ *
+ * @param stream Stream descriptor
+ * @param[out] data Buffer for samples
+ * @param len Buffer length, samples
+ * @param[out] count Number of samples copied to buffer
+ * @return `ESP_OK` on success
+ */
+esp_err_t hx711_stream_read(hx711_stream_t *stream, int32_t *data, size_t len, size_t *count);
+
+/**
+ * @brief Get last filter output
+ *
+ * @param stream Stream descriptor
+ * @param[out] raw Filtered ADC data, may be NULL
+ * @param[out] value Filtered data in calibrated units, may be NULL
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if filter has no samples yet
+ */
+esp_err_t hx711_stream_get(hx711_stream_t *stream, int32_t *raw, int32_t *value);
+
+/**
+ * @brief Set zero load to the current filter output
+ *
+ * @param stream Stream descriptor
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if filter is not settled
+ */
+esp_err_t hx711_stream_tare(hx711_stream_t *stream);
+
+/**
+ * @brief Set scale from the current filter output
+ *
+ * Call it with a known load, after ::hx711_stream_tare().
+ *
+ * @param stream Stream descriptor
+ * @param value Known load, calibrated units
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if filter is not settled
+ */
+esp_err_t hx711_stream_calibrate(hx711_stream_t *stream, int32_t value);
+
+/**
+ * @brief Set stream calibration
+ *
+ * @param stream Stream descriptor
+ * @param cal Calibration, e.g. saved after ::hx711_stream_calibrate()
+ * @return `ESP_OK` on success
+ */
+esp_err_t hx711_stream_set_calibration(hx711_stream_t *stream, const hx711_calibration_t *cal);
+
+/**
+ * @brief Get stream calibration
+ *
+ * @param stream Stream descriptor
+ * @param[out] cal Calibration
+ * @return `ESP_OK` on success
+ */
+esp_err_t hx711_stream_get_calibration(hx711_stream_t *stream, hx711_calibration_t *cal);
+
 #ifdef __cplusplus
 }
 #endif
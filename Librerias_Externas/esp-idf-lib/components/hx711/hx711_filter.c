@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019 Ruslan V. Uss <unclerus@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of itscontributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file hx711_filter.c
+ *
+ * Incremental filters and fixed point calibration for HX711 samples
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#include <string.h>
+#include "hx711_filter.h"
+
+#define Q16_ONE ((int64_t)1 << 16)
+
+static int32_t median(const hx711_filter_t *filter)
+{
+    size_t mid = filter->count / 2;
+    if (filter->count & 1)
+        return filter->sorted[mid];
+
+    return (int32_t)(((int64_t)filter->sorted[mid - 1] + filter->sorted[mid]) / 2);
+}
+
+// Replace `old` by `sample` in sorted window (when full), or insert it
+static void sorted_update(hx711_filter_t *filter, bool full, int32_t old, int32_t sample)
+{
+    int32_t *s = filter->sorted;
+    size_t n = filter->count;
+    size_t i;
+
+    if (full)
+    {
+        // remove old value, then insert in a window one sample shorter
+        for (i = 0; s[i] != old; i++);
+        memmove(&s[i], &s[i + 1], (n - i - 1) * sizeof(int32_t));
+        n--;
+    }
+
+    for (i = n; i > 0 && s[i - 1] > sample; i--)
+        s[i] = s[i - 1];
+    s[i] = sample;
+}
+
+bool hx711_filter_init(hx711_filter_t *filter, const hx711_filter_config_t *config)
+{
+    if (!filter || !config)
+        return false;
+
+    switch (config->type)
+    {
+        case HX711_FILTER_NONE:
+            break;
+        case HX711_FILTER_MOVING_AVERAGE:
+        case HX711_FILTER_MEDIAN:
+            if (!config->window || config->window > HX711_FILTER_MAX_WINDOW)
+                return false;
+            break;
+        case HX711_FILTER_IIR:
+            if (!config->iir_shift || config->iir_shift > HX711_FILTER_MAX_IIR_SHIFT)
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    filter->config = *config;
+    hx711_filter_reset(filter);
+
+    return true;
+}
+
+void hx711_filter_reset(hx711_filter_t *filter)
+{
+    filter->count = 0;
+    filter->pos = 0;
+    filter->acc = 0;
+}
+
+int32_t hx711_filter_update(hx711_filter_t *filter, int32_t sample)
+{
+    const hx711_filter_config_t *c = &filter->config;
+
+    if (c->type == HX711_FILTER_NONE)
+    {
+        filter->count = 1;
+        return sample;
+    }
+
+    if (c->type == HX711_FILTER_IIR)
+    {
+        if (!filter->count)
+            filter->acc = sample * Q16_ONE;
+        else
+            filter->acc += (sample * Q16_ONE - filter->acc) >> c->iir_shift;
+        // count only matters until the filter is settled
+        if (filter->count < ((size_t)4 << c->iir_shift))
+            filter->count++;
+        return (int32_t)((filter->acc + Q16_ONE / 2) >> 16);
+    }
+
+    // window filters
+    bool full = filter->count == c->window;
+    int32_t old = filter->history[filter->pos];
+
+    if (full)
+    {
+        filter->history[filter->pos] = sample;
+        filter->pos = (filter->pos + 1) % c->window;
+    }
+    else
+        filter->history[filter->count] = sample;
+
+    if (c->type == HX711_FILTER_MEDIAN)
+        sorted_update(filter, full, old, sample);
+    else
+        filter->acc += (int64_t)sample - (full ? old : 0);
+
+    if (!full)
+        filter->count++;
+
+    if (c->type == HX711_FILTER_MEDIAN)
+        return median(filter);
+
+    return (int32_t)(filter->acc / (int64_t)filter->count);
+}
+
+bool hx711_filter_settled(const hx711_filter_t *filter)
+{
+    switch (filter->config.type)
+    {
+        case HX711_FILTER_MOVING_AVERAGE:
+        case HX711_FILTER_MEDIAN:
+            return filter->count == filter->config.window;
+        case HX711_FILTER_IIR:
+            return filter->count >= ((size_t)4 << filter->config.iir_shift);
+        default:
+            return filter->count > 0;
+    }
+}
+
+int32_t hx711_calibration_apply(const hx711_calibration_t *cal, int32_t raw)
+{
+    int64_t v = ((int64_t)raw - cal->offset) * cal->scale_q16;
+
+    // round half away from zero
+    return (int32_t)(v >= 0 ? (v + Q16_ONE / 2) >> 16 : -((-v + Q16_ONE / 2) >> 16));
+}
+
+bool hx711_calibration_set_scale(hx711_calibration_t *cal, int32_t raw, int32_t value)
+{
+    int64_t counts = (int64_t)raw - cal->offset;
+    if (!counts)
+        return false;
+
+    // round to nearest
+    int64_t num = (int64_t)value * Q16_ONE;
+    int64_t scale = ((num < 0) == (counts < 0) ? num + counts / 2 : num - counts / 2) / counts;
+    if (scale > INT32_MAX || scale < INT32_MIN || !scale)
+        return false;
+
+    cal->scale_q16 = (int32_t)scale;
+
+    return true;
+}
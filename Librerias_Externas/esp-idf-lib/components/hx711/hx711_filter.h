@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019 Ruslan V. Uss <unclerus@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of itscontributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file hx711_filter.h
+ * @defgroup hx711_filter hx711_filter
+ * @{
+ *
+ * @brief Incremental filters and fixed point calibration for HX711 samples.
+ *
+ * All the filters take one sample at a time and run in constant or
+ * window-bounded time, so they can be updated from an interrupt handler.
+ *
+ * This module has no ESP-IDF dependencies so it can be built and tested on
+ * a host.
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#ifndef __HX711_FILTER_H__
+#define __HX711_FILTER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum window of moving average and median filters
+ */
+#define HX711_FILTER_MAX_WINDOW 16
+
+/**
+ * Maximum IIR filter shift
+ */
+#define HX711_FILTER_MAX_IIR_SHIFT 8
+
+/**
+ * Filter type
+ */
+typedef enum {
+    HX711_FILTER_NONE = 0,       //!< Pass samples through
+    HX711_FILTER_MOVING_AVERAGE, //!< Mean of the last `window` samples
+    HX711_FILTER_MEDIAN,         //!< Median of the last `window` samples
+    HX711_FILTER_IIR             //!< First order low-pass, alpha = 1 / 2^`iir_shift`
+} hx711_filter_type_t;
+
+/**
+ * Filter configuration
+ */
+typedef struct
+{
+    hx711_filter_type_t type;
+    uint8_t window;    //!< Samples in window, 1..HX711_FILTER_MAX_WINDOW
+    uint8_t iir_shift; //!< IIR filter coefficient, 1..HX711_FILTER_MAX_IIR_SHIFT
+} hx711_filter_config_t;
+
+/**
+ * Filter state
+ */
+typedef struct
+{
+    hx711_filter_config_t config;
+    int32_t history[HX711_FILTER_MAX_WINDOW]; //!< Last samples, circular
+    int32_t sorted[HX711_FILTER_MAX_WINDOW];  //!< Last samples, sorted (median filter)
+    size_t count;                             //!< Samples in history
+    size_t pos;                               //!< Position of the oldest sample in history
+    int64_t acc;                              //!< Sum of history or IIR state, Q16
+} hx711_filter_t;
+
+/**
+ * Linear calibration, value = (raw - offset) * scale
+ */
+typedef struct
+{
+    int32_t offset;    //!< Raw value at zero load
+    int32_t scale_q16; //!< Units per count, Q16.16 fixed point
+} hx711_calibration_t;
+
+/**
+ * Identity calibration
+ */
+#define HX711_CALIBRATION_DEFAULT { .offset = 0, .scale_q16 = 1 << 16 }
+
+/**
+ * @brief Initialize filter
+ *
+ * @param filter Filter state
+ * @param config Filter configuration
+ * @return false if configuration is invalid
+ */
+bool hx711_filter_init(hx711_filter_t *filter, const hx711_filter_config_t *config);
+
+/**
+ * @brief Drop all the samples from filter
+ *
+ * @param filter Filter state
+ */
+void hx711_filter_reset(hx711_filter_t *filter);
+
+/**
+ * @brief Add sample to filter
+ *
+ * @param filter Filter state
+ * @param sample Raw ADC data
+ * @return Filter output
+ */
+int32_t hx711_filter_update(hx711_filter_t *filter, int32_t sample);
+
+/**
+ * @brief Check if filter window is full
+ *
+ * IIR filter is considered settled after 4 * 2^`iir_shift` samples,
+ * when the weight of the first sample is below 2%.
+ *
+ * @param filter Filter state
+ * @return true if filter output depends only on real samples
+ */
+bool hx711_filter_settled(const hx711_filter_t *filter);
+
+/**
+ * @brief Convert raw value to calibrated units
+ *
+ * @param cal Calibration
+ * @param raw Raw or filtered ADC data
+ * @return Calibrated value, rounded
+ */
+int32_t hx711_calibration_apply(const hx711_calibration_t *cal, int32_t raw);
+
+/**
+ * @brief Compute scale from a reading of a known load
+ *
+ * Offset must be already set (tare).
+ *
+ * @param cal Calibration, scale is updated
+ * @param raw Raw or filtered ADC data with the known load
+ * @param value Known load, calibrated units
+ * @return false if raw is equal to offset or the scale overflows
+ */
+bool hx711_calibration_set_scale(hx711_calibration_t *cal, int32_t raw, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __HX711_FILTER_H__ */
@@ -31,18 +31,39 @@
  * MIT Licensed as described in the file LICENSE
  */
 #include <string.h>
+#include <stdlib.h>
 #include <inttypes.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
 #include <esp_log.h>
 #include "i2cdev.h"
 
 static const char *TAG = "i2cdev";
 
+/*
+ * Since ESP-IDF v4.4 command links can be built in a caller-provided buffer.
+ * A single buffer per port is enough because it is only used while the
+ * port mutex is held.
+ */
+#if HELPER_TARGET_IS_ESP32 && !CONFIG_I2CDEV_NOLOCK && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0)
+#define I2CDEV_STATIC_CMD_LINK 1
+#define I2CDEV_CMD_LINK_SIZE I2C_LINK_RECOMMENDED_SIZE(3)
+#else
+#define I2CDEV_STATIC_CMD_LINK 0
+#endif
+
 typedef struct {
     SemaphoreHandle_t lock;
     i2c_config_t config;
     bool installed;
+    uint32_t timeout_ticks;  // Last bus timeout set on the port, 0 if unknown
+    QueueHandle_t queue;     // Asynchronous transactions queue
+    TaskHandle_t worker;     // Asynchronous transactions worker
+    SemaphoreHandle_t worker_exit; // Given by the worker when it stops, see i2c_dev_stop_worker()
+#if I2CDEV_STATIC_CMD_LINK
+    uint8_t cmd_buf[I2CDEV_CMD_LINK_SIZE];
+#endif
 } i2c_port_state_t;
 
 static i2c_port_state_t states[I2C_NUM_MAX];
@@ -71,8 +92,15 @@ static i2c_port_state_t states[I2C_NUM_MAX];
         } while (0)
 #endif
 
+static esp_err_t i2c_dev_stop_worker(i2c_port_t port);
+
 esp_err_t i2cdev_init()
 {
+    // Release workers and mutexes of a previous initialization
+    esp_err_t res = i2cdev_done();
+    if (res != ESP_OK)
+        return res;
+
     memset(states, 0, sizeof(states));
 
 #if !CONFIG_I2CDEV_NOLOCK
@@ -94,6 +122,11 @@ esp_err_t i2cdev_done()
 {
     for (int i = 0; i < I2C_NUM_MAX; i++)
     {
+        // Worker uses the port mutex, stop it first
+        esp_err_t res = i2c_dev_stop_worker(i);
+        if (res != ESP_OK)
+            return res;
+
         if (!states[i].lock) continue;
 
         if (states[i].installed)
@@ -173,6 +206,24 @@ esp_err_t i2c_dev_give_mutex(i2c_dev_t *dev)
     return ESP_OK;
 }
 
+static i2c_cmd_handle_t cmd_link_create(i2c_port_t port)
+{
+#if I2CDEV_STATIC_CMD_LINK
+    return i2c_cmd_link_create_static(states[port].cmd_buf, sizeof(states[port].cmd_buf));
+#else
+    return i2c_cmd_link_create();
+#endif
+}
+
+static void cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+#if I2CDEV_STATIC_CMD_LINK
+    i2c_cmd_link_delete_static(cmd);
+#else
+    i2c_cmd_link_delete(cmd);
+#endif
+}
+
 inline static bool cfg_equal(const i2c_config_t *a, const i2c_config_t *b)
 {
     return a->scl_io_num == b->scl_io_num
@@ -219,19 +270,21 @@ static esp_err_t i2c_setup_port(const i2c_dev_t *dev)
             return res;
 #endif
         states[dev->port].installed = true;
+        states[dev->port].timeout_ticks = 0;
 
         memcpy(&states[dev->port].config, &temp, sizeof(i2c_config_t));
         ESP_LOGD(TAG, "I2C driver successfully reconfigured on port %d", dev->port);
     }
 #if HELPER_TARGET_IS_ESP32
-    int t;
-    if ((res = i2c_get_timeout(dev->port, &t)) != ESP_OK)
-        return res;
-    // Timeout cannot be 0
+    // Timeout cannot be 0. The last value set is cached to avoid querying the driver on every transfer
     uint32_t ticks = dev->timeout_ticks ? dev->timeout_ticks : I2CDEV_MAX_STRETCH_TIME;
-    if ((ticks != t) && (res = i2c_set_timeout(dev->port, ticks)) != ESP_OK)
-        return res;
-    ESP_LOGD(TAG, "Timeout: ticks = %" PRIu32 " (%" PRIu32 " usec) on port %d", dev->timeout_ticks, dev->timeout_ticks / 80, dev->port);
+    if (ticks != states[dev->port].timeout_ticks)
+    {
+        if ((res = i2c_set_timeout(dev->port, ticks)) != ESP_OK)
+            return res;
+        states[dev->port].timeout_ticks = ticks;
+        ESP_LOGD(TAG, "Timeout: ticks = %" PRIu32 " (%" PRIu32 " usec) on port %d", dev->timeout_ticks, dev->timeout_ticks / 80, dev->port);
+    }
 #endif
 
     return ESP_OK;
@@ -246,14 +299,14 @@ esp_err_t i2c_dev_probe(const i2c_dev_t *dev, i2c_dev_type_t operation_type)
     esp_err_t res = i2c_setup_port(dev);
     if (res == ESP_OK)
     {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+        i2c_cmd_handle_t cmd = cmd_link_create(dev->port);
         i2c_master_start(cmd);
         i2c_master_write_byte(cmd, dev->addr << 1 | (operation_type == I2C_DEV_READ ? 1 : 0), true);
         i2c_master_stop(cmd);
 
         res = i2c_master_cmd_begin(dev->port, cmd, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT));
 
-        i2c_cmd_link_delete(cmd);
+        cmd_link_delete(cmd);
     }
 
     SEMAPHORE_GIVE(dev->port);
@@ -261,16 +314,16 @@ esp_err_t i2c_dev_probe(const i2c_dev_t *dev, i2c_dev_type_t operation_type)
     return res;
 }
 
-esp_err_t i2c_dev_read(const i2c_dev_t *dev, const void *out_data, size_t out_size, void *in_data, size_t in_size)
+/*
+ * Build and execute a read (in_size != 0) or write transfer.
+ * Port mutex must be held and port must be set up.
+ */
+static esp_err_t i2c_dev_transfer(const i2c_dev_t *dev, const void *out_reg, size_t out_reg_size,
+        const void *out_data, size_t out_size, void *in_data, size_t in_size)
 {
-    if (!dev || !in_data || !in_size) return ESP_ERR_INVALID_ARG;
-
-    SEMAPHORE_TAKE(dev->port);
-
-    esp_err_t res = i2c_setup_port(dev);
-    if (res == ESP_OK)
+    i2c_cmd_handle_t cmd = cmd_link_create(dev->port);
+    if (in_size)
     {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
         if (out_data && out_size)
         {
             i2c_master_start(cmd);
@@ -281,13 +334,35 @@ esp_err_t i2c_dev_read(const i2c_dev_t *dev, const void *out_data, size_t out_si
         i2c_master_write_byte(cmd, (dev->addr << 1) | 1, true);
         i2c_master_read(cmd, in_data, in_size, I2C_MASTER_LAST_NACK);
         i2c_master_stop(cmd);
+    }
+    else
+    {
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, dev->addr << 1, true);
+        if (out_reg && out_reg_size)
+            i2c_master_write(cmd, (void *)out_reg, out_reg_size, true);
+        i2c_master_write(cmd, (void *)out_data, out_size, true);
+        i2c_master_stop(cmd);
+    }
 
-        res = i2c_master_cmd_begin(dev->port, cmd, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT));
-        if (res != ESP_OK)
-            ESP_LOGE(TAG, "Could not read from device [0x%02x at %d]: %d (%s)", dev->addr, dev->port, res, esp_err_to_name(res));
+    esp_err_t res = i2c_master_cmd_begin(dev->port, cmd, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT));
+    if (res != ESP_OK)
+        ESP_LOGE(TAG, "Could not %s device [0x%02x at %d]: %d (%s)", in_size ? "read from" : "write to",
+                dev->addr, dev->port, res, esp_err_to_name(res));
 
-        i2c_cmd_link_delete(cmd);
-    }
+    cmd_link_delete(cmd);
+    return res;
+}
+
+esp_err_t i2c_dev_read(const i2c_dev_t *dev, const void *out_data, size_t out_size, void *in_data, size_t in_size)
+{
+    if (!dev || !in_data || !in_size) return ESP_ERR_INVALID_ARG;
+
+    SEMAPHORE_TAKE(dev->port);
+
+    esp_err_t res = i2c_setup_port(dev);
+    if (res == ESP_OK)
+        res = i2c_dev_transfer(dev, NULL, 0, out_data, out_size, in_data, in_size);
 
     SEMAPHORE_GIVE(dev->port);
     return res;
@@ -301,19 +376,7 @@ esp_err_t i2c_dev_write(const i2c_dev_t *dev, const void *out_reg, size_t out_re
 
     esp_err_t res = i2c_setup_port(dev);
     if (res == ESP_OK)
-    {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, dev->addr << 1, true);
-        if (out_reg && out_reg_size)
-            i2c_master_write(cmd, (void *)out_reg, out_reg_size, true);
-        i2c_master_write(cmd, (void *)out_data, out_size, true);
-        i2c_master_stop(cmd);
-        res = i2c_master_cmd_begin(dev->port, cmd, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT));
-        if (res != ESP_OK)
-            ESP_LOGE(TAG, "Could not write to device [0x%02x at %d]: %d (%s)", dev->addr, dev->port, res, esp_err_to_name(res));
-        i2c_cmd_link_delete(cmd);
-    }
+        res = i2c_dev_transfer(dev, out_reg, out_reg_size, out_data, out_size, NULL, 0);
 
     SEMAPHORE_GIVE(dev->port);
     return res;
@@ -328,3 +391,267 @@ esp_err_t i2c_dev_write_reg(const i2c_dev_t *dev, uint8_t reg, const void *out_d
 {
     return i2c_dev_write(dev, &reg, 1, out_data, out_size);
 }
+
+struct i2c_dev_reg_cache
+{
+    const i2c_dev_reg_desc_t *map;
+    size_t count;
+    struct
+    {
+        bool valid;
+        uint8_t data[I2C_DEV_REG_CACHE_MAX_SIZE];
+    } entries[];
+};
+
+esp_err_t i2c_dev_cache_init(i2c_dev_t *dev, const i2c_dev_reg_desc_t *map, size_t count)
+{
+    if (!dev) return ESP_ERR_INVALID_ARG;
+
+    dev->reg_cache = NULL;
+
+    if (!map || !count) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < count; i++)
+        if (!map[i].size || map[i].size > I2C_DEV_REG_CACHE_MAX_SIZE)
+            return ESP_ERR_INVALID_ARG;
+
+    i2c_dev_reg_cache_t *cache = calloc(1, sizeof(i2c_dev_reg_cache_t) + count * sizeof(cache->entries[0]));
+    if (!cache)
+    {
+        ESP_LOGE(TAG, "[0x%02x at %d] Could not allocate register cache", dev->addr, dev->port);
+        return ESP_ERR_NO_MEM;
+    }
+    cache->map = map;
+    cache->count = count;
+    dev->reg_cache = cache;
+
+    return ESP_OK;
+}
+
+void i2c_dev_cache_free(i2c_dev_t *dev)
+{
+    if (!dev) return;
+
+    free(dev->reg_cache);
+    dev->reg_cache = NULL;
+}
+
+void i2c_dev_cache_invalidate(const i2c_dev_t *dev)
+{
+    if (!dev || !dev->reg_cache) return;
+
+    for (size_t i = 0; i < dev->reg_cache->count; i++)
+        dev->reg_cache->entries[i].valid = false;
+}
+
+/*
+ * Returns cache entry index of a register or -1 if the access is not cacheable
+ */
+static int cache_entry(const i2c_dev_t *dev, uint8_t reg, size_t size)
+{
+    const i2c_dev_reg_cache_t *cache = dev->reg_cache;
+    if (!cache) return -1;
+
+    for (size_t i = 0; i < cache->count; i++)
+        if (cache->map[i].reg == reg)
+            return cache->map[i].volatile_reg || cache->map[i].size != size ? -1 : (int)i;
+
+    return -1;
+}
+
+esp_err_t i2c_dev_read_reg_cached(const i2c_dev_t *dev, uint8_t reg, void *in_data, size_t in_size)
+{
+    if (!dev || !in_data || !in_size) return ESP_ERR_INVALID_ARG;
+
+    int i = cache_entry(dev, reg, in_size);
+    if (i >= 0 && dev->reg_cache->entries[i].valid)
+    {
+        memcpy(in_data, dev->reg_cache->entries[i].data, in_size);
+        return ESP_OK;
+    }
+
+    esp_err_t res = i2c_dev_read_reg(dev, reg, in_data, in_size);
+    if (res == ESP_OK && i >= 0)
+    {
+        memcpy(dev->reg_cache->entries[i].data, in_data, in_size);
+        dev->reg_cache->entries[i].valid = true;
+    }
+
+    return res;
+}
+
+esp_err_t i2c_dev_write_reg_cached(const i2c_dev_t *dev, uint8_t reg, const void *out_data, size_t out_size)
+{
+    if (!dev || !out_data || !out_size) return ESP_ERR_INVALID_ARG;
+
+    int i = cache_entry(dev, reg, out_size);
+    // Register value is unknown if the write fails
+    if (i >= 0)
+        dev->reg_cache->entries[i].valid = false;
+
+    esp_err_t res = i2c_dev_write_reg(dev, reg, out_data, out_size);
+    if (res == ESP_OK && i >= 0)
+    {
+        memcpy(dev->reg_cache->entries[i].data, out_data, out_size);
+        dev->reg_cache->entries[i].valid = true;
+    }
+
+    return res;
+}
+
+static void i2c_dev_complete(i2c_dev_transaction_t *trans, esp_err_t res)
+{
+    // descriptor may be reused as soon as busy is cleared
+    i2c_dev_callback_t callback = trans->callback;
+    void *arg = trans->arg;
+    SemaphoreHandle_t done = trans->done;
+
+    trans->result = res;
+    trans->busy = false;
+    if (callback)
+        callback(res, arg);
+    if (done)
+        xSemaphoreGive(done);
+}
+
+static void i2c_dev_worker(void *arg)
+{
+    i2c_port_t port = (i2c_port_t)(intptr_t)arg;
+    i2c_dev_transaction_t *trans;
+    bool stop = false;
+
+    while (!stop)
+    {
+        xQueueReceive(states[port].queue, &trans, portMAX_DELAY);
+        // NULL is the stop request, see i2c_dev_stop_worker()
+        if (!trans)
+            break;
+
+#if !CONFIG_I2CDEV_NOLOCK
+        if (!xSemaphoreTake(states[port].lock, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT)))
+        {
+            ESP_LOGE(TAG, "Could not take port mutex %d", port);
+            i2c_dev_complete(trans, ESP_ERR_TIMEOUT);
+            continue;
+        }
+#endif
+
+        // Execute queued transactions back-to-back, bounded so that synchronous
+        // callers waiting for the port are not starved
+        for (int n = 1; ; n++)
+        {
+            esp_err_t res = i2c_setup_port(trans->dev);
+            if (res == ESP_OK)
+                res = i2c_dev_transfer(trans->dev, trans->out_reg, trans->out_reg_size,
+                        trans->out_data, trans->out_size, trans->in_data, trans->in_size);
+            i2c_dev_complete(trans, res);
+
+            if (n >= CONFIG_I2CDEV_ASYNC_QUEUE_SIZE || !xQueueReceive(states[port].queue, &trans, 0))
+                break;
+            if (!trans)
+            {
+                stop = true;
+                break;
+            }
+        }
+
+#if !CONFIG_I2CDEV_NOLOCK
+        xSemaphoreGive(states[port].lock);
+#endif
+    }
+
+    xSemaphoreGive(states[port].worker_exit);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t i2c_dev_start_worker(i2c_port_t port)
+{
+    esp_err_t res = ESP_OK;
+
+    SEMAPHORE_TAKE(port);
+
+    if (!states[port].worker)
+    {
+        if (!states[port].queue)
+            states[port].queue = xQueueCreate(CONFIG_I2CDEV_ASYNC_QUEUE_SIZE, sizeof(i2c_dev_transaction_t *));
+        if (!states[port].queue ||
+                xTaskCreate(i2c_dev_worker, "i2cdev_worker", CONFIG_I2CDEV_ASYNC_TASK_STACK_SIZE,
+                        (void *)(intptr_t)port, CONFIG_I2CDEV_ASYNC_TASK_PRIORITY, &states[port].worker) != pdPASS)
+        {
+            ESP_LOGE(TAG, "Could not start asynchronous worker on port %d", port);
+            states[port].worker = NULL;
+            res = ESP_ERR_NO_MEM;
+        }
+    }
+
+    SEMAPHORE_GIVE(port);
+    return res;
+}
+
+/*
+ * Queue a stop request behind pending transactions and wait until the worker exits.
+ * Called from i2cdev_done(), no transactions may be submitted concurrently.
+ */
+static esp_err_t i2c_dev_stop_worker(i2c_port_t port)
+{
+    if (states[port].worker)
+    {
+        if (!states[port].worker_exit)
+            states[port].worker_exit = xSemaphoreCreateBinary();
+        if (!states[port].worker_exit)
+            return ESP_ERR_NO_MEM;
+
+        i2c_dev_transaction_t *stop = NULL;
+        if (!xQueueSend(states[port].queue, &stop, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT))
+                || !xSemaphoreTake(states[port].worker_exit, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT)))
+        {
+            ESP_LOGE(TAG, "Could not stop asynchronous worker on port %d", port);
+            return ESP_ERR_TIMEOUT;
+        }
+        states[port].worker = NULL;
+    }
+
+    if (states[port].queue)
+        vQueueDelete(states[port].queue);
+    states[port].queue = NULL;
+    if (states[port].worker_exit)
+        vSemaphoreDelete(states[port].worker_exit);
+    states[port].worker_exit = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t i2c_dev_submit(i2c_dev_transaction_t *trans)
+{
+    if (!trans || !trans->dev || trans->dev->port >= I2C_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    if (trans->in_size ? !trans->in_data : (!trans->out_data || !trans->out_size)) return ESP_ERR_INVALID_ARG;
+    if (trans->busy) return ESP_ERR_INVALID_STATE;
+
+    i2c_port_t port = trans->dev->port;
+    if (!states[port].worker)
+    {
+        esp_err_t res = i2c_dev_start_worker(port);
+        if (res != ESP_OK)
+            return res;
+    }
+
+    trans->busy = true;
+    trans->result = ESP_ERR_INVALID_STATE;
+    if (!xQueueSend(states[port].queue, &trans, pdMS_TO_TICKS(CONFIG_I2CDEV_TIMEOUT)))
+    {
+        ESP_LOGE(TAG, "[0x%02x at %d] Asynchronous queue is full", trans->dev->addr, port);
+        trans->busy = false;
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t i2c_dev_wait(i2c_dev_transaction_t *trans, TickType_t timeout)
+{
+    if (!trans || !trans->done) return ESP_ERR_INVALID_ARG;
+
+    if (!xSemaphoreTake(trans->done, timeout))
+        return ESP_ERR_TIMEOUT;
+
+    return trans->result;
+}
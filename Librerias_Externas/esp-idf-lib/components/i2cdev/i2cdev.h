@@ -62,6 +62,26 @@ extern "C" {
 
 #endif /* HELPER_TARGET_IS_ESP8266 */
 
+/**
+ * Maximum size of a cached register, in bytes
+ */
+#define I2C_DEV_REG_CACHE_MAX_SIZE 4
+
+/**
+ * Register descriptor of a register cache map
+ */
+typedef struct
+{
+    uint8_t reg;       //!< Register address
+    uint8_t size;      //!< Register size in bytes, 1..I2C_DEV_REG_CACHE_MAX_SIZE
+    bool volatile_reg; //!< Register is changed by the device itself (status, data) and is never cached
+} i2c_dev_reg_desc_t;
+
+/**
+ * Register cache, see ::i2c_dev_cache_init()
+ */
+typedef struct i2c_dev_reg_cache i2c_dev_reg_cache_t;
+
 /**
  * I2C device descriptor
  */
@@ -74,6 +94,7 @@ typedef struct
     uint32_t timeout_ticks;  /*!< HW I2C bus timeout (stretch time), in ticks. 80MHz APB clock
                                   ticks for ESP-IDF, CPU ticks for ESP8266.
                                   When this value is 0, I2CDEV_MAX_STRETCH_TIME will be used */
+    i2c_dev_reg_cache_t *reg_cache; //!< Register cache, set by ::i2c_dev_cache_init() in drivers that use it
 } i2c_dev_t;
 
 /**
@@ -84,6 +105,43 @@ typedef enum {
     I2C_DEV_READ       /**< Read operation */
 } i2c_dev_type_t;
 
+/**
+ * @brief Completion callback of an asynchronous transaction
+ *
+ * Called from the port worker task while the port mutex is held, so it must
+ * not block nor perform synchronous transfers on the same port.
+ *
+ * @param result Transaction result
+ * @param arg User argument of the transaction
+ */
+typedef void (*i2c_dev_callback_t)(esp_err_t result, void *arg);
+
+/**
+ * Asynchronous transaction descriptor
+ *
+ * If \p in_size is non-zero, the transaction is a read: \p out_data (if any) is sent,
+ * followed by a repeated start and reading \p in_size bytes into \p in_data.
+ * Otherwise, it is a write of \p out_reg (if any) followed by \p out_data.
+ *
+ * The descriptor and all the buffers it points to must stay valid until the
+ * transaction is completed.
+ */
+typedef struct
+{
+    const i2c_dev_t *dev;     //!< Device descriptor
+    const void *out_reg;      //!< Register address to send before \p out_data in writes, may be NULL
+    size_t out_reg_size;      //!< Size of register address
+    const void *out_data;     //!< Data to send, may be NULL in reads
+    size_t out_size;          //!< Size of data to send
+    void *in_data;            //!< Input data buffer, for reads
+    size_t in_size;           //!< Number of bytes to read, 0 for writes
+    i2c_dev_callback_t callback; //!< Completion callback, may be NULL
+    void *arg;                //!< User argument passed to \p callback
+    SemaphoreHandle_t done;   //!< Binary semaphore given on completion, may be NULL. See ::i2c_dev_wait()
+    volatile bool busy;       //!< True while the transaction is queued or in progress
+    volatile esp_err_t result; //!< Transaction result, valid after completion
+} i2c_dev_transaction_t;
+
 /**
  * @brief Init library
  *
@@ -97,7 +155,8 @@ esp_err_t i2cdev_init();
 /**
  * @brief Finish work with library
  *
- * Uninstall i2c drivers.
+ * Stop asynchronous workers after their queued transactions are completed
+ * and uninstall i2c drivers.
  *
  * @return ESP_OK on success
  */
@@ -215,6 +274,111 @@ esp_err_t i2c_dev_read_reg(const i2c_dev_t *dev, uint8_t reg,
 esp_err_t i2c_dev_write_reg(const i2c_dev_t *dev, uint8_t reg,
         const void *out_data, size_t out_size);
 
+/**
+ * @brief Create the register cache of a device
+ *
+ * Drivers that update register fields with read-modify-write cycles call this
+ * function in their descriptor init function, passing a static map of the
+ * device registers. Registers not in the map, registers marked as volatile and
+ * accesses of a different size than the register are never cached.
+ *
+ * Any previous value of \p dev->reg_cache is overwritten.
+ *
+ * @param dev Device descriptor
+ * @param map Register map, must stay valid while the cache is used
+ * @param count Number of registers in the map
+ * @return ESP_OK on success
+ */
+esp_err_t i2c_dev_cache_init(i2c_dev_t *dev, const i2c_dev_reg_desc_t *map, size_t count);
+
+/**
+ * @brief Free the register cache of a device
+ *
+ * @param dev Device descriptor
+ */
+void i2c_dev_cache_free(i2c_dev_t *dev);
+
+/**
+ * @brief Invalidate all cached registers of a device
+ *
+ * Must be called after the device has been reset or power cycled.
+ *
+ * @param dev Device descriptor
+ */
+void i2c_dev_cache_invalidate(const i2c_dev_t *dev);
+
+/**
+ * @brief Read from register with an 8-bit address, using the register cache
+ *
+ * If the register is cacheable and its value is known, it is returned without
+ * any bus transaction. Otherwise the register is read with ::i2c_dev_read_reg()
+ * and, if it is cacheable, its value is stored in the cache.
+ *
+ * Cache is not protected by the port mutex: call this function with the device
+ * mutex taken.
+ *
+ * @param dev Device descriptor
+ * @param reg Register address
+ * @param[out] in_data Pointer to input data buffer
+ * @param in_size Number of byte to read
+ * @return ESP_OK on success
+ */
+esp_err_t i2c_dev_read_reg_cached(const i2c_dev_t *dev, uint8_t reg,
+        void *in_data, size_t in_size);
+
+/**
+ * @brief Write to register with an 8-bit address, updating the register cache
+ *
+ * Register is always written with ::i2c_dev_write_reg(). On success, the value
+ * is stored in the cache if the register is cacheable, so the next
+ * read-modify-write cycle on it costs a single write transaction.
+ *
+ * Cache is not protected by the port mutex: call this function with the device
+ * mutex taken.
+ *
+ * @param dev Device descriptor
+ * @param reg Register address
+ * @param out_data Pointer to data to send
+ * @param out_size Size of data to send
+ * @return ESP_OK on success
+ */
+esp_err_t i2c_dev_write_reg_cached(const i2c_dev_t *dev, uint8_t reg,
+        const void *out_data, size_t out_size);
+
+/**
+ * @brief Submit an asynchronous transaction
+ *
+ * The transaction is queued to the worker task of the device port, which is
+ * created on first use. Queued transactions are executed back-to-back while the
+ * port mutex is held, reusing a statically allocated command link, so
+ * synchronous and asynchronous transfers never interleave on the bus.
+ * The calling task only blocks if the queue is full.
+ *
+ * When the transaction is completed, \p result is set, \p callback is called
+ * and \p done is given, in that order.
+ *
+ * The worker takes only the port mutex, not the device mutex (i2c_dev_t::mutex),
+ * the same as the synchronous i2c_dev_read() and i2c_dev_write(). Drivers that
+ * keep state in the descriptor must serialize asynchronous transactions with
+ * their other accesses themselves. Do not wait for a transaction while holding
+ * the device mutex if the callback takes it.
+ *
+ * @param trans Transaction descriptor
+ * @return ESP_OK if the transaction was queued, ESP_ERR_INVALID_STATE if it is still busy
+ */
+esp_err_t i2c_dev_submit(i2c_dev_transaction_t *trans);
+
+/**
+ * @brief Wait for an asynchronous transaction to complete
+ *
+ * The transaction must have a \p done semaphore.
+ *
+ * @param trans Transaction descriptor
+ * @param timeout Maximum time to wait
+ * @return Transaction result, or ESP_ERR_TIMEOUT
+ */
+esp_err_t i2c_dev_wait(i2c_dev_transaction_t *trans, TickType_t timeout);
+
 #define I2C_DEV_TAKE_MUTEX(dev) do { \
         esp_err_t __ = i2c_dev_take_mutex(dev); \
         if (__ != ESP_OK) return __;\
@@ -34,6 +34,8 @@
 #include <esp_log.h>
 #include <esp_attr.h>
 #include <stdlib.h>
+#include <string.h>
+#include <esp_timer.h>
 #include <ets_sys.h>
 #include <esp_idf_lib_helpers.h>
 
@@ -70,9 +72,19 @@ static const char *TAG = "led_strip";
 
 #define COLOR_SIZE(strip) (3 + ((strip)->is_rgbw != 0))
 
+/*
+ * Every bit is encoded as one RMT item, so a nibble maps to exactly four items.
+ * Lookup tables are built once in led_strip_install(), which keeps the
+ * translator (called from the RMT ISR while the frame is on the wire) down to
+ * two table lookups and eight word copies per byte.
+ */
+typedef rmt_item32_t led_rmt_nibble_t[4];
+
+static DRAM_ATTR led_rmt_nibble_t rmt_lut[LED_STRIP_TYPE_MAX][16] = { 0 };
+
 static void IRAM_ATTR _rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
                                    size_t wanted_num, size_t *translated_size, size_t *item_num,
-                                   const rmt_item32_t *bit0, const rmt_item32_t *bit1)
+                                   const led_rmt_nibble_t *lut)
 {
     if (!src || !dest)
     {
@@ -82,27 +94,23 @@ static void IRAM_ATTR _rmt_adapter(const void *src, rmt_item32_t *dest, size_t s
     }
     size_t size = 0;
     size_t num = 0;
-    uint8_t *psrc = (uint8_t *)src;
+    const uint8_t *psrc = (const uint8_t *)src;
     rmt_item32_t *pdest = dest;
-#ifdef LED_STRIP_BRIGHTNESS
-    led_strip_t *strip;
-    esp_err_t r = rmt_translator_get_context(item_num, (void **)&strip);
-    uint8_t brightness = r == ESP_OK ? strip->brightness : 255;
-#endif
     while (size < src_size && num < wanted_num)
     {
-#ifdef LED_STRIP_BRIGHTNESS
-        uint8_t b = brightness != 255 ? scale8_video(*psrc, brightness) : *psrc;
-#else
-        uint8_t b = *psrc;
-#endif
-        for (int i = 0; i < 8; i++)
-        {
-            // MSB first
-            pdest->val = b & (1 << (7 - i)) ? bit1->val : bit0->val;
-            num++;
-            pdest++;
-        }
+        // MSB first
+        const rmt_item32_t *hi = lut[*psrc >> 4];
+        const rmt_item32_t *lo = lut[*psrc & 0x0f];
+        pdest[0].val = hi[0].val;
+        pdest[1].val = hi[1].val;
+        pdest[2].val = hi[2].val;
+        pdest[3].val = hi[3].val;
+        pdest[4].val = lo[0].val;
+        pdest[5].val = lo[1].val;
+        pdest[6].val = lo[2].val;
+        pdest[7].val = lo[3].val;
+        pdest += 8;
+        num += 8;
         size++;
         psrc++;
     }
@@ -110,34 +118,28 @@ static void IRAM_ATTR _rmt_adapter(const void *src, rmt_item32_t *dest, size_t s
     *item_num = num;
 }
 
-typedef struct {
-    rmt_item32_t bit0, bit1;
-} led_rmt_t;
-
-static led_rmt_t rmt_items[LED_STRIP_TYPE_MAX] = { 0 };
-
 static void IRAM_ATTR ws2812_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
         size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
-    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, &rmt_items[LED_STRIP_WS2812].bit0, &rmt_items[LED_STRIP_WS2812].bit1);
+    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, rmt_lut[LED_STRIP_WS2812]);
 }
 
 static void IRAM_ATTR sk6812_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
         size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
-    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, &rmt_items[LED_STRIP_SK6812].bit0, &rmt_items[LED_STRIP_SK6812].bit1);
+    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, rmt_lut[LED_STRIP_SK6812]);
 }
 
 static void IRAM_ATTR apa106_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
         size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
-    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, &rmt_items[LED_STRIP_APA106].bit0, &rmt_items[LED_STRIP_APA106].bit1);
+    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, rmt_lut[LED_STRIP_APA106]);
 }
 
 static void IRAM_ATTR sm16703_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
                                          size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
-    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, &rmt_items[LED_STRIP_SM16703].bit0, &rmt_items[LED_STRIP_SM16703].bit1);
+    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, rmt_lut[LED_STRIP_SM16703]);
 }
 
 typedef enum {
@@ -158,6 +160,60 @@ static const led_params_t led_params[] = {
     [LED_STRIP_SM16703] = { .t0h = 300, .t0l = 900,  .t1h = 1360, .t1l = 350, .order = ORDER_RGB, .adapter = sm16703_rmt_adapter },
 };
 
+/*
+ * Pixel format conversion kernels, one per color order and RGB/RGBW layout.
+ * They are selected once per call, so converting a whole array of pixels
+ * is a tight loop without argument checks or switching on color order.
+ */
+typedef void (*pixel_conv_t)(uint8_t *dst, const rgb_t *src, size_t len);
+
+_Static_assert(sizeof(rgb_t) == 3, "rgb_t must be packed to 3 bytes");
+
+static void conv_rgb(uint8_t *dst, const rgb_t *src, size_t len)
+{
+    // rgb_t is already in wire order
+    memcpy(dst, src, len * sizeof(rgb_t));
+}
+
+static void conv_grb(uint8_t *dst, const rgb_t *src, size_t len)
+{
+    for (const rgb_t *end = src + len; src < end; src++, dst += 3)
+    {
+        dst[0] = src->g;
+        dst[1] = src->r;
+        dst[2] = src->b;
+    }
+}
+
+static void conv_rgbw(uint8_t *dst, const rgb_t *src, size_t len)
+{
+    for (const rgb_t *end = src + len; src < end; src++, dst += 4)
+    {
+        dst[0] = src->r;
+        dst[1] = src->g;
+        dst[2] = src->b;
+        dst[3] = rgb_luma(*src);
+    }
+}
+
+static void conv_grbw(uint8_t *dst, const rgb_t *src, size_t len)
+{
+    for (const rgb_t *end = src + len; src < end; src++, dst += 4)
+    {
+        dst[0] = src->g;
+        dst[1] = src->r;
+        dst[2] = src->b;
+        dst[3] = rgb_luma(*src);
+    }
+}
+
+static const pixel_conv_t pixel_conv[][2] = {
+    [ORDER_GRB] = { conv_grb, conv_grbw },
+    [ORDER_RGB] = { conv_rgb, conv_rgbw },
+};
+
+#define PIXEL_CONV(strip) (pixel_conv[led_params[(strip)->type].order][(strip)->is_rgbw != 0])
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void led_strip_install()
@@ -166,29 +222,76 @@ void led_strip_install()
 
     for (size_t i = 0; i < LED_STRIP_TYPE_MAX; i++)
     {
+        rmt_item32_t bit0, bit1;
         // 0 bit
-        rmt_items[i].bit0.duration0 = (uint32_t)(ratio * led_params[i].t0h);
-        rmt_items[i].bit0.level0 = 1;
-        rmt_items[i].bit0.duration1 = (uint32_t)(ratio * led_params[i].t0l);
-        rmt_items[i].bit0.level1 = 0;
+        bit0.duration0 = (uint32_t)(ratio * led_params[i].t0h);
+        bit0.level0 = 1;
+        bit0.duration1 = (uint32_t)(ratio * led_params[i].t0l);
+        bit0.level1 = 0;
         // 1 bit
-        rmt_items[i].bit1.duration0 = (uint32_t)(ratio * led_params[i].t1h);
-        rmt_items[i].bit1.level0 = 1;
-        rmt_items[i].bit1.duration1 = (uint32_t)(ratio * led_params[i].t1l);
-        rmt_items[i].bit1.level1 = 0;
+        bit1.duration0 = (uint32_t)(ratio * led_params[i].t1h);
+        bit1.level0 = 1;
+        bit1.duration1 = (uint32_t)(ratio * led_params[i].t1l);
+        bit1.level1 = 0;
+
+        for (size_t n = 0; n < 16; n++)
+            for (size_t b = 0; b < 4; b++)
+                // MSB first
+                rmt_lut[i][n][b].val = n & (0x08 >> b) ? bit1.val : bit0.val;
     }
 }
 
+static uint32_t frame_time_us(led_strip_t *strip)
+{
+    const led_params_t *p = &led_params[strip->type];
+    uint32_t bit_ns = p->t0h + p->t0l > p->t1h + p->t1l ? p->t0h + p->t0l : p->t1h + p->t1l;
+    return (uint32_t)((uint64_t)strip->length * COLOR_SIZE(strip) * 8 * bit_ns / 1000) + 1;
+}
+
+static esp_err_t wait_front(led_strip_t *strip)
+{
+    CHECK(rmt_wait_tx_done(strip->channel, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
+
+    // Reset pause is counted from the estimated end of the previous frame, so
+    // there is no delay at all if the caller took longer than that to render
+    int64_t left = strip->tx_end + CONFIG_LED_STRIP_PAUSE_LENGTH - esp_timer_get_time();
+    if (left > 0)
+        ets_delay_us((uint32_t)left);
+
+    return ESP_OK;
+}
+
+static esp_err_t send_front(led_strip_t *strip)
+{
+    size_t size = strip->length * COLOR_SIZE(strip);
+
+    strip->tx_end = esp_timer_get_time() + frame_time_us(strip);
+    return rmt_write_sample(strip->channel, strip->front, size, false);
+}
+
 esp_err_t led_strip_init(led_strip_t *strip)
 {
     CHECK_ARG(strip && strip->length > 0 && strip->type < LED_STRIP_TYPE_MAX);
 
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(4, 3, 0)
+    // Before brightness was supported on these versions, callers did not
+    // set it, so zero means unset here. Keep their strips at full brightness.
+    if (!strip->brightness)
+        strip->brightness = 255;
+#endif
+
     strip->buf = calloc(strip->length, COLOR_SIZE(strip));
-    if (!strip->buf)
+    strip->front = calloc(strip->length, COLOR_SIZE(strip));
+    if (!strip->buf || !strip->front)
     {
         ESP_LOGE(TAG, "Not enough memory");
+        free(strip->buf);
+        free(strip->front);
+        strip->buf = NULL;
+        strip->front = NULL;
         return ESP_ERR_NO_MEM;
     }
+    strip->tx_end = 0;
 
     rmt_config_t config = RMT_DEFAULT_CONFIG_TX(strip->gpio, strip->channel);
     config.clk_div = LED_STRIP_RMT_CLK_DIV;
@@ -197,10 +300,6 @@ esp_err_t led_strip_init(led_strip_t *strip)
     CHECK(rmt_driver_install(config.channel, 0, 0));
 
     CHECK(rmt_translator_init(config.channel, led_params[strip->type].adapter));
-#ifdef LED_STRIP_BRIGHTNESS
-    // No support for translator context prior to ESP-IDF 4.3
-    CHECK(rmt_translator_set_context(config.channel, strip));
-#endif
 
     return ESP_OK;
 }
@@ -209,6 +308,9 @@ esp_err_t led_strip_free(led_strip_t *strip)
 {
     CHECK_ARG(strip && strip->buf);
     free(strip->buf);
+    free(strip->front);
+    strip->buf = NULL;
+    strip->front = NULL;
 
     CHECK(rmt_driver_uninstall(strip->channel));
 
@@ -217,12 +319,38 @@ esp_err_t led_strip_free(led_strip_t *strip)
 
 esp_err_t led_strip_flush(led_strip_t *strip)
 {
-    CHECK_ARG(strip && strip->buf);
+    CHECK_ARG(strip && strip->buf && strip->front);
 
-    CHECK(rmt_wait_tx_done(strip->channel, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
-    ets_delay_us(CONFIG_LED_STRIP_PAUSE_LENGTH);
-    return rmt_write_sample(strip->channel, strip->buf,
-                            strip->length * COLOR_SIZE(strip), false);
+    CHECK(wait_front(strip));
+
+    size_t size = strip->length * COLOR_SIZE(strip);
+    if (strip->brightness == 255)
+        memcpy(strip->front, strip->buf, size);
+    else
+        for (size_t i = 0; i < size; i++)
+            strip->front[i] = scale8_video(strip->buf[i], strip->brightness);
+
+    return send_front(strip);
+}
+
+esp_err_t led_strip_swap(led_strip_t *strip)
+{
+    CHECK_ARG(strip && strip->buf && strip->front);
+
+    CHECK(wait_front(strip));
+
+    uint8_t *tmp = strip->front;
+    strip->front = strip->buf;
+    strip->buf = tmp;
+
+    if (strip->brightness != 255)
+    {
+        size_t size = strip->length * COLOR_SIZE(strip);
+        for (size_t i = 0; i < size; i++)
+            strip->front[i] = scale8_video(strip->front[i], strip->brightness);
+    }
+
+    return send_front(strip);
 }
 
 bool led_strip_busy(led_strip_t *strip)
@@ -240,33 +368,19 @@ esp_err_t led_strip_wait(led_strip_t *strip, TickType_t timeout)
 
 esp_err_t led_strip_set_pixel(led_strip_t *strip, size_t num, rgb_t color)
 {
-    CHECK_ARG(strip && strip->buf && num <= strip->length);
-    size_t idx = num * COLOR_SIZE(strip);
-    switch (led_params[strip->type].order)
-    {
-        case ORDER_GRB:
-            strip->buf[idx] = color.g;
-            strip->buf[idx + 1] = color.r;
-            strip->buf[idx + 2] = color.b;
-            if (strip->is_rgbw)
-                strip->buf[idx + 3] = rgb_luma(color);
-            break;
-        case ORDER_RGB:
-            strip->buf[idx] = color.r;
-            strip->buf[idx + 1] = color.g;
-            strip->buf[idx + 2] = color.b;
-            if (strip->is_rgbw)
-                strip->buf[idx + 3] = rgb_luma(color);
-            break;
-    }
+    CHECK_ARG(strip && strip->buf && num < strip->length);
+
+    PIXEL_CONV(strip)(strip->buf + num * COLOR_SIZE(strip), &color, 1);
+
     return ESP_OK;
 }
 
 esp_err_t led_strip_set_pixels(led_strip_t *strip, size_t start, size_t len, rgb_t *data)
 {
-    CHECK_ARG(strip && strip->buf && len && start + len <= strip->length);
-    for (size_t i = 0; i < len; i++)
-        CHECK(led_strip_set_pixel(strip, i + start, data[i]));
+    CHECK_ARG(strip && strip->buf && data && len && start + len <= strip->length);
+
+    PIXEL_CONV(strip)(strip->buf + start * COLOR_SIZE(strip), data, len);
+
     return ESP_OK;
 }
 
@@ -274,7 +388,31 @@ esp_err_t led_strip_fill(led_strip_t *strip, size_t start, size_t len, rgb_t col
 {
     CHECK_ARG(strip && strip->buf && len && start + len <= strip->length);
 
-    for (size_t i = start; i < start + len; i++)
-        CHECK(led_strip_set_pixel(strip, i, color));
+    size_t color_size = COLOR_SIZE(strip);
+    uint8_t *dst = strip->buf + start * color_size;
+    PIXEL_CONV(strip)(dst, &color, 1);
+
+    // Replicate first pixel, doubling the copied block every pass
+    size_t done = color_size;
+    size_t total = len * color_size;
+    while (done < total)
+    {
+        size_t chunk = done < total - done ? done : total - done;
+        memcpy(dst + done, dst, chunk);
+        done += chunk;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t led_strip_get_rgb_buffer(led_strip_t *strip, rgb_t **buf)
+{
+    CHECK_ARG(strip && strip->buf && buf);
+
+    if (PIXEL_CONV(strip) != conv_rgb)
+        return ESP_ERR_NOT_SUPPORTED;
+
+    *buf = (rgb_t *)strip->buf;
+
     return ESP_OK;
 }
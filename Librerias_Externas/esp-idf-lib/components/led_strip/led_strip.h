@@ -44,9 +44,12 @@
 extern "C" {
 #endif
 
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
+/**
+ * Brightness is applied once per frame in ::led_strip_flush() /
+ * ::led_strip_swap(), so it is available on all supported ESP-IDF versions.
+ * The macro is kept for compatibility.
+ */
 #define LED_STRIP_BRIGHTNESS 1
-#endif
 
 /**
  * LED type
@@ -68,14 +71,14 @@ typedef struct
 {
     led_strip_type_t type; ///< LED type
     bool is_rgbw;          ///< true for RGBW strips
-#ifdef LED_STRIP_BRIGHTNESS
     uint8_t brightness;    ///< Brightness 0..255, call ::led_strip_flush() after change.
-                           ///< Supported only for ESP-IDF version >= 4.3
-#endif
+                           ///< On ESP-IDF < 4.3, 0 is replaced with 255 by ::led_strip_init().
     size_t length;         ///< Number of LEDs in strip
     gpio_num_t gpio;       ///< Data GPIO pin
     rmt_channel_t channel; ///< RMT channel
-    uint8_t *buf;
+    uint8_t *buf;          ///< Back buffer, the frame being rendered
+    uint8_t *front;        ///< Front buffer, the frame on the wire (internal)
+    int64_t tx_end;        ///< Estimated end of current transmission, us (internal)
 } led_strip_t;
 
 /**
@@ -104,11 +107,31 @@ esp_err_t led_strip_free(led_strip_t *strip);
 /**
  * @brief Send strip buffer to LEDs
  *
+ * Waits until the previous frame has been sent, copies the back buffer
+ * to the front buffer applying brightness and starts transmission.
+ * Returns without waiting for the transmission to finish: the back buffer
+ * keeps its contents and can be modified right away.
+ *
  * @param strip Descriptor of LED strip
  * @return `ESP_OK` on success
  */
 esp_err_t led_strip_flush(led_strip_t *strip);
 
+/**
+ * @brief Swap back and front buffers and send the new front buffer to LEDs
+ *
+ * Zero-copy alternative to ::led_strip_flush() for callers that redraw
+ * the whole frame every time. Waits until the previous frame has been sent,
+ * swaps the buffers and starts transmission without waiting for it to finish.
+ *
+ * @note After the call `strip->buf` holds an old frame (possibly scaled
+ *       by brightness), so every pixel must be set again before next swap.
+ *
+ * @param strip Descriptor of LED strip
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_strip_swap(led_strip_t *strip);
+
 /**
  * @brief Check if associated RMT channel is busy
  *
@@ -167,6 +190,24 @@ esp_err_t led_strip_set_pixels(led_strip_t *strip, size_t start, size_t len, rgb
  */
 esp_err_t led_strip_fill(led_strip_t *strip, size_t start, size_t len, rgb_t color);
 
+/**
+ * @brief Get back buffer as array of `rgb_t` for zero-copy rendering
+ *
+ * Available only for strips whose wire format is the same as `rgb_t`
+ * (RGB color order, no white channel). Pixels can be rendered directly
+ * into the returned array instead of converting them with
+ * ::led_strip_set_pixels().
+ *
+ * @note ::led_strip_swap() exchanges the buffers, so the pointer must be
+ *       requested again after each swap.
+ *
+ * @param strip    Descriptor of LED strip
+ * @param[out] buf Pointer to back buffer, `strip->length` pixels
+ * @return `ESP_OK` on success, `ESP_ERR_NOT_SUPPORTED` if strip wire
+ *         format differs from `rgb_t`
+ */
+esp_err_t led_strip_get_rgb_buffer(led_strip_t *strip, rgb_t **buf);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,7 @@ static const char *TAG = "max7219";
 #define ALL_CHIPS 0xff
 #define ALL_DIGITS 8
 
+#define REG_NO_OP        (0 << 8)
 #define REG_DIGIT_0      (1 << 8)
 #define REG_DECODE_MODE  (9 << 8)
 #define REG_INTENSITY    (10 << 8)
@@ -217,6 +218,7 @@ esp_err_t max7219_set_digit(max7219_t *dev, uint8_t digit, uint8_t val)
     ESP_LOGV(TAG, "Chip %d, digit %d val 0x%02x", c, d, val);
 
     CHECK(send(dev, c, (REG_DIGIT_0 + ((uint16_t)d << 8)) | val));
+    dev->shadow[c * ALL_DIGITS + d] = val;
 
     return ESP_OK;
 }
@@ -228,6 +230,7 @@ esp_err_t max7219_clear(max7219_t *dev)
     uint8_t val = dev->bcd ? VAL_CLEAR_BCD : VAL_CLEAR_NORMAL;
     for (uint8_t i = 0; i < ALL_DIGITS; i++)
         CHECK(send(dev, ALL_CHIPS, (REG_DIGIT_0 + ((uint16_t)i << 8)) | val));
+    memset(dev->shadow, val, sizeof(dev->shadow));
 
     return ESP_OK;
 }
@@ -261,3 +264,52 @@ esp_err_t max7219_draw_image_8x8(max7219_t *dev, uint8_t pos, const void *image)
 
     return ESP_OK;
 }
+
+esp_err_t max7219_update_digits(max7219_t *dev, uint8_t pos, const uint8_t *vals, uint8_t len)
+{
+    CHECK_ARG(dev && vals);
+    if (pos >= dev->digits || len > dev->digits - pos)
+    {
+        ESP_LOGE(TAG, "Invalid digits range: %d..%d", pos, pos + len - 1);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // bit N of changed[d] is set if digit d of chip N must be sent
+    uint8_t changed[ALL_DIGITS] = { 0 };
+    uint8_t next[MAX7219_MAX_CASCADE_SIZE * ALL_DIGITS];
+    memcpy(next, dev->shadow, sizeof(next));
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t digit = pos + i;
+        if (dev->mirrored)
+            digit = dev->digits - digit - 1;
+        if (next[digit] == vals[i])
+            continue;
+        next[digit] = vals[i];
+        changed[digit % ALL_DIGITS] |= 1 << (digit / ALL_DIGITS);
+    }
+
+    for (uint8_t d = 0; d < ALL_DIGITS; d++)
+    {
+        if (!changed[d])
+            continue;
+
+        uint16_t buf[MAX7219_MAX_CASCADE_SIZE] = { 0 };
+        for (uint8_t c = 0; c < dev->cascade_size; c++)
+            buf[c] = shuffle(changed[d] & (1 << c)
+                             ? (REG_DIGIT_0 + ((uint16_t)d << 8)) | next[c * ALL_DIGITS + d]
+                             : REG_NO_OP);
+
+        spi_transaction_t t;
+        memset(&t, 0, sizeof(t));
+        t.length = dev->cascade_size * 16;
+        t.tx_buffer = buf;
+        CHECK(spi_device_transmit(dev->spi_dev, &t));
+
+        for (uint8_t c = 0; c < dev->cascade_size; c++)
+            if (changed[d] & (1 << c))
+                dev->shadow[c * ALL_DIGITS + d] = next[c * ALL_DIGITS + d];
+    }
+
+    return ESP_OK;
+}
@@ -68,6 +68,7 @@ typedef struct
     uint8_t cascade_size;        //!< Up to `MAX7219_MAX_CASCADE_SIZE` MAX721xx cascaded
     bool mirrored;               //!< true for horizontally mirrored displays
     bool bcd;
+    uint8_t shadow[MAX7219_MAX_CASCADE_SIZE * 8]; //!< Last values sent to digit registers, by chip and digit
 } max7219_t;
 
 /**
@@ -165,6 +166,22 @@ esp_err_t max7219_draw_text_7seg(max7219_t *dev, uint8_t pos, const char *s);
  */
 esp_err_t max7219_draw_image_8x8(max7219_t *dev, uint8_t pos, const void *image);
 
+/**
+ * @brief Update multiple digits, sending only changed ones
+ *
+ * New values are compared with the last values sent to the display.
+ * Changed digits with the same register number in different chips of
+ * the cascade are sent in a single SPI transaction, unchanged chips
+ * get a no-op command.
+ *
+ * @param dev Display descriptor
+ * @param pos Start digit
+ * @param vals Digit values
+ * @param len Number of digits
+ * @return `ESP_OK` on success
+ */
+esp_err_t max7219_update_digits(max7219_t *dev, uint8_t pos, const uint8_t *vals, uint8_t len);
+
 #ifdef __cplusplus
 }
 #endif
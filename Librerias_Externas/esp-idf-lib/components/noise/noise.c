@@ -215,6 +215,63 @@ ALWAYS_INLINE int8_t lerp7by8(int8_t a, int8_t b, fract8 frac)
     return result;
 }
 
+// Interpolation inside of a lattice cell. h[] are hashes of cell corners:
+// AA, BA, AB, BB (and AA + 1, BA + 1, AB + 1, BB + 1 for 3D)
+
+ALWAYS_INLINE int16_t noise16_3d_cell(const uint8_t *h, int16_t xx, int16_t yy, int16_t zz,
+                                      uint16_t u, uint16_t v, uint16_t w)
+{
+    uint16_t N = 0x8000L;
+
+    // skip the log fade adjustment for the moment, otherwise here we would
+    // adjust fade values for u,v,w
+    int16_t X1 = lerp15by16(grad16_3d(h[0], xx, yy, zz), grad16_3d(h[1], xx - N, yy, zz), u);
+    int16_t X2 = lerp15by16(grad16_3d(h[2], xx, yy - N, zz), grad16_3d(h[3], xx - N, yy - N, zz), u);
+    int16_t X3 = lerp15by16(grad16_3d(h[4], xx, yy, zz - N), grad16_3d(h[5], xx - N, yy, zz - N), u);
+    int16_t X4 = lerp15by16(grad16_3d(h[6], xx, yy - N, zz - N), grad16_3d(h[7], xx - N, yy - N, zz - N), u);
+
+    int16_t Y1 = lerp15by16(X1, X2, v);
+    int16_t Y2 = lerp15by16(X3, X4, v);
+
+    return lerp15by16(Y1, Y2, w);
+}
+
+ALWAYS_INLINE int16_t noise16_2d_cell(const uint8_t *h, int16_t xx, int16_t yy, uint16_t u, uint16_t v)
+{
+    uint16_t N = 0x8000L;
+
+    int16_t X1 = lerp15by16(grad16_2d(h[0], xx, yy), grad16_2d(h[1], xx - N, yy), u);
+    int16_t X2 = lerp15by16(grad16_2d(h[2], xx, yy - N), grad16_2d(h[3], xx - N, yy - N), u);
+
+    return lerp15by16(X1,X2,v);
+}
+
+ALWAYS_INLINE int8_t noise8_3d_cell(const uint8_t *h, int8_t xx, int8_t yy, int8_t zz,
+                                    uint8_t u, uint8_t v, uint8_t w)
+{
+    uint8_t N = 0x80;
+
+    int8_t X1 = lerp7by8(grad8_3d(h[0], xx, yy, zz), grad8_3d(h[1], xx - N, yy, zz), u);
+    int8_t X2 = lerp7by8(grad8_3d(h[2], xx, yy - N, zz), grad8_3d(h[3], xx - N, yy - N, zz), u);
+    int8_t X3 = lerp7by8(grad8_3d(h[4], xx, yy, zz - N), grad8_3d(h[5], xx - N, yy, zz - N), u);
+    int8_t X4 = lerp7by8(grad8_3d(h[6], xx, yy - N, zz - N), grad8_3d(h[7], xx - N, yy - N, zz - N), u);
+
+    int8_t Y1 = lerp7by8(X1, X2, v);
+    int8_t Y2 = lerp7by8(X3, X4, v);
+
+    return lerp7by8(Y1, Y2, w);
+}
+
+ALWAYS_INLINE int8_t noise8_2d_cell(const uint8_t *h, int8_t xx, int8_t yy, uint8_t u, uint8_t v)
+{
+    uint8_t N = 0x80;
+
+    int8_t X1 = lerp7by8(grad8_2d(h[0], xx, yy), grad8_2d(h[1], xx - N, yy), u);
+    int8_t X2 = lerp7by8(grad8_2d(h[2], xx, yy - N), grad8_2d(h[3], xx - N, yy - N), u);
+
+    return lerp7by8(X1, X2, v);
+}
+
 int16_t inoise16_3d_raw(uint32_t x, uint32_t y, uint32_t z)
 {
     // Find the unit cube containing the point
@@ -239,23 +296,12 @@ int16_t inoise16_3d_raw(uint32_t x, uint32_t y, uint32_t z)
     int16_t xx = (u >> 1) & 0x7FFF;
     int16_t yy = (v >> 1) & 0x7FFF;
     int16_t zz = (w >> 1) & 0x7FFF;
-    uint16_t N = 0x8000L;
-
     u = ease16InOutQuad(u);
     v = ease16InOutQuad(v);
     w = ease16InOutQuad(w);
 
-    // skip the log fade adjustment for the moment, otherwise here we would
-    // adjust fade values for u,v,w
-    int16_t X1 = lerp15by16(grad16_3d(P(AA), xx, yy, zz), grad16_3d(P(BA), xx - N, yy, zz), u);
-    int16_t X2 = lerp15by16(grad16_3d(P(AB), xx, yy - N, zz), grad16_3d(P(BB), xx - N, yy - N, zz), u);
-    int16_t X3 = lerp15by16(grad16_3d(P(AA + 1), xx, yy, zz - N), grad16_3d(P(BA + 1), xx - N, yy, zz - N), u);
-    int16_t X4 = lerp15by16(grad16_3d(P(AB + 1), xx, yy - N, zz - N), grad16_3d(P(BB + 1), xx - N, yy - N, zz - N), u);
-
-    int16_t Y1 = lerp15by16(X1, X2, v);
-    int16_t Y2 = lerp15by16(X3, X4, v);
-
-    return lerp15by16(Y1, Y2, w);
+    const uint8_t h[8] = { P(AA), P(BA), P(AB), P(BB), P(AA + 1), P(BA + 1), P(AB + 1), P(BB + 1) };
+    return noise16_3d_cell(h, xx, yy, zz, u, v, w);
 }
 
 uint16_t inoise16_3d(uint32_t x, uint32_t y, uint32_t z)
@@ -288,15 +334,11 @@ int16_t inoise16_2d_raw(uint32_t x, uint32_t y)
     // Get a signed version of the above for the grad function
     int16_t xx = (u >> 1) & 0x7FFF;
     int16_t yy = (v >> 1) & 0x7FFF;
-    uint16_t N = 0x8000L;
-
     u = ease16InOutQuad(u);
     v = ease16InOutQuad(v);
 
-    int16_t X1 = lerp15by16(grad16_2d(P(AA), xx, yy), grad16_2d(P(BA), xx - N, yy), u);
-    int16_t X2 = lerp15by16(grad16_2d(P(AB), xx, yy - N), grad16_2d(P(BB), xx - N, yy - N), u);
-
-    return lerp15by16(X1,X2,v);
+    const uint8_t h[4] = { P(AA), P(BA), P(AB), P(BB) };
+    return noise16_2d_cell(h, xx, yy, u, v);
 }
 
 uint16_t inoise16_2d(uint32_t x, uint32_t y)
@@ -360,21 +402,12 @@ int8_t inoise8_3d_raw(uint16_t x, uint16_t y, uint16_t z)
     int8_t xx = ((uint8_t)x >> 1) & 0x7F;
     int8_t yy = ((uint8_t)y >> 1) & 0x7F;
     int8_t zz = ((uint8_t)z >> 1) & 0x7F;
-    uint8_t N = 0x80;
-
     u = ease8InOutQuad(u);
     v = ease8InOutQuad(v);
     w = ease8InOutQuad(w);
 
-    int8_t X1 = lerp7by8(grad8_3d(P(AA), xx, yy, zz), grad8_3d(P(BA), xx - N, yy, zz), u);
-    int8_t X2 = lerp7by8(grad8_3d(P(AB), xx, yy - N, zz), grad8_3d(P(BB), xx - N, yy - N, zz), u);
-    int8_t X3 = lerp7by8(grad8_3d(P(AA + 1), xx, yy, zz - N), grad8_3d(P(BA + 1), xx - N, yy, zz - N), u);
-    int8_t X4 = lerp7by8(grad8_3d(P(AB + 1), xx, yy - N, zz - N), grad8_3d(P(BB + 1), xx - N, yy - N, zz - N), u);
-
-    int8_t Y1 = lerp7by8(X1, X2, v);
-    int8_t Y2 = lerp7by8(X3, X4, v);
-
-    return lerp7by8(Y1, Y2, w);
+    const uint8_t h[8] = { P(AA), P(BA), P(AB), P(BB), P(AA + 1), P(BA + 1), P(AB + 1), P(BB + 1) };
+    return noise8_3d_cell(h, xx, yy, zz, u, v, w);
 }
 
 uint8_t inoise8_3d(uint16_t x, uint16_t y, uint16_t z)
@@ -405,15 +438,11 @@ int8_t inoise8_2d_raw(uint16_t x, uint16_t y)
     // Get a signed version of the above for the grad function
     int8_t xx = ((uint8_t)x >> 1) & 0x7F;
     int8_t yy = ((uint8_t)y >> 1) & 0x7F;
-    uint8_t N = 0x80;
-
     u = ease8InOutQuad(u);
     v = ease8InOutQuad(v);
 
-    int8_t X1 = lerp7by8(grad8_2d(P(AA), xx, yy), grad8_2d(P(BA), xx - N, yy), u);
-    int8_t X2 = lerp7by8(grad8_2d(P(AB), xx, yy - N), grad8_2d(P(BB), xx - N, yy - N), u);
-
-    return lerp7by8(X1, X2, v);
+    const uint8_t h[4] = { P(AA), P(BA), P(AB), P(BB) };
+    return noise8_2d_cell(h, xx, yy, u, v);
 }
 
 uint8_t inoise8_2d(uint16_t x, uint16_t y)
@@ -454,14 +483,187 @@ uint8_t inoise8_1d(uint16_t x)
     return qadd8(n, n);            //  0..255
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Row kernels: walk along X, recalculating lattice hashes only when X crosses
+// a cell boundary. Y, Z coordinates and their fade values are constant along
+// the row.
+
+static void noise8_3d_row(uint8_t *out, size_t num, uint16_t x, uint16_t dx, uint16_t y, uint16_t z)
+{
+    uint8_t Y = y >> 8;
+    uint8_t Z = z >> 8;
+    int8_t yy = ((uint8_t)y >> 1) & 0x7F;
+    int8_t zz = ((uint8_t)z >> 1) & 0x7F;
+    uint8_t v = ease8InOutQuad((uint8_t)y);
+    uint8_t w = ease8InOutQuad((uint8_t)z);
+
+    int cell = -1;
+    uint8_t h[8] = { 0 };
+    for (size_t i = 0; i < num; i++, x += dx)
+    {
+        uint8_t X = x >> 8;
+        if (X != cell)
+        {
+            uint8_t A  = P(X) + Y;
+            uint8_t AA = P(A) + Z;
+            uint8_t AB = P(A + 1) + Z;
+            uint8_t B  = P(X + 1) + Y;
+            uint8_t BA = P(B) + Z;
+            uint8_t BB = P(B + 1) + Z;
+            h[0] = P(AA);
+            h[1] = P(BA);
+            h[2] = P(AB);
+            h[3] = P(BB);
+            h[4] = P(AA + 1);
+            h[5] = P(BA + 1);
+            h[6] = P(AB + 1);
+            h[7] = P(BB + 1);
+            cell = X;
+        }
+        int8_t xx = ((uint8_t)x >> 1) & 0x7F;
+        int8_t n = noise8_3d_cell(h, xx, yy, zz, ease8InOutQuad((uint8_t)x), v, w);
+        n += 64;
+        out[i] = qadd8(n, n);
+    }
+}
+
+static void noise8_2d_row(uint8_t *out, size_t num, uint16_t x, uint16_t dx, uint16_t y)
+{
+    uint8_t Y = y >> 8;
+    int8_t yy = ((uint8_t)y >> 1) & 0x7F;
+    uint8_t v = ease8InOutQuad((uint8_t)y);
+
+    int cell = -1;
+    uint8_t h[4] = { 0 };
+    for (size_t i = 0; i < num; i++, x += dx)
+    {
+        uint8_t X = x >> 8;
+        if (X != cell)
+        {
+            uint8_t A  = P(X) + Y;
+            uint8_t B  = P(X + 1) + Y;
+            h[0] = P(P(A));
+            h[1] = P(P(B));
+            h[2] = P(P(A + 1));
+            h[3] = P(P(B + 1));
+            cell = X;
+        }
+        int8_t xx = ((uint8_t)x >> 1) & 0x7F;
+        int8_t n = noise8_2d_cell(h, xx, yy, ease8InOutQuad((uint8_t)x), v);
+        n += 64;
+        out[i] = qadd8(n, n);
+    }
+}
+
+static void noise16_3d_row(uint16_t *out, size_t num, uint32_t x, uint32_t dx, uint32_t y, uint32_t z)
+{
+    uint8_t Y = (y >> 16) & 0xFF;
+    uint8_t Z = (z >> 16) & 0xFF;
+    int16_t yy = ((y & 0xFFFF) >> 1) & 0x7FFF;
+    int16_t zz = ((z & 0xFFFF) >> 1) & 0x7FFF;
+    uint16_t v = ease16InOutQuad(y & 0xFFFF);
+    uint16_t w = ease16InOutQuad(z & 0xFFFF);
+
+    int cell = -1;
+    uint8_t h[8] = { 0 };
+    for (size_t i = 0; i < num; i++, x += dx)
+    {
+        uint8_t X = (x >> 16) & 0xFF;
+        if (X != cell)
+        {
+            uint8_t A  = P(X) + Y;
+            uint8_t AA = P(A) + Z;
+            uint8_t AB = P(A + 1) + Z;
+            uint8_t B  = P(X + 1) + Y;
+            uint8_t BA = P(B) + Z;
+            uint8_t BB = P(B + 1) + Z;
+            h[0] = P(AA);
+            h[1] = P(BA);
+            h[2] = P(AB);
+            h[3] = P(BB);
+            h[4] = P(AA + 1);
+            h[5] = P(BA + 1);
+            h[6] = P(AB + 1);
+            h[7] = P(BB + 1);
+            cell = X;
+        }
+        int16_t xx = ((x & 0xFFFF) >> 1) & 0x7FFF;
+        int32_t ans = noise16_3d_cell(h, xx, yy, zz, ease16InOutQuad(x & 0xFFFF), v, w);
+        ans = ans + 19052L;
+        uint32_t pan = ans;
+        pan *= 440L;
+        out[i] = pan >> 8;
+    }
+}
+
+static void noise16_2d_row(uint16_t *out, size_t num, uint32_t x, uint32_t dx, uint32_t y)
+{
+    uint8_t Y = y >> 16;
+    int16_t yy = ((y & 0xFFFF) >> 1) & 0x7FFF;
+    uint16_t v = ease16InOutQuad(y & 0xFFFF);
+
+    int cell = -1;
+    uint8_t h[4] = { 0 };
+    for (size_t i = 0; i < num; i++, x += dx)
+    {
+        uint8_t X = x >> 16;
+        if (X != cell)
+        {
+            uint8_t A  = P(X) + Y;
+            uint8_t B  = P(X + 1) + Y;
+            h[0] = P(P(A));
+            h[1] = P(P(B));
+            h[2] = P(P(A + 1));
+            h[3] = P(P(B + 1));
+            cell = X;
+        }
+        int16_t xx = ((x & 0xFFFF) >> 1) & 0x7FFF;
+        int32_t ans = noise16_2d_cell(h, xx, yy, ease16InOutQuad(x & 0xFFFF), v);
+        ans = ans + 17308L;
+        uint32_t pan = ans;
+        pan *= 484L;
+        out[i] = pan >> 8;
+    }
+}
+
+void fill_noise8_2d(uint8_t *data, size_t width, size_t height, size_t stride,
+                    uint16_t x, uint16_t y, uint16_t scale_x, uint16_t scale_y)
+{
+    for (size_t row = 0; row < height; row++, y += scale_y)
+        noise8_2d_row(data + row * stride, width, x, scale_x, y);
+}
+
+void fill_noise8_3d(uint8_t *data, size_t width, size_t height, size_t stride,
+                    uint16_t x, uint16_t y, uint16_t z, uint16_t scale_x, uint16_t scale_y)
+{
+    for (size_t row = 0; row < height; row++, y += scale_y)
+        noise8_3d_row(data + row * stride, width, x, scale_x, y, z);
+}
+
+void fill_noise16_2d(uint16_t *data, size_t width, size_t height, size_t stride,
+                     uint32_t x, uint32_t y, uint32_t scale_x, uint32_t scale_y)
+{
+    for (size_t row = 0; row < height; row++, y += scale_y)
+        noise16_2d_row(data + row * stride, width, x, scale_x, y);
+}
+
+void fill_noise16_3d(uint16_t *data, size_t width, size_t height, size_t stride,
+                     uint32_t x, uint32_t y, uint32_t z, uint32_t scale_x, uint32_t scale_y)
+{
+    for (size_t row = 0; row < height; row++, y += scale_y)
+        noise16_3d_row(data + row * stride, width, x, scale_x, y, z);
+}
+
 void fill_raw_noise8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint16_t x, int scale, uint16_t time)
 {
+    uint8_t octave[UINT8_MAX];
     uint32_t _xx = x;
     uint32_t scx = scale;
     for (int o = 0; o < octaves; ++o)
     {
-        for (int i = 0, xx = _xx; i < num_points; ++i, xx += scx)
-            pData[i] = qadd8(pData[i], inoise8_2d(xx, time) >> o);
+        noise8_2d_row(octave, num_points, _xx, scx, time);
+        for (int i = 0; i < num_points; ++i)
+            pData[i] = qadd8(pData[i], octave[i] >> o);
 
         _xx <<= 1;
         scx <<= 1;
@@ -470,13 +672,15 @@ void fill_raw_noise8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint16
 
 void fill_raw_noise16into8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint32_t x, int scale, uint32_t time)
 {
+    uint16_t octave[UINT8_MAX];
     uint32_t _xx = x;
     uint32_t scx = scale;
     for (int o = 0; o < octaves; ++o)
     {
-        for (int i = 0, xx = _xx; i < num_points; ++i, xx += scx)
+        noise16_2d_row(octave, num_points, _xx, scx, time);
+        for (int i = 0; i < num_points; ++i)
         {
-            uint32_t accum = (inoise16_2d(xx, time)) >> o;
+            uint32_t accum = octave[i] >> o;
             accum += (pData[i] << 8);
             if (accum > 65535)
             {
@@ -87,6 +87,32 @@ int8_t inoise8_1d_raw(uint16_t x);
 void fill_raw_noise8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint16_t x, int scale, uint16_t time);
 void fill_raw_noise16into8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint32_t x, int scale, uint32_t time);
 ///@}
+
+///@name noise field fill functions
+///@{
+/// Fill a row-major 2d array with noise values, `data[row * stride + col]` gets the same value as
+/// inoise*(x + col * scale_x, y + row * scale_y[, z]). Points are calculated row by row, hashes of
+/// lattice cells and fade values of y and z are reused by neighboring points. This saves the hashing
+/// and call overhead of the single point functions (about 10% per frame in devtools/bench), the
+/// gradient interpolation of every point still dominates.
+///@param data the array of data to write into
+///@param width the number of points in a row
+///@param height the number of rows
+///@param stride the distance between rows in array elements, usually width
+///@param x the x position of the first point in the noise field
+///@param y the y position of the first point in the noise field
+///@param z the z position in the noise field for 3d functions
+///@param scale_x the scale (distance) between x points
+///@param scale_y the scale (distance) between y points
+void fill_noise8_2d(uint8_t *data, size_t width, size_t height, size_t stride,
+                    uint16_t x, uint16_t y, uint16_t scale_x, uint16_t scale_y);
+void fill_noise8_3d(uint8_t *data, size_t width, size_t height, size_t stride,
+                    uint16_t x, uint16_t y, uint16_t z, uint16_t scale_x, uint16_t scale_y);
+void fill_noise16_2d(uint16_t *data, size_t width, size_t height, size_t stride,
+                     uint32_t x, uint32_t y, uint32_t scale_x, uint32_t scale_y);
+void fill_noise16_3d(uint16_t *data, size_t width, size_t height, size_t stride,
+                     uint32_t x, uint32_t y, uint32_t z, uint32_t scale_x, uint32_t scale_y);
+///@}
 ///@}
 
 #endif /* __NOISE_H__ */
@@ -56,6 +56,10 @@
 #include <esp_idf_lib_helpers.h>
 #include "onewire.h"
 
+#if HELPER_TARGET_IS_ESP32
+#include "onewire_rmt.h"
+#endif
+
 #define ONEWIRE_SELECT_ROM 0x55
 #define ONEWIRE_SKIP_ROM   0xcc
 #define ONEWIRE_SEARCH     0xf0
@@ -107,6 +111,11 @@ static void setup_pin(gpio_num_t pin, bool open_drain)
 //
 bool onewire_reset(gpio_num_t pin)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+        return onewire_rmt_reset(pin);
+#endif
+
     setup_pin(pin, true);
 
     gpio_set_level(pin, 1);
@@ -132,6 +141,14 @@ bool onewire_reset(gpio_num_t pin)
 
 static bool _onewire_write_bit(gpio_num_t pin, bool v)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+    {
+        uint8_t b = v;
+        return onewire_rmt_write_bits(pin, &b, 1);
+    }
+#endif
+
     if (!_onewire_wait_for_bus(pin, 10))
         return false;
     PORT_ENTER_CRITICAL;
@@ -156,6 +173,14 @@ static bool _onewire_write_bit(gpio_num_t pin, bool v)
 
 static int _onewire_read_bit(gpio_num_t pin)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+    {
+        uint8_t b;
+        return onewire_rmt_read_bits(pin, &b, 1) ? b : -1;
+    }
+#endif
+
     if (!_onewire_wait_for_bus(pin, 10))
         return -1;
 
@@ -178,6 +203,11 @@ static int _onewire_read_bit(gpio_num_t pin)
 //
 bool onewire_write(gpio_num_t pin, uint8_t v)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+        return onewire_rmt_write_bits(pin, &v, 8);
+#endif
+
     for (uint8_t bitMask = 0x01; bitMask; bitMask <<= 1)
         if (!_onewire_write_bit(pin, (bitMask & v)))
             return false;
@@ -187,6 +217,11 @@ bool onewire_write(gpio_num_t pin, uint8_t v)
 
 bool onewire_write_bytes(gpio_num_t pin, const uint8_t *buf, size_t count)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+        return onewire_rmt_write_bits(pin, buf, count * 8);
+#endif
+
     for (size_t i = 0; i < count; i++)
         if (!onewire_write(pin, buf[i]))
             return false;
@@ -198,6 +233,14 @@ bool onewire_write_bytes(gpio_num_t pin, const uint8_t *buf, size_t count)
 //
 int onewire_read(gpio_num_t pin)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+    {
+        uint8_t b;
+        return onewire_rmt_read_bits(pin, &b, 8) ? b : -1;
+    }
+#endif
+
     int r = 0;
 
     for (uint8_t bitMask = 0x01; bitMask; bitMask <<= 1)
@@ -213,6 +256,11 @@ int onewire_read(gpio_num_t pin)
 
 bool onewire_read_bytes(gpio_num_t pin, uint8_t *buf, size_t count)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+        return onewire_rmt_read_bits(pin, buf, count * 8);
+#endif
+
     size_t i;
     int b;
 
@@ -250,6 +298,14 @@ bool onewire_skip_rom(gpio_num_t pin)
 
 bool onewire_power(gpio_num_t pin)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+    {
+        onewire_rmt_power(pin, true);
+        return true;
+    }
+#endif
+
     // Make sure the bus is not being held low before driving it high, or we
     // may end up shorting ourselves out.
     if (!_onewire_wait_for_bus(pin, 10))
@@ -263,6 +319,14 @@ bool onewire_power(gpio_num_t pin)
 
 void onewire_depower(gpio_num_t pin)
 {
+#if HELPER_TARGET_IS_ESP32
+    if (onewire_rmt_attached(pin))
+    {
+        onewire_rmt_power(pin, false);
+        return;
+    }
+#endif
+
     setup_pin(pin, true);
 }
 
@@ -44,6 +44,9 @@
  * (https://www.pjrc.com/teensy/td_libs_OneWire.html), by Jim Studt, Paul
  * Stoffregen, and a host of others.
  *
+ * On ESP32 targets a bus can use the RMT peripheral instead of bit-banging,
+ * see ::onewire_rmt_attach() in onewire_rmt.h.
+ *
  * The original code is licensed under the MIT license.  The CRC code was taken
  * (at least partially) from Dallas Semiconductor sample code, which was licensed
  * under an MIT license with an additional clause (prohibiting inappropriate use
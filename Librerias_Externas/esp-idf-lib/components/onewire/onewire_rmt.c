@@ -0,0 +1,298 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file onewire_rmt.c
+ *
+ * RMT transport for 1-Wire buses
+ */
+#include <esp_idf_lib_helpers.h>
+
+#if HELPER_TARGET_IS_ESP32
+
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+#include <hal/gpio_ll.h>
+#include <esp_log.h>
+#include "onewire_rmt.h"
+#include "onewire_rmt_codec.h"
+
+#define RMT_CLK_DIV         80   // 1 us per tick with 80 MHz APB clock
+#define RMT_RX_FILTER_TICKS 30   // Glitch filter, APB clock ticks
+#define RMT_RX_IDLE_US      (ONEWIRE_RMT_MAX_HIGH_US + 30)
+// Reset low has no edges, reception must not end before the presence pulse
+#define RMT_RX_IDLE_RESET_US (ONEWIRE_RMT_RESET_LOW_US + ONEWIRE_RMT_PRESENCE_MAX_US + 30)
+#define RMT_RX_BUF_SIZE     512
+#define RMT_RX_TIMEOUT_MS   10
+
+// One memory block holds 64 items, one is the end marker
+#define MAX_BITS 56
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static const char *TAG = "onewire_rmt";
+
+typedef struct
+{
+    bool used;
+    gpio_num_t pin;
+    rmt_channel_t tx;
+    rmt_channel_t rx;
+    RingbufHandle_t rb;
+} rmt_bus_t;
+
+static rmt_bus_t buses[ONEWIRE_RMT_MAX_BUSES] = { 0 };
+
+static const uint8_t ones[MAX_BITS / 8] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+static rmt_bus_t *find_bus(gpio_num_t pin)
+{
+    for (size_t i = 0; i < ONEWIRE_RMT_MAX_BUSES; i++)
+        if (buses[i].used && buses[i].pin == pin)
+            return &buses[i];
+
+    return NULL;
+}
+
+static esp_err_t set_pin(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t pin)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
+    return rmt_set_gpio(channel, mode, pin, false);
+#else
+    return rmt_set_pin(channel, mode, pin);
+#endif
+}
+
+/*
+ * Send items (the buffer must have room for the end marker). If rx is not NULL,
+ * bus activity is recorded until the bus stays idle for rx_idle_us, and returned,
+ * it must be freed with vRingbufferReturnItem().
+ */
+static bool transfer(rmt_bus_t *bus, rmt_item32_t *items, size_t count, uint32_t **rx, size_t *rx_count,
+        uint16_t rx_idle_us)
+{
+    items[count++].val = 0;
+
+    if (rx)
+    {
+        // Drop anything left from a failed transaction
+        size_t size;
+        void *stale;
+        while ((stale = xRingbufferReceive(bus->rb, &size, 0)) != NULL)
+            vRingbufferReturnItem(bus->rb, stale);
+
+        if (rmt_set_rx_idle_thresh(bus->rx, rx_idle_us) != ESP_OK)
+            return false;
+        rmt_rx_start(bus->rx, true);
+    }
+
+    if (rmt_write_items(bus->tx, items, count, true) != ESP_OK)
+    {
+        if (rx)
+            rmt_rx_stop(bus->rx);
+        return false;
+    }
+
+    if (!rx)
+        return true;
+
+    size_t size = 0;
+    *rx = xRingbufferReceive(bus->rb, &size, pdMS_TO_TICKS(RMT_RX_TIMEOUT_MS));
+    rmt_rx_stop(bus->rx);
+    *rx_count = size / sizeof(rmt_item32_t);
+
+    return *rx != NULL;
+}
+
+esp_err_t onewire_rmt_attach(gpio_num_t pin, rmt_channel_t tx_channel, rmt_channel_t rx_channel)
+{
+    CHECK_ARG(GPIO_IS_VALID_OUTPUT_GPIO(pin) && tx_channel != rx_channel);
+
+    if (find_bus(pin))
+        return ESP_ERR_INVALID_STATE;
+
+    rmt_bus_t *bus = NULL;
+    for (size_t i = 0; i < ONEWIRE_RMT_MAX_BUSES && !bus; i++)
+        if (!buses[i].used)
+            bus = &buses[i];
+    if (!bus)
+    {
+        ESP_LOGE(TAG, "Too many RMT buses");
+        return ESP_ERR_NO_MEM;
+    }
+
+    rmt_config_t tx_config = {
+        .rmt_mode = RMT_MODE_TX,
+        .channel = tx_channel,
+        .gpio_num = pin,
+        .clk_div = RMT_CLK_DIV,
+        .mem_block_num = 1,
+        .tx_config = {
+            .idle_level = RMT_IDLE_LEVEL_HIGH,
+            .idle_output_en = true,
+        },
+    };
+    rmt_config_t rx_config = {
+        .rmt_mode = RMT_MODE_RX,
+        .channel = rx_channel,
+        .gpio_num = pin,
+        .clk_div = RMT_CLK_DIV,
+        .mem_block_num = 1,
+        .rx_config = {
+            .filter_en = true,
+            .filter_ticks_thresh = RMT_RX_FILTER_TICKS,
+            .idle_threshold = RMT_RX_IDLE_US,
+        },
+    };
+
+    CHECK(rmt_config(&tx_config));
+    CHECK(rmt_driver_install(tx_channel, 0, 0));
+
+    esp_err_t res;
+    if ((res = rmt_config(&rx_config)) != ESP_OK
+            || (res = rmt_driver_install(rx_channel, RMT_RX_BUF_SIZE, 0)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Could not install RX channel %d: %d", rx_channel, res);
+        rmt_driver_uninstall(tx_channel);
+        return res;
+    }
+    rmt_get_ringbuf_handle(rx_channel, &bus->rb);
+
+    // Both channels share the open-drain pin. TX output must be connected
+    // last, connecting the RX input disables the pin output.
+    set_pin(rx_channel, RMT_MODE_RX, pin);
+    set_pin(tx_channel, RMT_MODE_TX, pin);
+    gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
+    gpio_ll_input_enable(&GPIO, pin);
+    gpio_ll_od_enable(&GPIO, pin);
+
+    bus->pin = pin;
+    bus->tx = tx_channel;
+    bus->rx = rx_channel;
+    bus->used = true;
+
+    return ESP_OK;
+}
+
+esp_err_t onewire_rmt_detach(gpio_num_t pin)
+{
+    rmt_bus_t *bus = find_bus(pin);
+    if (!bus)
+        return ESP_ERR_INVALID_ARG;
+
+    bus->used = false;
+    CHECK(rmt_driver_uninstall(bus->tx));
+    CHECK(rmt_driver_uninstall(bus->rx));
+
+    // Give the pin back to the GPIO matrix
+    gpio_reset_pin(pin);
+
+    return ESP_OK;
+}
+
+bool onewire_rmt_attached(gpio_num_t pin)
+{
+    return find_bus(pin) != NULL;
+}
+
+bool onewire_rmt_reset(gpio_num_t pin)
+{
+    rmt_bus_t *bus = find_bus(pin);
+    if (!bus)
+        return false;
+
+    rmt_item32_t items[2];
+    uint32_t *rx;
+    size_t rx_count;
+
+    size_t count = onewire_rmt_encode_reset(&items[0].val);
+    if (!transfer(bus, items, count, &rx, &rx_count, RMT_RX_IDLE_RESET_US))
+        return false;
+
+    bool presence = onewire_rmt_decode_reset(rx, rx_count);
+    vRingbufferReturnItem(bus->rb, rx);
+
+    return presence;
+}
+
+bool onewire_rmt_write_bits(gpio_num_t pin, const uint8_t *data, size_t bits)
+{
+    rmt_bus_t *bus = find_bus(pin);
+    if (!bus)
+        return false;
+
+    rmt_item32_t items[MAX_BITS + 1];
+
+    for (size_t done = 0; done < bits; done += MAX_BITS)
+    {
+        size_t chunk = bits - done < MAX_BITS ? bits - done : MAX_BITS;
+        size_t count = onewire_rmt_encode_bits(&items[0].val, data + done / 8, chunk);
+        if (!transfer(bus, items, count, NULL, NULL, 0))
+            return false;
+    }
+
+    return true;
+}
+
+bool onewire_rmt_read_bits(gpio_num_t pin, uint8_t *data, size_t bits)
+{
+    rmt_bus_t *bus = find_bus(pin);
+    if (!bus)
+        return false;
+
+    rmt_item32_t items[MAX_BITS + 1];
+
+    for (size_t done = 0; done < bits; done += MAX_BITS)
+    {
+        size_t chunk = bits - done < MAX_BITS ? bits - done : MAX_BITS;
+        uint32_t *rx;
+        size_t rx_count;
+
+        // Read slots are write 1 slots, devices pull the bus low to send a 0
+        size_t count = onewire_rmt_encode_bits(&items[0].val, ones, chunk);
+        if (!transfer(bus, items, count, &rx, &rx_count, RMT_RX_IDLE_US))
+            return false;
+
+        bool ok = onewire_rmt_decode_bits(rx, rx_count, data + done / 8, chunk);
+        vRingbufferReturnItem(bus->rb, rx);
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+void onewire_rmt_power(gpio_num_t pin, bool power)
+{
+    if (!find_bus(pin))
+        return;
+
+    // TX idle level is high, so disabling open-drain drives the bus high
+    if (power)
+        gpio_ll_od_disable(&GPIO, pin);
+    else
+        gpio_ll_od_enable(&GPIO, pin);
+}
+
+#endif /* HELPER_TARGET_IS_ESP32 */
@@ -0,0 +1,133 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file onewire_rmt.h
+ * @defgroup onewire_rmt onewire_rmt
+ * @{
+ *
+ * @brief RMT transport for 1-Wire buses (ESP32 family only).
+ *
+ * Once a bus pin is attached to a pair of RMT channels, all the `onewire_*`
+ * functions called with that pin use the RMT peripheral instead of
+ * bit-banging. Time slots are generated by the RMT TX channel and the bus
+ * is sampled by the RX channel, so the CPU is free and interrupts are not
+ * masked during transactions. Calling tasks block until each transaction is
+ * completed.
+ *
+ * Strong pullup (::onewire_power()) is applied when the TX channel reports
+ * the end of transmission, usually some tens of microseconds after the last
+ * slot. Parasite-powered devices needing it within 10 us should use the
+ * bit-banging transport.
+ */
+#ifndef __ONEWIRE_RMT_H__
+#define __ONEWIRE_RMT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <esp_err.h>
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of buses using the RMT transport
+ */
+#define ONEWIRE_RMT_MAX_BUSES 4
+
+/**
+ * @brief Use the RMT transport on a 1-Wire bus
+ *
+ * Installs the RMT driver on both channels and connects them to the bus pin,
+ * which is configured as open-drain with the internal pullup enabled.
+ *
+ * @param pin Bus pin
+ * @param tx_channel RMT channel used to generate time slots
+ * @param rx_channel RMT channel used to sample the bus
+ * @return ESP_OK on success
+ */
+esp_err_t onewire_rmt_attach(gpio_num_t pin, rmt_channel_t tx_channel, rmt_channel_t rx_channel);
+
+/**
+ * @brief Go back to the bit-banging transport on a 1-Wire bus
+ *
+ * Uninstalls the RMT driver from the channels of the bus.
+ *
+ * @param pin Bus pin
+ * @return ESP_OK on success
+ */
+esp_err_t onewire_rmt_detach(gpio_num_t pin);
+
+/**
+ * @brief Check if a 1-Wire bus uses the RMT transport
+ *
+ * @param pin Bus pin
+ * @return true if the bus is attached to RMT channels
+ */
+bool onewire_rmt_attached(gpio_num_t pin);
+
+/**
+ * @brief Reset the bus, see ::onewire_reset()
+ *
+ * @param pin Bus pin, attached to RMT channels
+ * @return true if a device asserted a presence pulse
+ */
+bool onewire_rmt_reset(gpio_num_t pin);
+
+/**
+ * @brief Write bits to the bus, LSB first
+ *
+ * @param pin Bus pin, attached to RMT channels
+ * @param data Bits to write
+ * @param bits Number of bits
+ * @return true on success
+ */
+bool onewire_rmt_write_bits(gpio_num_t pin, const uint8_t *data, size_t bits);
+
+/**
+ * @brief Read bits from the bus, LSB first
+ *
+ * @param pin Bus pin, attached to RMT channels
+ * @param[out] data Buffer for the bits read, (bits + 7) / 8 bytes
+ * @param bits Number of bits
+ * @return true on success
+ */
+bool onewire_rmt_read_bits(gpio_num_t pin, uint8_t *data, size_t bits);
+
+/**
+ * @brief Actively drive the bus high, or go back to open-drain
+ *
+ * @param pin Bus pin, attached to RMT channels
+ * @param power true to drive the bus high
+ */
+void onewire_rmt_power(gpio_num_t pin, bool power);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif  /* __ONEWIRE_RMT_H__ */
@@ -0,0 +1,121 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file onewire_rmt_codec.c
+ *
+ * Encoder and decoder of 1-Wire time slots as RMT items
+ */
+#include <string.h>
+#include "onewire_rmt_codec.h"
+
+/*
+ * Iterate over the pulses of a sequence of items, stopping at the end marker.
+ * Consecutive pulses of the same level are merged.
+ */
+typedef struct
+{
+    const uint32_t *items;
+    size_t count;
+    size_t pos;      // half-item index
+    bool level;
+    uint32_t duration;
+} pulse_iter_t;
+
+static bool next_pulse(pulse_iter_t *it)
+{
+    it->duration = 0;
+
+    while (it->pos < it->count * 2)
+    {
+        uint32_t item = it->items[it->pos / 2];
+        uint32_t duration = it->pos & 1 ? ONEWIRE_RMT_DURATION1(item) : ONEWIRE_RMT_DURATION0(item);
+        bool level = it->pos & 1 ? ONEWIRE_RMT_LEVEL1(item) : ONEWIRE_RMT_LEVEL0(item);
+
+        if (!duration)
+        {
+            // end marker
+            it->pos = it->count * 2;
+            break;
+        }
+        if (it->duration && level != it->level)
+            break;
+
+        it->level = level;
+        it->duration += duration;
+        it->pos++;
+    }
+
+    return it->duration != 0;
+}
+
+size_t onewire_rmt_encode_reset(uint32_t *items)
+{
+    items[0] = ONEWIRE_RMT_ITEM(ONEWIRE_RMT_RESET_LOW_US, 0, ONEWIRE_RMT_RESET_WAIT_US, 1);
+    return 1;
+}
+
+bool onewire_rmt_decode_reset(const uint32_t *items, size_t count)
+{
+    pulse_iter_t it = { .items = items, .count = count };
+
+    // First low pulse is the reset pulse itself
+    while (next_pulse(&it))
+        if (!it.level)
+            break;
+
+    while (next_pulse(&it))
+        if (!it.level && it.duration >= ONEWIRE_RMT_PRESENCE_MIN_US && it.duration <= ONEWIRE_RMT_PRESENCE_MAX_US)
+            return true;
+
+    return false;
+}
+
+size_t onewire_rmt_encode_bits(uint32_t *items, const uint8_t *data, size_t bits)
+{
+    for (size_t i = 0; i < bits; i++)
+    {
+        uint32_t low = (data[i / 8] >> (i % 8)) & 1 ? ONEWIRE_RMT_WRITE1_LOW_US : ONEWIRE_RMT_WRITE0_LOW_US;
+        items[i] = ONEWIRE_RMT_ITEM(low, 0, ONEWIRE_RMT_SLOT_US - low, 1);
+    }
+
+    return bits;
+}
+
+bool onewire_rmt_decode_bits(const uint32_t *items, size_t count, uint8_t *data, size_t bits)
+{
+    pulse_iter_t it = { .items = items, .count = count };
+    size_t i = 0;
+
+    memset(data, 0, (bits + 7) / 8);
+
+    while (i < bits && next_pulse(&it))
+    {
+        if (it.level)
+            continue;
+        if (it.duration <= ONEWIRE_RMT_READ_SAMPLE_US)
+            data[i / 8] |= 1 << (i % 8);
+        i++;
+    }
+
+    return i == bits;
+}
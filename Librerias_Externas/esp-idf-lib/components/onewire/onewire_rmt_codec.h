@@ -0,0 +1,117 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file onewire_rmt_codec.h
+ * @defgroup onewire_rmt_codec onewire_rmt_codec
+ * @{
+ *
+ * @brief Encoder and decoder of 1-Wire time slots as RMT items.
+ *
+ * Items are 32-bit words with the same layout as `rmt_item32_t`:
+ * duration0 (15 bits), level0 (1 bit), duration1 (15 bits), level1 (1 bit).
+ * Durations are in microseconds (RMT clocked at 1 MHz). A duration of 0
+ * marks the end of a sequence.
+ *
+ * This module has no ESP-IDF dependencies so it can be built and tested on
+ * a host.
+ */
+#ifndef __ONEWIRE_RMT_CODEC_H__
+#define __ONEWIRE_RMT_CODEC_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ONEWIRE_RMT_RESET_LOW_US     480 //!< Reset pulse
+#define ONEWIRE_RMT_RESET_WAIT_US    480 //!< Presence detect and recovery after reset
+#define ONEWIRE_RMT_PRESENCE_MIN_US  15  //!< Shortest low pulse accepted as presence
+#define ONEWIRE_RMT_PRESENCE_MAX_US  300 //!< Longest low pulse accepted as presence
+#define ONEWIRE_RMT_SLOT_US          70  //!< Time slot, including recovery
+#define ONEWIRE_RMT_WRITE1_LOW_US    6   //!< Low time of write 1 and read slots
+#define ONEWIRE_RMT_WRITE0_LOW_US    60  //!< Low time of write 0 slots
+#define ONEWIRE_RMT_READ_SAMPLE_US   15  //!< Low pulses longer than this are read as 0
+
+/**
+ * Longest high time inside a transaction. RX idle threshold must be greater.
+ */
+#define ONEWIRE_RMT_MAX_HIGH_US      (ONEWIRE_RMT_SLOT_US - ONEWIRE_RMT_WRITE1_LOW_US)
+
+#define ONEWIRE_RMT_ITEM(d0, l0, d1, l1) \
+    (((uint32_t)(d0) & 0x7fff) | ((uint32_t)!!(l0) << 15) | (((uint32_t)(d1) & 0x7fff) << 16) | ((uint32_t)!!(l1) << 31))
+
+#define ONEWIRE_RMT_DURATION0(item) ((item) & 0x7fff)
+#define ONEWIRE_RMT_LEVEL0(item)    (((item) >> 15) & 1)
+#define ONEWIRE_RMT_DURATION1(item) (((item) >> 16) & 0x7fff)
+#define ONEWIRE_RMT_LEVEL1(item)    ((item) >> 31)
+
+/**
+ * @brief Encode a reset pulse followed by the presence detect window
+ *
+ * @param[out] items Buffer for 1 item
+ * @return Number of items
+ */
+size_t onewire_rmt_encode_reset(uint32_t *items);
+
+/**
+ * @brief Decode the bus activity recorded during a reset
+ *
+ * @param items Received items
+ * @param count Number of items
+ * @return true if a device asserted a presence pulse
+ */
+bool onewire_rmt_decode_reset(const uint32_t *items, size_t count);
+
+/**
+ * @brief Encode write slots, LSB first
+ *
+ * Read slots are encoded as write 1 slots.
+ *
+ * @param[out] items Buffer for \p bits items
+ * @param data Bits to write
+ * @param bits Number of bits
+ * @return Number of items
+ */
+size_t onewire_rmt_encode_bits(uint32_t *items, const uint8_t *data, size_t bits);
+
+/**
+ * @brief Decode the bus activity recorded during read slots, LSB first
+ *
+ * @param items Received items
+ * @param count Number of items
+ * @param[out] data Buffer for the bits read, (bits + 7) / 8 bytes
+ * @param bits Number of bits
+ * @return true if all the slots were found
+ */
+bool onewire_rmt_decode_bits(const uint32_t *items, size_t count, uint8_t *data, size_t bits);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif  /* __ONEWIRE_RMT_CODEC_H__ */
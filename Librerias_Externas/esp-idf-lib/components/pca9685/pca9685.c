@@ -91,14 +91,28 @@ inline static uint32_t round_div(uint32_t x, uint32_t y)
     return (x + y / 2) / y;
 }
 
+/*
+ * Mode, address and prescaler registers only change when written, so they are
+ * served from the register cache. RESTART bit of MODE1 is read from the bus.
+ */
+static const i2c_dev_reg_desc_t regs[] = {
+    { .reg = REG_MODE1,      .size = 1 },
+    { .reg = REG_MODE2,      .size = 1 },
+    { .reg = REG_SUBADR1,    .size = 1 },
+    { .reg = REG_SUBADR2,    .size = 1 },
+    { .reg = REG_SUBADR3,    .size = 1 },
+    { .reg = REG_ALLCALLADR, .size = 1 },
+    { .reg = REG_PRE_SCALE,  .size = 1 },
+};
+
 inline static esp_err_t write_reg(i2c_dev_t *dev, uint8_t reg, uint8_t val)
 {
-    return i2c_dev_write_reg(dev, reg, &val, 1);
+    return i2c_dev_write_reg_cached(dev, reg, &val, 1);
 }
 
 inline static esp_err_t read_reg(i2c_dev_t *dev, uint8_t reg, uint8_t *val)
 {
-    return i2c_dev_read_reg(dev, reg, val, 1);
+    return i2c_dev_read_reg_cached(dev, reg, val, 1);
 }
 
 static esp_err_t update_reg(i2c_dev_t *dev, uint8_t reg, uint8_t mask, uint8_t val)
@@ -106,6 +120,9 @@ static esp_err_t update_reg(i2c_dev_t *dev, uint8_t reg, uint8_t mask, uint8_t v
     uint8_t v;
 
     CHECK(read_reg(dev, reg, &v));
+    // Writing 1 to RESTART bit restarts PWM channels, writing 0 has no effect
+    if (reg == REG_MODE1)
+        v &= ~MODE1_RESTART;
     v = (v & ~mask) | val;
     CHECK(write_reg(dev, reg, v));
 
@@ -135,6 +152,7 @@ esp_err_t pca9685_init_desc(i2c_dev_t *dev, uint8_t addr, i2c_port_t port, gpio_
 #if HELPER_TARGET_IS_ESP32
     dev->cfg.master.clk_speed = I2C_FREQ_HZ;
 #endif
+    CHECK(i2c_dev_cache_init(dev, regs, sizeof(regs) / sizeof(regs[0])));
 
     return i2c_dev_create_mutex(dev);
 }
@@ -143,6 +161,8 @@ esp_err_t pca9685_free_desc(i2c_dev_t *dev)
 {
     CHECK_ARG(dev);
 
+    i2c_dev_cache_free(dev);
+
     return i2c_dev_delete_mutex(dev);
 }
 
@@ -179,7 +199,8 @@ esp_err_t pca9685_restart(i2c_dev_t *dev)
 
     I2C_DEV_TAKE_MUTEX(dev);
     uint8_t mode;
-    I2C_DEV_CHECK(dev, read_reg(dev, REG_MODE1, &mode));
+    // RESTART bit is set by the device, so MODE1 is read from the bus
+    I2C_DEV_CHECK(dev, i2c_dev_read_reg(dev, REG_MODE1, &mode, 1));
     if (mode & MODE1_RESTART)
     {
         I2C_DEV_CHECK(dev, write_reg(dev, REG_MODE1, mode & ~MODE1_SLEEP));
@@ -0,0 +1,504 @@
+/*
+ * Host benchmark of lib8tion, color, noise, framebuffer and led_effects
+ *
+ * Every case does the work of one frame over a WxH matrix. Each case runs
+ * until the minimal measuring time elapses. The table reports time per frame
+ * and per pixel, and heap allocations made during setup and per frame.
+ * Only the LED output is stubbed: the render callback converts the frame to
+ * a GRB byte stream the way led_strip does, without sending it anywhere.
+ *
+ * usage: bench [-s WxH]... [-t ms] [-f filter] [-c]
+ *
+ *   -s WxH     matrix size, can be repeated (default 16x16, 32x8, 64x64)
+ *   -t ms      minimal measuring time per case (default 200)
+ *   -f filter  run only cases whose name contains filter
+ *   -c         print CSV instead of table
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <lib8tion.h>
+#include <color.h>
+#include <noise.h>
+#include <framebuffer.h>
+
+#include "effects/crazybees.h"
+#include "effects/dna.h"
+#include "effects/fire.h"
+#include "effects/matrix.h"
+#include "effects/noise.h"
+#include "effects/plasma_waves.h"
+#include "effects/rain.h"
+#include "effects/rainbow.h"
+#include "effects/rays.h"
+#include "effects/sparkles.h"
+#include "effects/waterfall.h"
+
+#define MAX_SIZES 16
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation counters, the binary is linked with -Wl,--wrap=malloc etc.
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static size_t alloc_count = 0;
+static size_t alloc_bytes = 0;
+
+void *__wrap_malloc(size_t size)
+{
+    alloc_count++;
+    alloc_bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size)
+{
+    alloc_count++;
+    alloc_bytes += num * size;
+    return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    alloc_count++;
+    alloc_bytes += size;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    __real_free(ptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark context
+
+typedef struct
+{
+    size_t width;
+    size_t height;
+    size_t num;         // width * height
+    framebuffer_t fb;
+    rgb_t *rgb;
+    hsv_t *hsv;
+    uint8_t *u8;
+    uint16_t *map;
+    uint8_t *strip;     // GRB output of the render callback
+    uint16_t frame;
+    esp_err_t (*effect_run)(framebuffer_t *fb);
+    esp_err_t (*effect_done)(framebuffer_t *fb);
+} bench_ctx_t;
+
+typedef struct
+{
+    const char *name;
+    esp_err_t (*setup)(bench_ctx_t *ctx);   // optional, allocations here are reported separately
+    void (*run)(bench_ctx_t *ctx);          // one frame of work
+} bench_case_t;
+
+static volatile uint32_t sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Serpentine matrix, the same mapping as render_frame() in the led_effects example
+static size_t xy_serpentine(void *ctx, size_t x, size_t y)
+{
+    bench_ctx_t *c = (bench_ctx_t *)ctx;
+    return y * c->width + (y % 2 ? c->width - x - 1 : x);
+}
+
+static size_t xy_linear(void *ctx, size_t x, size_t y)
+{
+    bench_ctx_t *c = (bench_ctx_t *)ctx;
+    return y * c->width + x;
+}
+
+// Stubbed LED output: convert frame to GRB like led_strip_set_pixel() does
+static esp_err_t render_sink(framebuffer_t *fb, void *arg)
+{
+    bench_ctx_t *c = (bench_ctx_t *)arg;
+
+    for (size_t y = 0; y < fb->height; y++)
+        for (size_t x = 0; x < fb->width; x++)
+        {
+            rgb_t color = fb->data[FB_OFFSET(fb, x, y)];
+            uint8_t *p = c->strip + xy_serpentine(c, x, y) * 3;
+            p[0] = color.g;
+            p[1] = color.r;
+            p[2] = color.b;
+        }
+    sink += c->strip[0];
+
+    return ESP_OK;
+}
+
+static void fill_random(bench_ctx_t *c)
+{
+    random16_set_seed(1337);
+    for (size_t i = 0; i < c->num; i++)
+    {
+        c->rgb[i] = rgb_from_values(random8(), random8(), random8());
+        c->hsv[i] = hsv_from_values(random8(), random8(), random8());
+        c->u8[i] = random8();
+    }
+    memcpy(c->fb.data, c->rgb, c->num * sizeof(rgb_t));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Primitives
+
+static void run_scale8(bench_ctx_t *c)
+{
+    uint8_t *p = (uint8_t *)c->rgb;
+    for (size_t i = 0; i < c->num * 3; i++)
+        p[i] = scale8(p[i], 250) + 3;
+}
+
+static void run_scale8_video(bench_ctx_t *c)
+{
+    uint8_t *p = (uint8_t *)c->rgb;
+    for (size_t i = 0; i < c->num * 3; i++)
+        p[i] = scale8_video(p[i], 250) + 3;
+}
+
+static void run_hsv2rgb_rainbow(bench_ctx_t *c)
+{
+    for (size_t i = 0; i < c->num; i++)
+        c->rgb[i] = hsv2rgb_rainbow(c->hsv[i]);
+}
+
+static void run_hsv2rgb_spectrum(bench_ctx_t *c)
+{
+    for (size_t i = 0; i < c->num; i++)
+        c->rgb[i] = hsv2rgb_spectrum(c->hsv[i]);
+}
+
+static void run_rgb2hsv_approximate(bench_ctx_t *c)
+{
+    for (size_t i = 0; i < c->num; i++)
+        c->hsv[i] = rgb2hsv_approximate(c->rgb[i]);
+}
+
+static void run_hsv2rgb_rainbow_array(bench_ctx_t *c)
+{
+    hsv2rgb_rainbow_array(c->rgb, c->hsv, c->num);
+}
+
+static void run_hsv2rgb_spectrum_array(bench_ctx_t *c)
+{
+    hsv2rgb_spectrum_array(c->rgb, c->hsv, c->num);
+}
+
+static void run_rgb2hsv_approximate_array(bench_ctx_t *c)
+{
+    rgb2hsv_approximate_array(c->hsv, c->rgb, c->num);
+}
+
+static void run_blur2d(bench_ctx_t *c)
+{
+    blur2d(c->rgb, c->width, c->height, 64, xy_serpentine, c);
+}
+
+static void run_blur2d_linear(bench_ctx_t *c)
+{
+    blur2d_linear(c->rgb, c->width, c->height, 64);
+}
+
+static esp_err_t setup_map(bench_ctx_t *c)
+{
+    xy_map_fill(c->map, c->width, c->height, xy_serpentine, c);
+    return ESP_OK;
+}
+
+static void run_blur2d_map(bench_ctx_t *c)
+{
+    blur2d_map(c->rgb, c->width, c->height, 64, c->map);
+}
+
+static void run_rgb_fade_array(bench_ctx_t *c)
+{
+    rgb_fade_array(c->rgb, c->num, 250);
+}
+
+static void run_inoise8_3d(bench_ctx_t *c)
+{
+    c->frame++;
+    for (size_t y = 0; y < c->height; y++)
+        for (size_t x = 0; x < c->width; x++)
+            c->u8[xy_linear(c, x, y)] = inoise8_3d(x * 30, y * 30, c->frame * 8);
+}
+
+static void run_fill_noise8_3d(bench_ctx_t *c)
+{
+    c->frame++;
+    fill_noise8_3d(c->u8, c->width, c->height, c->width, 0, 0, c->frame * 8, 30, 30);
+}
+
+static void run_fb_set_pixel_hsv(bench_ctx_t *c)
+{
+    for (size_t y = 0; y < c->height; y++)
+        for (size_t x = 0; x < c->width; x++)
+            fb_set_pixel_hsv(&c->fb, x, y, c->hsv[xy_linear(c, x, y)]);
+}
+
+static void run_fb_fade(bench_ctx_t *c)
+{
+    fb_fade(&c->fb, 250);
+}
+
+static void run_fb_blur2d(bench_ctx_t *c)
+{
+    fb_blur2d(&c->fb, 64);
+}
+
+static void run_fb_render(bench_ctx_t *c)
+{
+    fb_mark_dirty(&c->fb, 0, 0, c->width, c->height);
+    fb_render(&c->fb, c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Effects, parameters are fixed midpoints of the ranges used by the example
+
+#define EFFECT_SETUP(NAME, INIT) \
+    static esp_err_t setup_##NAME(bench_ctx_t *c) \
+    { \
+        c->effect_run = led_effect_##NAME##_run; \
+        c->effect_done = led_effect_##NAME##_done; \
+        return INIT; \
+    }
+
+EFFECT_SETUP(dna, led_effect_dna_init(&c->fb, 50, 5, false))
+EFFECT_SETUP(noise, led_effect_noise_init(&c->fb, 50, 25))
+EFFECT_SETUP(waterfall, led_effect_waterfall_init(&c->fb, WATERFALL_COLORS, 128, 70, 120))
+EFFECT_SETUP(plasma_waves, led_effect_plasma_waves_init(&c->fb, 150))
+EFFECT_SETUP(rainbow, led_effect_rainbow_init(&c->fb, RAINBOW_VERTICAL, 30, 10))
+EFFECT_SETUP(rays, led_effect_rays_init(&c->fb, 25, 3, 7))
+EFFECT_SETUP(crazybees, led_effect_crazybees_init(&c->fb, 4))
+EFFECT_SETUP(sparkles, led_effect_sparkles_init(&c->fb, 10, 80))
+EFFECT_SETUP(matrix, led_effect_matrix_init(&c->fb, 130))
+EFFECT_SETUP(rain, led_effect_rain_init(&c->fb, RAIN_MODE_RAINBOW, 128, 50, 150))
+EFFECT_SETUP(fire, led_effect_fire_init(&c->fb, FIRE_PALETTE_FIRE))
+
+// Effect frame plus render, the same work fb_animation does per frame
+static void run_effect(bench_ctx_t *c)
+{
+    c->effect_run(&c->fb);
+    fb_render(&c->fb, c);
+}
+
+static const bench_case_t cases[] = {
+    { "scale8",                     NULL,               run_scale8 },
+    { "scale8_video",               NULL,               run_scale8_video },
+    { "hsv2rgb_rainbow",            NULL,               run_hsv2rgb_rainbow },
+    { "hsv2rgb_spectrum",           NULL,               run_hsv2rgb_spectrum },
+    { "rgb2hsv_approximate",        NULL,               run_rgb2hsv_approximate },
+    { "hsv2rgb_rainbow_array",      NULL,               run_hsv2rgb_rainbow_array },
+    { "hsv2rgb_spectrum_array",     NULL,               run_hsv2rgb_spectrum_array },
+    { "rgb2hsv_approximate_array",  NULL,               run_rgb2hsv_approximate_array },
+    { "blur2d",                     NULL,               run_blur2d },
+    { "blur2d_linear",              NULL,               run_blur2d_linear },
+    { "blur2d_map",                 setup_map,          run_blur2d_map },
+    { "rgb_fade_array",             NULL,               run_rgb_fade_array },
+    { "inoise8_3d",                 NULL,               run_inoise8_3d },
+    { "fill_noise8_3d",             NULL,               run_fill_noise8_3d },
+    { "fb_set_pixel_hsv",           NULL,               run_fb_set_pixel_hsv },
+    { "fb_fade",                    NULL,               run_fb_fade },
+    { "fb_blur2d",                  NULL,               run_fb_blur2d },
+    { "fb_render",                  NULL,               run_fb_render },
+    { "effect/dna",                 setup_dna,          run_effect },
+    { "effect/noise",               setup_noise,        run_effect },
+    { "effect/waterfall",           setup_waterfall,    run_effect },
+    { "effect/plasma_waves",        setup_plasma_waves, run_effect },
+    { "effect/rainbow",             setup_rainbow,      run_effect },
+    { "effect/rays",                setup_rays,         run_effect },
+    { "effect/crazybees",           setup_crazybees,    run_effect },
+    { "effect/sparkles",            setup_sparkles,     run_effect },
+    { "effect/matrix",              setup_matrix,       run_effect },
+    { "effect/rain",                setup_rain,         run_effect },
+    { "effect/fire",                setup_fire,         run_effect },
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static esp_err_t ctx_init(bench_ctx_t *c, size_t width, size_t height)
+{
+    memset(c, 0, sizeof(bench_ctx_t));
+    c->width = width;
+    c->height = height;
+    c->num = width * height;
+
+    esp_err_t r = fb_init(&c->fb, width, height, render_sink);
+    if (r != ESP_OK)
+        return r;
+    c->rgb = calloc(c->num, sizeof(rgb_t));
+    c->hsv = calloc(c->num, sizeof(hsv_t));
+    c->u8 = calloc(c->num, 1);
+    c->map = calloc(c->num, sizeof(uint16_t));
+    c->strip = calloc(c->num, 3);
+    if (!c->rgb || !c->hsv || !c->u8 || !c->map || !c->strip)
+        return ESP_ERR_NO_MEM;
+    fill_random(c);
+
+    return ESP_OK;
+}
+
+static void ctx_free(bench_ctx_t *c)
+{
+    if (c->effect_done)
+        c->effect_done(&c->fb);
+    fb_free(&c->fb);
+    free(c->rgb);
+    free(c->hsv);
+    free(c->u8);
+    free(c->map);
+    free(c->strip);
+}
+
+static void print_header(bool csv)
+{
+    if (csv)
+        printf("case,width,height,frames,ns_per_frame,ns_per_pixel,setup_allocs,setup_bytes,allocs_per_frame,bytes_per_frame\n");
+    else
+        printf("%-26s %9s %9s %12s %10s %14s %14s\n",
+               "case", "size", "frames", "ns/frame", "ns/pixel", "setup allocs", "allocs/frame");
+}
+
+static int run_case(const bench_case_t *bc, size_t width, size_t height, uint64_t min_ns, bool csv)
+{
+    bench_ctx_t c;
+    if (ctx_init(&c, width, height) != ESP_OK)
+    {
+        fprintf(stderr, "%s: could not init %zux%zu context\n", bc->name, width, height);
+        ctx_free(&c);
+        return -1;
+    }
+
+    size_t setup_allocs = alloc_count;
+    size_t setup_bytes = alloc_bytes;
+    if (bc->setup && bc->setup(&c) != ESP_OK)
+    {
+        fprintf(stderr, "%s: setup failed\n", bc->name);
+        ctx_free(&c);
+        return -1;
+    }
+    setup_allocs = alloc_count - setup_allocs;
+    setup_bytes = alloc_bytes - setup_bytes;
+
+    // warm up caches and the effect state
+    bc->run(&c);
+
+    size_t allocs = alloc_count;
+    size_t bytes = alloc_bytes;
+    uint64_t frames = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do
+    {
+        for (int i = 0; i < 16; i++)
+            bc->run(&c);
+        frames += 16;
+        elapsed = now_ns() - start;
+    } while (elapsed < min_ns);
+    allocs = alloc_count - allocs;
+    bytes = alloc_bytes - bytes;
+
+    sink += c.rgb[0].r + c.hsv[0].h + c.u8[0];
+
+    double ns_frame = (double)elapsed / frames;
+    double ns_pixel = ns_frame / c.num;
+    double allocs_frame = (double)allocs / frames;
+
+    if (csv)
+        printf("%s,%zu,%zu,%llu,%.1f,%.3f,%zu,%zu,%.3f,%.1f\n", bc->name, width, height,
+               (unsigned long long)frames, ns_frame, ns_pixel, setup_allocs, setup_bytes,
+               allocs_frame, (double)bytes / frames);
+    else
+    {
+        char size[24];
+        snprintf(size, sizeof(size), "%zux%zu", width, height);
+        printf("%-26s %9s %9llu %12.1f %10.3f %8zu/%-5zu %14.3f\n", bc->name, size,
+               (unsigned long long)frames, ns_frame, ns_pixel, setup_allocs, setup_bytes, allocs_frame);
+    }
+
+    ctx_free(&c);
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-s WxH]... [-t ms] [-f filter] [-c]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    size_t widths[MAX_SIZES], heights[MAX_SIZES];
+    size_t sizes = 0;
+    unsigned min_ms = 200;
+    const char *filter = NULL;
+    bool csv = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:t:f:ch")) != -1)
+    {
+        switch (opt)
+        {
+            case 's':
+                if (sizes == MAX_SIZES || sscanf(optarg, "%zux%zu", &widths[sizes], &heights[sizes]) != 2
+                        || !widths[sizes] || !heights[sizes] || widths[sizes] * heights[sizes] > UINT16_MAX)
+                {
+                    fprintf(stderr, "invalid size: %s\n", optarg);
+                    return 1;
+                }
+                sizes++;
+                break;
+            case 't':
+                min_ms = atoi(optarg);
+                break;
+            case 'f':
+                filter = optarg;
+                break;
+            case 'c':
+                csv = true;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!sizes)
+    {
+        static const size_t def[][2] = { { 16, 16 }, { 32, 8 }, { 64, 64 } };
+        for (sizes = 0; sizes < sizeof(def) / sizeof(def[0]); sizes++)
+        {
+            widths[sizes] = def[sizes][0];
+            heights[sizes] = def[sizes][1];
+        }
+    }
+
+    print_header(csv);
+    int res = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        if (filter && !strstr(cases[i].name, filter))
+            continue;
+        for (size_t s = 0; s < sizes; s++)
+            if (run_case(&cases[i], widths[s], heights[s], (uint64_t)min_ms * 1000000, csv))
+                res = 1;
+    }
+
+    return res;
+}
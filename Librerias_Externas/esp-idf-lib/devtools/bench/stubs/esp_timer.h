@@ -0,0 +1,10 @@
+/* Host stub of ESP-IDF esp_timer.h for devtools/bench */
+#ifndef __ESP_TIMER_H__
+#define __ESP_TIMER_H__
+
+#include <stdint.h>
+
+/* Monotonic host time in microseconds */
+int64_t esp_timer_get_time(void);
+
+#endif /* __ESP_TIMER_H__ */
@@ -0,0 +1,14 @@
+/* Host stub of FreeRTOS semphr.h for devtools/bench, single-threaded mutex */
+#ifndef __SEMPHR_H__
+#define __SEMPHR_H__
+
+#include "FreeRTOS.h"
+
+typedef struct host_mutex_s *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#endif /* __SEMPHR_H__ */
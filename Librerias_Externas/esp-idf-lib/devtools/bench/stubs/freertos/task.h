@@ -0,0 +1,7 @@
+/* Host stub of FreeRTOS task.h for devtools/bench */
+#ifndef __TASK_H__
+#define __TASK_H__
+
+#include "FreeRTOS.h"
+
+#endif /* __TASK_H__ */
@@ -14,6 +14,8 @@
 #define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
 
+#define ROW_CHUNK 64
+
 typedef struct
 {
     uint8_t scale;
@@ -67,11 +69,14 @@ esp_err_t led_effect_noise_run(framebuffer_t *fb)
     params->z_pos += params->speed;
     params->hue++;
 
-    for (int x = 0; x < fb->width; x++)
-        for (int y = 0; y < fb->height; y++)
+    uint8_t noise[ROW_CHUNK];
+    for (int y = 0; y < fb->height; y++)
+        for (int x0 = 0; x0 < fb->width; x0 += ROW_CHUNK)
         {
-            uint8_t noise = inoise8_3d(x * params->scale, y * params->scale, params->z_pos);
-            fb_set_pixel_hsv(fb, x, y, hsv_from_values(params->hue + noise, 255, 255));
+            size_t len = fb->width - x0 < ROW_CHUNK ? fb->width - x0 : ROW_CHUNK;
+            fill_noise8_3d(noise, len, 1, len, x0 * params->scale, y * params->scale, params->z_pos, params->scale, 0);
+            for (size_t i = 0; i < len; i++)
+                fb_set_pixel_hsv(fb, x0 + i, y, hsv_from_values(params->hue + noise[i], 255, 255));
         }
 
     return fb_end(fb);
@@ -0,0 +1,466 @@
+/**
+ * @file ACTUADORES.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Capa de abstracción de los actuadores del sistema, que permite distribuir los actuadores en varios
+ *          expansores de I/O I2C, con un puerto sombra por expansor.
+ * @version 0.1
+ * @date 2023-02-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Cada actuador lógico (relé de luces, ventiladores, calefacción, etc.) se asocia, mediante la tabla de canales, a un
+ *  pin de alguno de los expansores de I/O de la tabla de expansores. Los expansores pueden ser de distinto tipo, y todos
+ *  comparten el bus I2C del MCP23008 de la placa.
+ *
+ *      Por cada expansor se mantiene un "puerto sombra" con el estado deseado de todas sus salidas. La función
+ *  "actuadores_set_estado()" solo modifica el puerto sombra, sin realizar transacciones I2C. Luego, la función
+ *  "actuadores_aplicar()", que se llama una vez por ciclo desde las tareas de control, escribe el puerto completo de
+ *  cada expansor cuyo puerto sombra haya cambiado desde la última escritura. De esta forma, se realiza como máximo
+ *  una transacción I2C por expansor y por ciclo, sin importar cuántos actuadores hayan cambiado, y no se requiere
+ *  la lectura-modificación-escritura de cada relé.
+ *
+ *      La escritura del MCP23008 de la placa es asíncrona: "actuadores_aplicar()" encola la transacción en la tarea de
+ *  "i2cdev" del puerto I2C y retorna sin esperar al bus. El resultado de la transacción se consulta en el siguiente
+ *  llamado, y solo entonces se actualiza el último valor escrito. Mientras la transacción está en curso, el expansor
+ *  no se vuelve a escribir. El resto de los expansores se escribe de forma síncrona.
+ *
+ *      Para agregar un expansor, se lo debe agregar a la tabla de expansores (incrementando "ACTUADORES_CANT_EXPANSORES")
+ *  y asociar sus pines a nuevos actuadores lógicos en la tabla de canales (incrementando "ACTUADORES_CANT_ACTUADORES").
+ *  Por ejemplo, un MCP23017 en la dirección 0x21 agrega 16 actuadores:
+ *
+ *      [1] = { .tipo = ACTUADORES_EXPANSOR_MCP23017, .addr = 0x21 },
+ *      ...
+ *      [7] = { .expansor = 1, .canal = 0 },
+ *      [8] = { .expansor = 1, .canal = 1 },
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "i2cdev.h"
+#include "mcp23x17.h"
+#include "pcf8574.h"
+#include "pcf8575.h"
+#include "tca95x5.h"
+
+#include "MCP23008.h"
+#include "ACTUADORES.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+/**
+ *  Estructura que representa el estado interno de un expansor de I/O.
+ */
+typedef struct {
+    i2c_dev_t dev;                  /* Descriptor I2C del expansor (no utilizado para el MCP23008). */
+    uint16_t puerto;                /* Puerto sombra, con el estado deseado de las salidas. */
+    uint16_t puerto_escrito;        /* Último valor escrito correctamente en el expansor. */
+    bool sincronizado;              /* Indica si "puerto_escrito" refleja el estado real del expansor. */
+    i2c_dev_transaction_t transaccion;  /* Transacción de las escrituras asíncronas. */
+    uint8_t dato_async;             /* Dato de la escritura asíncrona en curso. */
+    uint16_t puerto_en_curso;       /* Valor del puerto de la escritura asíncrona en curso. */
+    bool escritura_pendiente;       /* Indica que hay una escritura asíncrona cuyo resultado no se consultó. */
+} actuadores_expansor_t;
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+/* Tag para imprimir información en el LOG. */
+static const char *TAG = "ACTUADORES";
+
+/* Tabla de expansores de I/O del sistema. */
+static const actuadores_expansor_config_t actuadores_config_expansores[ACTUADORES_CANT_EXPANSORES] = {
+    [0] = { .tipo = ACTUADORES_EXPANSOR_MCP23008, .addr = MCP23008_ADDR },
+};
+
+/* Tabla que asocia cada actuador lógico a un pin de un expansor. */
+static const actuadores_canal_t actuadores_canales[ACTUADORES_CANT_ACTUADORES] = {
+    [RELE_1] = { .expansor = 0, .canal = 0 },
+    [RELE_2] = { .expansor = 0, .canal = 1 },
+    [RELE_3] = { .expansor = 0, .canal = 2 },
+    [RELE_4] = { .expansor = 0, .canal = 3 },
+    [RELE_5] = { .expansor = 0, .canal = 4 },
+    [RELE_6] = { .expansor = 0, .canal = 5 },
+    [RELE_7] = { .expansor = 0, .canal = 6 },
+};
+
+/* Estado interno de cada expansor. */
+static actuadores_expansor_t actuadores_expansores[ACTUADORES_CANT_EXPANSORES];
+
+/* Mutex que protege los puertos sombra, ya que se accede a ellos desde distintas tareas de control. */
+static SemaphoreHandle_t actuadores_mutex = NULL;
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static esp_err_t ActuadoresInitExpansor(unsigned int expansor, uint16_t mascara_salidas);
+static esp_err_t ActuadoresEscribirPuerto(unsigned int expansor, uint16_t valor);
+static esp_err_t ActuadoresEscribirPuertoAsync(unsigned int expansor, uint16_t valor);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para inicializar un expansor de I/O, configurando como salidas los pines asociados
+ *          a algún actuador.
+ *
+ * @param expansor          Índice del expansor en la tabla de expansores.
+ * @param mascara_salidas   Máscara de los pines que se utilizan como salidas.
+ * @return esp_err_t
+ */
+static esp_err_t ActuadoresInitExpansor(unsigned int expansor, uint16_t mascara_salidas)
+{
+    const actuadores_expansor_config_t *config = &actuadores_config_expansores[expansor];
+    i2c_dev_t *dev = &actuadores_expansores[expansor].dev;
+
+    switch(config->tipo)
+    {
+
+    case ACTUADORES_EXPANSOR_MCP23008:
+
+        /**
+         *  El MCP23008 de la placa se inicializa mediante "MCP23008_init()".
+         */
+        return ESP_OK;
+
+    case ACTUADORES_EXPANSOR_MCP23017:
+        ESP_RETURN_ON_ERROR(mcp23x17_init_desc(dev, config->addr, I2C_MASTER_NUM, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO),
+                            TAG, "Failed to initialize MCP23017 descriptor.");
+        break;
+
+    case ACTUADORES_EXPANSOR_PCF8574:
+        ESP_RETURN_ON_ERROR(pcf8574_init_desc(dev, config->addr, I2C_MASTER_NUM, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO),
+                            TAG, "Failed to initialize PCF8574 descriptor.");
+        break;
+
+    case ACTUADORES_EXPANSOR_PCF8575:
+        ESP_RETURN_ON_ERROR(pcf8575_init_desc(dev, config->addr, I2C_MASTER_NUM, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO),
+                            TAG, "Failed to initialize PCF8575 descriptor.");
+        break;
+
+    case ACTUADORES_EXPANSOR_TCA95X5:
+        ESP_RETURN_ON_ERROR(tca95x5_init_desc(dev, config->addr, I2C_MASTER_NUM, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO),
+                            TAG, "Failed to initialize TCA95x5 descriptor.");
+        break;
+
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /**
+     *  Se utiliza la misma configuración de bus que el MCP23008, para que la librería "i2cdev" no
+     *  reconfigure el driver I2C al alternar entre dispositivos. El PCF8574 es la excepción, ya
+     *  que solo admite un clock de hasta 100 kHz.
+     */
+    dev->cfg.sda_pullup_en = GPIO_PULLUP_DISABLE;
+    dev->cfg.scl_pullup_en = GPIO_PULLUP_DISABLE;
+
+    if(config->tipo != ACTUADORES_EXPANSOR_PCF8574)
+    {
+        dev->cfg.master.clk_speed = I2C_MASTER_FREQ_HZ;
+    }
+
+    /**
+     *  En los expansores con registro de dirección, los pines asociados a actuadores se configuran
+     *  como salidas (bit en 0) y el resto como entradas (bit en 1).
+     */
+    if(config->tipo == ACTUADORES_EXPANSOR_MCP23017)
+    {
+        ESP_RETURN_ON_ERROR(mcp23x17_port_set_mode(dev, ~mascara_salidas), TAG, "Failed to set MCP23017 mode.");
+    }
+
+    else if(config->tipo == ACTUADORES_EXPANSOR_TCA95X5)
+    {
+        ESP_RETURN_ON_ERROR(tca95x5_port_set_mode(dev, ~mascara_salidas), TAG, "Failed to set TCA95x5 mode.");
+    }
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para escribir el puerto completo de un expansor de I/O, en una única transacción I2C.
+ *
+ * @param expansor  Índice del expansor en la tabla de expansores.
+ * @param valor     Valor a escribir en el puerto.
+ * @return esp_err_t
+ */
+static esp_err_t ActuadoresEscribirPuerto(unsigned int expansor, uint16_t valor)
+{
+    i2c_dev_t *dev = &actuadores_expansores[expansor].dev;
+
+    switch(actuadores_config_expansores[expansor].tipo)
+    {
+
+    case ACTUADORES_EXPANSOR_MCP23008:
+        return MCP23008_port_write((uint8_t) valor);
+
+    case ACTUADORES_EXPANSOR_MCP23017:
+        return mcp23x17_port_write(dev, valor);
+
+    case ACTUADORES_EXPANSOR_PCF8574:
+        return pcf8574_port_write(dev, (uint8_t) valor);
+
+    case ACTUADORES_EXPANSOR_PCF8575:
+        return pcf8575_port_write(dev, valor);
+
+    case ACTUADORES_EXPANSOR_TCA95X5:
+        return tca95x5_port_write(dev, valor);
+
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+
+
+/**
+ * @brief   Función para encolar la escritura del puerto completo de un expansor de I/O, sin esperar a que
+ *          finalice la transacción I2C.
+ *
+ * @param expansor  Índice del expansor en la tabla de expansores.
+ * @param valor     Valor a escribir en el puerto.
+ * @return esp_err_t    ESP_ERR_NOT_SUPPORTED si el tipo de expansor solo admite escrituras síncronas.
+ */
+static esp_err_t ActuadoresEscribirPuertoAsync(unsigned int expansor, uint16_t valor)
+{
+    actuadores_expansor_t *estado = &actuadores_expansores[expansor];
+
+    if(actuadores_config_expansores[expansor].tipo != ACTUADORES_EXPANSOR_MCP23008)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    estado->dato_async = (uint8_t) valor;
+
+    esp_err_t err = MCP23008_port_write_async(&estado->transaccion, &estado->dato_async);
+
+    if(err == ESP_OK)
+    {
+        estado->puerto_en_curso = valor;
+        estado->escritura_pendiente = 1;
+    }
+
+    return err;
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para inicializar la capa de actuadores. Se inicializan los expansores de I/O y se
+ *          apagan todos los actuadores.
+ *
+ *          Previamente debe haberse llamado a "i2cdev_init()" y a "MCP23008_init()".
+ *
+ * @return esp_err_t
+ */
+esp_err_t actuadores_init(void)
+{
+    if(actuadores_mutex == NULL)
+    {
+        actuadores_mutex = xSemaphoreCreateMutex();
+
+        if(actuadores_mutex == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to create mutex.");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    for(unsigned int i = 0; i < ACTUADORES_CANT_EXPANSORES; i++)
+    {
+        /**
+         *  Se calcula qué pines del expansor se utilizan como salidas, y el valor del puerto con
+         *  todos los actuadores apagados.
+         */
+        uint16_t mascara_salidas = 0;
+        actuadores_tipo_expansor_t tipo = actuadores_config_expansores[i].tipo;
+
+        /**
+         *  En los expansores cuasi-bidireccionales (PCF857x), los pines que no son salidas se dejan
+         *  en nivel alto para que funcionen como entradas.
+         */
+        uint16_t puerto = (tipo == ACTUADORES_EXPANSOR_PCF8574 || tipo == ACTUADORES_EXPANSOR_PCF8575) ? 0xFFFF : 0;
+
+        for(unsigned int j = 0; j < ACTUADORES_CANT_ACTUADORES; j++)
+        {
+            if(actuadores_canales[j].expansor != i)
+            {
+                continue;
+            }
+
+            mascara_salidas |= BIT(actuadores_canales[j].canal);
+            BIT_WRITE(puerto, actuadores_canales[j].canal, actuadores_canales[j].activo_bajo);
+        }
+
+        ESP_RETURN_ON_ERROR(ActuadoresInitExpansor(i, mascara_salidas), TAG, "Failed to initialize expander %u.", i);
+
+        actuadores_expansores[i].puerto = puerto;
+        actuadores_expansores[i].sincronizado = 0;
+    }
+
+    /**
+     *  Se escriben los puertos de todos los expansores, con los actuadores apagados.
+     */
+    return actuadores_aplicar();
+}
+
+
+
+/**
+ * @brief   Función para establecer el estado de un actuador. Solo se modifica el puerto sombra del expansor
+ *          correspondiente, y el cambio se escribe en el expansor en el próximo llamado a "actuadores_aplicar()".
+ *
+ * @param actuador  Actuador lógico (por ejemplo, RELE_1 ... RELE_7).
+ * @param estado    Estado del actuador (ON u OFF).
+ * @return esp_err_t
+ */
+esp_err_t actuadores_set_estado(uint8_t actuador, bool estado)
+{
+    if(actuador >= ACTUADORES_CANT_ACTUADORES || actuadores_mutex == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const actuadores_canal_t *canal = &actuadores_canales[actuador];
+
+    xSemaphoreTake(actuadores_mutex, portMAX_DELAY);
+    BIT_WRITE(actuadores_expansores[canal->expansor].puerto, canal->canal, estado != canal->activo_bajo);
+    xSemaphoreGive(actuadores_mutex);
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para conocer el estado de un actuador, según el puerto sombra del expansor.
+ *
+ * @param actuador  Actuador lógico.
+ * @return true     Actuador encendido.
+ * @return false    Actuador apagado (o actuador inexistente).
+ */
+bool actuadores_get_estado(uint8_t actuador)
+{
+    if(actuador >= ACTUADORES_CANT_ACTUADORES || actuadores_mutex == NULL)
+    {
+        return 0;
+    }
+
+    const actuadores_canal_t *canal = &actuadores_canales[actuador];
+
+    xSemaphoreTake(actuadores_mutex, portMAX_DELAY);
+    bool nivel = (actuadores_expansores[canal->expansor].puerto >> canal->canal) & 1;
+    xSemaphoreGive(actuadores_mutex);
+
+    return nivel != canal->activo_bajo;
+}
+
+
+
+/**
+ * @brief   Función para escribir en los expansores los cambios de estado de los actuadores. Solo se escriben
+ *          los expansores cuyo puerto sombra cambió desde la última escritura, con una única transacción I2C
+ *          por expansor.
+ *
+ *          Se debe llamar una vez por ciclo desde las tareas de control, luego de actualizar los actuadores.
+ *          Los errores de las escrituras asíncronas se informan en el llamado siguiente.
+ *
+ * @return esp_err_t    ESP_OK si se pudieron escribir (o encolar) todos los expansores.
+ */
+esp_err_t actuadores_aplicar(void)
+{
+    if(actuadores_mutex == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t resultado = ESP_OK;
+
+    xSemaphoreTake(actuadores_mutex, portMAX_DELAY);
+
+    for(unsigned int i = 0; i < ACTUADORES_CANT_EXPANSORES; i++)
+    {
+        actuadores_expansor_t *expansor = &actuadores_expansores[i];
+
+        /**
+         *  Si hay una escritura asíncrona en curso, el expansor se escribe en un próximo ciclo. Si ya
+         *  finalizó, se consulta su resultado.
+         */
+        if(expansor->escritura_pendiente)
+        {
+            if(expansor->transaccion.busy)
+            {
+                continue;
+            }
+
+            expansor->escritura_pendiente = 0;
+
+            if(expansor->transaccion.result == ESP_OK)
+            {
+                expansor->puerto_escrito = expansor->puerto_en_curso;
+                expansor->sincronizado = 1;
+            }
+
+            else
+            {
+                ESP_LOGE(TAG, "Failed to write expander %u.", i);
+                expansor->sincronizado = 0;
+                resultado = expansor->transaccion.result;
+            }
+        }
+
+        if(expansor->sincronizado && expansor->puerto == expansor->puerto_escrito)
+        {
+            continue;
+        }
+
+        /**
+         *  En caso de error, el expansor queda sin sincronizar y se reintenta en el próximo ciclo.
+         */
+        esp_err_t err = ActuadoresEscribirPuertoAsync(i, expansor->puerto);
+
+        if(err == ESP_OK)
+        {
+            continue;
+        }
+
+        if(err == ESP_ERR_NOT_SUPPORTED)
+        {
+            err = ActuadoresEscribirPuerto(i, expansor->puerto);
+        }
+
+        if(err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to write expander %u.", i);
+            expansor->sincronizado = 0;
+            resultado = err;
+            continue;
+        }
+
+        expansor->puerto_escrito = expansor->puerto;
+        expansor->sincronizado = 1;
+    }
+
+    xSemaphoreGive(actuadores_mutex);
+
+    return resultado;
+}
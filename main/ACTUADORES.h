@@ -0,0 +1,76 @@
+/*
+
+    Capa de abstracción de los actuadores del sistema, que asocia cada actuador lógico a un canal de alguno
+    de los expansores de I/O I2C (MCP23008, MCP23017, PCF8574, PCF8575, TCA9535/TCA9555).
+
+*/
+
+#ifndef ACTUADORES_H_
+#define ACTUADORES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/* Cantidad de expansores de I/O configurados en la tabla de expansores. */
+#define ACTUADORES_CANT_EXPANSORES  1
+
+/**
+ *  Cantidad de actuadores lógicos configurados en la tabla de canales. Los primeros 7 corresponden
+ *  a los relés de la placa (RELE_1 ... RELE_7), por lo que dichos valores son identificadores válidos.
+ */
+#define ACTUADORES_CANT_ACTUADORES  7
+
+/**
+ *  Enumeración correspondiente a los tipos de expansores de I/O soportados.
+ */
+typedef enum {
+    ACTUADORES_EXPANSOR_MCP23008 = 0,   /* Expansor de 8 bits de la placa (librería MCP23008 propia). */
+    ACTUADORES_EXPANSOR_MCP23017,       /* Expansor de 16 bits (componente "mcp23x17"). */
+    ACTUADORES_EXPANSOR_PCF8574,        /* Expansor cuasi-bidireccional de 8 bits (componente "pcf8574"). */
+    ACTUADORES_EXPANSOR_PCF8575,        /* Expansor cuasi-bidireccional de 16 bits (componente "pcf8575"). */
+    ACTUADORES_EXPANSOR_TCA95X5,        /* Expansor de 16 bits TCA9535/TCA9555 (componente "tca95x5"). */
+} actuadores_tipo_expansor_t;
+
+
+/**
+ *  Estructura con la configuración de un expansor de I/O.
+ */
+typedef struct {
+    actuadores_tipo_expansor_t tipo;    /* Tipo de expansor. */
+    uint8_t addr;                       /* Dirección I2C (ignorada para el MCP23008, que usa MCP23008_ADDR). */
+} actuadores_expansor_config_t;
+
+
+/**
+ *  Estructura que asocia un actuador lógico a un canal de un expansor.
+ */
+typedef struct {
+    uint8_t expansor;                   /* Índice del expansor en la tabla de expansores. */
+    uint8_t canal;                      /* Número de pin del expansor (0 a 7 o 0 a 15). */
+    bool activo_bajo;                   /* El actuador se enciende con nivel bajo en el pin. */
+} actuadores_canal_t;
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+esp_err_t actuadores_init(void);
+esp_err_t actuadores_set_estado(uint8_t actuador, bool estado);
+bool actuadores_get_estado(uint8_t actuador);
+esp_err_t actuadores_aplicar(void);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACTUADORES_H_
@@ -24,6 +24,8 @@
 #include "MQTT_PUBL_SUSCR.h"
 #include "MEF_ALGORITMO_CONTROL_LUCES.h"
 #include "AUXILIARES_ALGORITMO_CONTROL_LUCES.h"
+#include "RELOJ_TIEMPO_REAL.h"
+#include "PLANIFICADOR_FOTOPERIODO.h"
 
 //==================================| MACROS AND TYPDEF |==================================//
 
@@ -46,6 +48,8 @@ static void vLucesTimerCallback( TimerHandle_t pxTimer );
 static void CallbackManualMode(void *pvParameters);
 static void CallbackManualModeNewActuatorState(void *pvParameters);
 static void CallbackNewLightsOnTime(void *pvParameters);
+static void CallbackNewLightsWindows(void *pvParameters);
+static void CallbackRelojSincronizado(void *pvParameters);
 
 //==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
 
@@ -156,6 +160,75 @@ static void CallbackNewLightsOnTime(void *pvParameters)
      *  Se actualiza el nuevo tiempo de encendido en la MEF, en horas.
      */
     mef_luces_set_lights_on_time_hours(tiempo_on_luces);
+
+    /**
+     *  Si las luces se controlan por hora local, se fuerza la evaluación del nuevo fotoperíodo.
+     */
+    if(reloj_hora_valida())
+    {
+        mef_luces_set_timer_flag_value(1);
+        xTaskNotifyGive(mef_luces_get_task_handle());
+    }
+}
+
+
+
+/**
+ *  @brief  Función de callback que se ejecuta cuando llega un mensaje al tópico MQTT
+ *          correspondiente con nuevas ventanas horarias de encendido de las luces,
+ *          con el formato "HH:MM-HH:MM;HH:MM-HH:MM".
+ * 
+ * @param pvParameters 
+ */
+static void CallbackNewLightsWindows(void *pvParameters)
+{
+    /**
+     *  Se obtiene el mensaje con las ventanas de encendido de las luces.
+     */
+    char buffer[50];
+    mqtt_get_char_data_from_topic(LIGHTS_WINDOWS_MQTT_TOPIC, buffer);
+
+    fotoperiodo_ventana_t ventanas[FOTOPERIODO_CANT_MAX_VENTANAS];
+    unsigned int cant_ventanas = 0;
+
+    if(fotoperiodo_parse_ventanas(buffer, ventanas, &cant_ventanas) != ESP_OK
+        || fotoperiodo_set_ventanas(ventanas, cant_ventanas) != ESP_OK)
+    {
+        ESP_LOGE(aux_control_luces_tag, "INVALID LIGHTS WINDOWS: %s", buffer);
+        return;
+    }
+
+    ESP_LOGI(aux_control_luces_tag, "NUEVAS VENTANAS LUCES: %s", buffer);
+
+    /**
+     *  Si las luces se controlan por hora local, se fuerza la evaluación del nuevo fotoperíodo.
+     */
+    if(reloj_hora_valida())
+    {
+        mef_luces_set_timer_flag_value(1);
+        xTaskNotifyGive(mef_luces_get_task_handle());
+    }
+}
+
+
+
+/**
+ * @brief   Función de callback que se ejecuta cuando se sincroniza la hora del sistema por SNTP,
+ *          para que la MEF de control de las luces pase a regirse por la hora local.
+ * 
+ * @param pvParameters 
+ */
+static void CallbackRelojSincronizado(void *pvParameters)
+{
+    mef_luces_set_timer_flag_value(1);
+
+    /**
+     * Se le envía un Task Notify a la tarea de la MEF de control de las luces.
+     */
+    if(mef_luces_get_task_handle() != NULL)
+    {
+        xTaskNotifyGive(mef_luces_get_task_handle());
+    }
 }
 
 //==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
@@ -199,6 +272,14 @@ esp_err_t aux_control_luces_init(esp_mqtt_client_handle_t mqtt_client)
     }
 
 
+    //=======================| SINCRONIZACIÓN HORA |=======================//
+
+    /**
+     *  Se configura la función callback a ejecutar cada vez que se sincroniza la hora del sistema.
+     */
+    reloj_callback_function_on_sync(CallbackRelojSincronizado);
+
+
     //=======================| TÓPICOS MQTT |=======================//
 
     /**
@@ -213,12 +294,14 @@ esp_err_t aux_control_luces_init(esp_mqtt_client_handle_t mqtt_client)
         [1].topic_function_cb = CallbackManualMode,
         [2].topic_name = MANUAL_MODE_LIGHTS_STATE_MQTT_TOPIC,
         [2].topic_function_cb = CallbackManualModeNewActuatorState,
+        [3].topic_name = LIGHTS_WINDOWS_MQTT_TOPIC,
+        [3].topic_function_cb = CallbackNewLightsWindows,
     };
 
     /**
      *  Se realiza la suscripción a los tópicos MQTT y la asignación de callbacks correspondientes.
      */
-    if(mqtt_suscribe_to_topics(list_of_topics, 3, Cliente_MQTT, 0) != ESP_OK)
+    if(mqtt_suscribe_to_topics(list_of_topics, 4, Cliente_MQTT, 0) != ESP_OK)
     {
         ESP_LOGE(aux_control_luces_tag, "FAILED TO SUSCRIBE TO MQTT TOPICS.");
         return ESP_FAIL;
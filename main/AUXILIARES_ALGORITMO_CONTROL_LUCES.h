@@ -28,6 +28,7 @@ extern "C" {
 #define LIGHTS_MANUAL_MODE_MQTT_TOPIC  "/Luces/Modo"
 #define MANUAL_MODE_LIGHTS_STATE_MQTT_TOPIC    "/Luces/Modo_Manual/Luces"
 #define LIGHTS_STATE_MQTT_TOPIC   "Actuadores/Luces"
+#define LIGHTS_WINDOWS_MQTT_TOPIC   "/Tiempos/Luces/Ventanas"
 
 /**
  *  Constante de conversión de horas a ms:
@@ -26,6 +26,7 @@
 #include "CO2_SENSOR.h"
 #include "MEF_ALGORITMO_CONTROL_VAR_AMB.h"
 #include "AUXILIARES_ALGORITMO_CONTROL_VAR_AMB.h"
+#include "HISTORIAL_SENSORES.h"
 
 //==================================| MACROS AND TYPDEF |==================================//
 
@@ -52,48 +53,71 @@ static const char aux_control_var_amb_topicos_datos_co2[AUX_CONTROL_VAR_AMB_CANT
     CO2_AMB_MQTT_TOPIC
 };
 
+/**
+ *  Zona del control de variables ambientales a la que pertenece cada unidad secundaria. La mediana de
+ *  cada variable ambiental de una zona se calcula solo con los datos de sus unidades secundarias.
+ */
+static const unsigned int aux_control_var_amb_zona_unidades[AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS] = {
+    0
+};
+
 //==================================| EXTERNAL DATA DEFINITION |==================================//
 
 //==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
 
 static void CallbackManualMode(void *pvParameters);
 static void CallbackManualModeNewActuatorState(void *pvParameters);
+static void CallbackTipoControl(void *pvParameters);
 static void CallbackGetTempAmbData(void *pvParameters);
 static void CallbackGetHumAmbData(void *pvParameters);
 static void CallbackGetCO2AmbData(void *pvParameters);
 static void CallbackNewTempAmbSP(void *pvParameters);
+static bool ZonaAfectadaPorTopico(const char topicos_unidades[][100], const char *topico, unsigned int zona);
+static bool ObtenerMedianaZona(const char topicos_unidades[][100], float codigo_error, unsigned int zona, float *mediana);
 static void SortData(float *data_array, unsigned int cantidad_datos);
 
 //==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
 
 /**
  * @brief   Función de callback que se ejecuta cuando llega un mensaje MQTT en el tópico
- *          correspondiente al modo MANUAL, para indicar si se quiere pasar a modo
- *          MANUAL o AUTOMÁTICO.
+ *          correspondiente al modo MANUAL de alguna zona, para indicar si se quiere pasar
+ *          a modo MANUAL o AUTOMÁTICO.
  * 
- * @param pvParameters 
+ * @param pvParameters  Nombre del tópico al que llegó el mensaje.
  */
 static void CallbackManualMode(void *pvParameters)
 {
-    /**
-     *  Se obtiene el mensaje del tópico de modo MANUAL o AUTO.
-     */
-    char buffer[10];
-    mqtt_get_char_data_from_topic(VAR_AMB_MANUAL_MODE_MQTT_TOPIC, buffer);
+    const char *topico = pvParameters;
 
-    /**
-     *  Dependiendo si el mensaje fue "MANUAL" o "AUTO", se setea o resetea
-     *  la bandera correspondiente para señalizarle a la MEF de control de
-     *  variables ambientales que debe pasar al estado de modo MANUAL o AUTOMATICO.
-     */
-    if(!strcmp("MANUAL", buffer))
+    for(unsigned int zona = 0; zona < MEF_VAR_AMB_CANT_ZONAS; zona++)
     {
-        mef_var_amb_set_manual_mode_flag_value(1);
-    }
+        const mef_var_amb_zona_config_t *config = mef_var_amb_get_zona_config(zona);
 
-    else if(!strcmp("AUTO", buffer))
-    {
-        mef_var_amb_set_manual_mode_flag_value(0);
+        if(topico != NULL && strcmp(topico, config->topico_modo))
+        {
+            continue;
+        }
+
+        /**
+         *  Se obtiene el mensaje del tópico de modo MANUAL o AUTO.
+         */
+        char buffer[50];
+        mqtt_get_char_data_from_topic(config->topico_modo, buffer);
+
+        /**
+         *  Dependiendo si el mensaje fue "MANUAL" o "AUTO", se setea o resetea
+         *  la bandera correspondiente para señalizarle a la MEF de control de
+         *  variables ambientales que debe pasar al estado de modo MANUAL o AUTOMATICO.
+         */
+        if(!strcmp("MANUAL", buffer))
+        {
+            mef_var_amb_set_manual_mode_flag_value(zona, 1);
+        }
+
+        else if(!strcmp("AUTO", buffer))
+        {
+            mef_var_amb_set_manual_mode_flag_value(zona, 0);
+        }
     }
 
     /**
@@ -125,100 +149,102 @@ static void CallbackManualModeNewActuatorState(void *pvParameters)
 
 
 /**
- *  @brief  Función de callback que se ejecuta cuando se completa una nueva medición de
- *          temperatura de alguno de los sensores DHT11 de las unidades secundarias.
+ *  @brief  Función de callback que se ejecuta cuando llega un mensaje MQTT en el tópico
+ *          correspondiente al tipo de control de las variables ambientales de alguna zona,
+ *          para indicar si se quiere utilizar el control por ventana de histéresis o el
+ *          control PI por tiempo proporcional.
  * 
- * @param pvParameters 
+ * @param pvParameters  Nombre del tópico al que llegó el mensaje.
  */
-static void CallbackGetTempAmbData(void *pvParameters)
+static void CallbackTipoControl(void *pvParameters)
 {
-    /**
-     *  Se inicializa un array dinámico en donde se irán guardando los datos de
-     *  temperatura ambiente sensados por cada una de las unidades secundarias,
-     *  para luego obtener la mediana del mismo.
-     */
-    DHT11_sensor_temp_t *temperaturas_unidades_sec = NULL;
-
-    /**
-     *  Variable que representa la cantidad de datos que llegan desde las unidades secundarias
-     *  que son considerados como correctos, esto es, que no tienen el código de error 
-     *  "CODIGO_ERROR_SENSOR_DHT11_TEMP_AMB".
-     */
-    unsigned int cantidad_datos_correctos = 0;
+    const char *topico = pvParameters;
 
-    /**
-     *  Se obtienen los datos de temperatura ambiente de cada una de las unidades secundarias.
-     */
-    for(int i = 1; i <= AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS; i++)
+    for(unsigned int zona = 0; zona < MEF_VAR_AMB_CANT_ZONAS; zona++)
     {
-        DHT11_sensor_temp_t buffer = CODIGO_ERROR_SENSOR_DHT11_TEMP_AMB;
-        mqtt_get_float_data_from_topic(aux_control_var_amb_topicos_datos_temp[i-1], &buffer);
-        ESP_LOGW(aux_control_var_amb_tag, "NEW TEMP VALUE: %.3f", buffer);
+        const mef_var_amb_zona_config_t *config = mef_var_amb_get_zona_config(zona);
+
+        if(topico != NULL && strcmp(topico, config->topico_tipo_control))
+        {
+            continue;
+        }
 
         /**
-         *  Se controla que el dato obtenido no tenga el código de error, en caso de que sí, 
-         *  no se considera dicho dato para el posterior cálculo de la mediana.
+         *  Se obtiene el mensaje del tópico de tipo de control.
          */
-        if(buffer != CODIGO_ERROR_SENSOR_DHT11_TEMP_AMB)
-        {
-            if(temperaturas_unidades_sec == NULL)
-            {
-                temperaturas_unidades_sec = calloc(1, sizeof(DHT11_sensor_temp_t));
-            }
+        char buffer[50];
+        mqtt_get_char_data_from_topic(config->topico_tipo_control, buffer);
 
-            else
-            {
-                temperaturas_unidades_sec = (DHT11_sensor_temp_t*) realloc(temperaturas_unidades_sec, cantidad_datos_correctos * sizeof(DHT11_sensor_temp_t));
-            }
+        /**
+         *  Dependiendo si el mensaje fue "PROPORCIONAL" o "HISTERESIS", se setea o resetea
+         *  la bandera correspondiente de la MEF de control de variables ambientales.
+         */
+        if(!strcmp("PROPORCIONAL", buffer))
+        {
+            mef_var_amb_set_proportional_mode_flag_value(zona, 1);
+        }
 
-            temperaturas_unidades_sec[cantidad_datos_correctos] = buffer;
-            cantidad_datos_correctos++;
+        else if(!strcmp("HISTERESIS", buffer))
+        {
+            mef_var_amb_set_proportional_mode_flag_value(zona, 0);
         }
     }
 
-
     /**
-     *  En caso de que no haya habido ningun dato correcto, se setea la bandera de error de sensor
-     *  y se salta hasta el final de la rutina, en donde se libera el puntero creado.
+     * Se le envía un Task Notify a la tarea de la MEF de control de variables ambientales.
      */
-    if(cantidad_datos_correctos == 0)
-    {
-        mef_var_amb_set_temp_DHT11_sensor_error_flag_value(1);
-        goto ERROR_TEMP;
-    }
+    xTaskNotifyGive(mef_var_amb_get_task_handle());
+}
 
-    /**
-     *  En caso de que si haya algun dato correcto, se resetea la bandera de error de sensor.
-     */
-    mef_var_amb_set_temp_DHT11_sensor_error_flag_value(0);
 
-    /**
-     *  Se ordenan los datos obtenidos de menor a mayor.
-     */
-    SortData(temperaturas_unidades_sec, cantidad_datos_correctos);
 
-    /**
-     *  Se obtiene la mediana de los datos recopilados.
-     */
-    DHT11_sensor_temp_t mediana_temperaturas_unidades_sec;
+/**
+ *  @brief  Función de callback que se ejecuta cuando se completa una nueva medición de
+ *          temperatura de alguno de los sensores DHT11 de las unidades secundarias.
+ * 
+ *          Se recalcula la mediana de temperatura de la zona a la que pertenece la unidad
+ *          secundaria que envió el dato.
+ * 
+ * @param pvParameters  Nombre del tópico al que llegó el dato.
+ */
+static void CallbackGetTempAmbData(void *pvParameters)
+{
+    for(unsigned int zona = 0; zona < MEF_VAR_AMB_CANT_ZONAS; zona++)
+    {
+        if(!ZonaAfectadaPorTopico(aux_control_var_amb_topicos_datos_temp, pvParameters, zona))
+        {
+            continue;
+        }
 
-    if ( (cantidad_datos_correctos % 2) == 0 )  
-        mediana_temperaturas_unidades_sec = (temperaturas_unidades_sec[(cantidad_datos_correctos-1) / 2] + temperaturas_unidades_sec[((cantidad_datos_correctos-1) / 2) + 1]) / 2.0;  
-    
-    else  
-        mediana_temperaturas_unidades_sec = temperaturas_unidades_sec[(cantidad_datos_correctos-1) / 2];
+        DHT11_sensor_temp_t mediana_temperaturas_unidades_sec;
 
+        /**
+         *  En caso de que no haya habido ningun dato correcto en la zona, se setea la bandera de
+         *  error de sensor de la misma.
+         */
+        if(!ObtenerMedianaZona(aux_control_var_amb_topicos_datos_temp, CODIGO_ERROR_SENSOR_DHT11_TEMP_AMB, 
+                               zona, &mediana_temperaturas_unidades_sec))
+        {
+            mef_var_amb_set_temp_DHT11_sensor_error_flag_value(zona, 1);
+            continue;
+        }
 
-    /**
-     *  Se le pasa la mediana del array de datos obtenido a la MEF de control de variables ambientales.
-     */
-    mef_var_amb_set_temp_amb_value(mediana_temperaturas_unidades_sec);
+        /**
+         *  En caso de que si haya algun dato correcto, se resetea la bandera de error de sensor, y se le 
+         *  pasa la mediana de los datos de la zona a la MEF de control de variables ambientales.
+         */
+        mef_var_amb_set_temp_DHT11_sensor_error_flag_value(zona, 0);
+        mef_var_amb_set_temp_amb_value(zona, mediana_temperaturas_unidades_sec);
 
-    /**
-     *  Se libera el puntero creado.
-     */
-    ERROR_TEMP: ;
-    free(temperaturas_unidades_sec);
+        /**
+         *  Se agrega la mediana obtenida al historial de la variable ambiental, que corresponde a
+         *  la zona principal.
+         */
+        if(zona == 0)
+        {
+            historial_sensores_agregar_muestra(HISTORIAL_TEMP_AMB, mediana_temperaturas_unidades_sec);
+        }
+    }
 }
 
 
@@ -227,196 +253,204 @@ static void CallbackGetTempAmbData(void *pvParameters)
  *  @brief  Función de callback que se ejecuta cuando se completa una nueva medición de
  *          humedad relativa de alguno de los sensores DHT11 de las unidades secundarias.
  * 
- * @param pvParameters 
+ *          Se recalcula la mediana de humedad de la zona a la que pertenece la unidad
+ *          secundaria que envió el dato.
+ * 
+ * @param pvParameters  Nombre del tópico al que llegó el dato.
  */
 static void CallbackGetHumAmbData(void *pvParameters)
 {
-    /**
-     *  Se inicializa un array dinámico en donde se irán guardando los datos de
-     *  humedad relativa ambiente sensados por cada una de las unidades secundarias,
-     *  para luego obtener la mediana del mismo.
-     */
-    DHT11_sensor_hum_t *humedades_unidades_sec = NULL;
-
-    /**
-     *  Variable que representa la cantidad de datos que llegan desde las unidades secundarias
-     *  que son considerados como correctos, esto es, que no tienen el código de error 
-     *  "CODIGO_ERROR_SENSOR_DHT11_HUM_AMB".
-     */
-    unsigned int cantidad_datos_correctos = 0;
-
-    /**
-     *  Se obtienen los datos de temperatura ambiente de cada una de las unidades secundarias.
-     */
-    for(int i = 1; i <= AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS; i++)
+    for(unsigned int zona = 0; zona < MEF_VAR_AMB_CANT_ZONAS; zona++)
     {
-        DHT11_sensor_hum_t buffer = CODIGO_ERROR_SENSOR_DHT11_HUM_AMB;
-        mqtt_get_float_data_from_topic(aux_control_var_amb_topicos_datos_hum[i-1], &buffer);
-        ESP_LOGW(aux_control_var_amb_tag, "NEW HUM VALUE: %.3f", buffer);
+        if(!ZonaAfectadaPorTopico(aux_control_var_amb_topicos_datos_hum, pvParameters, zona))
+        {
+            continue;
+        }
+
+        DHT11_sensor_hum_t mediana_humedades_unidades_sec;
 
         /**
-         *  Se controla que el dato obtenido no tenga el código de error, en caso de que sí, 
-         *  no se considera dicho dato para el posterior cálculo de la mediana.
+         *  En caso de que no haya habido ningun dato correcto en la zona, se setea la bandera de
+         *  error de sensor de la misma.
          */
-        if(buffer != CODIGO_ERROR_SENSOR_DHT11_HUM_AMB)
+        if(!ObtenerMedianaZona(aux_control_var_amb_topicos_datos_hum, CODIGO_ERROR_SENSOR_DHT11_HUM_AMB, 
+                               zona, &mediana_humedades_unidades_sec))
         {
-            if(humedades_unidades_sec == NULL)
-            {
-                humedades_unidades_sec = calloc(1, sizeof(DHT11_sensor_hum_t));
-            }
+            mef_var_amb_set_hum_DHT11_sensor_error_flag_value(zona, 1);
+            continue;
+        }
 
-            else
-            {
-                humedades_unidades_sec = (DHT11_sensor_hum_t*) realloc(humedades_unidades_sec, cantidad_datos_correctos * sizeof(DHT11_sensor_hum_t));
-            }
+        /**
+         *  En caso de que si haya algun dato correcto, se resetea la bandera de error de sensor, y se le 
+         *  pasa la mediana de los datos de la zona a la MEF de control de variables ambientales.
+         */
+        mef_var_amb_set_hum_DHT11_sensor_error_flag_value(zona, 0);
+        mef_var_amb_set_hum_amb_value(zona, mediana_humedades_unidades_sec);
 
-            humedades_unidades_sec[cantidad_datos_correctos] = buffer;
-            cantidad_datos_correctos++;
+        /**
+         *  Se agrega la mediana obtenida al historial de la variable ambiental, que corresponde a
+         *  la zona principal.
+         */
+        if(zona == 0)
+        {
+            historial_sensores_agregar_muestra(HISTORIAL_HUM_AMB, mediana_humedades_unidades_sec);
         }
     }
+}
 
 
-    /**
-     *  En caso de que no haya habido ningun dato correcto, se setea la bandera de error de sensor
-     *  y se salta hasta el final de la rutina, en donde se libera el puntero creado.
-     */
-    if(cantidad_datos_correctos == 0)
+
+/**
+ *  @brief  Función de callback que se ejecuta cuando se completa una nueva medición de
+ *          CO2 de alguno de los sensores de CO2 de las unidades secundarias.
+ * 
+ *          Se recalcula la mediana de CO2 de la zona a la que pertenece la unidad
+ *          secundaria que envió el dato.
+ * 
+ * @param pvParameters  Nombre del tópico al que llegó el dato.
+ */
+static void CallbackGetCO2AmbData(void *pvParameters)
+{
+    for(unsigned int zona = 0; zona < MEF_VAR_AMB_CANT_ZONAS; zona++)
     {
-        mef_var_amb_set_hum_DHT11_sensor_error_flag_value(1);
-        goto ERROR_HUM;
-    }
+        if(!ZonaAfectadaPorTopico(aux_control_var_amb_topicos_datos_co2, pvParameters, zona))
+        {
+            continue;
+        }
 
-    /**
-     *  En caso de que si haya algun dato correcto, se resetea la bandera de error de sensor.
-     */
-    mef_var_amb_set_hum_DHT11_sensor_error_flag_value(0);
+        CO2_sensor_ppm_t mediana_nivel_CO2_unidades_sec;
 
-    /**
-     *  Se ordenan los datos obtenidos de menor a mayor.
-     */
-    SortData(humedades_unidades_sec, cantidad_datos_correctos);
+        /**
+         *  En caso de que no haya habido ningun dato correcto en la zona, se setea la bandera de
+         *  error de sensor de la misma.
+         */
+        if(!ObtenerMedianaZona(aux_control_var_amb_topicos_datos_co2, CODIGO_ERROR_SENSOR_CO2, 
+                               zona, &mediana_nivel_CO2_unidades_sec))
+        {
+            mef_var_amb_set_CO2_sensor_error_flag_value(zona, 1);
+            continue;
+        }
 
-    /**
-     *  Se obtiene la mediana de los datos recopilados.
-     */
-    DHT11_sensor_hum_t mediana_humedades_unidades_sec;
+        /**
+         *  En caso de que si haya algun dato correcto, se resetea la bandera de error de sensor, y se le 
+         *  pasa la mediana de los datos de la zona a la MEF de control de variables ambientales.
+         */
+        mef_var_amb_set_CO2_sensor_error_flag_value(zona, 0);
+        mef_var_amb_set_CO2_amb_value(zona, mediana_nivel_CO2_unidades_sec);
 
-    if ( (cantidad_datos_correctos % 2) == 0 )  
-        mediana_humedades_unidades_sec = (humedades_unidades_sec[(cantidad_datos_correctos-1) / 2] + humedades_unidades_sec[((cantidad_datos_correctos-1) / 2) + 1]) / 2.0;  
-    
-    else  
-        mediana_humedades_unidades_sec = humedades_unidades_sec[(cantidad_datos_correctos-1) / 2];
+        /**
+         *  Se agrega la mediana obtenida al historial de la variable ambiental, que corresponde a
+         *  la zona principal.
+         */
+        if(zona == 0)
+        {
+            historial_sensores_agregar_muestra(HISTORIAL_CO2_AMB, mediana_nivel_CO2_unidades_sec);
+        }
+    }
+}
 
 
-    /**
-     *  Se le pasa la mediana del array de datos obtenido a la MEF de control de variables ambientales.
-     */
-    mef_var_amb_set_hum_amb_value(mediana_humedades_unidades_sec);
 
-    /**
-     *  Se libera el puntero creado.
-     */
-    ERROR_HUM: ;
-    free(humedades_unidades_sec);
+/**
+ * @brief   Función que determina si un dato que llegó a un tópico de las unidades secundarias afecta
+ *          a una zona, es decir, si alguna de las unidades secundarias de la zona publica en dicho tópico.
+ * 
+ * @param topicos_unidades  Lista de tópicos de la variable ambiental de cada unidad secundaria.
+ * @param topico            Tópico al que llegó el dato (si es NULL, se consideran afectadas todas las zonas).
+ * @param zona              Número de zona.
+ * @return true     El dato afecta a la zona.
+ * @return false    El dato no afecta a la zona.
+ */
+static bool ZonaAfectadaPorTopico(const char topicos_unidades[][100], const char *topico, unsigned int zona)
+{
+    if(topico == NULL)
+    {
+        return 1;
+    }
+
+    for(int i = 0; i < AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS; i++)
+    {
+        if(aux_control_var_amb_zona_unidades[i] == zona && !strcmp(topicos_unidades[i], topico))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
 }
 
 
 
 /**
- *  @brief  Función de callback que se ejecuta cuando se completa una nueva medición de
- *          CO2 de alguno de los sensores de CO2 de las unidades secundarias.
+ * @brief   Función que obtiene la mediana de los datos de una variable ambiental de las unidades secundarias
+ *          de una zona, descartando aquellos datos que tengan el código de error de sensado.
  * 
- * @param pvParameters 
+ * @param topicos_unidades  Lista de tópicos de la variable ambiental de cada unidad secundaria.
+ * @param codigo_error      Código de error de sensado de la variable ambiental.
+ * @param zona              Número de zona.
+ * @param mediana           Variable donde se guardará la mediana obtenida.
+ * @return true     Se obtuvo la mediana.
+ * @return false    No hubo ningún dato correcto en la zona.
  */
-static void CallbackGetCO2AmbData(void *pvParameters)
+static bool ObtenerMedianaZona(const char topicos_unidades[][100], float codigo_error, unsigned int zona, float *mediana)
 {
     /**
-     *  Se inicializa un array dinámico en donde se irán guardando los datos de
-     *  CO2 ambiente sensados por cada una de las unidades secundarias,
+     *  Array en donde se irán guardando los datos correctos de las unidades secundarias de la zona,
      *  para luego obtener la mediana del mismo.
      */
-    CO2_sensor_ppm_t *nivel_CO2_unidades_sec = NULL;
+    float datos_unidades_sec[AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS];
 
     /**
      *  Variable que representa la cantidad de datos que llegan desde las unidades secundarias
-     *  que son considerados como correctos, esto es, que no tienen el código de error 
-     *  "CODIGO_ERROR_SENSOR_CO2".
+     *  que son considerados como correctos, esto es, que no tienen el código de error.
      */
     unsigned int cantidad_datos_correctos = 0;
 
     /**
-     *  Se obtienen los datos de temperatura ambiente de cada una de las unidades secundarias.
+     *  Se obtienen los datos de cada una de las unidades secundarias de la zona.
      */
-    for(int i = 1; i <= AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS; i++)
+    for(int i = 0; i < AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS; i++)
     {
-        CO2_sensor_ppm_t buffer = CODIGO_ERROR_SENSOR_CO2;
-        mqtt_get_float_data_from_topic(aux_control_var_amb_topicos_datos_co2[i-1], &buffer);
-        ESP_LOGW(aux_control_var_amb_tag, "NEW CO2 VALUE: %.3f", buffer);
+        if(aux_control_var_amb_zona_unidades[i] != zona)
+        {
+            continue;
+        }
+
+        float buffer = codigo_error;
+        mqtt_get_float_data_from_topic(topicos_unidades[i], &buffer);
+        ESP_LOGW(aux_control_var_amb_tag, "NEW VALUE %s: %.3f", topicos_unidades[i], buffer);
 
         /**
          *  Se controla que el dato obtenido no tenga el código de error, en caso de que sí, 
          *  no se considera dicho dato para el posterior cálculo de la mediana.
          */
-        if(buffer != CODIGO_ERROR_SENSOR_CO2)
+        if(buffer != codigo_error)
         {
-            if(nivel_CO2_unidades_sec == NULL)
-            {
-                nivel_CO2_unidades_sec = calloc(1, sizeof(CO2_sensor_ppm_t));
-            }
-
-            else
-            {
-                nivel_CO2_unidades_sec = (CO2_sensor_ppm_t*) realloc(nivel_CO2_unidades_sec, cantidad_datos_correctos * sizeof(CO2_sensor_ppm_t));
-            }
-
-            nivel_CO2_unidades_sec[cantidad_datos_correctos] = buffer;
+            datos_unidades_sec[cantidad_datos_correctos] = buffer;
             cantidad_datos_correctos++;
         }
     }
 
-
-    /**
-     *  En caso de que no haya habido ningun dato correcto, se setea la bandera de error de sensor
-     *  y se salta hasta el final de la rutina, en donde se libera el puntero creado.
-     */
     if(cantidad_datos_correctos == 0)
     {
-        mef_var_amb_set_CO2_sensor_error_flag_value(1);
-        goto ERROR_CO2;
+        return 0;
     }
 
-    /**
-     *  En caso de que si haya algun dato correcto, se resetea la bandera de error de sensor.
-     */
-    mef_var_amb_set_CO2_sensor_error_flag_value(0);
-
     /**
      *  Se ordenan los datos obtenidos de menor a mayor.
      */
-    SortData(nivel_CO2_unidades_sec, cantidad_datos_correctos);
+    SortData(datos_unidades_sec, cantidad_datos_correctos);
 
     /**
      *  Se obtiene la mediana de los datos recopilados.
      */
-    CO2_sensor_ppm_t mediana_nivel_CO2_unidades_sec;
-
     if ( (cantidad_datos_correctos % 2) == 0 )  
-        mediana_nivel_CO2_unidades_sec = (nivel_CO2_unidades_sec[(cantidad_datos_correctos-1) / 2] + nivel_CO2_unidades_sec[((cantidad_datos_correctos-1) / 2) + 1]) / 2.0;  
+        *mediana = (datos_unidades_sec[(cantidad_datos_correctos-1) / 2] + datos_unidades_sec[((cantidad_datos_correctos-1) / 2) + 1]) / 2.0;  
     
     else  
-        mediana_nivel_CO2_unidades_sec = nivel_CO2_unidades_sec[(cantidad_datos_correctos-1) / 2];
-
+        *mediana = datos_unidades_sec[(cantidad_datos_correctos-1) / 2];
 
-    /**
-     *  Se le pasa la mediana del array de datos obtenido a la MEF de control de variables ambientales.
-     */
-    mef_var_amb_set_CO2_amb_value(mediana_nivel_CO2_unidades_sec);
-
-    /**
-     *  Se libera el puntero creado.
-     */
-    ERROR_CO2: ;
-    free(nivel_CO2_unidades_sec);
+    return 1;
 }
 
 
@@ -455,44 +489,60 @@ static void SortData(float *data_array, unsigned int cantidad_datos)
 
 /**
  *  @brief  Función de callback que se ejecuta cuando llega un mensaje al tópico MQTT
- *          correspondiente con un nuevo valor de set point de temperatura ambiente.
+ *          correspondiente con un nuevo valor de set point de temperatura ambiente de
+ *          alguna zona.
  * 
- * @param pvParameters 
+ * @param pvParameters  Nombre del tópico al que llegó el mensaje.
  */
 static void CallbackNewTempAmbSP(void *pvParameters)
 {
-    /**
-     *  Se obtiene el nuevo valor de SP de temperatura ambiente.
-     */
-    DHT11_sensor_temp_t SP_temp_amb = 0;
-    mqtt_get_float_data_from_topic(NEW_TEMP_SP_MQTT_TOPIC, &SP_temp_amb);
+    const char *topico = pvParameters;
 
-    ESP_LOGI(aux_control_var_amb_tag, "NUEVO SP: %.3f", SP_temp_amb);
+    for(unsigned int zona = 0; zona < MEF_VAR_AMB_CANT_ZONAS; zona++)
+    {
+        const mef_var_amb_zona_config_t *config = mef_var_amb_get_zona_config(zona);
 
-    /**
-     *  A partir del valor de SP de temperatura, se calculan los límites superior e inferior
-     *  utilizados por el algoritmo de control de variables ambientales, teniendo en cuenta el valor
-     *  del delta de temperatura que se estableció.
-     * 
-     *  EJEMPLO:
-     * 
-     *  SP_temp_amb = 25 °C
-     *  DELTA_TEMP = 2 °C
-     * 
-     *  LIM_SUPERIOR_TEMP_AMB = SP_temp_amb + DELTA_TEMP = 27 °C
-     *  LIM_INFERIOR_TEMP_AMB = SP_temp_amb - DELTA_TEMP = 23 °C
-     */
-    DHT11_sensor_temp_t limite_inferior_temp_amb, limite_superior_temp_amb;
-    limite_inferior_temp_amb = SP_temp_amb - mef_var_amb_get_delta_temp();
-    limite_superior_temp_amb = SP_temp_amb + mef_var_amb_get_delta_temp();
+        if(topico != NULL && strcmp(topico, config->topico_sp_temp))
+        {
+            continue;
+        }
 
-    /**
-     *  Se actualizan los límites superior e inferior de temperatura ambiente en la MEF.
-     */
-    mef_var_amb_set_temp_control_limits(limite_inferior_temp_amb, limite_superior_temp_amb);
+        /**
+         *  Se obtiene el nuevo valor de SP de temperatura ambiente.
+         */
+        DHT11_sensor_temp_t SP_temp_amb = 0;
+        mqtt_get_float_data_from_topic(config->topico_sp_temp, &SP_temp_amb);
+
+        ESP_LOGI(aux_control_var_amb_tag, "%s - NUEVO SP: %.3f", config->nombre, SP_temp_amb);
 
-    ESP_LOGI(aux_control_var_amb_tag, "LIMITE INFERIOR TEMP AMB: %.3f", limite_inferior_temp_amb);
-    ESP_LOGI(aux_control_var_amb_tag, "LIMITE SUPERIOR TEMP AMB: %.3f", limite_superior_temp_amb);
+        /**
+         *  A partir del valor de SP de temperatura, se calculan los límites superior e inferior
+         *  utilizados por el algoritmo de control de variables ambientales, teniendo en cuenta el valor
+         *  del delta de temperatura que se estableció.
+         * 
+         *  EJEMPLO:
+         * 
+         *  SP_temp_amb = 25 °C
+         *  DELTA_TEMP = 2 °C
+         * 
+         *  LIM_SUPERIOR_TEMP_AMB = SP_temp_amb + DELTA_TEMP = 27 °C
+         *  LIM_INFERIOR_TEMP_AMB = SP_temp_amb - DELTA_TEMP = 23 °C
+         */
+        DHT11_sensor_temp_t delta_temp = 0;
+        mef_var_amb_get_delta_temp(zona, &delta_temp);
+
+        DHT11_sensor_temp_t limite_inferior_temp_amb, limite_superior_temp_amb;
+        limite_inferior_temp_amb = SP_temp_amb - delta_temp;
+        limite_superior_temp_amb = SP_temp_amb + delta_temp;
+
+        /**
+         *  Se actualizan los límites superior e inferior de temperatura ambiente en la MEF.
+         */
+        mef_var_amb_set_temp_control_limits(zona, limite_inferior_temp_amb, limite_superior_temp_amb);
+
+        ESP_LOGI(aux_control_var_amb_tag, "LIMITE INFERIOR TEMP AMB: %.3f", limite_inferior_temp_amb);
+        ESP_LOGI(aux_control_var_amb_tag, "LIMITE SUPERIOR TEMP AMB: %.3f", limite_superior_temp_amb);
+    }
 }
 
 //==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
@@ -517,28 +567,43 @@ esp_err_t aux_control_var_amb_init(esp_mqtt_client_handle_t mqtt_client)
      *  Se inicializa el array con los tópicos MQTT a suscribirse, junto
      *  con las funciones callback correspondientes que serán ejecutadas
      *  al llegar un nuevo dato en el tópico.
+     * 
+     *  Se suscribe a los tópicos de datos de cada unidad secundaria y a los
+     *  tópicos de comando de cada zona.
      */
-    mqtt_topic_t list_of_topics[] = {
-        [0].topic_name = NEW_TEMP_SP_MQTT_TOPIC,
-        [0].topic_function_cb = CallbackNewTempAmbSP,
-        [1].topic_name = VAR_AMB_MANUAL_MODE_MQTT_TOPIC,
-        [1].topic_function_cb = CallbackManualMode,
-        [2].topic_name = MANUAL_MODE_VENTILADORES_STATE_MQTT_TOPIC,
-        [2].topic_function_cb = CallbackManualModeNewActuatorState,
-        [3].topic_name = MANUAL_MODE_CALEFACCION_STATE_MQTT_TOPIC,
-        [3].topic_function_cb = CallbackManualModeNewActuatorState,
-        [4].topic_name = TEMP_AMB_MQTT_TOPIC,
-        [4].topic_function_cb = CallbackGetTempAmbData,
-        [5].topic_name = HUM_AMB_MQTT_TOPIC,
-        [5].topic_function_cb = CallbackGetHumAmbData,
-        [6].topic_name = CO2_AMB_MQTT_TOPIC,
-        [6].topic_function_cb = CallbackGetCO2AmbData,
-    };
+    mqtt_topic_t list_of_topics[3 * AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS + 5 * MEF_VAR_AMB_CANT_ZONAS];
+    unsigned int cantidad_topicos = 0;
+
+    for(int i = 0; i < AUX_CONTROL_VAR_AMB_CANT_UNIDADES_SECUNDARIAS; i++)
+    {
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", aux_control_var_amb_topicos_datos_temp[i]);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackGetTempAmbData;
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", aux_control_var_amb_topicos_datos_hum[i]);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackGetHumAmbData;
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", aux_control_var_amb_topicos_datos_co2[i]);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackGetCO2AmbData;
+    }
+
+    for(unsigned int zona = 0; zona < MEF_VAR_AMB_CANT_ZONAS; zona++)
+    {
+        const mef_var_amb_zona_config_t *config = mef_var_amb_get_zona_config(zona);
+
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", config->topico_sp_temp);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackNewTempAmbSP;
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", config->topico_modo);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackManualMode;
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", config->topico_modo_manual_ventiladores);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackManualModeNewActuatorState;
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", config->topico_modo_manual_calefaccion);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackManualModeNewActuatorState;
+        snprintf(list_of_topics[cantidad_topicos].topic_name, sizeof(list_of_topics[0].topic_name), "%s", config->topico_tipo_control);
+        list_of_topics[cantidad_topicos++].topic_function_cb = CallbackTipoControl;
+    }
 
     /**
      *  Se realiza la suscripción a los tópicos MQTT y la asignación de callbacks correspondientes.
      */
-    if(mqtt_suscribe_to_topics(list_of_topics, 7, Cliente_MQTT, 0) != ESP_OK)
+    if(mqtt_suscribe_to_topics(list_of_topics, cantidad_topicos, Cliente_MQTT, 0) != ESP_OK)
     {
         ESP_LOGE(aux_control_var_amb_tag, "FAILED TO SUSCRIBE TO MQTT TOPICS.");
         return ESP_FAIL;
@@ -26,6 +26,7 @@ extern "C" {
  */
 #define NEW_TEMP_SP_MQTT_TOPIC   "NodeRed/Sensores ambientales/Temperatura/SP"
 #define VAR_AMB_MANUAL_MODE_MQTT_TOPIC  "/VarAmb/Modo"
+#define VAR_AMB_TIPO_CONTROL_MQTT_TOPIC  "/VarAmb/Tipo_Control"
 #define MANUAL_MODE_VENTILADORES_STATE_MQTT_TOPIC    "/VarAmb/Modo_Manual/Ventiladores"
 #define MANUAL_MODE_CALEFACCION_STATE_MQTT_TOPIC   "/VarAmb/Modo_Manual/Calefaccion"
 #define VENTILADORES_STATE_MQTT_TOPIC   "Actuadores/Ventiladores"
@@ -1,8 +1,9 @@
 /**
  * @file CO2_SENSOR.c
  * @author Franco Bisciglia, David Kündinger
- * @brief   Librería mediante la cual se obtienen datos del sensor MH-Z19C de CO2. Dichos datos consisten en pulsos PWM, cuyo ancho
- *          varía de forma directamente proporcional a la concentración de CO2 en el ambiente.
+ * @brief   Librería mediante la cual se obtienen datos del sensor de CO2. El sensor puede ser el MH-Z19C mediante su salida PWM,
+ *          cuyos pulsos varían su ancho de forma directamente proporcional a la concentración de CO2 en el ambiente, o alguno
+ *          de los sensores digitales soportados (ver "CO2_SENSOR_DIGITAL.c").
  * @version 0.1
  * @date 2022-12-29
  * 
@@ -27,6 +28,8 @@
 #include "esp_check.h"
 
 #include "CO2_SENSOR.h"
+#include "CO2_SENSOR_BACKEND.h"
+#include "DECODIFICADOR_PWM_CO2.h"
 
 //==================================| MACROS AND TYPDEF |==================================//
 
@@ -37,6 +40,21 @@
  */
 #define warm_up_expired(start, len) ((esp_timer_get_time() - (start)) >= (len * 1000000))
 
+/**
+ *  Tiempo de calentamiento del MH-Z19C cuando se lo lee por PWM, en segundos. La salida PWM no permite
+ *  detectar el fin del calentamiento, por lo que se utiliza el tiempo de precalentamiento de la hoja de datos.
+ */
+#define CO2_SENSOR_PWM_TIEMPO_CALENTAMIENTO_SEG     60
+
+/* Cantidad de flancos que puede almacenar el buffer circular de captura (potencia de 2). */
+#define CO2_SENSOR_CANT_FLANCOS_BUFFER  32
+
+/**
+ *  Tiempo máximo de espera de un resultado, en milisegundos. Se considera un período adicional
+ *  al de los períodos promediados, ya que el primer flanco ascendente solo inicia un período.
+ */
+#define CO2_SENSOR_TIMEOUT_MS           ((CO2_SENSOR_PERIODOS_PROMEDIO + 1) * 1060)
+
 //==================================| INTERNAL DATA DEFINITION |==================================//
 
 /* Tag para imprimir información en el LOG. */
@@ -51,32 +69,83 @@ static TaskHandle_t xCO2TaskHandle = NULL;
 /* Puntero a función que apuntará a la función callback pasada como argumento en la función de configuración de callback. */
 CO2SensorCallbackFunction CO2SensorCallback = NULL;
 
-/* Bandera para verificar si se obtuvo un pulso de PWM desde el sensor de CO2 */
-static bool CO2_interr_flag = 0;
+/* Variable en donde se guarda el último valor de CO2 obtenido. */
+static CO2_sensor_ppm_t CO2_ppm = 0;
 
-/* Variable en donde se guarda el valor de CO2 obtenido por PWM. */
-static CO2_sensor_ppm_t CO2_ppm_pwm = 0;
-
-/* Variable utilizada para controlar el tiempo de calentamiento del sensor de CO2. */
+/* Variable utilizada para controlar el tiempo de calentamiento del sensor de CO2 leído por PWM. */
 int64_t CO2_warm_up_time_start = 0;
 
+/**
+ *  Bandera que indica si el sensor se está calentando. Se actualiza desde la tarea del sensor luego de
+ *  cada medición, consultando al backend, y una vez que el sensor está listo no vuelve a consultarse.
+ */
+static volatile bool CO2_calentando = 1;
+
+/* Backend correspondiente al tipo de sensor configurado. */
+static const CO2_sensor_backend_t *CO2_backend = NULL;
+
+/**
+ *  Buffer circular donde la rutina de interrupción guarda los flancos de la señal PWM con su marca
+ *  de tiempo. La rutina de interrupción solo escribe "CO2_flanco_escritura", y la tarea solo
+ *  escribe "CO2_flanco_lectura".
+ */
+static co2_pwm_flanco_t CO2_buffer_flancos[CO2_SENSOR_CANT_FLANCOS_BUFFER];
+static volatile uint32_t CO2_flanco_escritura = 0;
+static volatile uint32_t CO2_flanco_lectura = 0;
+
+/* Bandera que indica que se perdieron flancos por estar lleno el buffer circular. */
+static volatile bool CO2_buffer_desbordado = 0;
+
+/* Cantidad de flancos ascendentes recibidos desde el último aviso a la tarea. */
+static uint8_t CO2_flancos_ascendentes = 0;
+
+/**
+ *  Cantidad de flancos ascendentes necesarios para el próximo aviso a la tarea. El primer aviso luego
+ *  del arranque o de un error requiere un flanco más, ya que el primer flanco ascendente solo inicia un
+ *  período. Luego, el decodificador conserva el último flanco, y cada flanco ascendente cierra un período.
+ */
+static uint8_t CO2_flancos_necesarios = CO2_SENSOR_PERIODOS_PROMEDIO + 1;
+
+/* Spinlock para proteger el buffer circular entre la rutina de interrupción y la tarea. */
+static portMUX_TYPE CO2_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Decodificador de la señal PWM del sensor. */
+static co2_pwm_decodificador_t CO2_decodificador;
+
 //==================================| EXTERNAL DATA DEFINITION |==================================//
 
 //==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
 
-static void vTaskGetCO2ByPWM(void *pvParameters);
+static void vTaskGetCO2(void *pvParameters);
 static void co2_sensor_isr_handler(void *args);
+static esp_err_t CO2PwmInit(const CO2_sensor_config_t *config);
+static esp_err_t CO2PwmObtenerMedicion(CO2_sensor_ppm_t *ppm);
+static bool CO2PwmCalentando(void);
+static void CO2PwmReiniciarDecodificador(void);
+
+/* Backend del MH-Z19C leído mediante su salida PWM. */
+static const CO2_sensor_backend_t CO2_sensor_backend_pwm = {
+    .nombre = "PWM",
+    .init = CO2PwmInit,
+    .obtener_medicion = CO2PwmObtenerMedicion,
+    .calentando = CO2PwmCalentando,
+};
 
 //==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
 
 /**
- * @brief   Rutina de servicio de interrupción de GPIO, mediante la cual se controla la lectura de flancos
- *          del pulso de PWM del sensor de CO2.
+ * @brief   Rutina de servicio de interrupción de GPIO, que se ejecuta en ambos flancos del pulso de PWM del
+ *          sensor de CO2. Se guarda el flanco con su marca de tiempo en el buffer circular, de modo que la
+ *          medición no dependa de la latencia del scheduler, y se avisa a la tarea recién cuando se
+ *          completaron los períodos necesarios para un resultado.
  * 
  * @param args  Parámetros pasados a la rutina de servicios de interrupción de GPIO.
  */
 static void co2_sensor_isr_handler(void *args)
 {
+    int64_t tiempo = esp_timer_get_time();
+    bool nivel = gpio_get_level(CO2_SENSOR_PWM_PIN);
+
     /**
      *  Esta variable sirve para que, en el caso de que un llamado a "xTaskNotifyFromISR()" desbloquee
      *  una tarea de mayor prioridad que la que estaba corriendo justo antes de entrar en la rutina
@@ -86,13 +155,44 @@ static void co2_sensor_isr_handler(void *args)
     BaseType_t xHigherPriorityTaskWoken;
     xHigherPriorityTaskWoken = pdFALSE;
 
+    portENTER_CRITICAL_ISR(&CO2_spinlock);
+
     /**
-     *  Enviamos un Task Notify a la tarea de obtención de nivel de CO2, para que continúe con su
-     *  rutina de conversión. Además, seteamos la bandera para que dicha tarea pueda saber que 
-     *  efectivamente ocurrió la interrupción y no hubo timeout.
+     *  Si el buffer circular está lleno, se descarta el flanco y se indica el desborde, para que la
+     *  tarea descarte el período en curso.
      */
-    vTaskNotifyGiveFromISR(xCO2TaskHandle, &xHigherPriorityTaskWoken);
-    CO2_interr_flag = 1;
+    if(CO2_flanco_escritura - CO2_flanco_lectura >= CO2_SENSOR_CANT_FLANCOS_BUFFER)
+    {
+        CO2_buffer_desbordado = 1;
+    }
+
+    else
+    {
+        co2_pwm_flanco_t *flanco = &CO2_buffer_flancos[CO2_flanco_escritura % CO2_SENSOR_CANT_FLANCOS_BUFFER];
+        flanco->tiempo_us = tiempo;
+        flanco->nivel = nivel;
+        CO2_flanco_escritura++;
+    }
+
+    /**
+     *  Cada flanco ascendente cierra un período de la señal PWM. Recién cuando se completaron los
+     *  períodos que se promedian para obtener un resultado, se envía un Task Notify a la tarea.
+     */
+    bool avisar = 0;
+
+    if(nivel && ++CO2_flancos_ascendentes >= CO2_flancos_necesarios)
+    {
+        CO2_flancos_ascendentes = 0;
+        CO2_flancos_necesarios = CO2_SENSOR_PERIODOS_PROMEDIO;
+        avisar = 1;
+    }
+
+    portEXIT_CRITICAL_ISR(&CO2_spinlock);
+
+    if(avisar)
+    {
+        vTaskNotifyGiveFromISR(xCO2TaskHandle, &xHigherPriorityTaskWoken);
+    }
 
     /**
      *  Devolvemos el procesador a la tarea que corresponda. En el caso de que xHigherPriorityTaskWoken = pdTRUE,
@@ -104,160 +204,233 @@ static void co2_sensor_isr_handler(void *args)
 
 
 /**
- * @brief   Tarea encargada de obtener una medición de CO2 en ppm del sensor de CO2.
- * 
- * @param pvParameters  Parámetros pasados a la tarea en su creación.
+ * @brief   Función para inicializar el backend PWM, configurando el GPIO de la salida PWM del sensor
+ *          y su interrupción.
+ *
+ * @param config    Configuración del sensor.
+ * @return esp_err_t
  */
-static void vTaskGetCO2ByPWM(void *pvParameters)
+static esp_err_t CO2PwmInit(const CO2_sensor_config_t *config)
 {
-    while(1)
-    {
-        CO2_interr_flag = 0;
+    /**
+     *  Se guarda el inicio del conteo de tiempo de calentamiento del sensor.
+     * 
+     */
+    CO2_warm_up_time_start = esp_timer_get_time();
+
+    /**
+     *  Se guarda el número de pin correspondiente al del PWM del sensor de CO2.
+     */
+    CO2_SENSOR_PWM_PIN = config->pin_pwm;
 
-        //========================| MEDICIÓN PULSO EN ALTO |===========================//
+    co2_pwm_decodificador_init(&CO2_decodificador, CO2_SENSOR_RANGO_PPM, CO2_SENSOR_PERIODOS_PROMEDIO);
 
-        /**
-         *  Se configura la interrupción por flanco ascendente en el pin correspondiente
-         *  al PWM del sensor de CO2, de modo de detectar el inicio del pulso en alto
-         *  de la señal PWM.
-         */
-        gpio_set_intr_type(CO2_SENSOR_PWM_PIN, GPIO_INTR_POSEDGE);
-        gpio_intr_enable(CO2_SENSOR_PWM_PIN);
 
 
-        /**
-         *  Se espera a recibir un Task Notify desde la rutina de interrupción. En caso
-         *  de que se cumpla el tiempo de timeout, se procede a lanzar un mensaje de
-         *  error de timeout, se saltea el proceso hasta el final (error_tag), donde
-         *  se ejecuta la función de callback, y se le carga al valor de CO2 el código 
-         *  de error definido.
-         */
-        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1060));
-        
-        if(!CO2_interr_flag)
-        {
-            CO2_ppm_pwm = CO2_SENSOR_MEASURE_ERROR;
-            ESP_LOGE(TAG, "TIMEOUT ERROR: Didn't get any high pulse PWM signal.");
-            goto error_tag;
-        }
+    //========================| CONFIGURACIÓN DE GPIO |===========================//
 
-        CO2_interr_flag = 0;
+    /* Variable donde se definen las configuraciones para el GPIO */
+    gpio_config_t pGPIOConfig;
 
+    /* Se define mediante mascara de bits el GPIO que configuraremos */
+    pGPIOConfig.pin_bit_mask = (1ULL << CO2_SENSOR_PWM_PIN);
+    /* Se define si el pin es I u O (input en este caso) */
+    pGPIOConfig.mode = GPIO_MODE_DEF_INPUT;
+    /* Habilitamos o deshabilitamos la resistencia interna de pull-up (deshabilitada en este caso) */
+    pGPIOConfig.pull_up_en = GPIO_PULLUP_DISABLE;
+    /* Habilitamos o deshabilitamos la resistencia interna de pull-down (deshabilitada en este caso) */
+    pGPIOConfig.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    /* Definimos si habilitamos la interrupción, y si es asi, de qué tipo (inicialmente, deshabilitada) */
+    pGPIOConfig.intr_type = GPIO_INTR_DISABLE;
+    
+    /**
+     *  Función para configurar un pin GPIO, incluyendo la interrupción. 
+     *  Se le pasa como parametro un puntero a la variable configurada anteriormente
+     */
+    ESP_RETURN_ON_ERROR(gpio_config(&pGPIOConfig), TAG, "Failed to load gpio config.");
 
-        /**
-         *  Se crea una variable donde se guardará el tiempo actual que lleva corriendo
-         *  el programa, para luego medir el ancho del pulso en alto como diferencia de 
-         *  tiempos.
-         */
-        int64_t high_time_start;
-        high_time_start = esp_timer_get_time();
+    /**
+     *  Mediante esta función, se habilita el servicio mediante el cual se tienen flags globales individuales
+     *  para cada GPIO con interrupción, en vez de tener una unica flag global para todas las interrupciones.
+     *  El 0 es para instanciar las flags en 0. Si el servicio ya fue instalado por otro módulo, se
+     *  obtiene ESP_ERR_INVALID_STATE, que no es un error.
+     */
+    esp_err_t err = gpio_install_isr_service(0);
 
+    if(err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Failed to install ISR.");
+        return err;
+    }
 
-        /**
-         *  Se configura la interrupción por flanco descendente en el pin correspondiente
-         *  al PWM del sensor de CO2, de modo de detectar el fin del pulso en alto
-         *  de la señal PWM.
-         */
-        gpio_set_intr_type(CO2_SENSOR_PWM_PIN, GPIO_INTR_NEGEDGE);
+    /**
+     *  Funcion para agregar efectivamente una interrupcion a un GPIO, junto con su handler.
+     */
+    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(CO2_SENSOR_PWM_PIN, co2_sensor_isr_handler, NULL), 
+                        TAG, "Failed to add the ISR handler.");
 
+    return ESP_OK;
+}
 
-       /**
-         *  Se espera a recibir un Task Notify desde la rutina de interrupción. En caso
-         *  de que se cumpla el tiempo de timeout, se procede a lanzar un mensaje de
-         *  error de timeout, se saltea el proceso hasta el final (error_tag), donde
-         *  se ejecuta la función de callback, y se le carga al valor de CO2 el código 
-         *  de error definido.
-         */
-        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1060));
 
-        if(!CO2_interr_flag)
-        {
-            CO2_ppm_pwm = CO2_SENSOR_MEASURE_ERROR;
-            ESP_LOGE(TAG, "TIMEOUT ERROR: Didn't get any high pulse PWM signal.");
-            goto error_tag;
-        }
 
-        CO2_interr_flag = 0;
+/**
+ * @brief   Función para descartar el período en curso y las muestras acumuladas en el decodificador, de modo
+ *          que el próximo aviso de la rutina de interrupción incluya el flanco que vuelve a sincronizarlo.
+ */
+static void CO2PwmReiniciarDecodificador(void)
+{
+    co2_pwm_decodificador_reset(&CO2_decodificador);
 
+    portENTER_CRITICAL(&CO2_spinlock);
+    CO2_flancos_ascendentes = 0;
+    CO2_flancos_necesarios = CO2_SENSOR_PERIODOS_PROMEDIO + 1;
+    portEXIT_CRITICAL(&CO2_spinlock);
+}
 
-        /**
-         *  Variable correspondiente al tiempo en alto del pulso PWM del sensor
-         *  de CO2.
-         */
-        int64_t th = 0;
-        th = esp_timer_get_time() - high_time_start;
 
-        
 
-        //========================| MEDICIÓN PULSO EN BAJO |===========================//
+/**
+ * @brief   Función para obtener una medición de CO2 decodificando los flancos capturados por la rutina
+ *          de interrupción. Se bloquea hasta completar los períodos necesarios para un resultado.
+ *
+ * @param ppm   Variable donde se guardará la concentración de CO2.
+ * @return esp_err_t    ESP_ERR_TIMEOUT si no se recibió la señal PWM del sensor.
+ */
+static esp_err_t CO2PwmObtenerMedicion(CO2_sensor_ppm_t *ppm)
+{
+    /**
+     *  La interrupción en ambos flancos se habilita en la primera medición, ya que la rutina de
+     *  interrupción necesita el handle de la tarea, y queda habilitada de forma permanente.
+     */
+    static bool interrupcion_habilitada = 0;
 
+    if(!interrupcion_habilitada)
+    {
+        gpio_set_intr_type(CO2_SENSOR_PWM_PIN, GPIO_INTR_ANYEDGE);
+        gpio_intr_enable(CO2_SENSOR_PWM_PIN);
+        interrupcion_habilitada = 1;
+    }
+
+    while(1)
+    {
         /**
-         *  Se crea una variable donde se guardará el tiempo actual que lleva corriendo
-         *  el programa, para luego medir el ancho del pulso en bajo como diferencia de 
-         *  tiempos.
+         *  Se espera a que la rutina de interrupción avise que se completaron los períodos necesarios
+         *  para un resultado.
          */
-        int64_t low_time_start;
-        low_time_start = esp_timer_get_time();
-        
+        if(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CO2_SENSOR_TIMEOUT_MS)) == 0)
+        {
+            CO2PwmReiniciarDecodificador();
+            ESP_LOGE(TAG, "TIMEOUT ERROR: Didn't get any PWM signal.");
+            return ESP_ERR_TIMEOUT;
+        }
+
         /**
-         *  Se configura la interrupción por flanco descendente en el pin correspondiente
-         *  al PWM del sensor de CO2, de modo de detectar el fin del pulso en alto
-         *  de la señal PWM.
+         *  Si se perdieron flancos, se descarta el período en curso y las muestras acumuladas.
          */
-        gpio_set_intr_type(CO2_SENSOR_PWM_PIN, GPIO_INTR_POSEDGE);
-
+        if(CO2_buffer_desbordado)
+        {
+            CO2_buffer_desbordado = 0;
+            CO2PwmReiniciarDecodificador();
+            ESP_LOGW(TAG, "Edge buffer overflow, discarding partial measurement.");
+        }
 
         /**
-         *  Se espera a recibir un Task Notify desde la rutina de interrupción. En caso
-         *  de que se cumpla el tiempo de timeout, se procede a lanzar un mensaje de
-         *  error de timeout, se saltea el proceso hasta el final (error_tag), donde
-         *  se ejecuta la función de callback, y se le carga al valor de CO2 el código 
-         *  de error definido.
+         *  Se procesan todos los flancos disponibles en el buffer circular.
          */
-        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1060));
+        bool nuevo_resultado = 0;
+        float resultado = 0;
 
-        if(!CO2_interr_flag)
+        while(1)
         {
-            CO2_ppm_pwm = CO2_SENSOR_MEASURE_ERROR;
-            ESP_LOGE(TAG, "TIMEOUT ERROR: Didn't get any low pulse PWM signal.");
-            goto error_tag;
-        }
+            co2_pwm_flanco_t flanco;
+
+            portENTER_CRITICAL(&CO2_spinlock);
+
+            if(CO2_flanco_lectura == CO2_flanco_escritura)
+            {
+                portEXIT_CRITICAL(&CO2_spinlock);
+                break;
+            }
 
-        CO2_interr_flag = 0;
+            flanco = CO2_buffer_flancos[CO2_flanco_lectura % CO2_SENSOR_CANT_FLANCOS_BUFFER];
+            CO2_flanco_lectura++;
 
+            portEXIT_CRITICAL(&CO2_spinlock);
+
+            if(co2_pwm_decodificador_procesar_flanco(&CO2_decodificador, &flanco, &resultado))
+            {
+                nuevo_resultado = 1;
+            }
+        }
 
         /**
-         *  Variable correspondiente al tiempo en bajo del pulso PWM del sensor
-         *  de CO2.
+         *  Si se descartaron períodos fuera de tolerancia, puede no haber un resultado disponible
+         *  todavía, y se espera el próximo aviso.
          */
-        int64_t tl = 0;
-        tl = esp_timer_get_time() - low_time_start;
+        if(nuevo_resultado)
+        {
+            *ppm = resultado;
+            return ESP_OK;
+        }
+    }
+}
 
 
 
-        //========================| OBTENCIÓN DE VALOR DE CO2 |===========================//
+/**
+ * @brief   Función que indica si el sensor leído por PWM se está calentando.
+ *
+ * @return true     Calentamiento en curso.
+ * @return false    Calentamiento terminado.
+ */
+static bool CO2PwmCalentando(void)
+{
+    return !warm_up_expired(CO2_warm_up_time_start, CO2_SENSOR_PWM_TIEMPO_CALENTAMIENTO_SEG);
+}
 
+
+
+/**
+ * @brief   Tarea encargada de obtener las mediciones de CO2 en ppm mediante el backend configurado.
+ * 
+ * @param pvParameters  Parámetros pasados a la tarea en su creación.
+ */
+static void vTaskGetCO2(void *pvParameters)
+{
+    while(1)
+    {
         /**
-         *  A partir de los tiempos en alto y en bajo del pulso PWM, se obtiene el valor
-         *  de CO2 en ppm.
+         *  Se espera una nueva medición del sensor. En caso de error, se le carga al valor de CO2 el
+         *  código de error definido, y se ejecuta igualmente la función de callback.
          */
-        CO2_ppm_pwm = 5000 * (th - 2) / (th + tl - 4);
+        CO2_sensor_ppm_t ppm;
+        esp_err_t err = CO2_backend->obtener_medicion(&ppm);
+
+        if(err == ESP_OK)
+        {
+            CO2_ppm = ppm;
+        }
+
+        else
+        {
+            CO2_ppm = CO2_SENSOR_MEASURE_ERROR;
+            ESP_LOGE(TAG, "Failed to get %s CO2 measurement (%s).", CO2_backend->nombre, esp_err_to_name(err));
+        }
 
-        
         /**
-         *  Etiqueta que se utiliza como forma de retorno de ejecución parcial de la rutina,
-         *  es decir, para casos en los que, por ejemplo, se cumplió el timeout de espera
-         *  de la respuesta del sensor, y por lo tanto no se debe continuar con la ejecución
-         *  de la rutina, sino que se debe volver a comenzar.
+         *  Se consulta al backend si terminó el calentamiento del sensor, hasta que esté listo.
          */
-        error_tag: ;
-
+        if(CO2_calentando)
+        {
+            CO2_calentando = CO2_backend->calentando();
+        }
 
         /**
          *  Se ejecuta la función callback configurada, verificando anteriormente que ya
          *  haya pasado el tiempo de calentamiento del sensor.
          */
-        if(CO2SensorCallback != NULL && !CO2_sensor_is_warming_up())
+        if(CO2SensorCallback != NULL && !CO2_calentando)
         {
             CO2SensorCallback(NULL);
         }
@@ -269,68 +442,79 @@ static void vTaskGetCO2ByPWM(void *pvParameters)
 //==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
 
 /**
- * @brief   Función para inicializar el sensor de CO2.
+ * @brief   Función para inicializar el sensor de CO2 leído mediante su salida PWM.
  * 
  * @param CO2_sens_pwm_pin  GPIO del pin de PWM del sensor de CO2.
  * @return esp_err_t 
  */
 esp_err_t CO2_sensor_init(CO2_sensor_pwm_pin_t CO2_sens_pwm_pin)
 {
-    /**
-     *  Se guarda el inicio del conteo de tiempo de calentamiento del sensor.
-     * 
-     */
-    CO2_warm_up_time_start = esp_timer_get_time();
+    CO2_sensor_config_t config = {
+        .backend = CO2_SENSOR_BACKEND_PWM,
+        .pin_pwm = CO2_sens_pwm_pin,
+    };
 
-    /**
-     *  Se guarda el número de pin correspondiente al del PWM del sensor de CO2.
-     */
-    CO2_SENSOR_PWM_PIN = CO2_sens_pwm_pin;
+    return CO2_sensor_init_with_config(&config);
+}
 
 
 
-    //========================| CONFIGURACIÓN DE GPIO |===========================//
+/**
+ * @brief   Función para inicializar el sensor de CO2 con el tipo de sensor indicado en la configuración.
+ * 
+ * @param config    Configuración del sensor.
+ * @return esp_err_t 
+ */
+esp_err_t CO2_sensor_init_with_config(const CO2_sensor_config_t *config)
+{
+    if(config == NULL || CO2_backend != NULL)
+    {
+        return (config == NULL) ? ESP_ERR_INVALID_ARG : ESP_ERR_INVALID_STATE;
+    }
 
-    /* Variable donde se definen las configuraciones para el GPIO */
-    gpio_config_t pGPIOConfig;
+    switch(config->backend)
+    {
 
-    /* Se define mediante mascara de bits el GPIO que configuraremos */
-    pGPIOConfig.pin_bit_mask = (1ULL << CO2_sens_pwm_pin);
-    /* Se define si el pin es I u O (input en este caso) */
-    pGPIOConfig.mode = GPIO_MODE_DEF_INPUT;
-    /* Habilitamos o deshabilitamos la resistencia interna de pull-up (deshabilitada en este caso) */
-    pGPIOConfig.pull_up_en = GPIO_PULLUP_DISABLE;
-    /* Habilitamos o deshabilitamos la resistencia interna de pull-down (deshabilitada en este caso) */
-    pGPIOConfig.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    /* Definimos si habilitamos la interrupción, y si es asi, de qué tipo (inicialmente, deshabilitada) */
-    pGPIOConfig.intr_type = GPIO_INTR_DISABLE;
-    
-    /**
-     *  Función para configurar un pin GPIO, incluyendo la interrupción. 
-     *  Se le pasa como parametro un puntero a la variable configurada anteriormente
-     */
-    ESP_RETURN_ON_ERROR(gpio_config(&pGPIOConfig), TAG, "Failed to load gpio config.");
+    case CO2_SENSOR_BACKEND_PWM:
+        CO2_backend = &CO2_sensor_backend_pwm;
+        break;
 
-    /**
-     *  Mediante esta función, se habilita el servicio mediante el cual se tienen flags globales individuales
-     *  para cada GPIO con interrupción, en vez de tener una unica flag global para todas las interrupciones.
-     *  El 0 es para instanciar las flags en 0.
-     */
-    ESP_RETURN_ON_ERROR(gpio_install_isr_service(0), TAG, "Failed to install ISR.");
+    case CO2_SENSOR_BACKEND_MHZ19B:
+        CO2_backend = &CO2_sensor_backend_mhz19b;
+        break;
 
-    /**
-     *  Funcion para agregar efectivamente una interrupcion a un GPIO, junto con su handler.
-     */
-    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(CO2_sens_pwm_pin, co2_sensor_isr_handler, NULL), 
-                        TAG, "Failed to add the ISR handler.");
+    case CO2_SENSOR_BACKEND_SCD4X:
+        CO2_backend = &CO2_sensor_backend_scd4x;
+        break;
+
+    case CO2_SENSOR_BACKEND_SCD30:
+        CO2_backend = &CO2_sensor_backend_scd30;
+        break;
+
+    case CO2_SENSOR_BACKEND_CCS811:
+        CO2_backend = &CO2_sensor_backend_ccs811;
+        break;
+
+    default:
+        ESP_LOGE(TAG, "Unknown CO2 sensor type.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = CO2_backend->init(config);
+
+    if(err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to initialize %s CO2 sensor.", CO2_backend->nombre);
+        CO2_backend = NULL;
+        return err;
+    }
 
 
 
     //========================| CREACIÓN DE TAREA |===========================//
 
     /**
-     *  Se crea la tarea encargada de recibir los datos desde el pin de PWM
-     *  del sensor de CO2.
+     *  Se crea la tarea encargada de recibir los datos del sensor de CO2.
      * 
      *  Se le da una prioridad a la tarea alta, considerando que el máximo de prioridad
      *  es de 5, de modo que no se vea afectado el proceso de recepción de datos desde
@@ -340,8 +524,8 @@ esp_err_t CO2_sensor_init(CO2_sensor_pwm_pin_t CO2_sens_pwm_pin)
     if(xCO2TaskHandle == NULL)
     {
         xTaskCreate(
-            vTaskGetCO2ByPWM,
-            "vTaskGetCO2ByPWM",
+            vTaskGetCO2,
+            "vTaskGetCO2",
             4096,
             NULL,
             4,
@@ -352,7 +536,8 @@ esp_err_t CO2_sensor_init(CO2_sensor_pwm_pin_t CO2_sens_pwm_pin)
          */
         if(xCO2TaskHandle == NULL)
         {
-            ESP_LOGE(TAG, "Failed to create vTaskGetCO2ByPWM task.");
+            ESP_LOGE(TAG, "Failed to create vTaskGetCO2 task.");
+            CO2_backend = NULL;
             return ESP_FAIL;
         }
     }
@@ -374,12 +559,17 @@ esp_err_t CO2_sensor_get_CO2(CO2_sensor_ppm_t *CO2_value_buffer)
      *  En caso de que se haya producido un error al sensar, se retorna
      *  ESP_FAIL para indicar la presencia de dicho error.
      */
-    if(CO2_ppm_pwm == CO2_SENSOR_MEASURE_ERROR)
+    if(CO2_value_buffer == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if(CO2_ppm == CO2_SENSOR_MEASURE_ERROR)
     {
         return ESP_FAIL;
     }
 
-    *CO2_value_buffer = CO2_ppm_pwm;
+    *CO2_value_buffer = CO2_ppm;
 
     return ESP_OK;
 }
@@ -394,10 +584,10 @@ esp_err_t CO2_sensor_get_CO2(CO2_sensor_ppm_t *CO2_value_buffer)
 bool CO2_sensor_is_warming_up(void)
 {
     /**
-     *  Se controla si ya se cumplió el tiempo de espera de calentamiento del sensor
-     *  (1 min).
+     *  El fin del calentamiento lo determina el backend del sensor (por ejemplo, el MH-Z19B
+     *  detecta cuándo comienza a entregar mediciones válidas).
      */
-    return !warm_up_expired(CO2_warm_up_time_start, 60);
+    return CO2_calentando;
 }
 
 
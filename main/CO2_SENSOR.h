@@ -1,6 +1,7 @@
 /*
 
-    CO2 sensor library
+    CO2 sensor library. La medición puede obtenerse mediante la salida PWM del sensor MH-Z19, o mediante
+    los sensores digitales MH-Z19B (UART), SCD4x, SCD30 y CCS811 (I2C).
 
 */
 
@@ -16,6 +17,8 @@ extern "C" {
 #include <stdio.h>
 #include "esp_err.h"
 #include "driver/gpio.h"
+#include "driver/uart.h"
+#include "driver/i2c.h"
 
 /*==================[DEFINES AND MACROS]=====================================*/
 
@@ -25,9 +28,52 @@ extern "C" {
  */
 #define CO2_SENSOR_MEASURE_ERROR -300 
 
+/* Rango de medición configurado en el sensor MH-Z19, en ppm. */
+#define CO2_SENSOR_RANGO_PPM            5000
+
+/**
+ *  Cantidad de períodos de la señal PWM (de aproximadamente 1 segundo cada uno) que se promedian
+ *  para obtener cada medición.
+ */
+#define CO2_SENSOR_PERIODOS_PROMEDIO    3
+
 typedef gpio_num_t CO2_sensor_pwm_pin_t;
 typedef float CO2_sensor_ppm_t;
 
+/**
+ *  Enumeración correspondiente a los tipos de sensores de CO2 soportados.
+ */
+typedef enum {
+    CO2_SENSOR_BACKEND_PWM = 0,         /* MH-Z19 mediante su salida PWM. */
+    CO2_SENSOR_BACKEND_MHZ19B,          /* MH-Z19B mediante UART (componente "mhz19b"). */
+    CO2_SENSOR_BACKEND_SCD4X,           /* Sensirion SCD40/SCD41 mediante I2C (componente "scd4x"). */
+    CO2_SENSOR_BACKEND_SCD30,           /* Sensirion SCD30 mediante I2C (componente "scd30"). */
+    CO2_SENSOR_BACKEND_CCS811,          /* CCS811 mediante I2C (componente "ccs811"), que mide CO2 equivalente (eCO2). */
+} CO2_sensor_backend_type_t;
+
+
+/**
+ *  Estructura con la configuración del sensor de CO2. Solo se utilizan los campos que corresponden
+ *  al tipo de sensor elegido.
+ */
+typedef struct {
+    CO2_sensor_backend_type_t backend;  /* Tipo de sensor. */
+    CO2_sensor_pwm_pin_t pin_pwm;       /* PWM: GPIO de la salida PWM del sensor. */
+    uart_port_t uart_port;              /* MH-Z19B: puerto UART. */
+    gpio_num_t pin_tx;                  /* MH-Z19B: GPIO de TX del ESP32. */
+    gpio_num_t pin_rx;                  /* MH-Z19B: GPIO de RX del ESP32. */
+    i2c_port_t i2c_port;                /* I2C: puerto I2C. */
+    gpio_num_t pin_sda;                 /* I2C: GPIO de SDA. */
+    gpio_num_t pin_scl;                 /* I2C: GPIO de SCL. */
+    uint8_t i2c_addr;                   /* CCS811: dirección I2C (CCS811_I2C_ADDRESS_1 o CCS811_I2C_ADDRESS_2). */
+
+    /**
+     *  SCD30 (pin RDY) y CCS811 (pin nINT): GPIO de la señal de dato disponible. Si es GPIO_NUM_NC,
+     *  el estado de la medición se consulta por I2C.
+     */
+    gpio_num_t pin_dato_listo;
+} CO2_sensor_config_t;
+
 /**
  *  @brief  Puntero a función que será utilizado para ejecutar la función que se pase
  *          como callback cuando finalice una nueva conversión del sensor.
@@ -39,6 +85,7 @@ typedef void (*CO2SensorCallbackFunction)(void *pvParameters);
 /*==================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
 
 esp_err_t CO2_sensor_init(CO2_sensor_pwm_pin_t CO2_sens_pwm_pin);
+esp_err_t CO2_sensor_init_with_config(const CO2_sensor_config_t *config);
 esp_err_t CO2_sensor_get_CO2(CO2_sensor_ppm_t *CO2_value_buffer);
 bool CO2_sensor_is_warming_up(void);
 void CO2_sensor_callback_function_on_new_measurment(CO2SensorCallbackFunction callback_function);
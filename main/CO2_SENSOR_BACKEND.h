@@ -0,0 +1,54 @@
+/*
+
+    Interfaz interna entre la librería del sensor de CO2 y cada uno de los tipos de sensores soportados
+    (backends). Solo debe incluirse desde los archivos de la librería del sensor de CO2.
+
+*/
+
+#ifndef CO2_SENSOR_BACKEND_H_
+#define CO2_SENSOR_BACKEND_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "CO2_SENSOR.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/**
+ *  Estructura con las funciones que debe implementar cada backend.
+ *
+ *  -init:              Inicializa el sensor a partir de la configuración.
+ *  -obtener_medicion:  Bloquea a la tarea del sensor hasta que haya una nueva medición, utilizando la
+ *                      señalización de dato disponible propia del sensor, y la devuelve en "ppm". Retorna
+ *                      ESP_ERR_TIMEOUT si el sensor no entregó una medición en el tiempo esperado.
+ *  -calentando:        Indica si el sensor aún se está calentando. Se consulta luego de cada medición,
+ *                      desde la tarea del sensor, por lo que puede realizar transacciones con el sensor.
+ */
+typedef struct {
+    const char *nombre;
+    esp_err_t (*init)(const CO2_sensor_config_t *config);
+    esp_err_t (*obtener_medicion)(CO2_sensor_ppm_t *ppm);
+    bool (*calentando)(void);
+} CO2_sensor_backend_t;
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+extern const CO2_sensor_backend_t CO2_sensor_backend_mhz19b;
+extern const CO2_sensor_backend_t CO2_sensor_backend_scd4x;
+extern const CO2_sensor_backend_t CO2_sensor_backend_scd30;
+extern const CO2_sensor_backend_t CO2_sensor_backend_ccs811;
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CO2_SENSOR_BACKEND_H_
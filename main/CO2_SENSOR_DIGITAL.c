@@ -0,0 +1,589 @@
+/**
+ * @file CO2_SENSOR_DIGITAL.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Backends de la librería del sensor de CO2 para los sensores digitales MH-Z19B (UART), SCD4x, SCD30 y CCS811 (I2C).
+ * @version 0.1
+ * @date 2023-02-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Cada backend implementa la interfaz "CO2_sensor_backend_t" (ver "CO2_SENSOR_BACKEND.h") utilizando el componente
+ *  correspondiente de "esp-idf-lib". La función "obtener_medicion" de cada backend bloquea a la tarea del sensor hasta
+ *  que el sensor indica que tiene una nueva medición, mediante su propia señalización:
+ *
+ *  -MH-Z19B:   No posee señal de dato disponible, por lo que se lee cada "MHZ19B_READ_INTERVAL_MS" (5 s), que es el
+ *              período de actualización de la medición del sensor.
+ *  -SCD4x:     Medición periódica cada 5 s. Se espera el período y luego se consulta el estado "data ready" por I2C.
+ *  -SCD30:     Pin RDY, que se pone en alto cuando hay una nueva medición. Si no está conectado, se consulta el estado
+ *              "data ready" por I2C.
+ *  -CCS811:    Pin nINT, que se pone en bajo cuando hay una nueva medición. Si no está conectado, se lee cada 1 s.
+ *
+ *      En todos los casos, cada medición requiere una única transacción con el sensor, en lugar de la medición de un
+ *  período completo de la señal PWM.
+ *
+ *      El fin del calentamiento del MH-Z19B se detecta comparando cada medición con la anterior, ya que el sensor
+ *  entrega un valor fijo mientras se calienta, o al cumplirse su tiempo máximo de calentamiento. El CCS811 requiere un tiempo de
+ *  acondicionamiento de 20 minutos luego del encendido, y los sensores SCD4x y SCD30 entregan mediciones válidas
+ *  desde la primera medición con "data ready".
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+
+#include "driver/gpio.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <esp_timer.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "mhz19b.h"
+#include "scd4x.h"
+#include "scd30.h"
+#include "ccs811.h"
+
+#include "CO2_SENSOR.h"
+#include "CO2_SENSOR_BACKEND.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+/* Período de medición del SCD4x en modo de medición periódica, en milisegundos. */
+#define CO2_SCD4X_PERIODO_MS                5000
+
+/* Intervalo de medición configurado en el SCD30, en segundos. */
+#define CO2_SCD30_INTERVALO_SEG             2
+
+/* Período de medición del CCS811 en el modo utilizado (CCS811_MODE_1S), en milisegundos. */
+#define CO2_CCS811_PERIODO_MS               1000
+
+/* Tiempo de acondicionamiento del CCS811 luego del encendido, en segundos. */
+#define CO2_CCS811_TIEMPO_CALENTAMIENTO_SEG (20 * 60)
+
+/* Intervalo de consulta del estado "data ready" por I2C, en milisegundos. */
+#define CO2_INTERVALO_CONSULTA_MS           100
+
+/**
+ *  Tiempo máximo que se espera una medición luego de cumplido el período de medición del sensor,
+ *  en milisegundos.
+ */
+#define CO2_MARGEN_TIMEOUT_MS               1000
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+/* Tag para imprimir información en el LOG. */
+static const char *TAG = "CO2_SENSOR_DIGITAL";
+
+/* Descriptores de los sensores. Solo se utiliza el del backend configurado. */
+static mhz19b_dev_t CO2_mhz19b_dev;
+static i2c_dev_t CO2_scd4x_dev;
+static i2c_dev_t CO2_scd30_dev;
+static ccs811_dev_t CO2_ccs811_dev;
+
+/**
+ *  Bandera de calentamiento del MH-Z19B. El calentamiento termina cuando la medición cambia respecto de la
+ *  anterior (el sensor entrega un valor fijo mientras se calienta), o al cumplirse su tiempo máximo.
+ */
+static bool CO2_mhz19b_calentando = 1;
+
+/* Última medición del MH-Z19B, para detectar el fin del calentamiento (-1 si todavía no se leyó). */
+static int16_t CO2_mhz19b_ultimo_valor = -1;
+
+/* Instante de la última lectura del MH-Z19B, para respetar su intervalo de actualización. */
+static TickType_t CO2_mhz19b_ultima_lectura = 0;
+
+/* Instante de la última medición del SCD4x, para esperar su período de medición. */
+static TickType_t CO2_scd4x_ultima_medicion = 0;
+
+/* Instante de inicialización del CCS811, para controlar su tiempo de acondicionamiento. */
+static int64_t CO2_ccs811_inicio = 0;
+
+/**
+ *  Pin de la señal de dato disponible (RDY del SCD30 o nINT del CCS811), y semáforo que se libera
+ *  desde su rutina de interrupción.
+ */
+static gpio_num_t CO2_pin_dato_listo = GPIO_NUM_NC;
+static SemaphoreHandle_t CO2_semaforo_dato_listo = NULL;
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static void co2_dato_listo_isr_handler(void *args);
+static esp_err_t CO2ConfigurarPinDatoListo(gpio_num_t pin, gpio_int_type_t flanco);
+static esp_err_t CO2EsperarDatoListo(TickType_t timeout);
+
+static esp_err_t CO2Mhz19bInit(const CO2_sensor_config_t *config);
+static esp_err_t CO2Mhz19bObtenerMedicion(CO2_sensor_ppm_t *ppm);
+static bool CO2Mhz19bCalentando(void);
+
+static esp_err_t CO2Scd4xInit(const CO2_sensor_config_t *config);
+static esp_err_t CO2Scd4xObtenerMedicion(CO2_sensor_ppm_t *ppm);
+
+static esp_err_t CO2Scd30Init(const CO2_sensor_config_t *config);
+static esp_err_t CO2Scd30ObtenerMedicion(CO2_sensor_ppm_t *ppm);
+
+static esp_err_t CO2Ccs811Init(const CO2_sensor_config_t *config);
+static esp_err_t CO2Ccs811ObtenerMedicion(CO2_sensor_ppm_t *ppm);
+static bool CO2Ccs811Calentando(void);
+
+static bool CO2SinCalentamiento(void);
+
+/* Backends de los sensores digitales, declarados en "CO2_SENSOR_BACKEND.h". */
+const CO2_sensor_backend_t CO2_sensor_backend_mhz19b = {
+    .nombre = "MH-Z19B",
+    .init = CO2Mhz19bInit,
+    .obtener_medicion = CO2Mhz19bObtenerMedicion,
+    .calentando = CO2Mhz19bCalentando,
+};
+
+
+const CO2_sensor_backend_t CO2_sensor_backend_scd4x = {
+    .nombre = "SCD4x",
+    .init = CO2Scd4xInit,
+    .obtener_medicion = CO2Scd4xObtenerMedicion,
+    .calentando = CO2SinCalentamiento,
+};
+
+
+const CO2_sensor_backend_t CO2_sensor_backend_scd30 = {
+    .nombre = "SCD30",
+    .init = CO2Scd30Init,
+    .obtener_medicion = CO2Scd30ObtenerMedicion,
+    .calentando = CO2SinCalentamiento,
+};
+
+
+const CO2_sensor_backend_t CO2_sensor_backend_ccs811 = {
+    .nombre = "CCS811",
+    .init = CO2Ccs811Init,
+    .obtener_medicion = CO2Ccs811ObtenerMedicion,
+    .calentando = CO2Ccs811Calentando,
+};
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Rutina de servicio de interrupción de la señal de dato disponible del sensor.
+ *
+ * @param args  Parámetros pasados a la rutina de servicios de interrupción de GPIO.
+ */
+static void co2_dato_listo_isr_handler(void *args)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xSemaphoreGiveFromISR(CO2_semaforo_dato_listo, &xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+
+
+/**
+ * @brief   Función para configurar el pin de la señal de dato disponible del sensor y su interrupción.
+ *
+ * @param pin       GPIO de la señal de dato disponible. Si es GPIO_NUM_NC, no se configura.
+ * @param flanco    Flanco en el que el sensor indica que hay una nueva medición.
+ * @return esp_err_t
+ */
+static esp_err_t CO2ConfigurarPinDatoListo(gpio_num_t pin, gpio_int_type_t flanco)
+{
+    CO2_pin_dato_listo = pin;
+
+    if(pin == GPIO_NUM_NC)
+    {
+        return ESP_OK;
+    }
+
+    CO2_semaforo_dato_listo = xSemaphoreCreateBinary();
+
+    if(CO2_semaforo_dato_listo == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create data ready semaphore.");
+        return ESP_ERR_NO_MEM;
+    }
+
+    gpio_config_t pGPIOConfig = {
+        .pin_bit_mask = (1ULL << pin),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = (flanco == GPIO_INTR_NEGEDGE) ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = flanco,
+    };
+
+    ESP_RETURN_ON_ERROR(gpio_config(&pGPIOConfig), TAG, "Failed to load gpio config.");
+
+    /**
+     *  Si el servicio de interrupciones de GPIO ya fue instalado por otro módulo, se obtiene
+     *  ESP_ERR_INVALID_STATE, que no es un error.
+     */
+    esp_err_t err = gpio_install_isr_service(0);
+
+    if(err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Failed to install ISR.");
+        return err;
+    }
+
+    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(pin, co2_dato_listo_isr_handler, NULL), TAG, "Failed to add the ISR handler.");
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para esperar la señal de dato disponible del sensor.
+ *
+ * @param timeout   Tiempo máximo de espera.
+ * @return esp_err_t    ESP_ERR_TIMEOUT si no se recibió la señal.
+ */
+static esp_err_t CO2EsperarDatoListo(TickType_t timeout)
+{
+    return (xSemaphoreTake(CO2_semaforo_dato_listo, timeout) == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+
+
+/**
+ * @brief   Función para los sensores que entregan mediciones válidas desde la primera medición.
+ *
+ * @return false    El sensor no requiere calentamiento.
+ */
+static bool CO2SinCalentamiento(void)
+{
+    return 0;
+}
+
+
+
+//========================| MH-Z19B |===========================//
+
+/**
+ * @brief   Función para inicializar el MH-Z19B mediante UART.
+ *
+ * @param config    Configuración del sensor.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Mhz19bInit(const CO2_sensor_config_t *config)
+{
+    ESP_RETURN_ON_ERROR(mhz19b_init(&CO2_mhz19b_dev, config->uart_port, config->pin_tx, config->pin_rx),
+                        TAG, "Failed to initialize MH-Z19B.");
+
+    if(!mhz19b_detect(&CO2_mhz19b_dev))
+    {
+        ESP_LOGE(TAG, "MH-Z19B not detected.");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_RETURN_ON_ERROR(mhz19b_set_range(&CO2_mhz19b_dev, MHZ19B_RANGE_5000), TAG, "Failed to set MH-Z19B range.");
+
+    CO2_mhz19b_ultima_lectura = xTaskGetTickCount();
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener una medición del MH-Z19B, respetando su intervalo de actualización.
+ *
+ * @param ppm   Variable donde se guardará la concentración de CO2.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Mhz19bObtenerMedicion(CO2_sensor_ppm_t *ppm)
+{
+    vTaskDelayUntil(&CO2_mhz19b_ultima_lectura, pdMS_TO_TICKS(MHZ19B_READ_INTERVAL_MS));
+
+    int16_t co2;
+    ESP_RETURN_ON_ERROR(mhz19b_read_co2(&CO2_mhz19b_dev, &co2), TAG, "Failed to read MH-Z19B.");
+
+    /**
+     *  Mientras se calienta, el sensor entrega siempre el mismo valor, por lo que el calentamiento termina
+     *  cuando la medición cambia respecto de la anterior, o al cumplirse el tiempo máximo de calentamiento.
+     */
+    if(CO2_mhz19b_calentando
+        && ((CO2_mhz19b_ultimo_valor != -1 && co2 != CO2_mhz19b_ultimo_valor)
+            || esp_timer_get_time() >= (int64_t) MHZ19B_WARMING_UP_TIME_US))
+    {
+        CO2_mhz19b_calentando = 0;
+    }
+
+    CO2_mhz19b_ultimo_valor = co2;
+    *ppm = co2;
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función que indica si el MH-Z19B se está calentando.
+ *
+ * @return true     Calentamiento en curso.
+ * @return false    Calentamiento terminado.
+ */
+static bool CO2Mhz19bCalentando(void)
+{
+    return CO2_mhz19b_calentando;
+}
+
+
+
+//========================| SCD4x |===========================//
+
+/**
+ * @brief   Función para inicializar el SCD4x e iniciar su medición periódica.
+ *
+ * @param config    Configuración del sensor.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Scd4xInit(const CO2_sensor_config_t *config)
+{
+    ESP_RETURN_ON_ERROR(scd4x_init_desc(&CO2_scd4x_dev, config->i2c_port, config->pin_sda, config->pin_scl),
+                        TAG, "Failed to initialize SCD4x descriptor.");
+
+    /**
+     *  Luego de un reinicio del ESP32 el sensor puede haber quedado en medición periódica, en cuyo
+     *  caso no acepta otros comandos, por lo que primero se la detiene.
+     */
+    ESP_RETURN_ON_ERROR(scd4x_stop_periodic_measurement(&CO2_scd4x_dev), TAG, "Failed to stop SCD4x measurement.");
+    ESP_RETURN_ON_ERROR(scd4x_reinit(&CO2_scd4x_dev), TAG, "Failed to reinitialize SCD4x.");
+    ESP_RETURN_ON_ERROR(scd4x_start_periodic_measurement(&CO2_scd4x_dev), TAG, "Failed to start SCD4x measurement.");
+
+    CO2_scd4x_ultima_medicion = xTaskGetTickCount();
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener una medición del SCD4x. Se espera su período de medición y luego se
+ *          consulta el estado "data ready", de modo de leer cada medición una única vez.
+ *
+ * @param ppm   Variable donde se guardará la concentración de CO2.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Scd4xObtenerMedicion(CO2_sensor_ppm_t *ppm)
+{
+    vTaskDelayUntil(&CO2_scd4x_ultima_medicion, pdMS_TO_TICKS(CO2_SCD4X_PERIODO_MS - CO2_INTERVALO_CONSULTA_MS));
+
+    bool dato_listo = 0;
+
+    for(int i = 0; i < CO2_MARGEN_TIMEOUT_MS / CO2_INTERVALO_CONSULTA_MS && !dato_listo; i++)
+    {
+        ESP_RETURN_ON_ERROR(scd4x_get_data_ready_status(&CO2_scd4x_dev, &dato_listo), TAG, "Failed to get SCD4x status.");
+
+        if(!dato_listo)
+        {
+            vTaskDelay(pdMS_TO_TICKS(CO2_INTERVALO_CONSULTA_MS));
+        }
+    }
+
+    /**
+     *  Se toma como referencia el instante en que efectivamente se obtuvo la medición, de modo que
+     *  la espera del próximo período se mantenga alineada con el sensor.
+     */
+    CO2_scd4x_ultima_medicion = xTaskGetTickCount();
+
+    if(!dato_listo)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    uint16_t co2;
+    float temperatura, humedad;
+    ESP_RETURN_ON_ERROR(scd4x_read_measurement(&CO2_scd4x_dev, &co2, &temperatura, &humedad), TAG, "Failed to read SCD4x.");
+
+    *ppm = co2;
+
+    return ESP_OK;
+}
+
+
+
+//========================| SCD30 |===========================//
+
+/**
+ * @brief   Función para inicializar el SCD30 e iniciar su medición continua.
+ *
+ * @param config    Configuración del sensor.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Scd30Init(const CO2_sensor_config_t *config)
+{
+    ESP_RETURN_ON_ERROR(scd30_init_desc(&CO2_scd30_dev, config->i2c_port, config->pin_sda, config->pin_scl),
+                        TAG, "Failed to initialize SCD30 descriptor.");
+
+    ESP_RETURN_ON_ERROR(CO2ConfigurarPinDatoListo(config->pin_dato_listo, GPIO_INTR_POSEDGE), TAG, "Failed to configure RDY pin.");
+
+    ESP_RETURN_ON_ERROR(scd30_set_measurement_interval(&CO2_scd30_dev, CO2_SCD30_INTERVALO_SEG),
+                        TAG, "Failed to set SCD30 measurement interval.");
+    ESP_RETURN_ON_ERROR(scd30_trigger_continuous_measurement(&CO2_scd30_dev, 0), TAG, "Failed to start SCD30 measurement.");
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener una medición del SCD30, esperando la señal RDY o consultando el
+ *          estado "data ready" por I2C.
+ *
+ * @param ppm   Variable donde se guardará la concentración de CO2.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Scd30ObtenerMedicion(CO2_sensor_ppm_t *ppm)
+{
+    const TickType_t timeout = pdMS_TO_TICKS(CO2_SCD30_INTERVALO_SEG * 1000 + CO2_MARGEN_TIMEOUT_MS);
+
+    if(CO2_pin_dato_listo != GPIO_NUM_NC)
+    {
+        /**
+         *  Si el pin RDY ya estaba en alto (por ejemplo, en la primera medición), no se produce el
+         *  flanco, por lo que se lee directamente. Se descarta el semáforo que pudo haber quedado
+         *  dado por ese flanco, para que la próxima medición no lo tome como un dato nuevo.
+         */
+        if(!gpio_get_level(CO2_pin_dato_listo))
+        {
+            ESP_RETURN_ON_ERROR(CO2EsperarDatoListo(timeout), TAG, "SCD30 RDY timeout.");
+        }
+
+        else
+        {
+            xSemaphoreTake(CO2_semaforo_dato_listo, 0);
+        }
+    }
+
+    else
+    {
+        bool dato_listo = 0;
+        TickType_t inicio = xTaskGetTickCount();
+
+        while(1)
+        {
+            ESP_RETURN_ON_ERROR(scd30_get_data_ready_status(&CO2_scd30_dev, &dato_listo), TAG, "Failed to get SCD30 status.");
+
+            if(dato_listo)
+            {
+                break;
+            }
+
+            if(xTaskGetTickCount() - inicio >= timeout)
+            {
+                return ESP_ERR_TIMEOUT;
+            }
+
+            vTaskDelay(pdMS_TO_TICKS(CO2_INTERVALO_CONSULTA_MS));
+        }
+    }
+
+    float co2, temperatura, humedad;
+    ESP_RETURN_ON_ERROR(scd30_read_measurement(&CO2_scd30_dev, &co2, &temperatura, &humedad), TAG, "Failed to read SCD30.");
+
+    *ppm = co2;
+
+    return ESP_OK;
+}
+
+
+
+//========================| CCS811 |===========================//
+
+/**
+ * @brief   Función para inicializar el CCS811 en el modo de medición de 1 segundo.
+ *
+ * @param config    Configuración del sensor.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Ccs811Init(const CO2_sensor_config_t *config)
+{
+    CO2_ccs811_inicio = esp_timer_get_time();
+
+    ESP_RETURN_ON_ERROR(ccs811_init_desc(&CO2_ccs811_dev, config->i2c_addr, config->i2c_port, config->pin_sda, config->pin_scl),
+                        TAG, "Failed to initialize CCS811 descriptor.");
+    ESP_RETURN_ON_ERROR(ccs811_init(&CO2_ccs811_dev), TAG, "Failed to initialize CCS811.");
+
+    ESP_RETURN_ON_ERROR(CO2ConfigurarPinDatoListo(config->pin_dato_listo, GPIO_INTR_NEGEDGE), TAG, "Failed to configure nINT pin.");
+
+    if(config->pin_dato_listo != GPIO_NUM_NC)
+    {
+        ESP_RETURN_ON_ERROR(ccs811_enable_interrupt(&CO2_ccs811_dev, true), TAG, "Failed to enable CCS811 interrupt.");
+    }
+
+    ESP_RETURN_ON_ERROR(ccs811_set_mode(&CO2_ccs811_dev, CCS811_MODE_1S), TAG, "Failed to set CCS811 mode.");
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener una medición de CO2 equivalente (eCO2) del CCS811, esperando la señal
+ *          nINT o el período de medición.
+ *
+ * @param ppm   Variable donde se guardará la concentración de CO2 equivalente.
+ * @return esp_err_t
+ */
+static esp_err_t CO2Ccs811ObtenerMedicion(CO2_sensor_ppm_t *ppm)
+{
+    if(CO2_pin_dato_listo != GPIO_NUM_NC)
+    {
+        /**
+         *  La señal nINT se mantiene en bajo hasta que se leen los resultados, por lo que si ya
+         *  estaba en bajo no se produce el flanco y se lee directamente, descartando el semáforo
+         *  que pudo haber quedado dado.
+         */
+        if(gpio_get_level(CO2_pin_dato_listo))
+        {
+            ESP_RETURN_ON_ERROR(CO2EsperarDatoListo(pdMS_TO_TICKS(CO2_CCS811_PERIODO_MS + CO2_MARGEN_TIMEOUT_MS)),
+                                TAG, "CCS811 nINT timeout.");
+        }
+
+        else
+        {
+            xSemaphoreTake(CO2_semaforo_dato_listo, 0);
+        }
+    }
+
+    else
+    {
+        vTaskDelay(pdMS_TO_TICKS(CO2_CCS811_PERIODO_MS));
+    }
+
+    uint16_t eco2;
+    ESP_RETURN_ON_ERROR(ccs811_get_results(&CO2_ccs811_dev, NULL, &eco2, NULL, NULL), TAG, "Failed to read CCS811.");
+
+    *ppm = eco2;
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función que indica si el CCS811 se encuentra en su período de acondicionamiento.
+ *
+ * @return true     Acondicionamiento en curso.
+ * @return false    Acondicionamiento terminado.
+ */
+static bool CO2Ccs811Calentando(void)
+{
+    return (esp_timer_get_time() - CO2_ccs811_inicio) < (int64_t) CO2_CCS811_TIEMPO_CALENTAMIENTO_SEG * 1000000;
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
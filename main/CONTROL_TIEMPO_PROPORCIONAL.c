@@ -0,0 +1,197 @@
+/**
+ * @file CONTROL_TIEMPO_PROPORCIONAL.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Control PI y planificador de accionamiento de relés por tiempo proporcional.
+ * @version 0.1
+ * @date 2023-02-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Los actuadores on/off (calefacción, ventiladores) se pueden controlar de forma proporcional si se los enciende
+ *  durante una fracción de una ventana de tiempo fija. El controlador PI ("control_pi_calcular()") calcula dicha fracción
+ *  (ciclo de trabajo, entre 0 y 1) a partir del error de la variable controlada, y el planificador ("control_tp_*")
+ *  la convierte en un tiempo de encendido dentro de la ventana.
+ *
+ *      El uso típico, llamado periódicamente desde la tarea de control, es:
+ *
+ *      if(control_tp_ventana_finalizada(&tp, ahora))
+ *      {
+ *          float ciclo = control_pi_calcular(&pi, error, periodo_ventana_seg);
+ *          control_tp_iniciar_ventana(&tp, ciclo, ahora);
+ *      }
+ *
+ *      bool estado = control_tp_get_estado_rele(&tp, ahora);
+ *
+ *      De esta forma, el relé conmuta como máximo dos veces por ventana, y solo se lo debe escribir cuando
+ *  "estado" cambia respecto del valor anterior.
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "CONTROL_TIEMPO_PROPORCIONAL.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función que calcula la salida del controlador PI, limitada entre "salida_min" y "salida_max".
+ *
+ *          El término integral solo se acumula si la salida no está saturada, o si el error tiende a
+ *          sacarla de la saturación (anti-windup por integración condicional).
+ *
+ * @param pi        Controlador PI.
+ * @param error     Error de la variable controlada (referencia - medición, o su inversa según el actuador).
+ * @param dt_seg    Tiempo transcurrido desde el último cálculo, en segundos.
+ * @return float    Salida del controlador.
+ */
+float control_pi_calcular(control_pi_t *pi, float error, float dt_seg)
+{
+    float integral_nueva = pi->integral + pi->ki * error * dt_seg;
+    float salida = pi->kp * error + integral_nueva;
+
+    if(salida > pi->salida_max)
+    {
+        salida = pi->salida_max;
+
+        if(error < 0)
+        {
+            pi->integral = integral_nueva;
+        }
+    }
+
+    else if(salida < pi->salida_min)
+    {
+        salida = pi->salida_min;
+
+        if(error > 0)
+        {
+            pi->integral = integral_nueva;
+        }
+    }
+
+    else
+    {
+        pi->integral = integral_nueva;
+    }
+
+    return salida;
+}
+
+
+
+/**
+ * @brief   Función para resetear el término integral del controlador PI.
+ *
+ * @param pi    Controlador PI.
+ */
+void control_pi_reset(control_pi_t *pi)
+{
+    pi->integral = 0;
+}
+
+
+
+/**
+ * @brief   Función para saber si finalizó la ventana en curso del planificador (o si todavía no
+ *          se inició ninguna), caso en el cual se debe calcular el nuevo ciclo de trabajo.
+ *
+ * @param tp        Planificador de tiempo proporcional.
+ * @param ahora     Tick actual.
+ * @return true     Se debe iniciar una nueva ventana.
+ * @return false    La ventana en curso no finalizó.
+ */
+bool control_tp_ventana_finalizada(const control_tp_rele_t *tp, TickType_t ahora)
+{
+    return !tp->ventana_iniciada || (TickType_t) (ahora - tp->inicio_ventana) >= tp->periodo_ventana;
+}
+
+
+
+/**
+ * @brief   Función para iniciar una nueva ventana del planificador con el ciclo de trabajo indicado,
+ *          aplicando los tiempos mínimos de encendido y apagado.
+ *
+ * @param tp                Planificador de tiempo proporcional.
+ * @param ciclo_de_trabajo  Fracción de la ventana en la que el relé estará encendido (0 a 1).
+ * @param ahora             Tick actual.
+ */
+void control_tp_iniciar_ventana(control_tp_rele_t *tp, float ciclo_de_trabajo, TickType_t ahora)
+{
+    if(ciclo_de_trabajo < 0) ciclo_de_trabajo = 0;
+    if(ciclo_de_trabajo > 1) ciclo_de_trabajo = 1;
+
+    TickType_t tiempo_on = (TickType_t) (ciclo_de_trabajo * tp->periodo_ventana);
+
+    /**
+     *  Se evitan encendidos o apagados más cortos que los mínimos establecidos.
+     */
+    if(tiempo_on < tp->tiempo_min_on)
+    {
+        tiempo_on = 0;
+    }
+
+    else if((tp->periodo_ventana - tiempo_on) < tp->tiempo_min_off)
+    {
+        tiempo_on = tp->periodo_ventana;
+    }
+
+    tp->tiempo_on = tiempo_on;
+    tp->inicio_ventana = ahora;
+    tp->ventana_iniciada = 1;
+}
+
+
+
+/**
+ * @brief   Función que devuelve el estado en el que debe estar el relé en el instante actual.
+ *
+ * @param tp        Planificador de tiempo proporcional.
+ * @param ahora     Tick actual.
+ * @return true     Relé encendido.
+ * @return false    Relé apagado.
+ */
+bool control_tp_get_estado_rele(const control_tp_rele_t *tp, TickType_t ahora)
+{
+    if(!tp->ventana_iniciada)
+    {
+        return 0;
+    }
+
+    return (TickType_t) (ahora - tp->inicio_ventana) < tp->tiempo_on;
+}
+
+
+
+/**
+ * @brief   Función para resetear el planificador, de modo que la próxima llamada a
+ *          "control_tp_ventana_finalizada()" inicie una nueva ventana.
+ *
+ * @param tp    Planificador de tiempo proporcional.
+ */
+void control_tp_reset(control_tp_rele_t *tp)
+{
+    tp->ventana_iniciada = 0;
+    tp->tiempo_on = 0;
+}
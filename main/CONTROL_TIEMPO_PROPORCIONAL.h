@@ -0,0 +1,68 @@
+/*
+
+    Control PI con accionamiento de relés por tiempo proporcional (PWM de período largo), utilizado como
+    alternativa al control por ventana de histéresis.
+
+*/
+
+#ifndef CONTROL_TIEMPO_PROPORCIONAL_H_
+#define CONTROL_TIEMPO_PROPORCIONAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/**
+ *  Estructura de un controlador PI con salida limitada y anti-windup por integración condicional.
+ */
+typedef struct {
+    float kp;               /* Ganancia proporcional, en unidades de salida por unidad de error. */
+    float ki;               /* Ganancia integral, en unidades de salida por unidad de error y por segundo. */
+    float salida_min;       /* Límite inferior de la salida. */
+    float salida_max;       /* Límite superior de la salida. */
+    float integral;         /* Término integral acumulado. */
+} control_pi_t;
+
+
+/**
+ *  Estructura del planificador de tiempo proporcional de un relé. En cada ventana de duración
+ *  "periodo_ventana", el relé permanece encendido durante "ciclo_de_trabajo * periodo_ventana"
+ *  y apagado el resto de la ventana.
+ *
+ *  Para no accionar el relé durante tiempos muy cortos, si el tiempo de encendido resulta menor
+ *  a "tiempo_min_on" el relé no se enciende en toda la ventana, y si el tiempo de apagado resulta
+ *  menor a "tiempo_min_off" el relé no se apaga en toda la ventana.
+ */
+typedef struct {
+    TickType_t periodo_ventana;     /* Duración de cada ventana, en ticks. */
+    TickType_t tiempo_min_on;       /* Tiempo mínimo de encendido del relé, en ticks. */
+    TickType_t tiempo_min_off;      /* Tiempo mínimo de apagado del relé, en ticks. */
+    TickType_t inicio_ventana;      /* Instante de inicio de la ventana en curso. */
+    TickType_t tiempo_on;           /* Tiempo de encendido calculado para la ventana en curso. */
+    bool ventana_iniciada;          /* Bandera que indica si ya se inició alguna ventana. */
+} control_tp_rele_t;
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+float control_pi_calcular(control_pi_t *pi, float error, float dt_seg);
+void control_pi_reset(control_pi_t *pi);
+bool control_tp_ventana_finalizada(const control_tp_rele_t *tp, TickType_t ahora);
+void control_tp_iniciar_ventana(control_tp_rele_t *tp, float ciclo_de_trabajo, TickType_t ahora);
+bool control_tp_get_estado_rele(const control_tp_rele_t *tp, TickType_t ahora);
+void control_tp_reset(control_tp_rele_t *tp);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONTROL_TIEMPO_PROPORCIONAL_H_
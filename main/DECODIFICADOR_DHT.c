@@ -0,0 +1,181 @@
+/**
+ * @file DECODIFICADOR_DHT.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Decodificador de la trama de datos de los sensores DHT11/DHT22 a partir de las marcas de tiempo de los flancos
+ *          de la línea de datos.
+ * @version 0.1
+ * @date 2023-02-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Luego de que el ESP32 mantiene la línea en bajo por al menos 18 ms y la libera, el sensor responde con un pulso
+ *  en bajo y uno en alto de unos 80 us, y luego transmite 40 bits. Cada bit comienza con un pulso en bajo de unos 50 us,
+ *  seguido de un pulso en alto cuya duración indica el valor del bit (26-28 us para un 0, y 70 us para un 1).
+ *
+ *      Los flancos de la trama se capturan con su marca de tiempo (por ejemplo, en la rutina de interrupción de GPIO),
+ *  y luego se decodifican mediante "dht_decod_decodificar_trama()". Se obtiene la duración de cada par de pulsos
+ *  bajo-alto, y los últimos 40 pares corresponden a los bits de datos. Al igual que el driver "dht", un bit vale 1
+ *  si su pulso en alto es más largo que el pulso en bajo que lo precede, lo que hace a la decodificación independiente
+ *  de pequeñas diferencias de velocidad entre sensores.
+ *
+ *      Dado que no depende de FreeRTOS ni de los drivers del ESP32, el decodificador puede probarse en una PC con
+ *  tramas grabadas del sensor.
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "DECODIFICADOR_DHT.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+/**
+ *  Duración máxima admitida de los pulsos de cada bit, en microsegundos. Pulsos más largos indican
+ *  un flanco perdido o una demora excesiva en la captura del flanco.
+ */
+#define DHT_DECOD_PULSO_MAX_US      120
+
+/* Duración mínima admitida del pulso en bajo de cada bit, en microsegundos. */
+#define DHT_DECOD_PULSO_BAJO_MIN_US 20
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static float DhtDecodConvertirValor(dht_decod_tipo_t tipo, uint8_t msb, uint8_t lsb);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para obtener un valor a partir de sus dos bytes de la trama, con el mismo formato que
+ *          el driver "dht".
+ *
+ * @param tipo  Tipo de sensor.
+ * @param msb   Byte más significativo.
+ * @param lsb   Byte menos significativo.
+ * @return float    Valor obtenido.
+ */
+static float DhtDecodConvertirValor(dht_decod_tipo_t tipo, uint8_t msb, uint8_t lsb)
+{
+    if(tipo == DHT_DECOD_DHT11)
+    {
+        return msb;
+    }
+
+    float valor = (float) (((msb & 0x7F) << 8) | lsb) / 10;
+
+    return (msb & 0x80) ? -valor : valor;
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para decodificar los 5 bytes de datos de una trama a partir de sus flancos.
+ *
+ * @param flancos   Flancos de la trama, en orden cronológico.
+ * @param cantidad  Cantidad de flancos.
+ * @param datos     Buffer donde se guardarán los 5 bytes de la trama.
+ * @return esp_err_t    ESP_ERR_INVALID_SIZE si la trama está incompleta, ESP_ERR_INVALID_RESPONSE si algún
+ *                      pulso está fuera de tolerancia, y ESP_ERR_INVALID_CRC si falla el checksum.
+ */
+esp_err_t dht_decod_decodificar_trama(const dht_decod_flanco_t *flancos, size_t cantidad, uint8_t datos[DHT_DECOD_BYTES])
+{
+    if(flancos == NULL || datos == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /**
+     *  Se recorren los flancos desde el final, buscando los últimos 40 pares de pulsos bajo-alto
+     *  (flanco descendente, ascendente y descendente consecutivos).
+     */
+    uint8_t bits_leidos = 0;
+    memset(datos, 0, DHT_DECOD_BYTES);
+
+    for(size_t i = cantidad; i >= 3 && bits_leidos < DHT_DECOD_BITS; i--)
+    {
+        const dht_decod_flanco_t *inicio_bajo = &flancos[i - 3];
+        const dht_decod_flanco_t *inicio_alto = &flancos[i - 2];
+        const dht_decod_flanco_t *fin_alto = &flancos[i - 1];
+
+        if(inicio_bajo->nivel || !inicio_alto->nivel || fin_alto->nivel)
+        {
+            continue;
+        }
+
+        int64_t duracion_bajo = inicio_alto->tiempo_us - inicio_bajo->tiempo_us;
+        int64_t duracion_alto = fin_alto->tiempo_us - inicio_alto->tiempo_us;
+
+        if(duracion_bajo < DHT_DECOD_PULSO_BAJO_MIN_US || duracion_bajo > DHT_DECOD_PULSO_MAX_US
+            || duracion_alto <= 0 || duracion_alto > DHT_DECOD_PULSO_MAX_US)
+        {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+
+        /**
+         *  Los bits se obtienen del último al primero.
+         */
+        uint8_t bit = DHT_DECOD_BITS - 1 - bits_leidos;
+
+        if(duracion_alto > duracion_bajo)
+        {
+            datos[bit / 8] |= 1 << (7 - bit % 8);
+        }
+
+        bits_leidos++;
+
+        /**
+         *  El flanco descendente que inicia este bit es también el fin del pulso en alto del bit
+         *  anterior, por lo que se retrocede de a dos flancos.
+         */
+        i--;
+    }
+
+    if(bits_leidos < DHT_DECOD_BITS)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if(datos[4] != ((datos[0] + datos[1] + datos[2] + datos[3]) & 0xFF))
+    {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener la humedad relativa y la temperatura a partir de los datos de la trama.
+ *
+ * @param tipo          Tipo de sensor.
+ * @param datos         Datos de la trama, previamente decodificados.
+ * @param humedad       Variable donde se guardará la humedad relativa, en %. Puede ser NULL.
+ * @param temperatura   Variable donde se guardará la temperatura, en °C. Puede ser NULL.
+ */
+void dht_decod_convertir(dht_decod_tipo_t tipo, const uint8_t datos[DHT_DECOD_BYTES], float *humedad, float *temperatura)
+{
+    if(humedad != NULL)
+    {
+        *humedad = DhtDecodConvertirValor(tipo, datos[0], datos[1]);
+    }
+
+    if(temperatura != NULL)
+    {
+        *temperatura = DhtDecodConvertirValor(tipo, datos[2], datos[3]);
+    }
+}
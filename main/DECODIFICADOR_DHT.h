@@ -0,0 +1,65 @@
+/*
+
+    Decodificador de la trama de datos de los sensores DHT11/DHT22, a partir de las marcas de tiempo de los flancos
+    de la línea de datos. No depende de FreeRTOS ni de los drivers del ESP32, de modo que puede utilizarse con
+    flancos capturados en una interrupción o con flancos grabados previamente.
+
+*/
+
+#ifndef DECODIFICADOR_DHT_H_
+#define DECODIFICADOR_DHT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/* Cantidad de bits y de bytes de datos de la trama. */
+#define DHT_DECOD_BITS                  40
+#define DHT_DECOD_BYTES                 5
+
+/**
+ *  Cantidad de flancos de una trama completa: flanco ascendente de la liberación de la línea por parte del
+ *  ESP32, flancos descendente y ascendente de la respuesta del sensor, flanco descendente del inicio del
+ *  primer bit, y un flanco ascendente y uno descendente por cada bit.
+ */
+#define DHT_DECOD_CANT_FLANCOS_TRAMA    (4 + 2 * DHT_DECOD_BITS)
+
+/**
+ *  Enumeración correspondiente a los tipos de sensores, que difieren en el formato de los datos.
+ */
+typedef enum {
+    DHT_DECOD_DHT11 = 0,        /* DHT11: parte entera en el primer byte de cada valor. */
+    DHT_DECOD_DHT22,            /* DHT22/AM2301: valores de 16 bits en décimas, con bit de signo en la temperatura. */
+} dht_decod_tipo_t;
+
+
+/**
+ *  Estructura que representa un flanco de la línea de datos.
+ */
+typedef struct {
+    int64_t tiempo_us;          /* Marca de tiempo del flanco, en microsegundos. */
+    bool nivel;                 /* Nivel de la línea luego del flanco (1: flanco ascendente). */
+} dht_decod_flanco_t;
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+esp_err_t dht_decod_decodificar_trama(const dht_decod_flanco_t *flancos, size_t cantidad, uint8_t datos[DHT_DECOD_BYTES]);
+void dht_decod_convertir(dht_decod_tipo_t tipo, const uint8_t datos[DHT_DECOD_BYTES], float *humedad, float *temperatura);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DECODIFICADOR_DHT_H_
@@ -0,0 +1,276 @@
+/**
+ * @file DECODIFICADOR_PWM_CO2.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Decodificador de la salida PWM de los sensores de CO2 MH-Z19, que obtiene la concentración de CO2 a partir
+ *          de las marcas de tiempo de los flancos de la señal, con descarte de períodos inválidos y promediado.
+ * @version 0.1
+ * @date 2023-02-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      La salida PWM del MH-Z19 tiene un período de 1004 ms (±5%), compuesto por un pulso en alto fijo de 2 ms, un tramo
+ *  de 1000 ms cuyo ciclo de trabajo es proporcional a la concentración de CO2, y un pulso en bajo fijo de 2 ms. Siendo
+ *  "th" el tiempo en alto y "tl" el tiempo en bajo de un período, la concentración se obtiene como:
+ *
+ *      ppm = rango * (th - 2 ms) / (th + tl - 4 ms)
+ *
+ *      El decodificador recibe los flancos de a uno, mediante "co2_pwm_decodificador_procesar_flanco()". Cada flanco
+ *  ascendente cierra el período anterior (ascendente -> descendente -> ascendente), cuyo "th" y "tl" se obtienen
+ *  directamente de las marcas de tiempo de los flancos. Los períodos cuya duración o pulsos fijos están fuera de
+ *  tolerancia (por ejemplo, por un flanco perdido o un glitch) se descartan.
+ *
+ *      Cuando se acumulan "cant_periodos_promedio" períodos válidos, se obtiene la mediana de las muestras, se descartan
+ *  las que se alejan de ella más de lo admitido, y se devuelve el promedio de las restantes.
+ *
+ *      Dado que no depende de FreeRTOS ni de los drivers del ESP32, el decodificador puede probarse en una PC con
+ *  secuencias de flancos grabadas del sensor.
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <string.h>
+
+#include "DECODIFICADOR_PWM_CO2.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+/* Desvío mínimo admitido respecto de la mediana de las muestras, en ppm. */
+#define CO2_PWM_DESVIO_MIN_PPM      50
+
+/* Desvío admitido respecto de la mediana de las muestras, en porcentaje de la mediana. */
+#define CO2_PWM_DESVIO_PCT          10
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static float CO2PwmPromedioSinOutliers(const float *muestras, uint8_t cantidad);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función que obtiene el promedio de las muestras, descartando aquellas que se alejan de la
+ *          mediana más de lo admitido.
+ *
+ * @param muestras  Muestras de concentración de CO2.
+ * @param cantidad  Cantidad de muestras (mayor a 0).
+ * @return float    Promedio de las muestras no descartadas.
+ */
+static float CO2PwmPromedioSinOutliers(const float *muestras, uint8_t cantidad)
+{
+    /**
+     *  Se ordena una copia de las muestras para obtener la mediana.
+     */
+    float ordenadas[CO2_PWM_CANT_MAX_PERIODOS];
+    memcpy(ordenadas, muestras, cantidad * sizeof(float));
+
+    for(uint8_t i = 1; i < cantidad; i++)
+    {
+        float valor = ordenadas[i];
+        int j = i - 1;
+
+        while(j >= 0 && ordenadas[j] > valor)
+        {
+            ordenadas[j + 1] = ordenadas[j];
+            j--;
+        }
+
+        ordenadas[j + 1] = valor;
+    }
+
+    float mediana = (cantidad % 2) ? ordenadas[cantidad / 2]
+                                   : (ordenadas[cantidad / 2 - 1] + ordenadas[cantidad / 2]) / 2;
+
+    float desvio_admitido = mediana * CO2_PWM_DESVIO_PCT / 100;
+
+    if(desvio_admitido < CO2_PWM_DESVIO_MIN_PPM)
+    {
+        desvio_admitido = CO2_PWM_DESVIO_MIN_PPM;
+    }
+
+    /**
+     *  Se promedian las muestras cercanas a la mediana. Al menos la muestra central cumple
+     *  la condición, por lo que el promedio siempre está definido.
+     */
+    float suma = 0;
+    uint8_t cant_validas = 0;
+
+    for(uint8_t i = 0; i < cantidad; i++)
+    {
+        float desvio = ordenadas[i] - mediana;
+
+        if(desvio <= desvio_admitido && desvio >= -desvio_admitido)
+        {
+            suma += ordenadas[i];
+            cant_validas++;
+        }
+    }
+
+    return (cant_validas > 0) ? suma / cant_validas : mediana;
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para inicializar el decodificador.
+ *
+ * @param dec                       Decodificador.
+ * @param rango_ppm                 Rango de medición configurado en el sensor (2000, 5000 o 10000 ppm).
+ * @param cant_periodos_promedio    Cantidad de períodos válidos que se promedian por resultado (1 a
+ *                                  "CO2_PWM_CANT_MAX_PERIODOS").
+ */
+void co2_pwm_decodificador_init(co2_pwm_decodificador_t *dec, uint16_t rango_ppm, uint8_t cant_periodos_promedio)
+{
+    if(cant_periodos_promedio == 0)
+    {
+        cant_periodos_promedio = 1;
+    }
+
+    if(cant_periodos_promedio > CO2_PWM_CANT_MAX_PERIODOS)
+    {
+        cant_periodos_promedio = CO2_PWM_CANT_MAX_PERIODOS;
+    }
+
+    memset(dec, 0, sizeof(co2_pwm_decodificador_t));
+    dec->rango_ppm = rango_ppm;
+    dec->cant_periodos_promedio = cant_periodos_promedio;
+}
+
+
+
+/**
+ * @brief   Función para descartar el período en curso y las muestras acumuladas, por ejemplo luego de
+ *          un desborde del buffer de flancos o de un timeout.
+ *
+ * @param dec   Decodificador.
+ */
+void co2_pwm_decodificador_reset(co2_pwm_decodificador_t *dec)
+{
+    dec->sincronizado = 0;
+    dec->flanco_descendente_recibido = 0;
+    dec->cant_muestras = 0;
+}
+
+
+
+/**
+ * @brief   Función para obtener la concentración de CO2 correspondiente a un único período de la señal PWM.
+ *
+ * @param rango_ppm     Rango de medición configurado en el sensor.
+ * @param th_us         Tiempo en alto del período, en microsegundos.
+ * @param tl_us         Tiempo en bajo del período, en microsegundos.
+ * @param ppm           Variable donde se guardará la concentración de CO2.
+ * @return true     Período válido.
+ * @return false    Período fuera de tolerancia, que debe descartarse.
+ */
+bool co2_pwm_decodificar_periodo(uint16_t rango_ppm, int64_t th_us, int64_t tl_us, float *ppm)
+{
+    const int64_t periodo_min = (int64_t) CO2_PWM_PERIODO_NOMINAL_US * (100 - CO2_PWM_TOLERANCIA_PERIODO_PCT) / 100;
+    const int64_t periodo_max = (int64_t) CO2_PWM_PERIODO_NOMINAL_US * (100 + CO2_PWM_TOLERANCIA_PERIODO_PCT) / 100;
+    const int64_t pulso_fijo_min = (int64_t) CO2_PWM_PULSO_FIJO_US * (100 - CO2_PWM_TOLERANCIA_PERIODO_PCT) / 100;
+
+    int64_t periodo = th_us + tl_us;
+
+    if(periodo < periodo_min || periodo > periodo_max || th_us < pulso_fijo_min || tl_us < pulso_fijo_min)
+    {
+        return 0;
+    }
+
+    float resultado = (float) rango_ppm * (th_us - CO2_PWM_PULSO_FIJO_US) / (periodo - 2 * CO2_PWM_PULSO_FIJO_US);
+
+    /**
+     *  Dentro de la tolerancia de los pulsos fijos, el resultado puede quedar levemente fuera del rango.
+     */
+    if(resultado < 0)
+    {
+        resultado = 0;
+    }
+
+    if(resultado > rango_ppm)
+    {
+        resultado = rango_ppm;
+    }
+
+    *ppm = resultado;
+
+    return 1;
+}
+
+
+
+/**
+ * @brief   Función para procesar un flanco de la señal PWM del sensor.
+ *
+ * @param dec       Decodificador.
+ * @param flanco    Flanco a procesar. Los flancos deben pasarse en orden cronológico.
+ * @param ppm       Variable donde se guardará la concentración de CO2, si se completó un nuevo resultado.
+ * @return true     Se obtuvo un nuevo resultado, promedio de "cant_periodos_promedio" períodos válidos.
+ * @return false    No hay un nuevo resultado.
+ */
+bool co2_pwm_decodificador_procesar_flanco(co2_pwm_decodificador_t *dec, const co2_pwm_flanco_t *flanco, float *ppm)
+{
+    if(!flanco->nivel)
+    {
+        /**
+         *  Dos flancos descendentes consecutivos indican que se perdió un flanco ascendente, por lo que
+         *  se debe esperar al inicio de un nuevo período.
+         */
+        if(!dec->sincronizado || dec->flanco_descendente_recibido)
+        {
+            dec->sincronizado = 0;
+            return 0;
+        }
+
+        dec->flanco_descendente_us = flanco->tiempo_us;
+        dec->flanco_descendente_recibido = 1;
+
+        return 0;
+    }
+
+    /**
+     *  Flanco ascendente: se cierra el período en curso, si está completo, y se inicia uno nuevo.
+     */
+    bool periodo_completo = dec->sincronizado && dec->flanco_descendente_recibido;
+    int64_t th = dec->flanco_descendente_us - dec->inicio_periodo_us;
+    int64_t tl = flanco->tiempo_us - dec->flanco_descendente_us;
+
+    dec->inicio_periodo_us = flanco->tiempo_us;
+    dec->sincronizado = 1;
+    dec->flanco_descendente_recibido = 0;
+
+    if(!periodo_completo)
+    {
+        return 0;
+    }
+
+    float muestra;
+
+    if(!co2_pwm_decodificar_periodo(dec->rango_ppm, th, tl, &muestra))
+    {
+        dec->periodos_descartados++;
+        return 0;
+    }
+
+    dec->muestras_ppm[dec->cant_muestras++] = muestra;
+
+    if(dec->cant_muestras < dec->cant_periodos_promedio)
+    {
+        return 0;
+    }
+
+    *ppm = CO2PwmPromedioSinOutliers(dec->muestras_ppm, dec->cant_muestras);
+    dec->cant_muestras = 0;
+
+    return 1;
+}
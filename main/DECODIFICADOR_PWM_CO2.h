@@ -0,0 +1,74 @@
+/*
+
+    Decodificador de la salida PWM de los sensores de CO2 de la familia MH-Z19, a partir de una secuencia de flancos
+    con sus marcas de tiempo. No depende de FreeRTOS ni de los drivers del ESP32, de modo que puede utilizarse
+    con flancos capturados en una interrupción o con flancos grabados previamente.
+
+*/
+
+#ifndef DECODIFICADOR_PWM_CO2_H_
+#define DECODIFICADOR_PWM_CO2_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/* Cantidad máxima de períodos que se pueden promediar para obtener un resultado. */
+#define CO2_PWM_CANT_MAX_PERIODOS       8
+
+/* Período nominal de la señal PWM del sensor MH-Z19, en microsegundos. */
+#define CO2_PWM_PERIODO_NOMINAL_US      1004000
+
+/* Tolerancia del período de la señal PWM, en porcentaje del período nominal. */
+#define CO2_PWM_TOLERANCIA_PERIODO_PCT  5
+
+/* Duración de los pulsos fijos de inicio y fin de cada período, en microsegundos. */
+#define CO2_PWM_PULSO_FIJO_US           2000
+
+/**
+ *  Estructura que representa un flanco de la señal PWM.
+ */
+typedef struct {
+    int64_t tiempo_us;          /* Marca de tiempo del flanco, en microsegundos. */
+    bool nivel;                 /* Nivel de la señal luego del flanco (1: flanco ascendente). */
+} co2_pwm_flanco_t;
+
+
+/**
+ *  Estructura con el estado del decodificador. Sus campos son internos, y se deben
+ *  inicializar mediante "co2_pwm_decodificador_init()".
+ */
+typedef struct {
+    uint16_t rango_ppm;                                 /* Rango de medición del sensor (2000, 5000 o 10000 ppm). */
+    uint8_t cant_periodos_promedio;                     /* Cantidad de períodos válidos que componen un resultado. */
+    bool sincronizado;                                  /* Se recibió un flanco ascendente que inicia un período. */
+    bool flanco_descendente_recibido;                   /* Se recibió el flanco descendente del período en curso. */
+    int64_t inicio_periodo_us;                          /* Marca de tiempo del inicio del período en curso. */
+    int64_t flanco_descendente_us;                      /* Marca de tiempo del flanco descendente del período en curso. */
+    uint8_t cant_muestras;                              /* Cantidad de muestras acumuladas para el próximo resultado. */
+    float muestras_ppm[CO2_PWM_CANT_MAX_PERIODOS];      /* Concentración obtenida en cada período válido. */
+    uint32_t periodos_descartados;                      /* Contador de períodos descartados por estar fuera de tolerancia. */
+} co2_pwm_decodificador_t;
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+void co2_pwm_decodificador_init(co2_pwm_decodificador_t *dec, uint16_t rango_ppm, uint8_t cant_periodos_promedio);
+void co2_pwm_decodificador_reset(co2_pwm_decodificador_t *dec);
+bool co2_pwm_decodificador_procesar_flanco(co2_pwm_decodificador_t *dec, const co2_pwm_flanco_t *flanco, float *ppm);
+bool co2_pwm_decodificar_periodo(uint16_t rango_ppm, int64_t th_us, int64_t tl_us, float *ppm);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DECODIFICADOR_PWM_CO2_H_
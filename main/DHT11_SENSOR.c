@@ -14,15 +14,27 @@
 /**
  * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
  *  
- *          
+ *      La lectura del sensor se realiza sin deshabilitar las interrupciones ni bloquear el procesador durante la trama.
+ *  La tarea mantiene la línea de datos en bajo durante el pulso de inicio mediante "vTaskDelay()", y luego la libera
+ *  habilitando la interrupción de GPIO en ambos flancos. La rutina de interrupción solo guarda la marca de tiempo y
+ *  el nivel de cada flanco, y avisa a la tarea cuando se recibió la trama completa. Finalmente, la tarea decodifica
+ *  la duración de los pulsos mediante "DECODIFICADOR_DHT".
+ *
+ *      Si la captura de algún flanco se demora (por ejemplo, por una interrupción de mayor prioridad), el pulso queda
+ *  fuera de tolerancia o falla el checksum, y la medición se descarta como cualquier otro error de lectura.
+ *
+ *      Si el sensor se inicializa mediante "DHT11_sensor_init_planificado()", no se crea la tarea propia del sensor, y
+ *  las mediciones las realiza la tarea de "PLANIFICADOR_ADQUISICION", que es la que recibe el aviso de la rutina de
+ *  interrupción. Una medición bloquea a la tarea a lo sumo DHT11_COSTO_MEDICION_MS.
  */
 
 
 
 //==================================| INCLUDES |==================================//
 
-#include "dht.h"
 #include "DHT11_SENSOR.h"
+#include "DECODIFICADOR_DHT.h"
+#include "PLANIFICADOR_ADQUISICION.h"
 
 #include "esp_log.h"
 #include "esp_err.h"
@@ -30,17 +42,54 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <esp_timer.h>
 
 //==================================| MACROS AND TYPDEF |==================================//
 
+/**
+ *  Duración del pulso de inicio en bajo, en milisegundos (al menos 18 ms para el DHT11). Se suma un tick
+ *  para que "vTaskDelay()" no lo acorte.
+ */
+#define DHT11_PULSO_INICIO_MS       20
+
+/* Tiempo máximo de espera de la trama completa (de unos 4 ms), en milisegundos. */
+#define DHT11_TIMEOUT_TRAMA_MS      10
+
+/* Cantidad de flancos que puede almacenar el buffer de captura. */
+#define DHT11_CANT_FLANCOS_BUFFER   (DHT_DECOD_CANT_FLANCOS_TRAMA + 8)
+
+/* Período de medición de la tarea propia del sensor, en milisegundos. */
+#define DHT11_PERIODO_MS            3000
+
+/* Período mínimo entre mediciones que admite el DHT11, en milisegundos. */
+#define DHT11_PERIODO_MIN_MS        1000
+
+/**
+ *  Duración máxima de una medición, en milisegundos: pulso de inicio y timeout de la trama, con un
+ *  tick adicional en cada espera.
+ */
+#define DHT11_COSTO_MEDICION_MS     (DHT11_PULSO_INICIO_MS + DHT11_TIMEOUT_TRAMA_MS + 2 * portTICK_PERIOD_MS)
+
 //==================================| INTERNAL DATA DEFINITION |==================================//
 
 /* Tag para imprimir información en el LOG. */
 static const char *TAG = "DHT11_SENSOR_LIBRARY";
 
-/* Handle de la tarea de obtención de datos del sensor DHT11. */
+/* Handle de la tarea propia del sensor DHT11 (NULL si las mediciones las realiza el planificador). */
 static TaskHandle_t xDHT11TaskHandle = NULL;
 
+/**
+ *  Semáforo con el que la rutina de interrupción avisa el fin de la trama. Se usa un semáforo propio
+ *  y no la notificación de la tarea, porque la tarea del planificador de adquisición también recibe
+ *  notificaciones al agregarse sensores.
+ */
+static SemaphoreHandle_t DHT11_sem_trama = NULL;
+
+/* Bandera que indica que las mediciones las realiza el planificador de adquisición. */
+static bool DHT11_planificado = 0;
+
 /* Puntero a función que apuntará a la función callback pasada como argumento en la función de configuración de callback. */
 DHT11SensorCallbackFunction DHT11Callback = NULL;
 
@@ -53,65 +102,216 @@ static DHT11_sensor_hum_t DHT11_hum_value = 0;
 /* Variable que representa el pin GPIO al cual está conectado en sensor DHT11. */
 static DHT11_sensor_data_pin_t DHT11_SENSOR_DATA_PIN;
 
+/* Buffer donde la rutina de interrupción guarda los flancos de la trama con su marca de tiempo. */
+static dht_decod_flanco_t DHT11_flancos[DHT11_CANT_FLANCOS_BUFFER];
+
+/* Cantidad de flancos capturados de la trama en curso. */
+static volatile uint8_t DHT11_cant_flancos = 0;
+
 //==================================| EXTERNAL DATA DEFINITION |==================================//
 
 //==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
 
 static void vTaskGetTempAndHum(void *pvParameters);
+static void dht11_sensor_isr_handler(void *args);
+static esp_err_t DHT11LeerTrama(uint8_t datos[DHT_DECOD_BYTES]);
+static esp_err_t DHT11Medir(void);
+static esp_err_t DHT11AdqMedir(void *contexto, adq_muestra_t *muestras, size_t *cantidad);
+static esp_err_t DHT11ConfigurarPin(DHT11_sensor_data_pin_t DHT11_sens_data_pin);
 
 //==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
 
 /**
- * @brief   Tarea encargada de obtener los valores de temperatura y humedad relativa desde el sensor DHT11.
+ * @brief   Rutina de servicio de interrupción de GPIO, que se ejecuta en ambos flancos de la línea de datos
+ *          del sensor, y guarda el flanco con su marca de tiempo.
  * 
- * @param pvParameters  Parámetros pasados a la tarea en su creación.
+ * @param args  Parámetros pasados a la rutina de servicios de interrupción de GPIO.
  */
-static void vTaskGetTempAndHum(void *pvParameters)
+static void dht11_sensor_isr_handler(void *args)
 {
-    while (1) {
+    int64_t tiempo = esp_timer_get_time();
+
+    BaseType_t xHigherPriorityTaskWoken;
+    xHigherPriorityTaskWoken = pdFALSE;
+
+    if(DHT11_cant_flancos < DHT11_CANT_FLANCOS_BUFFER)
+    {
+        DHT11_flancos[DHT11_cant_flancos].tiempo_us = tiempo;
+        DHT11_flancos[DHT11_cant_flancos].nivel = gpio_get_level(DHT11_SENSOR_DATA_PIN);
+        DHT11_cant_flancos++;
 
         /**
-         *  Se obtiene el valor de temperatura y humedad relativa desde el sensor DHT11.
+         *  Al recibir el flanco descendente que finaliza el último bit, se avisa a la tarea.
          */
-        if(dht_read_float_data(DHT_TYPE_DHT11, DHT11_SENSOR_DATA_PIN, &DHT11_hum_value, &DHT11_temp_value) != ESP_OK)
+        if(DHT11_cant_flancos == DHT_DECOD_CANT_FLANCOS_TRAMA)
         {
-            /**
-             *  En caso de error de medición del sensor, cargamos a la variable de temperatura
-             *  y de humedad el valor definido para detección de error de forma externa a la librería.
-             */
-            DHT11_hum_value = DHT11_MEASURE_ERROR;
-            DHT11_temp_value = DHT11_MEASURE_ERROR;
-            ESP_LOGE(TAG, "Failed to get temp and hum.");
+            xSemaphoreGiveFromISR(DHT11_sem_trama, &xHigherPriorityTaskWoken);
         }
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+
+
+/**
+ * @brief   Función para solicitar una trama al sensor y capturar sus flancos mediante la interrupción
+ *          de GPIO, sin bloquear el procesador.
+ * 
+ * @param datos     Buffer donde se guardarán los 5 bytes de la trama.
+ * @return esp_err_t 
+ */
+static esp_err_t DHT11LeerTrama(uint8_t datos[DHT_DECOD_BYTES])
+{
+    /**
+     *  Pulso de inicio: se mantiene la línea en bajo mientras la tarea está bloqueada.
+     */
+    gpio_set_level(DHT11_SENSOR_DATA_PIN, 0);
+    vTaskDelay(pdMS_TO_TICKS(DHT11_PULSO_INICIO_MS) + 1);
+
+    /**
+     *  Se habilita la captura de flancos y se libera la línea, de modo que el sensor comience
+     *  a transmitir la trama. Fuera de la trama el tipo de interrupción está deshabilitado, de modo
+     *  que el flanco descendente del pulso de inicio no queda pendiente, y la cuenta de flancos
+     *  comienza con el flanco ascendente al liberar la línea.
+     */
+    DHT11_cant_flancos = 0;
+    xSemaphoreTake(DHT11_sem_trama, 0);
+    gpio_set_intr_type(DHT11_SENSOR_DATA_PIN, GPIO_INTR_ANYEDGE);
+    gpio_intr_enable(DHT11_SENSOR_DATA_PIN);
+    gpio_set_level(DHT11_SENSOR_DATA_PIN, 1);
+
+    BaseType_t trama_completa = xSemaphoreTake(DHT11_sem_trama, pdMS_TO_TICKS(DHT11_TIMEOUT_TRAMA_MS) + 1);
+
+    gpio_intr_disable(DHT11_SENSOR_DATA_PIN);
+    gpio_set_intr_type(DHT11_SENSOR_DATA_PIN, GPIO_INTR_DISABLE);
+
+    if(trama_completa != pdTRUE)
+    {
+        ESP_LOGE(TAG, "TIMEOUT ERROR: Got %u of %u edges.", DHT11_cant_flancos, DHT_DECOD_CANT_FLANCOS_TRAMA);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return dht_decod_decodificar_trama(DHT11_flancos, DHT11_cant_flancos, datos);
+}
+
+
 
 
+/**
+ * @brief   Función para obtener los valores de temperatura y humedad relativa desde el sensor DHT11, y ejecutar
+ *          la función callback configurada. Se llama desde la tarea propia del sensor o desde la del planificador.
+ * 
+ * @return esp_err_t 
+ */
+static esp_err_t DHT11Medir(void)
+{
+    uint8_t datos[DHT_DECOD_BYTES];
+    esp_err_t err = DHT11LeerTrama(datos);
+
+    if(err == ESP_OK)
+    {
+        dht_decod_convertir(DHT_DECOD_DHT11, datos, &DHT11_hum_value, &DHT11_temp_value);
+    }
+
+    else
+    {
         /**
-         *  Se ejecuta la función callback configurada.
+         *  En caso de error de medición del sensor, cargamos a la variable de temperatura
+         *  y de humedad el valor definido para detección de error de forma externa a la librería.
          */
-        if(DHT11Callback != NULL)
-        {
-            DHT11Callback(NULL);
-        }
+        DHT11_hum_value = DHT11_MEASURE_ERROR;
+        DHT11_temp_value = DHT11_MEASURE_ERROR;
+        ESP_LOGE(TAG, "Failed to get temp and hum (%s).", esp_err_to_name(err));
+    }
+
+
+    /**
+     *  Se ejecuta la función callback configurada.
+     */
+    if(DHT11Callback != NULL)
+    {
+        DHT11Callback(NULL);
+    }
+
+    return err;
+}
+
+
+
+/**
+ * @brief   Tarea encargada de obtener los valores de temperatura y humedad relativa desde el sensor DHT11.
+ * 
+ * @param pvParameters  Parámetros pasados a la tarea en su creación.
+ */
+static void vTaskGetTempAndHum(void *pvParameters)
+{
+    while (1) {
+
+        DHT11Medir();
         
-        vTaskDelay(pdMS_TO_TICKS(3000));
+        vTaskDelay(pdMS_TO_TICKS(DHT11_PERIODO_MS));
     }
 }
 
-//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
 
 /**
- * @brief   Función para inicializar el sensor de temperatura y humedad relativa DHT11.
+ * @brief   Función de medición del sensor DHT11 para el planificador de adquisición. Se ejecuta desde la tarea
+ *          del planificador, y entrega una muestra de temperatura y otra de humedad relativa.
+ * 
+ * @param contexto  No utilizado.
+ * @param muestras  Buffer donde se guardarán las muestras.
+ * @param cantidad  Variable donde se guardará la cantidad de muestras.
+ * @return esp_err_t 
+ */
+static esp_err_t DHT11AdqMedir(void *contexto, adq_muestra_t *muestras, size_t *cantidad)
+{
+    esp_err_t err = DHT11Medir();
+    adq_calidad_t calidad = adq_calidad_desde_error(err);
+
+    muestras[0].magnitud = ADQ_MAGNITUD_TEMP_AMB;
+    muestras[0].valor = DHT11_temp_value;
+    muestras[0].calidad = calidad;
+
+    muestras[1].magnitud = ADQ_MAGNITUD_HUM_AMB;
+    muestras[1].valor = DHT11_hum_value;
+    muestras[1].calidad = calidad;
+
+    *cantidad = 2;
+
+    return err;
+}
+
+
+
+/**
+ * @brief   Función para configurar el pin de datos del sensor y su rutina de interrupción.
  * 
  * @param DHT11_sens_data_pin    Pin de datos del sensor.
  * @return esp_err_t 
  */
-esp_err_t DTH11_sensor_init(DHT11_sensor_data_pin_t DHT11_sens_data_pin)
+static esp_err_t DHT11ConfigurarPin(DHT11_sensor_data_pin_t DHT11_sens_data_pin)
 {
     /**
      *  Se guarda el GPIO al cual está conectado el pin de datos del sensor.
      */
     DHT11_SENSOR_DATA_PIN = DHT11_sens_data_pin;
 
+    /**
+     *  Se crea el semáforo con el que la rutina de interrupción avisa el fin de la trama.
+     */
+    if(DHT11_sem_trama == NULL)
+    {
+        DHT11_sem_trama = xSemaphoreCreateBinary();
+
+        if(DHT11_sem_trama == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to create the frame semaphore.");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
 
 
     //========================| CONFIGURACIÓN DE GPIO |===========================//
@@ -121,14 +321,20 @@ esp_err_t DTH11_sensor_init(DHT11_sensor_data_pin_t DHT11_sens_data_pin)
 
     /* Se define mediante mascara de bits el GPIO que configuraremos */
     pGPIOConfig.pin_bit_mask = (1ULL << DHT11_sens_data_pin);
-    /* Se define si el pin es I u O (input en este caso) */
-    pGPIOConfig.mode = GPIO_MODE_DEF_INPUT;
+    /**
+     *  Se define si el pin es I u O (entrada y salida open-drain en este caso, para generar el pulso
+     *  de inicio y leer la trama sin reconfigurar el pin).
+     */
+    pGPIOConfig.mode = GPIO_MODE_INPUT_OUTPUT_OD;
     /* Habilitamos o deshabilitamos la resistencia interna de pull-up (deshabilitada en este caso) */
     pGPIOConfig.pull_up_en = GPIO_PULLUP_DISABLE;
     /* Habilitamos o deshabilitamos la resistencia interna de pull-down (deshabilitada en este caso) */
     pGPIOConfig.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    /* Definimos si habilitamos la interrupción, y si es asi, de qué tipo (deshabilitada en este caso) */
-    pGPIOConfig.intr_type = GPIO_INTR_DISABLE;
+    /**
+     *  Definimos si habilitamos la interrupción, y si es asi, de qué tipo (en ambos flancos, pero solo
+     *  se la habilita durante la lectura de cada trama)
+     */
+    pGPIOConfig.intr_type = GPIO_INTR_ANYEDGE;
     
     /**
      *  Función para configurar un pin GPIO. 
@@ -136,6 +342,45 @@ esp_err_t DTH11_sensor_init(DHT11_sensor_data_pin_t DHT11_sens_data_pin)
      */
     ESP_RETURN_ON_ERROR(gpio_config(&pGPIOConfig), TAG, "Failed to load gpio config.");
 
+    gpio_intr_disable(DHT11_sens_data_pin);
+    gpio_set_intr_type(DHT11_sens_data_pin, GPIO_INTR_DISABLE);
+    gpio_set_level(DHT11_sens_data_pin, 1);
+
+    /**
+     *  Se instala el servicio de interrupciones de GPIO. Si ya fue instalado por otro módulo, se
+     *  obtiene ESP_ERR_INVALID_STATE, que no es un error.
+     */
+    esp_err_t err = gpio_install_isr_service(0);
+
+    if(err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Failed to install ISR.");
+        return err;
+    }
+
+    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(DHT11_sens_data_pin, dht11_sensor_isr_handler, NULL), 
+                        TAG, "Failed to add the ISR handler.");
+
+    return ESP_OK;
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para inicializar el sensor de temperatura y humedad relativa DHT11.
+ * 
+ * @param DHT11_sens_data_pin    Pin de datos del sensor.
+ * @return esp_err_t 
+ */
+esp_err_t DTH11_sensor_init(DHT11_sensor_data_pin_t DHT11_sens_data_pin)
+{
+    if(DHT11_planificado)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ESP_RETURN_ON_ERROR(DHT11ConfigurarPin(DHT11_sens_data_pin), TAG, "Failed to configure data pin.");
+
 
 
     //========================| CREACIÓN DE TAREA |===========================//
@@ -173,6 +418,47 @@ esp_err_t DTH11_sensor_init(DHT11_sensor_data_pin_t DHT11_sens_data_pin)
 
 
 
+/**
+ * @brief   Función para inicializar el sensor de temperatura y humedad relativa DHT11 sin tarea propia,
+ *          registrándolo en el planificador de adquisición, que debe estar inicializado.
+ * 
+ * @param DHT11_sens_data_pin   Pin de datos del sensor.
+ * @param periodo_ms            Período de medición, en milisegundos (al menos DHT11_PERIODO_MIN_MS).
+ * @param id_sensor             Variable donde se guardará el identificador del sensor en el planificador. Puede ser NULL.
+ * @return esp_err_t 
+ */
+esp_err_t DHT11_sensor_init_planificado(DHT11_sensor_data_pin_t DHT11_sens_data_pin, uint32_t periodo_ms, uint8_t *id_sensor)
+{
+    if(periodo_ms < DHT11_PERIODO_MIN_MS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if(DHT11_planificado || xDHT11TaskHandle != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ESP_RETURN_ON_ERROR(DHT11ConfigurarPin(DHT11_sens_data_pin), TAG, "Failed to configure data pin.");
+
+    adq_sensor_config_t config = {
+        .nombre = "DHT11",
+        .medir = DHT11AdqMedir,
+        .contexto = NULL,
+        .periodo_ms = periodo_ms,
+        .plazo_ms = 0,
+        .costo_ms = DHT11_COSTO_MEDICION_MS,
+    };
+
+    ESP_RETURN_ON_ERROR(adq_planif_agregar_sensor(&config, id_sensor), TAG, "Failed to add the sensor to the scheduler.");
+
+    DHT11_planificado = 1;
+
+    return ESP_OK;
+}
+
+
+
 /**
  * @brief   Función para guardar en la variable pasada como argumento el valor de temperatura
  *          obtenido del sensor DHT11.
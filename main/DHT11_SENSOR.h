@@ -14,6 +14,7 @@ extern "C" {
 /*==================[INCLUDES]=============================================*/
 
 #include <stdio.h>
+#include <stdint.h>
 #include "esp_err.h"
 #include "driver/gpio.h"
 
@@ -36,6 +37,7 @@ typedef void (*DHT11SensorCallbackFunction)(void *pvParameters);
 /*==================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
 
 esp_err_t DTH11_sensor_init(DHT11_sensor_data_pin_t DHT11_sens_data_pin);
+esp_err_t DHT11_sensor_init_planificado(DHT11_sensor_data_pin_t DHT11_sens_data_pin, uint32_t periodo_ms, uint8_t *id_sensor);
 esp_err_t DHT11_getTemp(DHT11_sensor_temp_t *DHT11_temp_value_buffer);
 esp_err_t DHT11_getHum(DHT11_sensor_hum_t *DHT11_hum_value_buffer);
 void DHT11_callback_function_on_new_measurment(DHT11SensorCallbackFunction callback_function);
@@ -0,0 +1,548 @@
+/**
+ * @file HISTORIAL_SENSORES.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Historial de tamaño fijo de las variables ambientales (temperatura, humedad relativa y CO2 ambiente), con
+ *          submuestreo en el propio ESP32 y consulta de rangos mediante MQTT.
+ * @version 0.1
+ * @date 2023-02-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Por cada magnitud (temperatura, humedad y CO2) se tiene un buffer circular por cada resolución temporal definida en
+ *  el header (1 min, 15 min y 1 hora). Cada elemento del buffer es un intervalo en donde se acumulan el mínimo, el máximo
+ *  y la suma de las muestras que llegan durante el mismo, de modo que el promedio se obtiene al momento de la consulta.
+ *
+ *      Al llegar una muestra mediante "historial_sensores_agregar_muestra()", se la acumula en el intervalo actual de cada
+ *  una de las resoluciones. Si el tiempo actual ya corresponde a un intervalo posterior, se avanza el buffer circular,
+ *  dejando vacíos (cantidad de muestras en 0) los intervalos en los que no llegaron datos. De esta forma, la memoria
+ *  utilizada es fija sin importar la frecuencia de las muestras.
+ *
+ *      Los buffers se intentan reservar en la PSRAM externa, si es que la placa la tiene, y en caso contrario se reservan
+ *  en la RAM interna.
+ *
+ *      Para consultar el historial vía MQTT, se publica en el tópico "HISTORIAL_SOLICITUD_MQTT_TOPIC" un mensaje con el
+ *  formato "MAGNITUD,RESOLUCION,CANTIDAD" (ver header), y se responde en el tópico "HISTORIAL_RESPUESTA_MQTT_TOPIC"
+ *  con un JSON de la forma:
+ *
+ *      {"magnitud":"TEMP","resolucion":15,"ahora":86400,"datos":[[t,min,max,prom],...]}
+ *
+ *  donde "ahora" son los segundos desde el arranque del ESP32 y "t" es la antigüedad del inicio de cada intervalo, en
+ *  segundos antes de "ahora". Los intervalos van del más antiguo al más reciente, y el último es siempre el intervalo en
+ *  curso, aunque no hayan llegado muestras recientemente. Los intervalos sin datos se envían con "null" en min, max y prom.
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "mqtt_client.h"
+
+#include "MQTT_PUBL_SUSCR.h"
+#include "HISTORIAL_SENSORES.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+/* Tamaño máximo estimado, en caracteres, de cada intervalo en el JSON de respuesta. */
+#define HISTORIAL_CARACTERES_POR_INTERVALO  48
+
+/**
+ *  Estructura que representa el buffer circular de una magnitud en una resolución determinada.
+ */
+typedef struct {
+    historial_intervalo_t *intervalos;  /* Buffer de intervalos. */
+    uint32_t resolucion_seg;            /* Duración de cada intervalo, en segundos. */
+    unsigned int capacidad;             /* Cantidad de intervalos del buffer. */
+    unsigned int indice_actual;         /* Índice del intervalo en curso. */
+    unsigned int cant_validos;          /* Cantidad de intervalos ya utilizados (hasta "capacidad"). */
+} historial_buffer_t;
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+/* Tag para imprimir información en el LOG. */
+static const char *historial_tag = "HISTORIAL_SENSORES";
+
+/* Handle del cliente MQTT. */
+static esp_mqtt_client_handle_t HistorialClienteMQTT = NULL;
+
+/* Mutex para proteger el acceso a los buffers del historial. */
+static SemaphoreHandle_t xHistorialMutex = NULL;
+
+/* Buffers circulares de cada magnitud en cada resolución. */
+static historial_buffer_t historial_buffers[HISTORIAL_CANT_MAGNITUDES][HISTORIAL_CANT_RESOLUCIONES];
+
+/* Resoluciones y capacidades de los buffers, definidas en el header. */
+static const uint32_t historial_resoluciones_seg[HISTORIAL_CANT_RESOLUCIONES] = {
+    HISTORIAL_RESOLUCION_1_SEG,
+    HISTORIAL_RESOLUCION_2_SEG,
+    HISTORIAL_RESOLUCION_3_SEG,
+};
+
+static const unsigned int historial_capacidades[HISTORIAL_CANT_RESOLUCIONES] = {
+    HISTORIAL_RESOLUCION_1_CANT,
+    HISTORIAL_RESOLUCION_2_CANT,
+    HISTORIAL_RESOLUCION_3_CANT,
+};
+
+/* Nombres de las magnitudes, utilizados en los mensajes MQTT de solicitud y respuesta. */
+static const char *historial_nombres_magnitudes[HISTORIAL_CANT_MAGNITUDES] = {
+    "TEMP",
+    "HUM",
+    "CO2",
+};
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static uint32_t HistorialGetTiempoSeg(void);
+static historial_buffer_t *HistorialGetBuffer(historial_magnitud_t magnitud, uint32_t resolucion_seg);
+static void HistorialAvanzarBuffer(historial_buffer_t *buffer, uint32_t tiempo_seg);
+static void HistorialAcumularMuestra(historial_buffer_t *buffer, uint32_t tiempo_seg, float valor);
+static void CallbackSolicitudHistorial(void *pvParameters);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función que devuelve el tiempo transcurrido desde el arranque del ESP32, en segundos.
+ *
+ * @return uint32_t Tiempo en segundos.
+ */
+static uint32_t HistorialGetTiempoSeg(void)
+{
+    return (uint32_t) (esp_timer_get_time() / 1000000);
+}
+
+
+
+/**
+ * @brief   Función que devuelve el buffer circular de una magnitud en la resolución indicada.
+ *
+ * @param magnitud          Magnitud del historial.
+ * @param resolucion_seg    Resolución del buffer, en segundos.
+ * @return historial_buffer_t*  Buffer correspondiente, o NULL si no existe.
+ */
+static historial_buffer_t *HistorialGetBuffer(historial_magnitud_t magnitud, uint32_t resolucion_seg)
+{
+    if(magnitud >= HISTORIAL_CANT_MAGNITUDES)
+    {
+        return NULL;
+    }
+
+    for(int i = 0; i < HISTORIAL_CANT_RESOLUCIONES; i++)
+    {
+        if(historial_buffers[magnitud][i].resolucion_seg == resolucion_seg && historial_buffers[magnitud][i].intervalos != NULL)
+        {
+            return &historial_buffers[magnitud][i];
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * @brief   Función que avanza un buffer circular hasta el intervalo correspondiente al tiempo actual,
+ *          dejando vacíos aquellos intervalos en donde no llegaron datos. Si el buffer no tiene
+ *          intervalos, no se modifica.
+ *
+ * @param buffer        Buffer circular.
+ * @param tiempo_seg    Tiempo actual, en segundos desde el arranque.
+ */
+static void HistorialAvanzarBuffer(historial_buffer_t *buffer, uint32_t tiempo_seg)
+{
+    uint32_t num_intervalo = tiempo_seg / buffer->resolucion_seg;
+
+    /**
+     *  Si el tiempo actual corresponde a un intervalo posterior al actual, se avanza el buffer tantas
+     *  posiciones como intervalos hayan transcurrido (como máximo, el buffer completo).
+     */
+    if(buffer->cant_validos > 0 && num_intervalo > buffer->intervalos[buffer->indice_actual].num_intervalo)
+    {
+        uint32_t intervalos_transcurridos = num_intervalo - buffer->intervalos[buffer->indice_actual].num_intervalo;
+
+        if(intervalos_transcurridos > buffer->capacidad)
+        {
+            intervalos_transcurridos = buffer->capacidad;
+        }
+
+        for(uint32_t i = 1; i <= intervalos_transcurridos; i++)
+        {
+            buffer->indice_actual = (buffer->indice_actual + 1) % buffer->capacidad;
+
+            memset(&buffer->intervalos[buffer->indice_actual], 0, sizeof(historial_intervalo_t));
+            buffer->intervalos[buffer->indice_actual].num_intervalo = num_intervalo - intervalos_transcurridos + i;
+
+            if(buffer->cant_validos < buffer->capacidad)
+            {
+                buffer->cant_validos++;
+            }
+        }
+    }
+}
+
+
+
+/**
+ * @brief   Función que acumula una muestra en el intervalo en curso de un buffer circular, avanzando
+ *          el buffer si el tiempo actual corresponde a un intervalo posterior.
+ *
+ * @param buffer        Buffer circular.
+ * @param tiempo_seg    Tiempo actual, en segundos desde el arranque.
+ * @param valor         Valor de la muestra.
+ */
+static void HistorialAcumularMuestra(historial_buffer_t *buffer, uint32_t tiempo_seg, float valor)
+{
+    /**
+     *  En caso de que sea la primera muestra, se inicializa el primer intervalo del buffer.
+     */
+    if(buffer->cant_validos == 0)
+    {
+        buffer->indice_actual = 0;
+        buffer->cant_validos = 1;
+        memset(&buffer->intervalos[0], 0, sizeof(historial_intervalo_t));
+        buffer->intervalos[0].num_intervalo = tiempo_seg / buffer->resolucion_seg;
+    }
+
+    else
+    {
+        HistorialAvanzarBuffer(buffer, tiempo_seg);
+    }
+
+    /**
+     *  Se acumula la muestra en el intervalo en curso.
+     */
+    historial_intervalo_t *intervalo = &buffer->intervalos[buffer->indice_actual];
+
+    if(intervalo->cant_muestras == 0)
+    {
+        intervalo->minimo = valor;
+        intervalo->maximo = valor;
+    }
+
+    else
+    {
+        if(valor < intervalo->minimo) intervalo->minimo = valor;
+        if(valor > intervalo->maximo) intervalo->maximo = valor;
+    }
+
+    intervalo->suma += valor;
+    intervalo->cant_muestras++;
+}
+
+
+
+/**
+ *  @brief  Función de callback que se ejecuta cuando llega un mensaje MQTT en el tópico
+ *          de solicitud de datos del historial.
+ *
+ * @param pvParameters
+ */
+static void CallbackSolicitudHistorial(void *pvParameters)
+{
+    /**
+     *  Se obtiene el mensaje de solicitud y se separan sus campos "MAGNITUD,RESOLUCION,CANTIDAD".
+     */
+    char buffer_solicitud[50] = "";
+    mqtt_get_char_data_from_topic(HISTORIAL_SOLICITUD_MQTT_TOPIC, buffer_solicitud);
+
+    char nombre_magnitud[8] = "";
+    unsigned int resolucion_min = 0;
+    unsigned int cantidad = 0;
+
+    if(sscanf(buffer_solicitud, "%7[^,],%u,%u", nombre_magnitud, &resolucion_min, &cantidad) != 3 || cantidad == 0)
+    {
+        ESP_LOGE(historial_tag, "INVALID HISTORY REQUEST: %s", buffer_solicitud);
+        return;
+    }
+
+    historial_magnitud_t magnitud = HISTORIAL_CANT_MAGNITUDES;
+
+    for(int i = 0; i < HISTORIAL_CANT_MAGNITUDES; i++)
+    {
+        if(!strcmp(nombre_magnitud, historial_nombres_magnitudes[i]))
+        {
+            magnitud = i;
+        }
+    }
+
+    uint32_t resolucion_seg = resolucion_min * 60;
+    historial_buffer_t *buffer_historial = HistorialGetBuffer(magnitud, resolucion_seg);
+
+    if(buffer_historial == NULL)
+    {
+        ESP_LOGE(historial_tag, "INVALID HISTORY REQUEST: %s", buffer_solicitud);
+        return;
+    }
+
+    if(cantidad > buffer_historial->capacidad)
+    {
+        cantidad = buffer_historial->capacidad;
+    }
+
+    /**
+     *  Se copian los intervalos solicitados a un buffer auxiliar, de modo de no retener el mutex
+     *  mientras se arma y publica la respuesta.
+     */
+    size_t tam_respuesta = cantidad * HISTORIAL_CARACTERES_POR_INTERVALO + 100;
+    historial_intervalo_t *intervalos = malloc(cantidad * sizeof(historial_intervalo_t));
+    char *respuesta = malloc(tam_respuesta);
+
+    if(intervalos == NULL || respuesta == NULL)
+    {
+        ESP_LOGE(historial_tag, "Failed to allocate memory for history response.");
+        goto LIBERAR_MEMORIA;
+    }
+
+    int cant_intervalos = historial_sensores_get_intervalos(magnitud, resolucion_seg, intervalos, cantidad);
+
+    if(cant_intervalos < 0)
+    {
+        goto LIBERAR_MEMORIA;
+    }
+
+    /**
+     *  Se arma el JSON de respuesta, con los intervalos del más antiguo al más reciente. El inicio de
+     *  cada intervalo se informa como antigüedad respecto del tiempo actual.
+     */
+    uint32_t ahora = HistorialGetTiempoSeg();
+    int largo = snprintf(respuesta, tam_respuesta, "{\"magnitud\":\"%s\",\"resolucion\":%u,\"ahora\":%u,\"datos\":[",
+                         historial_nombres_magnitudes[magnitud], resolucion_min, (unsigned int) ahora);
+
+    for(int i = 0; i < cant_intervalos && largo >= 0 && (size_t) largo < tam_respuesta; i++)
+    {
+        uint32_t inicio_intervalo = intervalos[i].num_intervalo * resolucion_seg;
+        unsigned int antiguedad = (ahora > inicio_intervalo) ? ahora - inicio_intervalo : 0;
+        const char *separador = (i == 0) ? "" : ",";
+
+        if(intervalos[i].cant_muestras == 0)
+        {
+            largo += snprintf(respuesta + largo, tam_respuesta - largo, "%s[%u,null,null,null]",
+                              separador, antiguedad);
+        }
+
+        else
+        {
+            largo += snprintf(respuesta + largo, tam_respuesta - largo, "%s[%u,%.1f,%.1f,%.1f]",
+                              separador, antiguedad, intervalos[i].minimo, intervalos[i].maximo,
+                              intervalos[i].suma / intervalos[i].cant_muestras);
+        }
+    }
+
+    if(largo < 0 || (size_t) largo + 3 > tam_respuesta)
+    {
+        ESP_LOGE(historial_tag, "History response truncated.");
+        goto LIBERAR_MEMORIA;
+    }
+
+    snprintf(respuesta + largo, 3, "]}");
+
+    if(mqtt_check_connection())
+    {
+        esp_mqtt_client_publish(HistorialClienteMQTT, HISTORIAL_RESPUESTA_MQTT_TOPIC, respuesta, 0, 0, 0);
+    }
+
+    /**
+     *  Se libera la memoria reservada.
+     */
+    LIBERAR_MEMORIA: ;
+    free(intervalos);
+    free(respuesta);
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para inicializar el historial de las variables ambientales, reservando la memoria de
+ *          los buffers circulares y suscribiéndose al tópico MQTT de solicitud de datos.
+ *
+ * @param mqtt_client   Handle del cliente MQTT.
+ * @return esp_err_t
+ */
+esp_err_t historial_sensores_init(esp_mqtt_client_handle_t mqtt_client)
+{
+    /**
+     *  Copiamos el handle del cliente MQTT en la variable interna.
+     */
+    HistorialClienteMQTT = mqtt_client;
+
+    /**
+     *  Se crea el mutex de acceso a los buffers.
+     */
+    if(xHistorialMutex == NULL)
+    {
+        xHistorialMutex = xSemaphoreCreateMutex();
+
+        if(xHistorialMutex == NULL)
+        {
+            ESP_LOGE(historial_tag, "Failed to create history mutex.");
+            return ESP_FAIL;
+        }
+    }
+
+    //=======================| RESERVA DE MEMORIA |=======================//
+
+    /**
+     *  Se reserva la memoria de cada buffer circular, intentando primero en la PSRAM externa
+     *  y luego, si no hay PSRAM o no alcanza, en la RAM interna.
+     */
+    for(int magnitud = 0; magnitud < HISTORIAL_CANT_MAGNITUDES; magnitud++)
+    {
+        for(int res = 0; res < HISTORIAL_CANT_RESOLUCIONES; res++)
+        {
+            historial_buffer_t *buffer = &historial_buffers[magnitud][res];
+
+            if(buffer->intervalos != NULL)
+            {
+                continue;
+            }
+
+            buffer->intervalos = heap_caps_calloc(historial_capacidades[res], sizeof(historial_intervalo_t), MALLOC_CAP_SPIRAM);
+
+            if(buffer->intervalos == NULL)
+            {
+                buffer->intervalos = calloc(historial_capacidades[res], sizeof(historial_intervalo_t));
+            }
+
+            if(buffer->intervalos == NULL)
+            {
+                ESP_LOGE(historial_tag, "Failed to allocate memory for history buffers.");
+                return ESP_ERR_NO_MEM;
+            }
+
+            buffer->resolucion_seg = historial_resoluciones_seg[res];
+            buffer->capacidad = historial_capacidades[res];
+            buffer->indice_actual = 0;
+            buffer->cant_validos = 0;
+        }
+    }
+
+    //=======================| TÓPICOS MQTT |=======================//
+
+    /**
+     *  Se realiza la suscripción al tópico MQTT de solicitud de datos del historial.
+     */
+    mqtt_topic_t list_of_topics[] = {
+        [0].topic_name = HISTORIAL_SOLICITUD_MQTT_TOPIC,
+        [0].topic_function_cb = CallbackSolicitudHistorial,
+    };
+
+    if(mqtt_suscribe_to_topics(list_of_topics, 1, HistorialClienteMQTT, 0) != ESP_OK)
+    {
+        ESP_LOGE(historial_tag, "FAILED TO SUSCRIBE TO MQTT TOPICS.");
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para agregar una nueva muestra de una magnitud al historial, en todas sus resoluciones.
+ *
+ * @param magnitud  Magnitud a la cual corresponde la muestra.
+ * @param valor     Valor de la muestra.
+ * @return esp_err_t
+ */
+esp_err_t historial_sensores_agregar_muestra(historial_magnitud_t magnitud, float valor)
+{
+    if(magnitud >= HISTORIAL_CANT_MAGNITUDES)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if(xHistorialMutex == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t tiempo_seg = HistorialGetTiempoSeg();
+
+    xSemaphoreTake(xHistorialMutex, portMAX_DELAY);
+
+    for(int res = 0; res < HISTORIAL_CANT_RESOLUCIONES; res++)
+    {
+        if(historial_buffers[magnitud][res].intervalos != NULL)
+        {
+            HistorialAcumularMuestra(&historial_buffers[magnitud][res], tiempo_seg, valor);
+        }
+    }
+
+    xSemaphoreGive(xHistorialMutex);
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener los últimos intervalos del historial de una magnitud, en una resolución
+ *          determinada. Los intervalos se copian en el buffer del más antiguo al más reciente, y el
+ *          último es siempre el intervalo en curso (vacío si no llegaron muestras durante el mismo).
+ *
+ * @param magnitud          Magnitud del historial.
+ * @param resolucion_seg    Resolución deseada, en segundos (debe ser una de las definidas en el header).
+ * @param buffer            Buffer donde se copiarán los intervalos.
+ * @param cantidad          Cantidad máxima de intervalos a copiar.
+ * @return int  Cantidad de intervalos copiados, o -1 en caso de error.
+ */
+int historial_sensores_get_intervalos(historial_magnitud_t magnitud, uint32_t resolucion_seg,
+                                      historial_intervalo_t *buffer, unsigned int cantidad)
+{
+    historial_buffer_t *buffer_historial = HistorialGetBuffer(magnitud, resolucion_seg);
+
+    if(buffer_historial == NULL || buffer == NULL || xHistorialMutex == NULL)
+    {
+        return -1;
+    }
+
+    uint32_t tiempo_seg = HistorialGetTiempoSeg();
+
+    xSemaphoreTake(xHistorialMutex, portMAX_DELAY);
+
+    /**
+     *  Se avanza el buffer hasta el intervalo actual, de modo que los intervalos transcurridos sin
+     *  muestras se informen vacíos.
+     */
+    HistorialAvanzarBuffer(buffer_historial, tiempo_seg);
+
+    if(cantidad > buffer_historial->cant_validos)
+    {
+        cantidad = buffer_historial->cant_validos;
+    }
+
+    /**
+     *  Se parte desde el intervalo más antiguo de los solicitados y se avanza hasta el actual.
+     */
+    unsigned int indice = (buffer_historial->indice_actual + buffer_historial->capacidad - cantidad + 1) % buffer_historial->capacidad;
+
+    for(unsigned int i = 0; i < cantidad; i++)
+    {
+        buffer[i] = buffer_historial->intervalos[indice];
+        indice = (indice + 1) % buffer_historial->capacidad;
+    }
+
+    xSemaphoreGive(xHistorialMutex);
+
+    return cantidad;
+}
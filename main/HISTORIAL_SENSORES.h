@@ -0,0 +1,92 @@
+/*
+
+    Historial de las variables ambientales sensadas (temperatura, humedad relativa y CO2 ambiente), almacenado
+    en buffers circulares de tamaño fijo a distintas resoluciones temporales.
+
+*/
+
+#ifndef HISTORIAL_SENSORES_H_
+#define HISTORIAL_SENSORES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "mqtt_client.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/**
+ *  Definición de los tópicos MQTT de solicitud y respuesta de datos del historial.
+ *
+ *  El mensaje de solicitud tiene el formato "MAGNITUD,RESOLUCION,CANTIDAD", donde:
+ *
+ *  -MAGNITUD: "TEMP", "HUM" o "CO2".
+ *  -RESOLUCION: Duración de cada intervalo del historial, en minutos (1, 15 o 60).
+ *  -CANTIDAD: Cantidad de intervalos a devolver, empezando desde el más reciente.
+ *
+ *  EJEMPLO: "TEMP,15,96" -> Resumen de temperatura de las últimas 24 hs en intervalos de 15 min.
+ */
+#define HISTORIAL_SOLICITUD_MQTT_TOPIC  "/Historial/Solicitud"
+#define HISTORIAL_RESPUESTA_MQTT_TOPIC  "Historial/Respuesta"
+
+/**
+ *  Resoluciones del historial, en segundos, junto con la cantidad de intervalos que se almacenan
+ *  en cada una:
+ *
+ *  -1 min, durante 2 hs.
+ *  -15 min, durante 24 hs.
+ *  -1 hora, durante 7 días.
+ */
+#define HISTORIAL_RESOLUCION_1_SEG      60
+#define HISTORIAL_RESOLUCION_1_CANT     120
+#define HISTORIAL_RESOLUCION_2_SEG      900
+#define HISTORIAL_RESOLUCION_2_CANT     96
+#define HISTORIAL_RESOLUCION_3_SEG      3600
+#define HISTORIAL_RESOLUCION_3_CANT     168
+
+/* Cantidad de resoluciones distintas del historial. */
+#define HISTORIAL_CANT_RESOLUCIONES     3
+
+/**
+ *  Enumeración correspondiente a las magnitudes de las cuales se guarda historial.
+ */
+typedef enum {
+    HISTORIAL_TEMP_AMB = 0,
+    HISTORIAL_HUM_AMB,
+    HISTORIAL_CO2_AMB,
+    HISTORIAL_CANT_MAGNITUDES,
+} historial_magnitud_t;
+
+
+/**
+ *  Estructura que representa un intervalo del historial, en donde se acumulan las muestras
+ *  que llegan durante el mismo.
+ */
+typedef struct {
+    uint32_t num_intervalo;     /* Número de intervalo desde el arranque (tiempo / resolución). */
+    uint32_t cant_muestras;     /* Cantidad de muestras acumuladas. Si es 0, el intervalo no tiene datos. */
+    float minimo;               /* Valor mínimo del intervalo. */
+    float maximo;               /* Valor máximo del intervalo. */
+    float suma;                 /* Suma de las muestras, para calcular el promedio. */
+} historial_intervalo_t;
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+esp_err_t historial_sensores_init(esp_mqtt_client_handle_t mqtt_client);
+esp_err_t historial_sensores_agregar_muestra(historial_magnitud_t magnitud, float valor);
+int historial_sensores_get_intervalos(historial_magnitud_t magnitud, uint32_t resolucion_seg,
+                                      historial_intervalo_t *buffer, unsigned int cantidad);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HISTORIAL_SENSORES_H_
@@ -44,6 +44,8 @@
 #include "driver/i2c.h"
 #include "driver/gpio.h"
 
+#include "i2cdev.h"
+
 #include "MCP23008.h"
 
 
@@ -58,6 +60,16 @@
 /* Tag para imprimir información en el LOG. */
 static const char *TAG = "MCP23008_I2C_LIBRARY";
 
+/**
+ *  Descriptor I2C del MCP23008. Se accede al bus mediante la librería "i2cdev", de modo de poder
+ *  compartir el puerto I2C con otros dispositivos (por ejemplo, el RTC DS3231) de forma segura
+ *  entre tareas.
+ */
+static i2c_dev_t MCP23008_dev = {0};
+
+/* Dirección del registro de GPIO, que se envía antes del dato en las escrituras asíncronas del puerto. */
+static const uint8_t MCP23008_gpio_port_reg = MCP23008_GPIO_PORT_REG_ADDR;
+
 
 
 //==================================| EXTERNAL DATA DEFINITION |==================================//
@@ -81,8 +93,7 @@ static esp_err_t MCP23008_register_write_byte(uint8_t reg_addr, uint8_t data);
  */
 static esp_err_t MCP23008_register_read(uint8_t reg_addr, uint8_t *data, size_t len)
 {
-    return i2c_master_write_read_device(I2C_MASTER_NUM, MCP23008_ADDR, &reg_addr, 1, 
-                                        data, len, I2C_MASTER_TIMEOUT_MS / portTICK_RATE_MS);
+    return i2c_dev_read_reg(&MCP23008_dev, reg_addr, data, len);
 }
 
 
@@ -96,10 +107,7 @@ static esp_err_t MCP23008_register_read(uint8_t reg_addr, uint8_t *data, size_t
  */
 static esp_err_t MCP23008_register_write_byte(uint8_t reg_addr, uint8_t data)
 {
-    uint8_t write_buf[2] = {reg_addr, data};
-
-    return i2c_master_write_to_device(  I2C_MASTER_NUM, MCP23008_ADDR, write_buf, sizeof(write_buf), 
-                                        I2C_MASTER_TIMEOUT_MS / portTICK_RATE_MS);
+    return i2c_dev_write_reg(&MCP23008_dev, reg_addr, &data, 1);
 }
 
 
@@ -121,29 +129,23 @@ esp_err_t MCP23008_init(void)
     gpio_set_direction(RESET_PIN, GPIO_MODE_OUTPUT);
     gpio_set_level(RESET_PIN, 1);
 
-    /* Se selecciona el puerto de I2C, en este caso solo hay uno, que es el 0. */
-    int i2c_master_port = I2C_MASTER_NUM;
-
-    /* Se crea una variable de configuración del I2C. */
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,                        //Se establece al ESP32 como master de I2C
-        .sda_io_num = I2C_MASTER_SDA_IO,                //Se establece el pin correspondiente al SDA
-        .scl_io_num = I2C_MASTER_SCL_IO,                //Se establece el pin correspondiente al SCL
-        .sda_pullup_en = GPIO_PULLUP_DISABLE,           //Se desactiva el pull-up en el SDA dado que se tiene un pull-up externo
-        .scl_pullup_en = GPIO_PULLUP_DISABLE,           //Se desactiva el pull-up en el SCL dado que se tiene un pull-up externo
-        .master.clk_speed = I2C_MASTER_FREQ_HZ,         //Se establece la frecuencia del canal I2C
-    };
-
-    /* Se efectua la configuración del driver I2C del ESP32 */
-    ESP_RETURN_ON_ERROR(i2c_param_config(i2c_master_port, &conf), TAG, "Failed to configure I2C driver.");
-
     /* 
-        Se carga la configuración del driver I2C, desactivando en este caso los buffers que son para el caso donde
-        se lo utilizaría al ESP32 como slave, y también desactivando las flags de interrupciones (último parametro).
-        dado que en este caso no se utilizarán interrupciones.
+        Se carga el descriptor I2C del MCP23008. El driver I2C del ESP32 lo instala la librería "i2cdev" en la primera
+        transacción, con esta misma configuración, por lo que previamente debe haberse llamado a "i2cdev_init()".
     */
-    ESP_RETURN_ON_ERROR(i2c_driver_install(i2c_master_port, conf.mode, I2C_MASTER_RX_BUF_DISABLE, I2C_MASTER_TX_BUF_DISABLE, 0), 
-                        TAG, "Failed to initialize I2C driver.");
+    MCP23008_dev.port = I2C_MASTER_NUM;                             //Se selecciona el puerto de I2C, en este caso el 0
+    MCP23008_dev.addr = MCP23008_ADDR;                              //Se establece la dirección I2C del MCP23008
+    MCP23008_dev.cfg.sda_io_num = I2C_MASTER_SDA_IO;                //Se establece el pin correspondiente al SDA
+    MCP23008_dev.cfg.scl_io_num = I2C_MASTER_SCL_IO;                //Se establece el pin correspondiente al SCL
+    MCP23008_dev.cfg.sda_pullup_en = GPIO_PULLUP_DISABLE;           //Se desactiva el pull-up en el SDA dado que se tiene un pull-up externo
+    MCP23008_dev.cfg.scl_pullup_en = GPIO_PULLUP_DISABLE;           //Se desactiva el pull-up en el SCL dado que se tiene un pull-up externo
+    MCP23008_dev.cfg.master.clk_speed = I2C_MASTER_FREQ_HZ;         //Se establece la frecuencia del canal I2C
+
+    /*
+        Se crea el mutex del dispositivo, utilizado para que la lectura-modificación-escritura del registro de GPIO
+        al accionar un relé no se intercale entre distintas tareas.
+    */
+    ESP_RETURN_ON_ERROR(i2c_dev_create_mutex(&MCP23008_dev), TAG, "Failed to create MCP23008 mutex.");
 
     /*
         Se realiza una escritura en el MCP23008, en el registro de configuración de I/O, para configurar el GP7 (Trigger pH)
@@ -203,9 +205,12 @@ esp_err_t set_relay_state(int8_t relay_num, bool relay_state)
     /* Se crea un buffer para guardar el dato leido mediante I2C desde el MCP23008 */
     uint8_t buffer;
 
+    /* Se toma el mutex del MCP23008 para que la lectura-modificación-escritura no se intercale con otra tarea */
+    I2C_DEV_TAKE_MUTEX(&MCP23008_dev);
+
     /* Se realiza la lectura del registro de GPIO del MCP23008 */
-    ESP_RETURN_ON_ERROR(MCP23008_register_read(MCP23008_GPIO_PORT_REG_ADDR, &buffer, 1), 
-                        TAG, "Failed to read GPIO state.");
+    I2C_DEV_CHECK_LOGE(&MCP23008_dev, MCP23008_register_read(MCP23008_GPIO_PORT_REG_ADDR, &buffer, 1), 
+                       "Failed to read GPIO state.");
 
     /* 
         Mediante operaciones de bit, se establece en el buffer el estado del rele segun el número de rele, ambos pasados como 
@@ -214,8 +219,10 @@ esp_err_t set_relay_state(int8_t relay_num, bool relay_state)
     BIT_WRITE(buffer, relay_num, relay_state);
 
     /* Se escribe en el registro de GPIO del MCP23008 el buffer resultante, con el estado del relé correspondiente ya establecido  */
-    ESP_RETURN_ON_ERROR(MCP23008_register_write_byte(MCP23008_GPIO_PORT_REG_ADDR, buffer), 
-                        TAG, "Failed to set relay state.");
+    I2C_DEV_CHECK_LOGE(&MCP23008_dev, MCP23008_register_write_byte(MCP23008_GPIO_PORT_REG_ADDR, buffer), 
+                       "Failed to set relay state.");
+
+    I2C_DEV_GIVE_MUTEX(&MCP23008_dev);
 
     return ESP_OK;
 
@@ -244,4 +251,92 @@ bool get_relay_state(int8_t relay_num)
     */
    return ((buffer >> relay_num) & 1);
 
-}
\ No newline at end of file
+}
+
+
+
+/**
+ * @brief   FUNCIÓN PARA ESCRIBIR EL PUERTO COMPLETO DE GPIO DEL MCP23008 EN UNA ÚNICA TRANSACCIÓN I2C. LOS BITS
+ *          CORRESPONDIENTES A PINES CONFIGURADOS COMO ENTRADA SON IGNORADOS POR EL MCP23008.
+ *
+ * @param valor     Valor a escribir en el registro de GPIO.
+ * @return esp_err_t
+ */
+esp_err_t MCP23008_port_write(uint8_t valor)
+{
+
+    I2C_DEV_TAKE_MUTEX(&MCP23008_dev);
+
+    I2C_DEV_CHECK_LOGE(&MCP23008_dev, MCP23008_register_write_byte(MCP23008_GPIO_PORT_REG_ADDR, valor),
+                       "Failed to write GPIO port.");
+
+    I2C_DEV_GIVE_MUTEX(&MCP23008_dev);
+
+    return ESP_OK;
+
+}
+
+
+
+/**
+ * @brief   FUNCIÓN PARA LEER EL PUERTO COMPLETO DE GPIO DEL MCP23008.
+ *
+ * @param valor     Variable donde se guardará el valor del registro de GPIO.
+ * @return esp_err_t
+ */
+esp_err_t MCP23008_port_read(uint8_t *valor)
+{
+
+    if(valor == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    I2C_DEV_TAKE_MUTEX(&MCP23008_dev);
+
+    I2C_DEV_CHECK_LOGE(&MCP23008_dev, MCP23008_register_read(MCP23008_GPIO_PORT_REG_ADDR, valor, 1),
+                       "Failed to read GPIO port.");
+
+    I2C_DEV_GIVE_MUTEX(&MCP23008_dev);
+
+    return ESP_OK;
+
+}
+
+
+
+/**
+ * @brief   FUNCIÓN PARA ESCRIBIR EL PUERTO COMPLETO DE GPIO DEL MCP23008 DE FORMA ASÍNCRONA. LA TRANSACCIÓN SE ENCOLA
+ *          EN LA TAREA DE "i2cdev" DEL PUERTO I2C, Y LA TAREA QUE LLAMA A LA FUNCIÓN NO SE BLOQUEA ESPERANDO AL BUS.
+ *
+ *          LOS CAMPOS "callback", "arg" Y "done" DE LA TRANSACCIÓN LOS DEFINE QUIEN LLAMA A LA FUNCIÓN. LA TRANSACCIÓN
+ *          Y EL VALOR DEBEN PERMANECER VÁLIDOS HASTA QUE LA TRANSACCIÓN FINALICE (CAMPO "busy" EN 0).
+ *
+ * @param transaccion   Transacción a utilizar.
+ * @param valor         Valor a escribir en el registro de GPIO.
+ * @return esp_err_t    ESP_ERR_INVALID_STATE si la transacción anterior aún no finalizó.
+ */
+esp_err_t MCP23008_port_write_async(i2c_dev_transaction_t *transaccion, const uint8_t *valor)
+{
+
+    if(transaccion == NULL || valor == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if(transaccion->busy)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    transaccion->dev = &MCP23008_dev;
+    transaccion->out_reg = &MCP23008_gpio_port_reg;
+    transaccion->out_reg_size = 1;
+    transaccion->out_data = valor;
+    transaccion->out_size = 1;
+    transaccion->in_data = NULL;
+    transaccion->in_size = 0;
+
+    return i2c_dev_submit(transaccion);
+
+}
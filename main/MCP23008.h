@@ -6,6 +6,7 @@
 #include "esp_err.h"
 #include <stdio.h>
 #include <stdbool.h>
+#include "i2cdev.h"
 
 /*==================[DEFINES AND MACROS]=====================================*/
 
@@ -58,6 +59,9 @@ esp_err_t MCP23008_init(void);
 bool read_pH_trigger(void);
 esp_err_t set_relay_state(int8_t relay_num, bool relay_state);
 bool get_relay_state(int8_t relay_num);
+esp_err_t MCP23008_port_write(uint8_t valor);
+esp_err_t MCP23008_port_read(uint8_t *valor);
+esp_err_t MCP23008_port_write_async(i2c_dev_transaction_t *transaccion, const uint8_t *valor);
 
 /*==================[END OF FILE]============================================*/
 #endif // MCP23008_H_
\ No newline at end of file
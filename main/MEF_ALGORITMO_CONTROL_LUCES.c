@@ -23,8 +23,11 @@
 
 #include "MQTT_PUBL_SUSCR.h"
 #include "MCP23008.h"
+#include "ACTUADORES.h"
 #include "AUXILIARES_ALGORITMO_CONTROL_LUCES.h"
 #include "MEF_ALGORITMO_CONTROL_LUCES.h"
+#include "RELOJ_TIEMPO_REAL.h"
+#include "PLANIFICADOR_FOTOPERIODO.h"
 
 //==================================| MACROS AND TYPDEF |==================================//
 
@@ -71,17 +74,72 @@ static bool mef_luces_timer_finished_flag = 0;
 
 //==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
 
+static bool MefLucesProximoEstado(bool estado_actual);
 static void MEFControlLuces(void);
 static void vTaskLigthsControl(void *pvParameters);
 
 //==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
 
+/**
+ * @brief   Función que determina el estado en el que deben quedar las luces al cumplirse el timeout del timer
+ *          de control de luces, y recarga el timer con el tiempo hasta el próximo cambio.
+ *
+ *          Si la hora del sistema es válida, el estado se obtiene del planificador de fotoperíodo a partir de
+ *          la hora local, y el timer se carga con el tiempo hasta el próximo cambio (limitado a
+ *          "MEF_LUCES_PERIODO_MAX_TIMER_SEG"). En caso contrario, se alterna el estado actual y se carga el
+ *          tiempo de encendido o apagado correspondiente, como respaldo hasta que se tenga la hora.
+ *
+ * @param estado_actual     Estado actual de las luces.
+ * @return true     Luces encendidas.
+ * @return false    Luces apagadas.
+ */
+static bool MefLucesProximoEstado(bool estado_actual)
+{
+    struct tm hora_local;
+
+    if(reloj_get_hora_local(&hora_local) == ESP_OK)
+    {
+        uint32_t seg_hasta_cambio = 0;
+        bool estado = fotoperiodo_get_estado(&hora_local, &seg_hasta_cambio);
+
+        if(seg_hasta_cambio > MEF_LUCES_PERIODO_MAX_TIMER_SEG)
+        {
+            seg_hasta_cambio = MEF_LUCES_PERIODO_MAX_TIMER_SEG;
+        }
+
+        xTimerChangePeriod(aux_control_luces_get_timer_handle(), pdMS_TO_TICKS(seg_hasta_cambio * 1000), 0);
+
+        return estado;
+    }
+
+    bool estado = !estado_actual;
+
+    if(estado == ON)
+    {
+        xTimerChangePeriod(aux_control_luces_get_timer_handle(), pdMS_TO_TICKS(HOURS_TO_MS * mef_luces_tiempo_luces_on), 0);
+    }
+
+    else
+    {
+        xTimerChangePeriod(aux_control_luces_get_timer_handle(), pdMS_TO_TICKS(HOURS_TO_MS * mef_luces_tiempo_luces_off), 0);
+    }
+
+    xTimerReset(aux_control_luces_get_timer_handle(), 0);
+
+    return estado;
+}
+
+
+
 /**
  * @brief   Función de la MEF de control de las luces ubicadas en las distintas unidades secundarias.
  *          
  *          Se tiene un periodo compuesto por un tiempo de encendido y un tiempo de apagado de las luces,
  *          en un ciclo completo de 24 hs, es decir, si son 8 hs de luces encendidas, serán 16 hs de luces
  *          apagadas.
+ *
+ *          Si la hora del sistema es válida, el encendido y apagado se rigen por las ventanas horarias del
+ *          planificador de fotoperíodo.
  */
 static void MEFControlLuces(void)
 {
@@ -109,7 +167,7 @@ static void MEFControlLuces(void)
          *  Se reestablece el estado en el que estaban las luces antes de la transición
          *  con historia.
          */
-        set_relay_state(LUCES, mef_luces_lights_state_history_transition);
+        actuadores_set_estado(LUCES, mef_luces_lights_state_history_transition);
 
         /**
          *  Se publica el nuevo estado de las luces en el tópico MQTT correspondiente.
@@ -132,6 +190,15 @@ static void MEFControlLuces(void)
             
             esp_mqtt_client_publish(MefLucesClienteMQTT, LIGHTS_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
         }
+
+        /**
+         *  Si las luces se controlan por hora local, se fuerza su evaluación, ya que el estado
+         *  pudo haber cambiado mientras se estaba en modo MANUAL.
+         */
+        if(reloj_hora_valida())
+        {
+            mef_luces_timer_finished_flag = 1;
+        }
     }
 
 
@@ -141,21 +208,25 @@ static void MEFControlLuces(void)
     case ESPERA_ILUMINACION_CULTIVOS:
 
         /**
-         *  Cuando se cumpla el timeout del timer, se cambia al estado con las luces encendidas, y se carga
-         *  en el timer el tiempo de encendido de las luces.
+         *  Cuando se cumpla el timeout del timer, se determina si se deben encender las luces, en cuyo caso
+         *  se cambia al estado con las luces encendidas. El timer queda cargado con el tiempo hasta el
+         *  próximo cambio.
          */
         if(mef_luces_timer_finished_flag)
         {
             mef_luces_timer_finished_flag = 0;
-            xTimerChangePeriod(aux_control_luces_get_timer_handle(), pdMS_TO_TICKS(HOURS_TO_MS * mef_luces_tiempo_luces_on), 0);
-            xTimerReset(aux_control_luces_get_timer_handle(), 0);
+
+            if(MefLucesProximoEstado(OFF) != ON)
+            {
+                break;
+            }
 
             /**
              *  Se actualiza el nuevo estado de las luces para las transiciones con historia.
              */
             mef_luces_lights_state_history_transition = ON;
 
-            set_relay_state(LUCES, ON);
+            actuadores_set_estado(LUCES, ON);
             /**
              *  Se publica el nuevo estado de las luces en el tópico MQTT correspondiente.
              */
@@ -177,21 +248,25 @@ static void MEFControlLuces(void)
     case ILUMINACION_CULTIVOS:
 
         /**
-         *  Cuando se cumpla el timeout del timer, se cambia al estado con las luces apagadas, y se carga
-         *  en el timer el tiempo de apagado de las luces.
+         *  Cuando se cumpla el timeout del timer, se determina si se deben apagar las luces, en cuyo caso
+         *  se cambia al estado con las luces apagadas. El timer queda cargado con el tiempo hasta el
+         *  próximo cambio.
          */
         if(mef_luces_timer_finished_flag)
         {
             mef_luces_timer_finished_flag = 0;
-            xTimerChangePeriod(aux_control_luces_get_timer_handle(), pdMS_TO_TICKS(HOURS_TO_MS * mef_luces_tiempo_luces_off), 0);
-            xTimerReset(aux_control_luces_get_timer_handle(), 0);
+
+            if(MefLucesProximoEstado(ON) != OFF)
+            {
+                break;
+            }
 
             /**
              *  Se actualiza el nuevo estado de las luces para las transiciones con historia.
              */
             mef_luces_lights_state_history_transition = OFF;
 
-            set_relay_state(LUCES, OFF);
+            actuadores_set_estado(LUCES, OFF);
             /**
              *  Se publica el nuevo estado de las luces en el tópico MQTT correspondiente.
              */
@@ -230,7 +305,9 @@ static void vTaskLigthsControl(void *pvParameters)
     /**
      *  Se establece el estado inicial de las luces, que es apagadas.
      */
-    set_relay_state(LUCES, OFF);
+    actuadores_set_estado(LUCES, OFF);
+    actuadores_aplicar();
+
     /**
      *  Se publica el nuevo estado de las luces en el tópico MQTT correspondiente.
      */
@@ -243,6 +320,15 @@ static void vTaskLigthsControl(void *pvParameters)
 
     ESP_LOGW(mef_luces_tag, "LUCES APAGADAS");
 
+    /**
+     *  Si ya se tiene la hora local (por ejemplo, cargada desde el RTC luego de un reinicio), se fuerza
+     *  la evaluación del fotoperíodo para retomar el estado que corresponde a la hora actual.
+     */
+    if(reloj_hora_valida())
+    {
+        mef_luces_timer_finished_flag = 1;
+    }
+
 
     while(1)
     {
@@ -258,6 +344,12 @@ static void vTaskLigthsControl(void *pvParameters)
          */
         ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
 
+        /**
+         *  Si se sincronizó la hora por SNTP, se actualiza el DS3231 desde esta tarea, y no desde el
+         *  callback de SNTP, que se ejecuta en la tarea de TCP/IP.
+         */
+        reloj_actualizar_rtc();
+
 
         switch(est_MEF_principal)
         {
@@ -312,7 +404,7 @@ static void vTaskLigthsControl(void *pvParameters)
 
             if(manual_mode_luces_state == 0 || manual_mode_luces_state == 1)
             {
-                set_relay_state(LUCES, manual_mode_luces_state);
+                actuadores_set_estado(LUCES, manual_mode_luces_state);
 
                 /**
                  *  Se publica el nuevo estado de las luces en el tópico MQTT correspondiente.
@@ -339,6 +431,11 @@ static void vTaskLigthsControl(void *pvParameters)
 
             break;
         }
+
+        /**
+         *  Se escriben en el expansor de I/O los cambios de estado de las luces.
+         */
+        actuadores_aplicar();
     }
 }
 
@@ -358,6 +455,11 @@ esp_err_t mef_luces_init(esp_mqtt_client_handle_t mqtt_client)
      */
     MefLucesClienteMQTT = mqtt_client;
 
+    /**
+     *  Se carga la ventana de fotoperíodo por defecto.
+     */
+    mef_luces_set_lights_on_time_hours(mef_luces_tiempo_luces_on);
+
 
     //=======================| CREACION TAREAS |=======================//
     
@@ -412,9 +514,11 @@ TaskHandle_t mef_luces_get_task_handle(void)
 
 
 /**
- * @brief   Función para establecer un nuevo tiempo de encendido de la bomba de solución.
+ * @brief   Función para establecer un nuevo tiempo de encendido de las luces. Cuando las luces se controlan
+ *          por hora local, se carga una única ventana de fotoperíodo que comienza a las
+ *          "MEF_LUCES_HORA_INICIO_LUCES" hs y dura el tiempo indicado.
  * 
- * @param nuevo_tiempo_bomba_on   Tiempo de encendido de la bomba.
+ * @param tiempo_luces_on   Tiempo de encendido de las luces, en horas.
  */
 void mef_luces_set_lights_on_time_hours(light_time_t tiempo_luces_on)
 {
@@ -428,6 +532,31 @@ void mef_luces_set_lights_on_time_hours(light_time_t tiempo_luces_on)
      */
     //mef_luces_tiempo_luces_off = 24 - mef_luces_tiempo_luces_on;
     mef_luces_tiempo_luces_off = mef_luces_tiempo_luces_on;
+
+    /**
+     *  Se actualiza la ventana de fotoperíodo. El valor llega por MQTT sin validar, por lo que un
+     *  tiempo de 24 hs o más se limita a 24 hs, que da una ventana con igual hora de encendido y
+     *  apagado, que abarca el día completo.
+     */
+    if(tiempo_luces_on > 24)
+    {
+        tiempo_luces_on = 24;
+    }
+
+    int minutos_on = (tiempo_luces_on > 0) ? (int) (tiempo_luces_on * 60) : 0;
+
+    if(minutos_on <= 0)
+    {
+        fotoperiodo_set_ventanas(NULL, 0);
+        return;
+    }
+
+    fotoperiodo_ventana_t ventana = {
+        .inicio_min = MEF_LUCES_HORA_INICIO_LUCES * 60,
+        .fin_min = (MEF_LUCES_HORA_INICIO_LUCES * 60 + minutos_on) % (24 * 60),
+    };
+
+    fotoperiodo_set_ventanas(&ventana, 1);
 }
 
 
@@ -26,6 +26,16 @@ extern "C" {
 #define MEF_LUCES_TIEMPO_LUCES_ON  3
 #define MEF_LUCES_TIEMPO_LUCES_OFF  3
 
+/* Hora local de encendido de las luces de la ventana de fotoperíodo por defecto, en horas. */
+#define MEF_LUCES_HORA_INICIO_LUCES  6
+
+/**
+ *  Período máximo del timer de control de luces cuando se controlan por hora local, en segundos. Pasado este
+ *  tiempo se vuelve a calcular el plazo hasta el próximo cambio a partir de la hora del sistema, de modo que las
+ *  correcciones de hora por SNTP se reflejen sin esperar al próximo cambio de estado.
+ */
+#define MEF_LUCES_PERIODO_MAX_TIMER_SEG  3600
+
 /**
  *  Enumeración correspondiente a los actuadores del control de las luces de las unidades secundarias.
  * 
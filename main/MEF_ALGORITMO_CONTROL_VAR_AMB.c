@@ -26,6 +26,8 @@
 #include "DHT11_SENSOR.h"
 #include "CO2_SENSOR.h"
 #include "MCP23008.h"
+#include "ACTUADORES.h"
+#include "CONTROL_TIEMPO_PROPORCIONAL.h"
 #include "AUXILIARES_ALGORITMO_CONTROL_VAR_AMB.h"
 #include "MEF_ALGORITMO_CONTROL_VAR_AMB.h"
 
@@ -42,47 +44,39 @@ static TaskHandle_t xMefVarAmbAlgoritmoControlTaskHandle = NULL;
 /* Handle del cliente MQTT. */
 static esp_mqtt_client_handle_t MefVarAmbClienteMQTT = NULL;
 
-/* Variable donde se guarda el valor de la temperatura ambiente sensada en °C. */
-static DHT11_sensor_temp_t mef_var_amb_temp = 25;
-/* Límite inferior de temperatura ambiente del rango considerado como correcto en el algoritmo de control de variables ambientes, en °C. */
-static DHT11_sensor_temp_t mef_var_amb_limite_inferior_temp = 22;
-/* Límite superior de temperatura ambiente del rango considerado como correcto en el algoritmo de control de variables ambientes, en °C. */
-static DHT11_sensor_temp_t mef_var_amb_limite_superior_temp = 28;
-/* Ancho de la ventana de histeresis de temperatura ambiente, posicionada alrededor de los límites del rango considerado como correcto, en °C. */
-static DHT11_sensor_temp_t mef_var_amb_ancho_ventana_hist_temp = 1;
-/* Delta de temperatura considerado, en °C. */
-static DHT11_sensor_temp_t mef_var_amb_delta_temp = 3;
-
-/* Variable donde se guarda el valor de la humedad relativa ambiente sensada en %. */
-static DHT11_sensor_hum_t mef_var_amb_hum = 10;
-/* Límite superior de humedad ambiente del rango considerado como correcto en el algoritmo de control de variables ambientes, en %. */
-static DHT11_sensor_hum_t mef_var_amb_limite_superior_hum =20;
-/* Ancho de la ventana de histeresis de humedad ambiente, posicionada alrededor de los límites del rango considerado como correcto, en %. */
-static DHT11_sensor_hum_t mef_var_amb_ancho_ventana_hist_hum = 5;
-
-/* Variable donde se guarda el valor del CO2 ambiente sensado en ppm. */
-static CO2_sensor_ppm_t mef_var_amb_CO2 = 500;
-/* Límite inferior de CO2 ambiente del rango considerado como correcto en el algoritmo de control de variables ambientes, en ppm. */
-static CO2_sensor_ppm_t mef_var_amb_limite_inferior_CO2 = 400;
-/* Ancho de la ventana de histeresis de CO2 ambiente, posicionada alrededor de los límites del rango considerado como correcto, en ppm. */
-static CO2_sensor_ppm_t mef_var_amb_ancho_ventana_hist_CO2 = 100;
-
-/* Bandera utilizada para controlar si se está o no en modo manual en el algoritmo de control de las variables ambientales. */
-static bool mef_var_amb_manual_mode_flag = 0;
-/* Bandera utilizada para controlar las transiciones con reset de la MEF de control de las variables ambientales. */
-static bool mef_var_amb_reset_transition_flag_control_var_amb = 0;
-/* Bandera utilizada para verificar si hubo error de sensado de temperatura del sensor DHT11. */
-static bool mef_var_amb_temp_DHT11_sensor_error_flag = 0;
-/* Bandera utilizada para verificar si hubo error de sensado de humedad relativa del sensor DHT11. */
-static bool mef_var_amb_hum_DHT11_sensor_error_flag = 0;
-/* Bandera utilizada para verificar si hubo error de sensado del sensor de CO2. */
-static bool mef_var_amb_CO2_sensor_error_flag = 0;
+/**
+ *  Tabla de configuración de las zonas controladas. Cada zona tiene sus propios relés de ventiladores y
+ *  calefacción, y sus propios tópicos MQTT de comando y de estado.
+ *
+ *  Para agregar una zona, se debe incrementar "MEF_VAR_AMB_CANT_ZONAS", agregar su entrada en esta tabla,
+ *  y asignarle las unidades secundarias correspondientes en "AUXILIARES_ALGORITMO_CONTROL_VAR_AMB.c".
+ */
+static const mef_var_amb_zona_config_t mef_var_amb_config_zonas[MEF_VAR_AMB_CANT_ZONAS] = {
+    [0] = {
+        .nombre = "ZONA 1",
+        .rele_ventiladores = VENTILADORES,
+        .rele_calefaccion = CALEFACCION,
+        .topico_sp_temp = NEW_TEMP_SP_MQTT_TOPIC,
+        .topico_modo = VAR_AMB_MANUAL_MODE_MQTT_TOPIC,
+        .topico_tipo_control = VAR_AMB_TIPO_CONTROL_MQTT_TOPIC,
+        .topico_modo_manual_ventiladores = MANUAL_MODE_VENTILADORES_STATE_MQTT_TOPIC,
+        .topico_modo_manual_calefaccion = MANUAL_MODE_CALEFACCION_STATE_MQTT_TOPIC,
+        .topico_estado_ventiladores = VENTILADORES_STATE_MQTT_TOPIC,
+        .topico_estado_calefaccion = CALEFACCION_STATE_MQTT_TOPIC,
+    },
+};
+
+/* Contextos de las zonas controladas, todas evaluadas por la misma tarea. */
+static mef_var_amb_zona_t mef_var_amb_zonas[MEF_VAR_AMB_CANT_ZONAS];
 
 //==================================| EXTERNAL DATA DEFINITION |==================================//
 
 //==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
 
-void MEFControlVarAmb(void);
+void MEFControlVarAmb(mef_var_amb_zona_t *zona);
+void ControlVarAmbTiempoProporcional(mef_var_amb_zona_t *zona);
+static void ActualizarReleTiempoProporcional(mef_var_amb_zona_t *zona, int8_t rele, const char *topico_mqtt, bool nuevo_estado, bool *estado_actual);
+void MEFPrincipalVarAmb(mef_var_amb_zona_t *zona);
 void vTaskVarAmbControl(void *pvParameters);
 
 //==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
@@ -98,22 +92,19 @@ void vTaskVarAmbControl(void *pvParameters);
  * 
  *          Respecto a la humedad, solo se controla que la misma no suba por encima de un límite establecido,
  *          y se ventila el ambiente si esto sucede.
+ *
+ * @param zona  Contexto de la zona a controlar.
  */
-void MEFControlVarAmb(void)
+void MEFControlVarAmb(mef_var_amb_zona_t *zona)
 {
-    /**
-     * Variable que representa el estado de la MEF de control de las variables ambientales.
-     */
-    static estado_MEF_control_var_amb_t est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
-
     /**
      *  Se controla si se debe hacer una transición con reset, caso en el cual se vuelve al estado
      *  de VAR_AMB_CORRECTAS, con los ventiladores y la calefacción apagados.
      */
-    if (mef_var_amb_reset_transition_flag_control_var_amb)
+    if (zona->reset_transition_flag)
     {
-        set_relay_state(VENTILADORES, OFF);
-        set_relay_state(CALEFACCION, OFF);
+        actuadores_set_estado(zona->config->rele_ventiladores, OFF);
+        actuadores_set_estado(zona->config->rele_calefaccion, OFF);
 
         /**
          *  Se publica el nuevo estado de la calefacción y ventiladores en los tópicos MQTT correspondientes.
@@ -122,20 +113,20 @@ void MEFControlVarAmb(void)
         {
             char buffer[10];
             snprintf(buffer, sizeof(buffer), "%s", "OFF");
-            esp_mqtt_client_publish(MefVarAmbClienteMQTT, VENTILADORES_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
-            esp_mqtt_client_publish(MefVarAmbClienteMQTT, CALEFACCION_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+            esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_ventiladores, buffer, 0, 0, 0);
+            esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_calefaccion, buffer, 0, 0, 0);
         }
 
-        ESP_LOGW(mef_var_amb_tag, "VENTILADORES APAGADOS");
-        ESP_LOGW(mef_var_amb_tag, "CALEFACCIÓN APAGADA");
+        ESP_LOGW(mef_var_amb_tag, "%s: VENTILADORES APAGADOS", zona->config->nombre);
+        ESP_LOGW(mef_var_amb_tag, "%s: CALEFACCIÓN APAGADA", zona->config->nombre);
 
-        est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
-        mef_var_amb_reset_transition_flag_control_var_amb = 0;
+        zona->est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
+        zona->reset_transition_flag = 0;
 
         return;
     }
 
-    switch (est_MEF_control_var_amb)
+    switch (zona->est_MEF_control_var_amb)
     {
 
     case VAR_AMB_CORRECTAS:
@@ -148,13 +139,13 @@ void MEFControlVarAmb(void)
          * 
          *  También, debe haber conexión con el broker MQTT.
          */
-        if ((mef_var_amb_CO2 < (mef_var_amb_limite_inferior_CO2 - (mef_var_amb_ancho_ventana_hist_CO2 / 2)) 
-            || mef_var_amb_hum > (mef_var_amb_limite_superior_hum + (mef_var_amb_ancho_ventana_hist_hum / 2)))
-            && (mef_var_amb_temp >= (mef_var_amb_limite_inferior_temp - (mef_var_amb_ancho_ventana_hist_temp / 2)))
-            && !mef_var_amb_temp_DHT11_sensor_error_flag && !mef_var_amb_hum_DHT11_sensor_error_flag && !mef_var_amb_CO2_sensor_error_flag
+        if ((zona->CO2 < (zona->limite_inferior_CO2 - (zona->ancho_ventana_hist_CO2 / 2)) 
+            || zona->hum > (zona->limite_superior_hum + (zona->ancho_ventana_hist_hum / 2)))
+            && (zona->temp >= (zona->limite_inferior_temp - (zona->ancho_ventana_hist_temp / 2)))
+            && !zona->temp_DHT11_sensor_error_flag && !zona->hum_DHT11_sensor_error_flag && !zona->CO2_sensor_error_flag
             && mqtt_check_connection())
         {
-            set_relay_state(VENTILADORES, ON);
+            actuadores_set_estado(zona->config->rele_ventiladores, ON);
             /**
              *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
              */
@@ -162,12 +153,12 @@ void MEFControlVarAmb(void)
             {
                 char buffer[10];
                 snprintf(buffer, sizeof(buffer), "%s", "ON");
-                esp_mqtt_client_publish(MefVarAmbClienteMQTT, VENTILADORES_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_ventiladores, buffer, 0, 0, 0);
             }
 
-             ESP_LOGW(mef_var_amb_tag, "VENTILADORES ENCENDIDOS");
+             ESP_LOGW(mef_var_amb_tag, "%s: VENTILADORES ENCENDIDOS", zona->config->nombre);
 
-            est_MEF_control_var_amb = CO2_BAJO_O_HUM_AMB_ALTA;
+            zona->est_MEF_control_var_amb = CO2_BAJO_O_HUM_AMB_ALTA;
         }
 
 
@@ -180,11 +171,11 @@ void MEFControlVarAmb(void)
          * 
          *  También, debe haber conexión con el broker MQTT.
          */
-        else if (mef_var_amb_temp < (mef_var_amb_limite_inferior_temp - (mef_var_amb_ancho_ventana_hist_temp / 2)) 
-            && !mef_var_amb_temp_DHT11_sensor_error_flag
+        else if (zona->temp < (zona->limite_inferior_temp - (zona->ancho_ventana_hist_temp / 2)) 
+            && !zona->temp_DHT11_sensor_error_flag
             && mqtt_check_connection())
         {
-            set_relay_state(CALEFACCION, ON);
+            actuadores_set_estado(zona->config->rele_calefaccion, ON);
             /**
              *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
              */
@@ -192,12 +183,12 @@ void MEFControlVarAmb(void)
             {
                 char buffer[10];
                 snprintf(buffer, sizeof(buffer), "%s", "ON");
-                esp_mqtt_client_publish(MefVarAmbClienteMQTT, CALEFACCION_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_calefaccion, buffer, 0, 0, 0);
             }
              
-            ESP_LOGW(mef_var_amb_tag, "CALEFACCIÓN ENCENDIDA");
+            ESP_LOGW(mef_var_amb_tag, "%s: CALEFACCIÓN ENCENDIDA", zona->config->nombre);
 
-            est_MEF_control_var_amb = TEMP_AMB_BAJA;
+            zona->est_MEF_control_var_amb = TEMP_AMB_BAJA;
         }
 
 
@@ -210,11 +201,11 @@ void MEFControlVarAmb(void)
          * 
          *  También, debe haber conexión con el broker MQTT.
          */
-        else if (mef_var_amb_temp > (mef_var_amb_limite_superior_temp + (mef_var_amb_ancho_ventana_hist_temp / 2)) 
-            && !mef_var_amb_temp_DHT11_sensor_error_flag
+        else if (zona->temp > (zona->limite_superior_temp + (zona->ancho_ventana_hist_temp / 2)) 
+            && !zona->temp_DHT11_sensor_error_flag
             && mqtt_check_connection())
         {
-            set_relay_state(VENTILADORES, ON);
+            actuadores_set_estado(zona->config->rele_ventiladores, ON);
             /**
              *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
              */
@@ -222,12 +213,12 @@ void MEFControlVarAmb(void)
             {
                 char buffer[10];
                 snprintf(buffer, sizeof(buffer), "%s", "ON");
-                esp_mqtt_client_publish(MefVarAmbClienteMQTT, VENTILADORES_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_ventiladores, buffer, 0, 0, 0);
             }
 
-            ESP_LOGW(mef_var_amb_tag, "VENTILADORES ENCENDIDOS");
+            ESP_LOGW(mef_var_amb_tag, "%s: VENTILADORES ENCENDIDOS", zona->config->nombre);
 
-            est_MEF_control_var_amb = TEMP_AMB_ELEVADA;
+            zona->est_MEF_control_var_amb = TEMP_AMB_ELEVADA;
         }
 
         break;
@@ -243,13 +234,13 @@ void MEFControlVarAmb(void)
          *  También, si se produce una deconexión del broker MQTT, al no poder recibir nuevos datos, se vuelve al estado
          *  con los actuadores apagados.
          */
-        if (((mef_var_amb_CO2 > (mef_var_amb_limite_inferior_CO2 + (mef_var_amb_ancho_ventana_hist_CO2 / 2)) 
-            && mef_var_amb_hum < (mef_var_amb_limite_superior_hum - (mef_var_amb_ancho_ventana_hist_hum / 2)))
-            || mef_var_amb_temp < (mef_var_amb_limite_inferior_temp - (mef_var_amb_ancho_ventana_hist_temp / 2)))
-            || (mef_var_amb_temp_DHT11_sensor_error_flag || mef_var_amb_hum_DHT11_sensor_error_flag || mef_var_amb_CO2_sensor_error_flag)
+        if (((zona->CO2 > (zona->limite_inferior_CO2 + (zona->ancho_ventana_hist_CO2 / 2)) 
+            && zona->hum < (zona->limite_superior_hum - (zona->ancho_ventana_hist_hum / 2)))
+            || zona->temp < (zona->limite_inferior_temp - (zona->ancho_ventana_hist_temp / 2)))
+            || (zona->temp_DHT11_sensor_error_flag || zona->hum_DHT11_sensor_error_flag || zona->CO2_sensor_error_flag)
             || !mqtt_check_connection())
         {
-            set_relay_state(VENTILADORES, OFF);
+            actuadores_set_estado(zona->config->rele_ventiladores, OFF);
             /**
              *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
              */
@@ -257,12 +248,12 @@ void MEFControlVarAmb(void)
             {
                 char buffer[10];
                 snprintf(buffer, sizeof(buffer), "%s", "OFF");
-                esp_mqtt_client_publish(MefVarAmbClienteMQTT, VENTILADORES_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_ventiladores, buffer, 0, 0, 0);
             }
 
-            ESP_LOGW(mef_var_amb_tag, "VENTILADORES APAGADOS");
+            ESP_LOGW(mef_var_amb_tag, "%s: VENTILADORES APAGADOS", zona->config->nombre);
 
-            est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
+            zona->est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
         }
 
         break;
@@ -278,11 +269,11 @@ void MEFControlVarAmb(void)
          *  También, si se produce una deconexión del broker MQTT, al no poder recibir nuevos datos, se vuelve al estado
          *  con los actuadores apagados.
          */
-        if (mef_var_amb_temp > (mef_var_amb_limite_inferior_temp + (mef_var_amb_ancho_ventana_hist_temp / 2))
-            || mef_var_amb_temp_DHT11_sensor_error_flag
+        if (zona->temp > (zona->limite_inferior_temp + (zona->ancho_ventana_hist_temp / 2))
+            || zona->temp_DHT11_sensor_error_flag
             || !mqtt_check_connection())
         {
-            set_relay_state(CALEFACCION, OFF);
+            actuadores_set_estado(zona->config->rele_calefaccion, OFF);
             /**
              *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
              */
@@ -290,12 +281,12 @@ void MEFControlVarAmb(void)
             {
                 char buffer[10];
                 snprintf(buffer, sizeof(buffer), "%s", "OFF");
-                esp_mqtt_client_publish(MefVarAmbClienteMQTT, CALEFACCION_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_calefaccion, buffer, 0, 0, 0);
             }
 
-            ESP_LOGW(mef_var_amb_tag, "CALEFACCIÓN APAGADA");
+            ESP_LOGW(mef_var_amb_tag, "%s: CALEFACCIÓN APAGADA", zona->config->nombre);
 
-            est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
+            zona->est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
         }
 
         break;
@@ -311,11 +302,11 @@ void MEFControlVarAmb(void)
          *  También, si se produce una deconexión del broker MQTT, al no poder recibir nuevos datos, se vuelve al estado
          *  con los actuadores apagados.
          */
-        if (mef_var_amb_temp < (mef_var_amb_limite_superior_temp - (mef_var_amb_ancho_ventana_hist_temp / 2))
-            || mef_var_amb_temp_DHT11_sensor_error_flag
+        if (zona->temp < (zona->limite_superior_temp - (zona->ancho_ventana_hist_temp / 2))
+            || zona->temp_DHT11_sensor_error_flag
             || !mqtt_check_connection())
         {
-            set_relay_state(VENTILADORES, OFF);
+            actuadores_set_estado(zona->config->rele_ventiladores, OFF);
             /**
              *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
              */
@@ -323,12 +314,12 @@ void MEFControlVarAmb(void)
             {
                 char buffer[10];
                 snprintf(buffer, sizeof(buffer), "%s", "OFF");
-                esp_mqtt_client_publish(MefVarAmbClienteMQTT, VENTILADORES_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_ventiladores, buffer, 0, 0, 0);
             }
 
-            ESP_LOGW(mef_var_amb_tag, "VENTILADORES APAGADOS");
+            ESP_LOGW(mef_var_amb_tag, "%s: VENTILADORES APAGADOS", zona->config->nombre);
 
-            est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
+            zona->est_MEF_control_var_amb = VAR_AMB_CORRECTAS;
         }
 
         break;
@@ -338,142 +329,350 @@ void MEFControlVarAmb(void)
 
 
 /**
- * @brief   Tarea encargada del control de la MEF de mayor jerarquía del algoritmo de control de las variables
- *          ambientales, que son la temperatura, humedad relativa y nivel de CO2 ambiente.
- * 
- * @param pvParameters 
+ * @brief   Función que acciona un relé del control por tiempo proporcional, solo en caso de que
+ *          su estado haya cambiado, publicando el nuevo estado en el tópico MQTT correspondiente.
+ *
+ *          De esta forma, solo se escribe en el MCP23008 cuando el relé efectivamente conmuta.
+ *
+ * @param zona          Contexto de la zona.
+ * @param rele          Relé a accionar.
+ * @param topico_mqtt   Tópico MQTT donde se publica el estado del actuador.
+ * @param nuevo_estado  Estado en el que debe quedar el relé.
+ * @param estado_actual Estado actual del relé, que se actualiza si hubo un cambio.
  */
-void vTaskVarAmbControl(void *pvParameters)
+static void ActualizarReleTiempoProporcional(mef_var_amb_zona_t *zona, int8_t rele, const char *topico_mqtt, bool nuevo_estado, bool *estado_actual)
 {
+    if(nuevo_estado == *estado_actual)
+    {
+        return;
+    }
+
+    actuadores_set_estado(rele, nuevo_estado);
+    *estado_actual = nuevo_estado;
+
     /**
-     * Variable que representa el estado de la MEF de jerarquía superior del algoritmo de control de las variables ambientales.
+     *  Se publica el nuevo estado del actuador en el tópico MQTT correspondiente.
      */
-    static estado_MEF_principal_control_var_amb_t est_MEF_principal = ALGORITMO_CONTROL_VAR_AMB;
+    if(mqtt_check_connection())
+    {
+        char buffer[10];
+        snprintf(buffer, sizeof(buffer), "%s", nuevo_estado ? "ON" : "OFF");
+        esp_mqtt_client_publish(MefVarAmbClienteMQTT, topico_mqtt, buffer, 0, 0, 0);
+    }
 
-    while (1)
+    ESP_LOGW(mef_var_amb_tag, "%s - %s: %s", zona->config->nombre, topico_mqtt, nuevo_estado ? "ON" : "OFF");
+}
+
+
+
+/**
+ * @brief   Función del control de las variables ambientales por tiempo proporcional, alternativo a la MEF
+ *          de control por ventana de histéresis "MEFControlVarAmb()".
+ *
+ *          Al inicio de cada ventana de tiempo, un controlador PI calcula el ciclo de trabajo de la calefacción
+ *          a partir de cuánto está la temperatura por debajo del centro del rango correcto, y otro el de los
+ *          ventiladores a partir de cuánto está por encima. Luego, cada relé se mantiene encendido durante
+ *          esa fracción de la ventana, respetando los tiempos mínimos de encendido y apagado.
+ *
+ *          Respecto al CO2 y la humedad, se mantiene el mismo criterio que en la MEF por histéresis: si el CO2
+ *          está por debajo de su límite o la humedad por encima del suyo, se ventila durante toda la ventana,
+ *          siempre que la temperatura no esté por debajo de su límite inferior.
+ *
+ *          Ante un error de sensado o una desconexión del broker MQTT, se recalcula inmediatamente la ventana,
+ *          de modo de apagar los actuadores correspondientes sin esperar a que finalice la ventana en curso.
+ *
+ * @param zona  Contexto de la zona a controlar.
+ */
+void ControlVarAmbTiempoProporcional(mef_var_amb_zona_t *zona)
+{
+    /**
+     *  Se controla si se debe hacer una transición con reset, caso en el cual se apagan la calefacción
+     *  y los ventiladores, y se reinician los controladores PI y las ventanas de tiempo.
+     */
+    if (zona->reset_transition_flag)
     {
         /**
-         *  Se realiza un Notify Take a la espera de señales que indiquen:
-         *
-         *  -Que se debe pasar a modo MANUAL o modo AUTO.
-         *  -Que estando en modo MANUAL, se deba cambiar el estado de los ventiladores o la calefacción.
-         *
-         *  Además, se le coloca un timeout para evaluar las transiciones de las MEFs periódicamente, en caso
-         *  de que no llegue ninguna de las señales mencionadas, y para controlar los valores de sensado que
-         *  llegan.
+         *  Se fuerza la escritura de ambos relés, ya que su estado real pudo haber sido modificado
+         *  por el modo MANUAL o por el control por ventana de histéresis.
          */
-        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        zona->estado_calefaccion_tp = ON;
+        zona->estado_ventiladores_tp = ON;
+        ActualizarReleTiempoProporcional(zona, zona->config->rele_calefaccion, zona->config->topico_estado_calefaccion, OFF, &zona->estado_calefaccion_tp);
+        ActualizarReleTiempoProporcional(zona, zona->config->rele_ventiladores, zona->config->topico_estado_ventiladores, OFF, &zona->estado_ventiladores_tp);
+
+        control_pi_reset(&zona->pi_calefaccion);
+        control_pi_reset(&zona->pi_ventiladores);
+        control_tp_reset(&zona->tp_calefaccion);
+        control_tp_reset(&zona->tp_ventiladores);
+
+        zona->reset_transition_flag = 0;
+
+        return;
+    }
+
+    TickType_t ahora = xTaskGetTickCount();
+    bool conexion_mqtt = mqtt_check_connection();
+
+    /**
+     *  Si cambió alguna bandera de error de sensado o el estado de la conexión MQTT, se reinician las
+     *  ventanas de tiempo para recalcular los ciclos de trabajo inmediatamente.
+     */
+    uint8_t estado_errores = (zona->temp_DHT11_sensor_error_flag << 0) | (zona->hum_DHT11_sensor_error_flag << 1)
+                           | (zona->CO2_sensor_error_flag << 2) | (!conexion_mqtt << 3);
 
-        switch (est_MEF_principal)
+    if (estado_errores != zona->estado_errores_anterior)
+    {
+        zona->estado_errores_anterior = estado_errores;
+        control_tp_reset(&zona->tp_calefaccion);
+        control_tp_reset(&zona->tp_ventiladores);
+    }
+
+    /**
+     *  Temperatura de referencia de los controladores PI, que es el centro del rango de temperatura correcto.
+     */
+    DHT11_sensor_temp_t temp_referencia = (zona->limite_inferior_temp + zona->limite_superior_temp) / 2;
+    bool temp_valida = !zona->temp_DHT11_sensor_error_flag && conexion_mqtt;
+
+    /**
+     *  Al inicio de cada ventana de la calefacción, se calcula su nuevo ciclo de trabajo.
+     */
+    if (control_tp_ventana_finalizada(&zona->tp_calefaccion, ahora))
+    {
+        float ciclo_de_trabajo = 0;
+
+        if (temp_valida)
         {
+            ciclo_de_trabajo = control_pi_calcular(&zona->pi_calefaccion, temp_referencia - zona->temp, 
+                                                   MEF_VAR_AMB_TP_PERIODO_VENTANA);
+        }
 
-        case ALGORITMO_CONTROL_VAR_AMB:
+        else
+        {
+            control_pi_reset(&zona->pi_calefaccion);
+        }
 
-            /**
-             *  En caso de que se levante la bandera de modo MANUAL, se debe transicionar a dicho estado,
-             *  en donde el accionamiento de los ventiladores y la calefacción será manejado por el usuario
-             *  vía mensajes MQTT.
-             */
-            if (mef_var_amb_manual_mode_flag)
-            {
-                est_MEF_principal = MODO_MANUAL_CONTROL_VAR_AMB;
-                mef_var_amb_reset_transition_flag_control_var_amb = 1;
-            }
+        control_tp_iniciar_ventana(&zona->tp_calefaccion, ciclo_de_trabajo, ahora);
+    }
 
-            MEFControlVarAmb();
+    /**
+     *  Al inicio de cada ventana de los ventiladores, se calcula su nuevo ciclo de trabajo.
+     */
+    if (control_tp_ventana_finalizada(&zona->tp_ventiladores, ahora))
+    {
+        float ciclo_de_trabajo = 0;
 
-            break;
+        if (temp_valida)
+        {
+            ciclo_de_trabajo = control_pi_calcular(&zona->pi_ventiladores, zona->temp - temp_referencia, 
+                                                   MEF_VAR_AMB_TP_PERIODO_VENTANA);
+        }
 
-        case MODO_MANUAL_CONTROL_VAR_AMB:
+        else
+        {
+            control_pi_reset(&zona->pi_ventiladores);
+        }
 
-            /**
-             *  En caso de que se baje la bandera de modo MANUAL, se debe transicionar nuevamente al estado
-             *  de modo AUTOMATICO, en donde se controlan las variables ambientales a partir de los
-             *  valores de los sensores DHT11 y de CO2 de las unidades secundarias y los ventiladores y
-             *  calefacción.
-             * 
-             *  Además, en caso de que se produzca una desconexión del broker MQTT, se vuelve también
-             *  al modo AUTOMATICO, y se limpia la bandera de modo MANUAL.
-             */
-            if (!mef_var_amb_manual_mode_flag || !mqtt_check_connection())
-            {
-                est_MEF_principal = ALGORITMO_CONTROL_VAR_AMB;
+        /**
+         *  Si el CO2 está bajo o la humedad alta, se ventila durante toda la ventana, siempre que no haya
+         *  errores de sensado y que la temperatura no esté por debajo del límite inferior.
+         */
+        if ((zona->CO2 < zona->limite_inferior_CO2 || zona->hum > zona->limite_superior_hum)
+            && zona->temp >= zona->limite_inferior_temp
+            && temp_valida && !zona->hum_DHT11_sensor_error_flag && !zona->CO2_sensor_error_flag)
+        {
+            ciclo_de_trabajo = 1;
+        }
 
-                mef_var_amb_manual_mode_flag = 0;
+        control_tp_iniciar_ventana(&zona->tp_ventiladores, ciclo_de_trabajo, ahora);
+    }
+
+    /**
+     *  Se accionan los relés según el instante actual de cada ventana.
+     */
+    ActualizarReleTiempoProporcional(zona, zona->config->rele_calefaccion, zona->config->topico_estado_calefaccion, 
+                                     control_tp_get_estado_rele(&zona->tp_calefaccion, ahora), &zona->estado_calefaccion_tp);
+    ActualizarReleTiempoProporcional(zona, zona->config->rele_ventiladores, zona->config->topico_estado_ventiladores, 
+                                     control_tp_get_estado_rele(&zona->tp_ventiladores, ahora), &zona->estado_ventiladores_tp);
+}
 
-                /**
-                 *  Se setea la bandera de reset de la MEF de control de variables ambientales de modo
-                 *  que se resetee el estado de los actuadores correspondientes.
-                 */
-                mef_var_amb_reset_transition_flag_control_var_amb = 1;
 
-                break;
-            }
+
+/**
+ * @brief   Función de la MEF de mayor jerarquía del algoritmo de control de las variables ambientales de una
+ *          zona, que alterna entre el modo automático (por ventana de histéresis o por tiempo proporcional)
+ *          y el modo manual.
+ * 
+ * @param zona  Contexto de la zona a controlar.
+ */
+void MEFPrincipalVarAmb(mef_var_amb_zona_t *zona)
+{
+    switch (zona->est_MEF_principal)
+    {
+
+    case ALGORITMO_CONTROL_VAR_AMB:
+
+        /**
+         *  En caso de que se levante la bandera de modo MANUAL, se debe transicionar a dicho estado,
+         *  en donde el accionamiento de los ventiladores y la calefacción será manejado por el usuario
+         *  vía mensajes MQTT.
+         */
+        if (zona->manual_mode_flag)
+        {
+            zona->est_MEF_principal = MODO_MANUAL_CONTROL_VAR_AMB;
+            zona->reset_transition_flag = 1;
+        }
+
+        /**
+         *  En caso de que se cambie el tipo de control, se realiza una transición con reset, de modo
+         *  de apagar los actuadores y comenzar el nuevo tipo de control desde su estado inicial.
+         */
+        if (zona->proportional_mode_flag != zona->modo_proporcional_anterior)
+        {
+            zona->modo_proporcional_anterior = zona->proportional_mode_flag;
+            zona->reset_transition_flag = 1;
+        }
+
+        if (zona->modo_proporcional_anterior)
+        {
+            ControlVarAmbTiempoProporcional(zona);
+        }
+
+        else
+        {
+            MEFControlVarAmb(zona);
+        }
+
+        break;
+
+    case MODO_MANUAL_CONTROL_VAR_AMB:
+
+        /**
+         *  En caso de que se baje la bandera de modo MANUAL, se debe transicionar nuevamente al estado
+         *  de modo AUTOMATICO, en donde se controlan las variables ambientales a partir de los
+         *  valores de los sensores DHT11 y de CO2 de las unidades secundarias y los ventiladores y
+         *  calefacción.
+         * 
+         *  Además, en caso de que se produzca una desconexión del broker MQTT, se vuelve también
+         *  al modo AUTOMATICO, y se limpia la bandera de modo MANUAL.
+         */
+        if (!zona->manual_mode_flag || !mqtt_check_connection())
+        {
+            zona->est_MEF_principal = ALGORITMO_CONTROL_VAR_AMB;
+
+            zona->manual_mode_flag = 0;
 
             /**
-             *  Se obtiene el nuevo estado en el que deben estar los ventiladores y la calefacción, y se accionan
-             *  los relés correspondientes.
+             *  Se setea la bandera de reset de la MEF de control de variables ambientales de modo
+             *  que se resetee el estado de los actuadores correspondientes.
              */
-            float manual_mode_ventiladores_state = -1;
-            float manual_mode_calefaccion_state = -1;
+            zona->reset_transition_flag = 1;
+
+            break;
+        }
+
+        /**
+         *  Se obtiene el nuevo estado en el que deben estar los ventiladores y la calefacción, y se accionan
+         *  los relés correspondientes.
+         */
+        float manual_mode_ventiladores_state = -1;
+        float manual_mode_calefaccion_state = -1;
 
-            mqtt_get_float_data_from_topic(MANUAL_MODE_VENTILADORES_STATE_MQTT_TOPIC, &manual_mode_ventiladores_state);
-            mqtt_get_float_data_from_topic(MANUAL_MODE_CALEFACCION_STATE_MQTT_TOPIC, &manual_mode_calefaccion_state);
+        mqtt_get_float_data_from_topic(zona->config->topico_modo_manual_ventiladores, &manual_mode_ventiladores_state);
+        mqtt_get_float_data_from_topic(zona->config->topico_modo_manual_calefaccion, &manual_mode_calefaccion_state);
 
-            if (manual_mode_ventiladores_state == 0 || manual_mode_ventiladores_state == 1)
+        if (manual_mode_ventiladores_state == 0 || manual_mode_ventiladores_state == 1)
+        {
+            actuadores_set_estado(zona->config->rele_ventiladores, manual_mode_ventiladores_state);
+            /**
+             *  Se publica el nuevo estado de los ventiladores en el tópico MQTT correspondiente.
+             */
+            if(mqtt_check_connection())
             {
-                set_relay_state(VENTILADORES, manual_mode_ventiladores_state);
-                /**
-                 *  Se publica el nuevo estado de los ventiladores en el tópico MQTT correspondiente.
-                 */
-                if(mqtt_check_connection())
+                char buffer[10];
+
+                if(manual_mode_ventiladores_state == 0)
                 {
-                    char buffer[10];
-
-                    if(manual_mode_ventiladores_state == 0)
-                    {
-                        snprintf(buffer, sizeof(buffer), "%s", "OFF");    
-                    }
-
-                    else if(manual_mode_ventiladores_state == 1)
-                    {
-                        snprintf(buffer, sizeof(buffer), "%s", "ON");
-                    }
-                    
-                    esp_mqtt_client_publish(MefVarAmbClienteMQTT, VENTILADORES_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                    snprintf(buffer, sizeof(buffer), "%s", "OFF");    
                 }
 
-                ESP_LOGW(mef_var_amb_tag, "MANUAL MODE VENTILADORES: %.0f", manual_mode_ventiladores_state);
+                else if(manual_mode_ventiladores_state == 1)
+                {
+                    snprintf(buffer, sizeof(buffer), "%s", "ON");
+                }
+                
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_ventiladores, buffer, 0, 0, 0);
             }
 
-            if (manual_mode_calefaccion_state == 0 || manual_mode_calefaccion_state == 1)
+            ESP_LOGW(mef_var_amb_tag, "%s: MANUAL MODE VENTILADORES: %.0f", zona->config->nombre, manual_mode_ventiladores_state);
+        }
+
+        if (manual_mode_calefaccion_state == 0 || manual_mode_calefaccion_state == 1)
+        {
+            actuadores_set_estado(zona->config->rele_calefaccion, manual_mode_calefaccion_state);
+            /**
+             *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
+             */
+            if(mqtt_check_connection())
             {
-                set_relay_state(CALEFACCION, manual_mode_calefaccion_state);
-                /**
-                 *  Se publica el nuevo estado de la calefacción en el tópico MQTT correspondiente.
-                 */
-                if(mqtt_check_connection())
+                char buffer[10];
+
+                if(manual_mode_calefaccion_state == 0)
                 {
-                    char buffer[10];
-
-                    if(manual_mode_calefaccion_state == 0)
-                    {
-                        snprintf(buffer, sizeof(buffer), "%s", "OFF");    
-                    }
-
-                    else if(manual_mode_calefaccion_state == 1)
-                    {
-                        snprintf(buffer, sizeof(buffer), "%s", "ON");
-                    }
-                    
-                    esp_mqtt_client_publish(MefVarAmbClienteMQTT, CALEFACCION_STATE_MQTT_TOPIC, buffer, 0, 0, 0);
+                    snprintf(buffer, sizeof(buffer), "%s", "OFF");    
                 }
 
-                ESP_LOGW(mef_var_amb_tag, "MANUAL MODE CALEFACCIÓN: %.0f", manual_mode_calefaccion_state);
+                else if(manual_mode_calefaccion_state == 1)
+                {
+                    snprintf(buffer, sizeof(buffer), "%s", "ON");
+                }
+                
+                esp_mqtt_client_publish(MefVarAmbClienteMQTT, zona->config->topico_estado_calefaccion, buffer, 0, 0, 0);
             }
 
-            break;
+            ESP_LOGW(mef_var_amb_tag, "%s: MANUAL MODE CALEFACCIÓN: %.0f", zona->config->nombre, manual_mode_calefaccion_state);
         }
+
+        break;
+    }
+}
+
+
+
+/**
+ * @brief   Tarea encargada del control de las MEFs del algoritmo de control de las variables ambientales de
+ *          todas las zonas, que son la temperatura, humedad relativa y nivel de CO2 ambiente.
+ * 
+ *          Todas las zonas se evalúan en la misma tarea, una a continuación de la otra, de modo que agregar
+ *          zonas no requiere tareas ni stacks adicionales.
+ * 
+ * @param pvParameters 
+ */
+void vTaskVarAmbControl(void *pvParameters)
+{
+    while (1)
+    {
+        /**
+         *  Se realiza un Notify Take a la espera de señales que indiquen:
+         *
+         *  -Que se debe pasar a modo MANUAL o modo AUTO en alguna zona.
+         *  -Que estando en modo MANUAL, se deba cambiar el estado de los ventiladores o la calefacción.
+         *
+         *  Además, se le coloca un timeout para evaluar las transiciones de las MEFs periódicamente, en caso
+         *  de que no llegue ninguna de las señales mencionadas, y para controlar los valores de sensado que
+         *  llegan.
+         */
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+        for (int i = 0; i < MEF_VAR_AMB_CANT_ZONAS; i++)
+        {
+            MEFPrincipalVarAmb(&mef_var_amb_zonas[i]);
+        }
+
+        /**
+         *  Se escriben en los expansores de I/O los cambios de estado de los actuadores de todas
+         *  las zonas, con una única transacción I2C por expansor.
+         */
+        actuadores_aplicar();
     }
 }
 
@@ -492,6 +691,14 @@ esp_err_t mef_var_amb_init(esp_mqtt_client_handle_t mqtt_client)
      */
     MefVarAmbClienteMQTT = mqtt_client;
 
+    /**
+     *  Se inicializan los contextos de las zonas a partir de la tabla de configuración.
+     */
+    for (int i = 0; i < MEF_VAR_AMB_CANT_ZONAS; i++)
+    {
+        mef_var_amb_zona_init(&mef_var_amb_zonas[i], &mef_var_amb_config_zonas[i]);
+    }
+
     //=======================| CREACION TAREAS |=======================//
 
     /**
@@ -523,6 +730,62 @@ esp_err_t mef_var_amb_init(esp_mqtt_client_handle_t mqtt_client)
 
 
 
+/**
+ * @brief   Función para inicializar el contexto de una zona del control de variables ambientales, con
+ *          los valores y límites por defecto, y las MEFs en su estado inicial.
+ *
+ * @param zona      Contexto de la zona a inicializar.
+ * @param config    Configuración fija de la zona (relés y tópicos MQTT).
+ */
+void mef_var_amb_zona_init(mef_var_amb_zona_t *zona, const mef_var_amb_zona_config_t *config)
+{
+    *zona = (mef_var_amb_zona_t) {
+        .config = config,
+
+        .temp = 25,
+        .limite_inferior_temp = 22,
+        .limite_superior_temp = 28,
+        .ancho_ventana_hist_temp = 1,
+        .delta_temp = 3,
+
+        .hum = 10,
+        .limite_superior_hum = 20,
+        .ancho_ventana_hist_hum = 5,
+
+        .CO2 = 500,
+        .limite_inferior_CO2 = 400,
+        .ancho_ventana_hist_CO2 = 100,
+
+        .est_MEF_principal = ALGORITMO_CONTROL_VAR_AMB,
+        .est_MEF_control_var_amb = VAR_AMB_CORRECTAS,
+
+        .pi_calefaccion = {
+            .kp = MEF_VAR_AMB_PI_KP_TEMP,
+            .ki = MEF_VAR_AMB_PI_KI_TEMP,
+            .salida_min = 0,
+            .salida_max = 1,
+        },
+        .pi_ventiladores = {
+            .kp = MEF_VAR_AMB_PI_KP_TEMP,
+            .ki = MEF_VAR_AMB_PI_KI_TEMP,
+            .salida_min = 0,
+            .salida_max = 1,
+        },
+        .tp_calefaccion = {
+            .periodo_ventana = pdMS_TO_TICKS(MEF_VAR_AMB_TP_PERIODO_VENTANA * 1000),
+            .tiempo_min_on = pdMS_TO_TICKS(MEF_VAR_AMB_TP_TIEMPO_MIN_ON * 1000),
+            .tiempo_min_off = pdMS_TO_TICKS(MEF_VAR_AMB_TP_TIEMPO_MIN_OFF * 1000),
+        },
+        .tp_ventiladores = {
+            .periodo_ventana = pdMS_TO_TICKS(MEF_VAR_AMB_TP_PERIODO_VENTANA * 1000),
+            .tiempo_min_on = pdMS_TO_TICKS(MEF_VAR_AMB_TP_TIEMPO_MIN_ON * 1000),
+            .tiempo_min_off = pdMS_TO_TICKS(MEF_VAR_AMB_TP_TIEMPO_MIN_OFF * 1000),
+        },
+    };
+}
+
+
+
 /**
  * @brief   Función que devuelve el Task Handle de la tarea principal del algoritmo de control de variables ambientales.
  *
@@ -536,13 +799,40 @@ TaskHandle_t mef_var_amb_get_task_handle(void)
 
 
 /**
- * @brief   Función que devuelve el valor del delta de temperatura ambiente establecido.
+ * @brief   Función que devuelve la configuración fija de una zona.
+ *
+ * @param zona  Número de zona.
+ * @return const mef_var_amb_zona_config_t*    Configuración de la zona, o NULL si la zona no existe.
+ */
+const mef_var_amb_zona_config_t* mef_var_amb_get_zona_config(unsigned int zona)
+{
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return NULL;
+    }
+
+    return &mef_var_amb_config_zonas[zona];
+}
+
+
+
+/**
+ * @brief   Función que devuelve el valor del delta de temperatura ambiente establecido en una zona.
  *
- * @return DHT11_sensor_temp_t Delta de temperatura en °C.
+ * @param zona          Número de zona.
+ * @param delta_temp    Variable donde se guardará el delta de temperatura, en °C.
+ * @return esp_err_t    ESP_ERR_INVALID_ARG si la zona no existe.
  */
-DHT11_sensor_temp_t mef_var_amb_get_delta_temp(void)
+esp_err_t mef_var_amb_get_delta_temp(unsigned int zona, DHT11_sensor_temp_t *delta_temp)
 {
-    return mef_var_amb_delta_temp;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS || delta_temp == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *delta_temp = mef_var_amb_zonas[zona].delta_temp;
+
+    return ESP_OK;
 }
 
 
@@ -551,13 +841,22 @@ DHT11_sensor_temp_t mef_var_amb_get_delta_temp(void)
  * @brief   Función para establecer nuevos límites del rango de temperatura ambiente considerado como correcto para el 
  *          algoritmo de control de variables ambientales.
  *
+ * @param zona  Número de zona.
  * @param nuevo_limite_inferior_temp_amb   Límite inferior del rango.
  * @param nuevo_limite_superior_temp_amb   Límite superior del rango.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_temp_control_limits(DHT11_sensor_temp_t nuevo_limite_inferior_temp_amb, DHT11_sensor_temp_t nuevo_limite_superior_temp_amb)
+esp_err_t mef_var_amb_set_temp_control_limits(unsigned int zona, DHT11_sensor_temp_t nuevo_limite_inferior_temp_amb, DHT11_sensor_temp_t nuevo_limite_superior_temp_amb)
 {
-    mef_var_amb_limite_inferior_temp = nuevo_limite_inferior_temp_amb;
-    mef_var_amb_limite_superior_temp = nuevo_limite_superior_temp_amb;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].limite_inferior_temp = nuevo_limite_inferior_temp_amb;
+    mef_var_amb_zonas[zona].limite_superior_temp = nuevo_limite_superior_temp_amb;
+
+    return ESP_OK;
 }
 
 
@@ -565,11 +864,20 @@ void mef_var_amb_set_temp_control_limits(DHT11_sensor_temp_t nuevo_limite_inferi
 /**
  * @brief   Función para actualizar el valor de temperatura ambiente sensado.
  *
+ * @param zona  Número de zona.
  * @param nuevo_valor_temp_amb Nuevo valor de temperatura ambiente, en °C.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_temp_amb_value(DHT11_sensor_temp_t nuevo_valor_temp_amb)
+esp_err_t mef_var_amb_set_temp_amb_value(unsigned int zona, DHT11_sensor_temp_t nuevo_valor_temp_amb)
 {
-    mef_var_amb_temp = nuevo_valor_temp_amb;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].temp = nuevo_valor_temp_amb;
+
+    return ESP_OK;
 }
 
 
@@ -577,11 +885,20 @@ void mef_var_amb_set_temp_amb_value(DHT11_sensor_temp_t nuevo_valor_temp_amb)
 /**
  * @brief   Función para actualizar el valor de humedad relativa ambiente sensado.
  *
+ * @param zona  Número de zona.
  * @param nuevo_valor_hum_amb Nuevo valor de humedad relativa ambiente, en %.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_hum_amb_value(DHT11_sensor_hum_t nuevo_valor_hum_amb)
+esp_err_t mef_var_amb_set_hum_amb_value(unsigned int zona, DHT11_sensor_hum_t nuevo_valor_hum_amb)
 {
-    mef_var_amb_hum = nuevo_valor_hum_amb;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].hum = nuevo_valor_hum_amb;
+
+    return ESP_OK;
 }
 
 
@@ -589,11 +906,20 @@ void mef_var_amb_set_hum_amb_value(DHT11_sensor_hum_t nuevo_valor_hum_amb)
 /**
  * @brief   Función para actualizar el valor de CO2 ambiente sensado.
  *
+ * @param zona  Número de zona.
  * @param nuevo_valor_CO2_amb Nuevo valor de CO2 ambiente, en ppm.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_CO2_amb_value(CO2_sensor_ppm_t nuevo_valor_CO2_amb)
+esp_err_t mef_var_amb_set_CO2_amb_value(unsigned int zona, CO2_sensor_ppm_t nuevo_valor_CO2_amb)
 {
-    mef_var_amb_CO2 = nuevo_valor_CO2_amb;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].CO2 = nuevo_valor_CO2_amb;
+
+    return ESP_OK;
 }
 
 
@@ -602,11 +928,43 @@ void mef_var_amb_set_CO2_amb_value(CO2_sensor_ppm_t nuevo_valor_CO2_amb)
  * @brief   Función para cambiar el estado de la bandera de modo MANUAL, utilizada por
  *          la MEF para cambiar entre estado de modo MANUAL y AUTOMATICO.
  *
+ * @param zona  Número de zona.
  * @param manual_mode_flag_state    Estado de la bandera.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_manual_mode_flag_value(bool manual_mode_flag_state)
+esp_err_t mef_var_amb_set_manual_mode_flag_value(unsigned int zona, bool manual_mode_flag_state)
 {
-    mef_var_amb_manual_mode_flag = manual_mode_flag_state;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].manual_mode_flag = manual_mode_flag_state;
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para cambiar el estado de la bandera de modo de control por tiempo proporcional,
+ *          utilizada para elegir entre el control PI por tiempo proporcional y el control por
+ *          ventana de histéresis.
+ *
+ * @param zona  Número de zona.
+ * @param proportional_mode_flag_state    Estado de la bandera.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
+ */
+esp_err_t mef_var_amb_set_proportional_mode_flag_value(unsigned int zona, bool proportional_mode_flag_state)
+{
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].proportional_mode_flag = proportional_mode_flag_state;
+
+    return ESP_OK;
 }
 
 
@@ -614,11 +972,20 @@ void mef_var_amb_set_manual_mode_flag_value(bool manual_mode_flag_state)
 /**
  * @brief   Función para cambiar el estado de la bandera de error de temperatura del sensor DHT11.
  *
+ * @param zona  Número de zona.
  * @param sensor_error_flag_state    Estado de la bandera.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_temp_DHT11_sensor_error_flag_value(bool sensor_error_flag_state)
+esp_err_t mef_var_amb_set_temp_DHT11_sensor_error_flag_value(unsigned int zona, bool sensor_error_flag_state)
 {
-    mef_var_amb_temp_DHT11_sensor_error_flag = sensor_error_flag_state;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].temp_DHT11_sensor_error_flag = sensor_error_flag_state;
+
+    return ESP_OK;
 }
 
 
@@ -626,11 +993,20 @@ void mef_var_amb_set_temp_DHT11_sensor_error_flag_value(bool sensor_error_flag_s
 /**
  * @brief   Función para cambiar el estado de la bandera de error de humedad del sensor DHT11.
  *
+ * @param zona  Número de zona.
  * @param sensor_error_flag_state    Estado de la bandera.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_hum_DHT11_sensor_error_flag_value(bool sensor_error_flag_state)
+esp_err_t mef_var_amb_set_hum_DHT11_sensor_error_flag_value(unsigned int zona, bool sensor_error_flag_state)
 {
-    mef_var_amb_hum_DHT11_sensor_error_flag = sensor_error_flag_state;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].hum_DHT11_sensor_error_flag = sensor_error_flag_state;
+
+    return ESP_OK;
 }
 
 
@@ -638,9 +1014,18 @@ void mef_var_amb_set_hum_DHT11_sensor_error_flag_value(bool sensor_error_flag_st
 /**
  * @brief   Función para cambiar el estado de la bandera de error del sensor de CO2.
  *
+ * @param zona  Número de zona.
  * @param sensor_error_flag_state    Estado de la bandera.
+ * @return esp_err_t   ESP_ERR_INVALID_ARG si la zona no existe.
  */
-void mef_var_amb_set_CO2_sensor_error_flag_value(bool sensor_error_flag_state)
+esp_err_t mef_var_amb_set_CO2_sensor_error_flag_value(unsigned int zona, bool sensor_error_flag_state)
 {
-    mef_var_amb_CO2_sensor_error_flag = sensor_error_flag_state;
+    if (zona >= MEF_VAR_AMB_CANT_ZONAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mef_var_amb_zonas[zona].CO2_sensor_error_flag = sensor_error_flag_state;
+
+    return ESP_OK;
 }
\ No newline at end of file
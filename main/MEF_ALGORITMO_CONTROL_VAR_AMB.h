@@ -22,9 +22,32 @@ extern "C" {
 #include "DHT11_SENSOR.h"
 #include "CO2_SENSOR.h"
 #include "MCP23008.h"
+#include "CONTROL_TIEMPO_PROPORCIONAL.h"
 
 /*============================[DEFINES AND MACROS]=====================================*/
 
+/**
+ *  Parámetros del modo de control por tiempo proporcional de la temperatura ambiente, en donde
+ *  un controlador PI calcula el ciclo de trabajo de la calefacción y los ventiladores dentro de
+ *  una ventana de tiempo fija.
+ *
+ *  -Las ganancias están expresadas en ciclo de trabajo (0 a 1) por °C, y por °C*s en el caso de
+ *   la ganancia integral.
+ *  -Los tiempos están expresados en segundos.
+ */
+#define MEF_VAR_AMB_TP_PERIODO_VENTANA      120
+#define MEF_VAR_AMB_TP_TIEMPO_MIN_ON        15
+#define MEF_VAR_AMB_TP_TIEMPO_MIN_OFF       15
+#define MEF_VAR_AMB_PI_KP_TEMP              0.25
+#define MEF_VAR_AMB_PI_KI_TEMP              0.0005
+
+/**
+ *  Cantidad de zonas (salas de cultivo) controladas de forma independiente por el algoritmo de control de
+ *  variables ambientales. Cada zona tiene sus propios límites, modos y actuadores, y se la configura en la
+ *  tabla de zonas de "MEF_ALGORITMO_CONTROL_VAR_AMB.c".
+ */
+#define MEF_VAR_AMB_CANT_ZONAS  1
+
 /**
  *  Enumeración correspondiente al número de relés de los ventiladores y la calefaccion de control
  *  de la temperatura, humedad y CO2 ambiente del sistema.
@@ -58,21 +81,84 @@ typedef enum {
     MODO_MANUAL_CONTROL_VAR_AMB,
 } estado_MEF_principal_control_var_amb_t;
 
+
+/**
+ *  Estructura con la configuración fija de una zona del control de variables ambientales, esto es, los relés
+ *  de sus actuadores y los tópicos MQTT mediante los cuales se la comanda y se publica su estado.
+ */
+typedef struct {
+    const char *nombre;                             /* Nombre de la zona, utilizado en el LOG. */
+    int8_t rele_ventiladores;                       /* Relé de los ventiladores de la zona. */
+    int8_t rele_calefaccion;                        /* Relé de la calefacción de la zona. */
+    const char *topico_sp_temp;                     /* Tópico de nuevo SP de temperatura. */
+    const char *topico_modo;                        /* Tópico de modo MANUAL o AUTO. */
+    const char *topico_tipo_control;                /* Tópico de tipo de control (histéresis o tiempo proporcional). */
+    const char *topico_modo_manual_ventiladores;    /* Tópico de estado de los ventiladores en modo MANUAL. */
+    const char *topico_modo_manual_calefaccion;     /* Tópico de estado de la calefacción en modo MANUAL. */
+    const char *topico_estado_ventiladores;         /* Tópico donde se publica el estado de los ventiladores. */
+    const char *topico_estado_calefaccion;          /* Tópico donde se publica el estado de la calefacción. */
+} mef_var_amb_zona_config_t;
+
+
+/**
+ *  Estructura que representa el contexto de una zona del control de variables ambientales, con los valores
+ *  sensados, los límites de control, las banderas y el estado de las MEFs de dicha zona.
+ */
+typedef struct {
+    const mef_var_amb_zona_config_t *config;        /* Configuración fija de la zona. */
+
+    DHT11_sensor_temp_t temp;                       /* Temperatura ambiente sensada, en °C. */
+    DHT11_sensor_temp_t limite_inferior_temp;       /* Límite inferior del rango correcto de temperatura, en °C. */
+    DHT11_sensor_temp_t limite_superior_temp;       /* Límite superior del rango correcto de temperatura, en °C. */
+    DHT11_sensor_temp_t ancho_ventana_hist_temp;    /* Ancho de la ventana de histéresis de temperatura, en °C. */
+    DHT11_sensor_temp_t delta_temp;                 /* Delta de temperatura alrededor del SP, en °C. */
+
+    DHT11_sensor_hum_t hum;                         /* Humedad relativa ambiente sensada, en %. */
+    DHT11_sensor_hum_t limite_superior_hum;         /* Límite superior del rango correcto de humedad, en %. */
+    DHT11_sensor_hum_t ancho_ventana_hist_hum;      /* Ancho de la ventana de histéresis de humedad, en %. */
+
+    CO2_sensor_ppm_t CO2;                           /* CO2 ambiente sensado, en ppm. */
+    CO2_sensor_ppm_t limite_inferior_CO2;           /* Límite inferior del rango correcto de CO2, en ppm. */
+    CO2_sensor_ppm_t ancho_ventana_hist_CO2;        /* Ancho de la ventana de histéresis de CO2, en ppm. */
+
+    bool manual_mode_flag;                          /* Bandera de modo MANUAL. */
+    bool proportional_mode_flag;                    /* Bandera de control por tiempo proporcional. */
+    bool reset_transition_flag;                     /* Bandera de transición con reset de la MEF de control. */
+    bool temp_DHT11_sensor_error_flag;              /* Bandera de error de sensado de temperatura. */
+    bool hum_DHT11_sensor_error_flag;               /* Bandera de error de sensado de humedad. */
+    bool CO2_sensor_error_flag;                     /* Bandera de error de sensado de CO2. */
+
+    estado_MEF_principal_control_var_amb_t est_MEF_principal;  /* Estado de la MEF principal. */
+    estado_MEF_control_var_amb_t est_MEF_control_var_amb;       /* Estado de la MEF de control por histéresis. */
+    bool modo_proporcional_anterior;                /* Tipo de control utilizado en la evaluación anterior. */
+
+    control_pi_t pi_calefaccion;                    /* Controlador PI de la calefacción (tiempo proporcional). */
+    control_pi_t pi_ventiladores;                   /* Controlador PI de los ventiladores (tiempo proporcional). */
+    control_tp_rele_t tp_calefaccion;               /* Planificador de tiempo proporcional de la calefacción. */
+    control_tp_rele_t tp_ventiladores;              /* Planificador de tiempo proporcional de los ventiladores. */
+    bool estado_calefaccion_tp;                     /* Estado actual del relé de la calefacción en tiempo proporcional. */
+    bool estado_ventiladores_tp;                    /* Estado actual del relé de los ventiladores en tiempo proporcional. */
+    uint8_t estado_errores_anterior;                /* Banderas de error y conexión MQTT de la evaluación anterior. */
+} mef_var_amb_zona_t;
+
 /*======================[EXTERNAL DATA DECLARATION]==============================*/
 
 /*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
 
 esp_err_t mef_var_amb_init(esp_mqtt_client_handle_t mqtt_client);
+void mef_var_amb_zona_init(mef_var_amb_zona_t *zona, const mef_var_amb_zona_config_t *config);
 TaskHandle_t mef_var_amb_get_task_handle(void);
-DHT11_sensor_temp_t mef_var_amb_get_delta_temp(void);
-void mef_var_amb_set_temp_control_limits(DHT11_sensor_temp_t nuevo_limite_inferior_temp_amb, DHT11_sensor_temp_t nuevo_limite_superior_temp_amb);
-void mef_var_amb_set_temp_amb_value(DHT11_sensor_temp_t nuevo_valor_temp_amb);
-void mef_var_amb_set_hum_amb_value(DHT11_sensor_hum_t nuevo_valor_hum_amb);
-void mef_var_amb_set_CO2_amb_value(CO2_sensor_ppm_t nuevo_valor_CO2_amb);
-void mef_var_amb_set_manual_mode_flag_value(bool manual_mode_flag_state);
-void mef_var_amb_set_temp_DHT11_sensor_error_flag_value(bool sensor_error_flag_state);
-void mef_var_amb_set_hum_DHT11_sensor_error_flag_value(bool sensor_error_flag_state);
-void mef_var_amb_set_CO2_sensor_error_flag_value(bool sensor_error_flag_state);
+const mef_var_amb_zona_config_t* mef_var_amb_get_zona_config(unsigned int zona);
+esp_err_t mef_var_amb_get_delta_temp(unsigned int zona, DHT11_sensor_temp_t *delta_temp);
+esp_err_t mef_var_amb_set_temp_control_limits(unsigned int zona, DHT11_sensor_temp_t nuevo_limite_inferior_temp_amb, DHT11_sensor_temp_t nuevo_limite_superior_temp_amb);
+esp_err_t mef_var_amb_set_temp_amb_value(unsigned int zona, DHT11_sensor_temp_t nuevo_valor_temp_amb);
+esp_err_t mef_var_amb_set_hum_amb_value(unsigned int zona, DHT11_sensor_hum_t nuevo_valor_hum_amb);
+esp_err_t mef_var_amb_set_CO2_amb_value(unsigned int zona, CO2_sensor_ppm_t nuevo_valor_CO2_amb);
+esp_err_t mef_var_amb_set_manual_mode_flag_value(unsigned int zona, bool manual_mode_flag_state);
+esp_err_t mef_var_amb_set_proportional_mode_flag_value(unsigned int zona, bool proportional_mode_flag_state);
+esp_err_t mef_var_amb_set_temp_DHT11_sensor_error_flag_value(unsigned int zona, bool sensor_error_flag_state);
+esp_err_t mef_var_amb_set_hum_DHT11_sensor_error_flag_value(unsigned int zona, bool sensor_error_flag_state);
+esp_err_t mef_var_amb_set_CO2_sensor_error_flag_value(unsigned int zona, bool sensor_error_flag_state);
 
 /*==================[END OF FILE]============================================*/
 #ifdef __cplusplus
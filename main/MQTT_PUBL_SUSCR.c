@@ -164,11 +164,12 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
                 strncpy(mqtt_topic_list[i].data, event->data, event->data_len);
 
                 /**
-                 *  En caso de que para este tópico se haya cargado una función callback, se la ejecuta.
+                 *  En caso de que para este tópico se haya cargado una función callback, se la ejecuta,
+                 *  pasándole el nombre del tópico.
                  */
                 if(mqtt_topic_list[i].topic_cb != NULL)
                 {
-                    mqtt_topic_list[i].topic_cb(NULL);
+                    mqtt_topic_list[i].topic_cb(mqtt_topic_list[i].topic);
                 }
 
                 ESP_LOGI(TAG, "TOPIC DATA ARRIVED: %s", mqtt_topic_list[i].data);
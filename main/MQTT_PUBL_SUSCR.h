@@ -21,6 +21,9 @@ extern "C" {
 /**
  *  @brief  Puntero a función que será utilizado para ejecutar la función que se pase
  *          como callback cuando llegue un dato al tópico correspondiente.
+ *
+ *          Como parámetro se le pasa el nombre del tópico (const char*), de modo que una
+ *          misma función callback pueda atender a varios tópicos.
  */
 typedef void (*CallbackFunction)(void *pvParameters);
 
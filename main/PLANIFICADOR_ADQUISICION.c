@@ -0,0 +1,533 @@
+/**
+ * @file PLANIFICADOR_ADQUISICION.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Planificador de adquisición que ejecuta las mediciones de los sensores registrados desde una única tarea,
+ *          con planificación por vencimiento más próximo (EDF), y entrega muestras con marca de tiempo y calidad.
+ * @version 0.1
+ * @date 2023-03-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Cada sensor se registra con su función de medición, su período, su plazo y su costo (la duración máxima
+ *  estimada de una medición). Cada período se libera una nueva medición del sensor, que vence al cumplirse el plazo
+ *  desde su liberación. La tarea del planificador ejecuta, entre las mediciones liberadas, la de vencimiento más
+ *  próximo, y si no hay ninguna liberada se bloquea hasta la próxima liberación.
+ *
+ *      Las mediciones no se interrumpen entre sí (la tarea ejecuta una medición completa antes de elegir la
+ *  siguiente), por lo que una medición liberada puede demorarse, como máximo, el costo de la medición en curso.
+ *  Al registrar un sensor se verifica que la utilización total (suma de costo / período) no supere
+ *  ADQ_PLANIF_UTILIZACION_MAX, y se avisa si el plazo no alcanza para cubrir esa demora.
+ *
+ *      Las mediciones que terminan después de su vencimiento se cuentan como plazos perdidos. Si un sensor se atrasa
+ *  más de un período, se descartan las mediciones atrasadas en lugar de ejecutarlas una detrás de otra.
+ *
+ *      Todas las muestras tienen el mismo formato (magnitud, valor, calidad y marca de tiempo), de modo que la
+ *  aplicación no depende de los valores de error propios de cada sensor. Como todas las mediciones se realizan desde
+ *  la misma tarea, los sensores que comparten un bus no compiten por él, y no se necesita una tarea por sensor.
+ *
+ *      Las funciones de medición no deben esperar eventos de duración indefinida (por ejemplo, el dato disponible
+ *  de un sensor que mide cada varios segundos), ya que demorarían al resto de los sensores.
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_err.h"
+#include <esp_timer.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "PLANIFICADOR_ADQUISICION.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+/**
+ *  Estructura que representa el estado interno de un sensor registrado.
+ */
+typedef struct {
+    adq_sensor_config_t config;                         /* Configuración del sensor. */
+    int64_t liberacion_us;                              /* Liberación de la próxima medición. */
+    int64_t vencimiento_us;                             /* Vencimiento de la próxima medición. */
+    uint32_t costo_medido_us;                           /* Duración máxima medida de una medición. */
+    uint32_t plazos_perdidos;                           /* Cantidad de mediciones terminadas después de su vencimiento. */
+    adq_muestra_t muestras[ADQ_PLANIF_CANT_MAX_MUESTRAS]; /* Muestras de la última medición. */
+    size_t cant_muestras;                               /* Cantidad de muestras de la última medición. */
+} adq_sensor_t;
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+/* Tag para imprimir información en el LOG. */
+static const char *TAG = "PLANIFICADOR_ADQUISICION";
+
+/* Handle de la tarea del planificador. */
+static TaskHandle_t xAdquisicionTaskHandle = NULL;
+
+/* Estado interno de cada sensor registrado. */
+static adq_sensor_t ADQ_sensores[ADQ_PLANIF_CANT_MAX_SENSORES];
+
+/* Cantidad de sensores registrados. */
+static size_t ADQ_cant_sensores = 0;
+
+/* Utilización de la tarea del planificador por los sensores registrados, en milésimos. */
+static uint32_t ADQ_utilizacion = 0;
+
+/* Mutex que protege el estado de los sensores, al que se accede desde la tarea del planificador y de la aplicación. */
+static SemaphoreHandle_t ADQ_mutex = NULL;
+
+/* Función callback a ejecutar en cada medición, y su argumento. */
+static adq_planif_callback_t ADQ_callback = NULL;
+static void *ADQ_callback_arg = NULL;
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static adq_sensor_t *AdqPlanifSeleccionarSensor(int64_t ahora, int64_t *proxima_liberacion);
+static void AdqPlanifActualizarSensor(adq_sensor_t *sensor, const adq_muestra_t *muestras, size_t cantidad, int64_t inicio, int64_t fin);
+static void vTaskAdquisicion(void *pvParameters);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para elegir, entre las mediciones ya liberadas, la de vencimiento más próximo. Debe llamarse
+ *          con el mutex tomado.
+ *
+ * @param ahora                 Tiempo actual, en microsegundos.
+ * @param proxima_liberacion    Variable donde se guardará la liberación más próxima de los sensores sin medición
+ *                              liberada, o INT64_MAX si no hay ninguno.
+ * @return adq_sensor_t*        Sensor a medir, o NULL si no hay mediciones liberadas.
+ */
+static adq_sensor_t *AdqPlanifSeleccionarSensor(int64_t ahora, int64_t *proxima_liberacion)
+{
+    adq_sensor_t *elegido = NULL;
+    *proxima_liberacion = INT64_MAX;
+
+    for(size_t i = 0; i < ADQ_cant_sensores; i++)
+    {
+        adq_sensor_t *sensor = &ADQ_sensores[i];
+
+        if(sensor->liberacion_us > ahora)
+        {
+            if(sensor->liberacion_us < *proxima_liberacion)
+            {
+                *proxima_liberacion = sensor->liberacion_us;
+            }
+        }
+
+        else if(elegido == NULL || sensor->vencimiento_us < elegido->vencimiento_us)
+        {
+            elegido = sensor;
+        }
+    }
+
+    return elegido;
+}
+
+
+
+/**
+ * @brief   Función para guardar el resultado de una medición y calcular la liberación y el vencimiento de la
+ *          siguiente. Debe llamarse con el mutex tomado.
+ *
+ * @param sensor    Sensor medido.
+ * @param muestras  Muestras de la medición.
+ * @param cantidad  Cantidad de muestras.
+ * @param inicio    Inicio de la medición, en microsegundos.
+ * @param fin       Fin de la medición, en microsegundos.
+ */
+static void AdqPlanifActualizarSensor(adq_sensor_t *sensor, const adq_muestra_t *muestras, size_t cantidad, int64_t inicio, int64_t fin)
+{
+    int64_t periodo_us = (int64_t) sensor->config.periodo_ms * 1000;
+    int64_t plazo_us = (int64_t) sensor->config.plazo_ms * 1000;
+    uint32_t costo_us = (uint32_t) (fin - inicio);
+
+    memcpy(sensor->muestras, muestras, cantidad * sizeof(adq_muestra_t));
+    sensor->cant_muestras = cantidad;
+
+    /**
+     *  Se avisa cada vez que se supera la duración máxima medida, si es mayor que el costo declarado.
+     */
+    if(costo_us > sensor->costo_medido_us)
+    {
+        sensor->costo_medido_us = costo_us;
+
+        if(costo_us > sensor->config.costo_ms * 1000)
+        {
+            ESP_LOGW(TAG, "%s took %u us, more than its declared cost.", sensor->config.nombre, (unsigned int) costo_us);
+        }
+    }
+
+    if(fin > sensor->vencimiento_us)
+    {
+        sensor->plazos_perdidos++;
+        ESP_LOGD(TAG, "%s missed its deadline by %lld us.", sensor->config.nombre, (long long) (fin - sensor->vencimiento_us));
+    }
+
+    /**
+     *  Si la siguiente liberación quedó atrasada más de un período, se descartan las mediciones atrasadas.
+     */
+    sensor->liberacion_us += periodo_us;
+
+    if(sensor->liberacion_us + periodo_us <= fin)
+    {
+        sensor->liberacion_us = fin;
+    }
+
+    sensor->vencimiento_us = sensor->liberacion_us + plazo_us;
+}
+
+
+
+/**
+ * @brief   Tarea del planificador, que ejecuta las mediciones liberadas por orden de vencimiento.
+ *
+ * @param pvParameters  Parámetros pasados a la tarea en su creación.
+ */
+static void vTaskAdquisicion(void *pvParameters)
+{
+    adq_muestra_t muestras[ADQ_PLANIF_CANT_MAX_MUESTRAS];
+
+    while(1)
+    {
+        int64_t ahora = esp_timer_get_time();
+        int64_t proxima_liberacion;
+
+        xSemaphoreTake(ADQ_mutex, portMAX_DELAY);
+        adq_sensor_t *sensor = AdqPlanifSeleccionarSensor(ahora, &proxima_liberacion);
+        xSemaphoreGive(ADQ_mutex);
+
+        /**
+         *  Si no hay mediciones liberadas, se espera hasta la próxima liberación. La espera se interrumpe
+         *  al registrar un nuevo sensor.
+         */
+        if(sensor == NULL)
+        {
+            TickType_t espera = portMAX_DELAY;
+
+            if(proxima_liberacion != INT64_MAX)
+            {
+                espera = pdMS_TO_TICKS((proxima_liberacion - ahora + 999) / 1000) + 1;
+            }
+
+            ulTaskNotifyTake(pdTRUE, espera);
+            continue;
+        }
+
+        /**
+         *  Los sensores no se eliminan, y su configuración no cambia luego de registrarlos, por lo
+         *  que la medición se realiza sin tomar el mutex.
+         */
+        uint8_t id_sensor = sensor - ADQ_sensores;
+        size_t cantidad = 0;
+
+        esp_err_t err = sensor->config.medir(sensor->config.contexto, muestras, &cantidad);
+        int64_t fin = esp_timer_get_time();
+
+        if(err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to measure %s (%s).", sensor->config.nombre, esp_err_to_name(err));
+        }
+
+        if(cantidad > ADQ_PLANIF_CANT_MAX_MUESTRAS)
+        {
+            cantidad = ADQ_PLANIF_CANT_MAX_MUESTRAS;
+        }
+
+        for(size_t i = 0; i < cantidad; i++)
+        {
+            muestras[i].sensor = id_sensor;
+            muestras[i].marca_tiempo_us = fin;
+        }
+
+        xSemaphoreTake(ADQ_mutex, portMAX_DELAY);
+        AdqPlanifActualizarSensor(sensor, muestras, cantidad, ahora, fin);
+        xSemaphoreGive(ADQ_mutex);
+
+        /**
+         *  Se ejecuta la función callback configurada con las muestras de la medición.
+         */
+        if(ADQ_callback != NULL && cantidad > 0)
+        {
+            ADQ_callback(muestras, cantidad, ADQ_callback_arg);
+        }
+    }
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para inicializar el planificador de adquisición y crear su tarea.
+ *
+ * @param callback  Función a ejecutar en cada medición, con las muestras obtenidas. Puede ser NULL.
+ * @param arg       Argumento que se pasa a la función callback.
+ * @return esp_err_t
+ */
+esp_err_t adq_planif_init(adq_planif_callback_t callback, void *arg)
+{
+    if(xAdquisicionTaskHandle != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ADQ_callback = callback;
+    ADQ_callback_arg = arg;
+
+    ADQ_mutex = xSemaphoreCreateMutex();
+
+    if(ADQ_mutex == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create mutex.");
+        return ESP_ERR_NO_MEM;
+    }
+
+
+
+    //========================| CREACIÓN DE TAREA |===========================//
+
+    /**
+     *  Se crea la tarea que realiza las mediciones de todos los sensores. Su stack debe alcanzar para
+     *  la función de medición de cualquiera de los sensores.
+     *
+     *  Se le da una prioridad media, por encima de las tareas de control que consumen las muestras.
+     */
+    xTaskCreate(
+        vTaskAdquisicion,
+        "vTaskAdquisicion",
+        4096,
+        NULL,
+        3,
+        &xAdquisicionTaskHandle);
+
+    /**
+     *  En caso de que el handle sea NULL, implica que no se pudo crear la tarea, y se retorna con error.
+     */
+    if(xAdquisicionTaskHandle == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create vTaskAdquisicion task.");
+        vSemaphoreDelete(ADQ_mutex);
+        ADQ_mutex = NULL;
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para registrar un sensor en el planificador. Su primera medición se libera inmediatamente.
+ *
+ * @param config        Configuración del sensor.
+ * @param id_sensor     Variable donde se guardará el identificador del sensor. Puede ser NULL.
+ * @return esp_err_t    ESP_ERR_INVALID_STATE si el sensor superaría la utilización máxima.
+ */
+esp_err_t adq_planif_agregar_sensor(const adq_sensor_config_t *config, uint8_t *id_sensor)
+{
+    if(config == NULL || config->medir == NULL || config->periodo_ms == 0 || config->costo_ms == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t plazo_ms = (config->plazo_ms != 0) ? config->plazo_ms : config->periodo_ms;
+
+    if(plazo_ms > config->periodo_ms || config->costo_ms > plazo_ms)
+    {
+        ESP_LOGE(TAG, "Invalid timing for %s.", config->nombre);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if(ADQ_mutex == NULL)
+    {
+        ESP_LOGE(TAG, "Scheduler not initialized.");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t utilizacion = (config->costo_ms * 1000 + config->periodo_ms - 1) / config->periodo_ms;
+
+    xSemaphoreTake(ADQ_mutex, portMAX_DELAY);
+
+    if(ADQ_cant_sensores >= ADQ_PLANIF_CANT_MAX_SENSORES)
+    {
+        xSemaphoreGive(ADQ_mutex);
+        ESP_LOGE(TAG, "Maximum number of sensors reached.");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if(ADQ_utilizacion + utilizacion > ADQ_PLANIF_UTILIZACION_MAX)
+    {
+        xSemaphoreGive(ADQ_mutex);
+        ESP_LOGE(TAG, "Adding %s would exceed the maximum utilization.", config->nombre);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /**
+     *  Una medición puede demorarse el costo de la medición más larga de otro sensor, que ya esté en curso.
+     */
+    uint32_t costo_max_ms = 0;
+
+    for(size_t i = 0; i < ADQ_cant_sensores; i++)
+    {
+        adq_sensor_t *otro = &ADQ_sensores[i];
+
+        if(otro->config.costo_ms > costo_max_ms)
+        {
+            costo_max_ms = otro->config.costo_ms;
+        }
+
+        if(otro->config.plazo_ms < otro->config.costo_ms + config->costo_ms)
+        {
+            ESP_LOGW(TAG, "%s may make %s miss its deadline.", config->nombre, otro->config.nombre);
+        }
+    }
+
+    if(plazo_ms < config->costo_ms + costo_max_ms)
+    {
+        ESP_LOGW(TAG, "%s may miss its deadline.", config->nombre);
+    }
+
+    uint8_t id = ADQ_cant_sensores;
+    adq_sensor_t *sensor = &ADQ_sensores[id];
+
+    memset(sensor, 0, sizeof(adq_sensor_t));
+    sensor->config = *config;
+    sensor->config.plazo_ms = plazo_ms;
+    sensor->liberacion_us = esp_timer_get_time();
+    sensor->vencimiento_us = sensor->liberacion_us + (int64_t) plazo_ms * 1000;
+
+    ADQ_utilizacion += utilizacion;
+    ADQ_cant_sensores++;
+
+    xSemaphoreGive(ADQ_mutex);
+
+    /**
+     *  Se despierta a la tarea para que tenga en cuenta la liberación del nuevo sensor.
+     */
+    xTaskNotifyGive(xAdquisicionTaskHandle);
+
+    if(id_sensor != NULL)
+    {
+        *id_sensor = id;
+    }
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener la última muestra de una magnitud de un sensor.
+ *
+ * @param id_sensor     Identificador del sensor.
+ * @param magnitud      Magnitud buscada.
+ * @param muestra       Variable donde se guardará la muestra.
+ * @return esp_err_t    ESP_ERR_NOT_FOUND si el sensor todavía no entregó muestras de esa magnitud.
+ */
+esp_err_t adq_planif_get_muestra(uint8_t id_sensor, adq_magnitud_t magnitud, adq_muestra_t *muestra)
+{
+    if(muestra == NULL || ADQ_mutex == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(ADQ_mutex, portMAX_DELAY);
+
+    if(id_sensor < ADQ_cant_sensores)
+    {
+        adq_sensor_t *sensor = &ADQ_sensores[id_sensor];
+
+        for(size_t i = 0; i < sensor->cant_muestras; i++)
+        {
+            if(sensor->muestras[i].magnitud == magnitud)
+            {
+                *muestra = sensor->muestras[i];
+                err = ESP_OK;
+                break;
+            }
+        }
+    }
+
+    else
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreGive(ADQ_mutex);
+
+    return err;
+}
+
+
+
+/**
+ * @brief   Función para obtener la cantidad de mediciones de un sensor que terminaron después de su vencimiento.
+ *
+ * @param id_sensor     Identificador del sensor.
+ * @return uint32_t     Cantidad de plazos perdidos.
+ */
+uint32_t adq_planif_get_plazos_perdidos(uint8_t id_sensor)
+{
+    uint32_t plazos_perdidos = 0;
+
+    if(ADQ_mutex == NULL)
+    {
+        return 0;
+    }
+
+    xSemaphoreTake(ADQ_mutex, portMAX_DELAY);
+
+    if(id_sensor < ADQ_cant_sensores)
+    {
+        plazos_perdidos = ADQ_sensores[id_sensor].plazos_perdidos;
+    }
+
+    xSemaphoreGive(ADQ_mutex);
+
+    return plazos_perdidos;
+}
+
+
+
+/**
+ * @brief   Función para obtener el código de calidad que corresponde al error devuelto por un driver,
+ *          para las funciones de medición de los sensores.
+ *
+ * @param err               Error devuelto por el driver.
+ * @return adq_calidad_t    Calidad de la muestra.
+ */
+adq_calidad_t adq_calidad_desde_error(esp_err_t err)
+{
+    switch(err)
+    {
+
+    case ESP_OK:
+        return ADQ_CALIDAD_OK;
+
+    case ESP_ERR_TIMEOUT:
+    case ESP_ERR_NOT_FOUND:
+        return ADQ_CALIDAD_SIN_RESPUESTA;
+
+    case ESP_ERR_INVALID_CRC:
+    case ESP_ERR_INVALID_RESPONSE:
+    case ESP_ERR_INVALID_SIZE:
+        return ADQ_CALIDAD_ERROR_DATOS;
+
+    default:
+        return ADQ_CALIDAD_ERROR;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+
+    Planificador de adquisición de sensores, que ejecuta las mediciones de todos los sensores registrados desde
+    una única tarea, según la política "primero el de vencimiento más próximo" (EDF), y entrega las muestras en un
+    formato común, con marca de tiempo y código de calidad.
+
+*/
+
+#ifndef PLANIFICADOR_ADQUISICION_H_
+#define PLANIFICADOR_ADQUISICION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/* Cantidad máxima de sensores registrados en el planificador. */
+#define ADQ_PLANIF_CANT_MAX_SENSORES        8
+
+/* Cantidad máxima de muestras que entrega un sensor en cada medición (por ejemplo, temperatura y humedad). */
+#define ADQ_PLANIF_CANT_MAX_MUESTRAS        4
+
+/**
+ *  Utilización máxima del procesador de la tarea del planificador, en milésimos, que se admite al registrar
+ *  un sensor (suma de costo / período de todos los sensores). Se deja un margen, ya que la tarea no es expropiativa
+ *  y una medición en curso demora a las demás.
+ */
+#define ADQ_PLANIF_UTILIZACION_MAX          900
+
+/**
+ *  Enumeración correspondiente a las magnitudes que se miden.
+ */
+typedef enum {
+    ADQ_MAGNITUD_TEMP_AMB = 0,          /* Temperatura ambiente, en °C. */
+    ADQ_MAGNITUD_HUM_AMB,               /* Humedad relativa ambiente, en %. */
+    ADQ_MAGNITUD_CO2_AMB,               /* CO2 ambiente, en ppm. */
+    ADQ_MAGNITUD_TEMP_SOLUCION,         /* Temperatura de la solución nutritiva, en °C. */
+    ADQ_MAGNITUD_PH,                    /* pH de la solución nutritiva. */
+    ADQ_MAGNITUD_TDS,                   /* Sólidos disueltos totales de la solución nutritiva, en ppm. */
+    ADQ_MAGNITUD_NIVEL,                 /* Nivel de tanque, en %. */
+} adq_magnitud_t;
+
+
+/**
+ *  Enumeración correspondiente a la calidad de una muestra. Reemplaza a los valores de error propios
+ *  de cada sensor.
+ */
+typedef enum {
+    ADQ_CALIDAD_OK = 0,                 /* Medición válida. */
+    ADQ_CALIDAD_CALENTANDO,             /* El sensor se está calentando, el valor no es confiable. */
+    ADQ_CALIDAD_SIN_RESPUESTA,          /* El sensor no respondió. */
+    ADQ_CALIDAD_ERROR_DATOS,            /* Respuesta corrupta (checksum, CRC o formato inválido). */
+    ADQ_CALIDAD_FUERA_DE_RANGO,         /* Valor fuera del rango de medición del sensor. */
+    ADQ_CALIDAD_ERROR,                  /* Otro error. */
+} adq_calidad_t;
+
+
+/**
+ *  Estructura que representa una muestra. El sensor completa la magnitud, el valor y la calidad, y el
+ *  planificador completa el identificador del sensor y la marca de tiempo.
+ */
+typedef struct {
+    uint8_t sensor;                     /* Identificador del sensor en el planificador. */
+    adq_magnitud_t magnitud;            /* Magnitud medida. */
+    float valor;                        /* Valor medido. Solo es válido si la calidad es ADQ_CALIDAD_OK. */
+    adq_calidad_t calidad;              /* Calidad de la muestra. */
+    int64_t marca_tiempo_us;            /* Marca de tiempo del fin de la medición (esp_timer), en microsegundos. */
+} adq_muestra_t;
+
+
+/**
+ *  @brief  Puntero a función que realiza una medición de un sensor. Se ejecuta desde la tarea del planificador,
+ *          por lo que puede bloquearse, pero no más que el costo declarado del sensor. Debe cargar en "muestras"
+ *          una muestra por magnitud, aun en caso de error (con la calidad correspondiente), y su cantidad en
+ *          "cantidad" (hasta ADQ_PLANIF_CANT_MAX_MUESTRAS).
+ */
+typedef esp_err_t (*adq_funcion_medicion_t)(void *contexto, adq_muestra_t *muestras, size_t *cantidad);
+
+
+/**
+ *  Estructura con la configuración de un sensor.
+ */
+typedef struct {
+    const char *nombre;                 /* Nombre del sensor, para el LOG. */
+    adq_funcion_medicion_t medir;       /* Función de medición. */
+    void *contexto;                     /* Argumento que se pasa a la función de medición. */
+    uint32_t periodo_ms;                /* Período de medición, en milisegundos. */
+    uint32_t plazo_ms;                  /* Plazo de cada medición desde su liberación, o 0 para usar el período. */
+    uint32_t costo_ms;                  /* Duración máxima estimada de una medición, en milisegundos. */
+} adq_sensor_config_t;
+
+
+/**
+ *  @brief  Puntero a función que será utilizado para ejecutar la función que se pase como callback cada vez
+ *          que se realiza una medición. Se ejecuta desde la tarea del planificador.
+ */
+typedef void (*adq_planif_callback_t)(const adq_muestra_t *muestras, size_t cantidad, void *arg);
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+esp_err_t adq_planif_init(adq_planif_callback_t callback, void *arg);
+esp_err_t adq_planif_agregar_sensor(const adq_sensor_config_t *config, uint8_t *id_sensor);
+esp_err_t adq_planif_get_muestra(uint8_t id_sensor, adq_magnitud_t magnitud, adq_muestra_t *muestra);
+uint32_t adq_planif_get_plazos_perdidos(uint8_t id_sensor);
+adq_calidad_t adq_calidad_desde_error(esp_err_t err);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLANIFICADOR_ADQUISICION_H_
@@ -0,0 +1,447 @@
+/**
+ * @file PLANIFICADOR_DS18B20.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Planificador de conversiones de los sensores de temperatura DS18B20/DS18S20 conectados a uno o más buses 1-Wire.
+ * @version 0.1
+ * @date 2023-02-27
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Al agregar un bus mediante "ds18b20_planif_agregar_bus()", se buscan los sensores conectados, se configura la
+ *  resolución de los DS18B20 (si se indicó), y se obtiene el tiempo de conversión del bus, que es el del sensor más
+ *  lento (750 ms a 12 bits, 375 ms a 11 bits, 187,5 ms a 10 bits y 93,75 ms a 9 bits; 750 ms para el DS18S20).
+ *
+ *      Cada bus es atendido por una única tarea, sin importar la cantidad de sensores. En cada período, la tarea envía
+ *  el comando CONVERT_T con SKIP ROM, de modo que todos los sensores del bus convierten a la vez, y se bloquea durante
+ *  el tiempo de conversión del bus. Luego lee el scratchpad de cada sensor, y ejecuta la función callback con las
+ *  lecturas de todo el bus. Las tareas de distintos buses se ejecutan en paralelo.
+ *
+ *      De esta forma, el tiempo de refresco del bus es el de una única conversión más la lectura de los scratchpads
+ *  (unos 10 ms por sensor), en lugar de una conversión completa por sensor.
+ *
+ *      Un sensor que devuelve 85 °C (valor de reset del registro de temperatura) no realizó la conversión, por ejemplo
+ *  por una caída de la alimentación, y su lectura se informa como errónea.
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include <esp_timer.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "onewire.h"
+#include "onewire_rmt.h"
+#include "ds18x20.h"
+
+#include "PLANIFICADOR_DS18B20.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+/* Tiempo de conversión a 12 bits (máxima resolución), en microsegundos. */
+#define DS18B20_PLANIF_CONVERSION_MAX_US    750000
+
+/* Posición y máscara de los bits de resolución en el registro de configuración del DS18B20. */
+#define DS18B20_PLANIF_RESOLUCION_OFFSET    5
+#define DS18B20_PLANIF_RESOLUCION_MASK      0x03
+
+/* Byte del registro de configuración en el scratchpad del DS18B20. */
+#define DS18B20_PLANIF_BYTE_CONFIG          4
+
+/* Temperatura que contiene el registro de temperatura luego del encendido del sensor. */
+#define DS18B20_PLANIF_TEMP_RESET           85.0
+
+/**
+ *  Estructura que representa el estado interno de un bus 1-Wire.
+ */
+typedef struct {
+    ds18b20_planif_config_bus_t config;                             /* Configuración del bus. */
+    ds18x20_addr_t direcciones[DS18B20_PLANIF_CANT_MAX_SENSORES];  /* Direcciones de los sensores encontrados. */
+    size_t cant_sensores;                                           /* Cantidad de sensores encontrados. */
+    uint32_t tiempo_conversion_ms;                                  /* Tiempo de conversión del sensor más lento. */
+    ds18b20_planif_lectura_t lecturas[DS18B20_PLANIF_CANT_MAX_SENSORES]; /* Últimas lecturas de los sensores. */
+    ds18b20_planif_callback_t callback;                             /* Callback al leer todos los sensores. */
+    void *arg;                                                      /* Argumento de la función callback. */
+    TaskHandle_t tarea;                                             /* Handle de la tarea del bus. */
+} ds18b20_planif_bus_t;
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+/* Tag para imprimir información en el LOG. */
+static const char *TAG = "PLANIFICADOR_DS18B20";
+
+/* Estado interno de cada bus agregado. */
+static ds18b20_planif_bus_t DS18B20_planif_buses[DS18B20_PLANIF_CANT_MAX_BUSES];
+
+/* Cantidad de buses agregados. */
+static size_t DS18B20_planif_cant_buses = 0;
+
+/* Mutex que protege las últimas lecturas, a las que se accede desde las tareas de los buses y de la aplicación. */
+static SemaphoreHandle_t DS18B20_planif_mutex = NULL;
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static ds18b20_planif_bus_t *DS18B20PlanifBuscarBus(gpio_num_t pin);
+static esp_err_t DS18B20PlanifConfigurarSensor(ds18b20_planif_bus_t *bus, ds18x20_addr_t direccion, uint32_t *tiempo_conversion_us);
+static void vTaskDS18B20Bus(void *pvParameters);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para obtener el estado interno de un bus a partir de su pin GPIO.
+ *
+ * @param pin   Pin GPIO del bus.
+ * @return ds18b20_planif_bus_t*    Estado del bus, o NULL si no se agregó el bus.
+ */
+static ds18b20_planif_bus_t *DS18B20PlanifBuscarBus(gpio_num_t pin)
+{
+    for(size_t i = 0; i < DS18B20_planif_cant_buses; i++)
+    {
+        if(DS18B20_planif_buses[i].config.pin == pin)
+        {
+            return &DS18B20_planif_buses[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * @brief   Función para configurar la resolución de un sensor DS18B20, si se indicó en la configuración del bus,
+ *          y obtener su tiempo de conversión. La resolución se escribe solo en el scratchpad (no en la EEPROM),
+ *          por lo que se vuelve a configurar en cada inicio.
+ *
+ * @param bus                   Bus del sensor.
+ * @param direccion             Dirección 1-Wire del sensor.
+ * @param tiempo_conversion_us  Variable donde se guardará el tiempo de conversión del sensor, en microsegundos.
+ * @return esp_err_t
+ */
+static esp_err_t DS18B20PlanifConfigurarSensor(ds18b20_planif_bus_t *bus, ds18x20_addr_t direccion, uint32_t *tiempo_conversion_us)
+{
+    /**
+     *  El DS18S20 tiene resolución fija, con el tiempo de conversión máximo.
+     */
+    if((uint8_t) direccion != DS18B20_FAMILY_ID)
+    {
+        *tiempo_conversion_us = DS18B20_PLANIF_CONVERSION_MAX_US;
+        return ESP_OK;
+    }
+
+    uint8_t scratchpad[8];
+
+    ESP_RETURN_ON_ERROR(ds18x20_read_scratchpad(bus->config.pin, direccion, scratchpad), TAG, "Failed to read scratchpad.");
+
+    if(bus->config.resolucion_bits >= 9 && bus->config.resolucion_bits <= 12)
+    {
+        /**
+         *  Se escriben TH, TL (sin modificar) y el registro de configuración.
+         */
+        uint8_t config = scratchpad[DS18B20_PLANIF_BYTE_CONFIG];
+        config &= ~(DS18B20_PLANIF_RESOLUCION_MASK << DS18B20_PLANIF_RESOLUCION_OFFSET);
+        config |= (bus->config.resolucion_bits - 9) << DS18B20_PLANIF_RESOLUCION_OFFSET;
+
+        uint8_t escritura[3] = { scratchpad[2], scratchpad[3], config };
+
+        ESP_RETURN_ON_ERROR(ds18x20_write_scratchpad(bus->config.pin, direccion, escritura), TAG, "Failed to write scratchpad.");
+
+        scratchpad[DS18B20_PLANIF_BYTE_CONFIG] = config;
+    }
+
+    uint8_t resolucion = (scratchpad[DS18B20_PLANIF_BYTE_CONFIG] >> DS18B20_PLANIF_RESOLUCION_OFFSET) & DS18B20_PLANIF_RESOLUCION_MASK;
+
+    /**
+     *  El tiempo de conversión se reduce a la mitad por cada bit de resolución menos.
+     */
+    *tiempo_conversion_us = DS18B20_PLANIF_CONVERSION_MAX_US >> (DS18B20_PLANIF_RESOLUCION_MASK - resolucion);
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Tarea que atiende un bus 1-Wire. En cada período inicia la conversión de todos los sensores del bus a la
+ *          vez, espera el tiempo de conversión bloqueada, y luego lee la temperatura de cada sensor.
+ *
+ * @param pvParameters  Estado interno del bus.
+ */
+static void vTaskDS18B20Bus(void *pvParameters)
+{
+    ds18b20_planif_bus_t *bus = (ds18b20_planif_bus_t *) pvParameters;
+    ds18b20_planif_lectura_t lecturas[DS18B20_PLANIF_CANT_MAX_SENSORES];
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+
+    while(1)
+    {
+        /**
+         *  Conversión simultánea de todos los sensores del bus (SKIP ROM + CONVERT_T). La función retorna
+         *  inmediatamente, dejando la línea alimentada para los sensores en modo parásito.
+         */
+        esp_err_t err_conversion = ds18x20_measure(bus->config.pin, DS18X20_ANY, false);
+
+        if(err_conversion == ESP_OK)
+        {
+            vTaskDelay(pdMS_TO_TICKS(bus->tiempo_conversion_ms) + 1);
+        }
+
+        onewire_depower(bus->config.pin);
+
+        int64_t marca_tiempo = esp_timer_get_time();
+
+        for(size_t i = 0; i < bus->cant_sensores; i++)
+        {
+            ds18b20_planif_lectura_t *lectura = &lecturas[i];
+
+            lectura->pin = bus->config.pin;
+            lectura->direccion = bus->direcciones[i];
+            lectura->marca_tiempo_us = marca_tiempo;
+            lectura->estado = err_conversion;
+
+            if(err_conversion == ESP_OK)
+            {
+                lectura->estado = ds18x20_read_temperature(bus->config.pin, bus->direcciones[i], &lectura->temperatura);
+            }
+
+            if(lectura->estado == ESP_OK && lectura->temperatura == DS18B20_PLANIF_TEMP_RESET)
+            {
+                lectura->estado = ESP_ERR_INVALID_RESPONSE;
+            }
+
+            if(lectura->estado != ESP_OK)
+            {
+                ESP_LOGE(TAG, "Failed to read sensor %u on GPIO %d.", (unsigned int) i, bus->config.pin);
+                lectura->temperatura = DS18B20_PLANIF_ERROR_MEDICION;
+            }
+        }
+
+        xSemaphoreTake(DS18B20_planif_mutex, portMAX_DELAY);
+        memcpy(bus->lecturas, lecturas, bus->cant_sensores * sizeof(ds18b20_planif_lectura_t));
+        xSemaphoreGive(DS18B20_planif_mutex);
+
+        /**
+         *  Se ejecuta la función callback configurada con las lecturas de todo el bus.
+         */
+        if(bus->callback != NULL)
+        {
+            bus->callback(lecturas, bus->cant_sensores, bus->arg);
+        }
+
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(bus->config.periodo_ms));
+    }
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para agregar un bus 1-Wire al planificador. Se buscan los sensores del bus, se configura su
+ *          resolución y se crea la tarea que atiende al bus.
+ *
+ * @param config    Configuración del bus.
+ * @param callback  Función a ejecutar cada vez que se leen todos los sensores del bus. Puede ser NULL.
+ * @param arg       Argumento que se pasa a la función callback.
+ * @return esp_err_t    ESP_ERR_NOT_FOUND si no se encontraron sensores en el bus.
+ */
+esp_err_t ds18b20_planif_agregar_bus(const ds18b20_planif_config_bus_t *config, ds18b20_planif_callback_t callback, void *arg)
+{
+    if(config == NULL || config->periodo_ms == 0 || DS18B20PlanifBuscarBus(config->pin) != NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if(DS18B20_planif_cant_buses >= DS18B20_PLANIF_CANT_MAX_BUSES)
+    {
+        ESP_LOGE(TAG, "Maximum number of buses reached.");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if(DS18B20_planif_mutex == NULL)
+    {
+        DS18B20_planif_mutex = xSemaphoreCreateMutex();
+
+        if(DS18B20_planif_mutex == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to create mutex.");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ds18b20_planif_bus_t *bus = &DS18B20_planif_buses[DS18B20_planif_cant_buses];
+    memset(bus, 0, sizeof(ds18b20_planif_bus_t));
+    bus->config = *config;
+    bus->callback = callback;
+    bus->arg = arg;
+
+    //========================| BÚSQUEDA DE SENSORES |===========================//
+
+    /**
+     *  Con el periférico RMT, las transacciones del bus no bloquean al procesador ni deshabilitan
+     *  las interrupciones. No es apto para sensores en modo parásito.
+     */
+    if(config->usar_rmt)
+    {
+        ESP_RETURN_ON_ERROR(onewire_rmt_attach(config->pin, config->canal_rmt_tx, config->canal_rmt_rx),
+                            TAG, "Failed to attach RMT channels to GPIO %d.", config->pin);
+    }
+
+    /**
+     *  A partir de aquí, ante un error se liberan los canales RMT asignados al bus.
+     */
+    esp_err_t ret = ESP_OK;
+    size_t encontrados = 0;
+
+    ESP_GOTO_ON_ERROR(ds18x20_scan_devices(config->pin, bus->direcciones, DS18B20_PLANIF_CANT_MAX_SENSORES, &encontrados),
+                      LIBERAR_RMT, TAG, "Failed to scan bus on GPIO %d.", config->pin);
+
+    if(encontrados == 0)
+    {
+        ESP_LOGE(TAG, "No sensors found on GPIO %d.", config->pin);
+        ret = ESP_ERR_NOT_FOUND;
+        goto LIBERAR_RMT;
+    }
+
+    if(encontrados > DS18B20_PLANIF_CANT_MAX_SENSORES)
+    {
+        ESP_LOGW(TAG, "%u sensors found on GPIO %d, only %d will be read.", (unsigned int) encontrados, config->pin,
+                 DS18B20_PLANIF_CANT_MAX_SENSORES);
+        encontrados = DS18B20_PLANIF_CANT_MAX_SENSORES;
+    }
+
+    bus->cant_sensores = encontrados;
+
+    //========================| CONFIGURACIÓN DE SENSORES |===========================//
+
+    /**
+     *  El tiempo de conversión del bus es el del sensor más lento.
+     */
+    uint32_t tiempo_conversion_us = 0;
+
+    for(size_t i = 0; i < bus->cant_sensores; i++)
+    {
+        uint32_t tiempo_sensor_us;
+
+        ESP_GOTO_ON_ERROR(DS18B20PlanifConfigurarSensor(bus, bus->direcciones[i], &tiempo_sensor_us),
+                          LIBERAR_RMT, TAG, "Failed to configure sensor %u on GPIO %d.", (unsigned int) i, config->pin);
+
+        if(tiempo_sensor_us > tiempo_conversion_us)
+        {
+            tiempo_conversion_us = tiempo_sensor_us;
+        }
+
+        bus->lecturas[i].pin = config->pin;
+        bus->lecturas[i].direccion = bus->direcciones[i];
+        bus->lecturas[i].temperatura = DS18B20_PLANIF_ERROR_MEDICION;
+        bus->lecturas[i].estado = ESP_ERR_INVALID_STATE;
+    }
+
+    bus->tiempo_conversion_ms = (tiempo_conversion_us + 999) / 1000;
+
+    /**
+     *  El período no puede ser menor al tiempo de conversión.
+     */
+    if(bus->config.periodo_ms < bus->tiempo_conversion_ms)
+    {
+        bus->config.periodo_ms = bus->tiempo_conversion_ms;
+    }
+
+    //========================| CREACIÓN DE TAREA |===========================//
+
+    /**
+     *  Se crea la tarea encargada de atender al bus. La tarea pasa la mayor parte del tiempo bloqueada
+     *  durante la conversión, por lo que se le da una prioridad media.
+     */
+    xTaskCreate(
+        vTaskDS18B20Bus,
+        "vTaskDS18B20Bus",
+        3072,
+        bus,
+        3,
+        &bus->tarea);
+
+    if(bus->tarea == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create vTaskDS18B20Bus task.");
+        ret = ESP_FAIL;
+        goto LIBERAR_RMT;
+    }
+
+    DS18B20_planif_cant_buses++;
+
+    ESP_LOGI(TAG, "%u sensors on GPIO %d, conversion time %u ms.", (unsigned int) bus->cant_sensores, config->pin,
+             (unsigned int) bus->tiempo_conversion_ms);
+
+    return ESP_OK;
+
+    /**
+     *  Se liberan los canales RMT, para que el bus pueda volver a agregarse o los canales puedan
+     *  utilizarse en otro bus.
+     */
+    LIBERAR_RMT:
+
+    if(config->usar_rmt)
+    {
+        onewire_rmt_detach(config->pin);
+    }
+
+    return ret;
+}
+
+
+
+/**
+ * @brief   Función que devuelve la cantidad de sensores encontrados en un bus.
+ *
+ * @param pin   Pin GPIO del bus.
+ * @return size_t   Cantidad de sensores, 0 si no se agregó el bus.
+ */
+size_t ds18b20_planif_get_cantidad_sensores(gpio_num_t pin)
+{
+    ds18b20_planif_bus_t *bus = DS18B20PlanifBuscarBus(pin);
+
+    return (bus != NULL) ? bus->cant_sensores : 0;
+}
+
+
+
+/**
+ * @brief   Función que devuelve la última lectura de un sensor.
+ *
+ * @param pin       Pin GPIO del bus.
+ * @param indice    Índice del sensor en el bus (0 a cantidad de sensores - 1).
+ * @param lectura   Buffer donde se guardará la lectura.
+ * @return esp_err_t
+ */
+esp_err_t ds18b20_planif_get_lectura(gpio_num_t pin, size_t indice, ds18b20_planif_lectura_t *lectura)
+{
+    ds18b20_planif_bus_t *bus = DS18B20PlanifBuscarBus(pin);
+
+    if(bus == NULL || lectura == NULL || indice >= bus->cant_sensores)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(DS18B20_planif_mutex, portMAX_DELAY);
+    *lectura = bus->lecturas[indice];
+    xSemaphoreGive(DS18B20_planif_mutex);
+
+    return ESP_OK;
+}
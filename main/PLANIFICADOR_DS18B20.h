@@ -0,0 +1,81 @@
+/*
+
+    Planificador de conversiones de los sensores de temperatura DS18B20/DS18S20 de la solución nutritiva, que
+    inicia la conversión de todos los sensores de cada bus 1-Wire a la vez, y lee los resultados cuando transcurre
+    el tiempo de conversión correspondiente a la resolución configurada.
+
+*/
+
+#ifndef PLANIFICADOR_DS18B20_H_
+#define PLANIFICADOR_DS18B20_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "driver/rmt.h"
+#include "ds18x20.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/* Cantidad máxima de buses 1-Wire, cada uno atendido por su propia tarea. */
+#define DS18B20_PLANIF_CANT_MAX_BUSES       4
+
+/* Cantidad máxima de sensores por bus. */
+#define DS18B20_PLANIF_CANT_MAX_SENSORES    16
+
+/* Valor de temperatura que se informa cuando no se pudo leer un sensor. */
+#define DS18B20_PLANIF_ERROR_MEDICION       -300
+
+/**
+ *  Estructura con la configuración de un bus 1-Wire.
+ */
+typedef struct {
+    gpio_num_t pin;                     /* Pin GPIO del bus. */
+    uint32_t periodo_ms;                /* Período de medición, en milisegundos. */
+    uint8_t resolucion_bits;            /* Resolución de los DS18B20 (9 a 12 bits), o 0 para mantener la actual. */
+    bool usar_rmt;                      /* Utilizar el periférico RMT en lugar de generar los pulsos por software. */
+    rmt_channel_t canal_rmt_tx;         /* Canal RMT de transmisión, si "usar_rmt" es 1. */
+    rmt_channel_t canal_rmt_rx;         /* Canal RMT de recepción, si "usar_rmt" es 1. */
+} ds18b20_planif_config_bus_t;
+
+
+/**
+ *  Estructura con el resultado de la lectura de un sensor.
+ */
+typedef struct {
+    gpio_num_t pin;                     /* Pin GPIO del bus del sensor. */
+    ds18x20_addr_t direccion;           /* Dirección 1-Wire del sensor. */
+    float temperatura;                  /* Temperatura en °C, o DS18B20_PLANIF_ERROR_MEDICION. */
+    esp_err_t estado;                   /* Resultado de la lectura. */
+    int64_t marca_tiempo_us;            /* Marca de tiempo de la lectura (esp_timer), en microsegundos. */
+} ds18b20_planif_lectura_t;
+
+
+/**
+ *  @brief  Puntero a función que será utilizado para ejecutar la función que se pase como callback cada vez
+ *          que se leen todos los sensores de un bus. Se ejecuta desde la tarea del bus.
+ */
+typedef void (*ds18b20_planif_callback_t)(const ds18b20_planif_lectura_t *lecturas, size_t cantidad, void *arg);
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+esp_err_t ds18b20_planif_agregar_bus(const ds18b20_planif_config_bus_t *config, ds18b20_planif_callback_t callback, void *arg);
+size_t ds18b20_planif_get_cantidad_sensores(gpio_num_t pin);
+esp_err_t ds18b20_planif_get_lectura(gpio_num_t pin, size_t indice, ds18b20_planif_lectura_t *lectura);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLANIFICADOR_DS18B20_H_
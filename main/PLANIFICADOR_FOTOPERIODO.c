@@ -0,0 +1,252 @@
+/**
+ * @file PLANIFICADOR_FOTOPERIODO.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Planificador del fotoperíodo de las luces, que a partir de la hora local determina si las luces deben estar
+ *          encendidas y cuánto falta para el próximo cambio de estado.
+ * @version 0.1
+ * @date 2023-02-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      El fotoperíodo se define como una lista de hasta "FOTOPERIODO_CANT_MAX_VENTANAS" ventanas diarias de encendido,
+ *  cada una con su hora de encendido y de apagado. Las luces deben estar encendidas si la hora local cae dentro de
+ *  alguna de las ventanas.
+ *
+ *      Mediante "fotoperiodo_get_estado()" se obtiene el estado en el que deben estar las luces en la hora local pasada
+ *  como argumento, y los segundos que faltan para el próximo cambio de estado, de modo que quien controla las luces
+ *  pueda dormir hasta ese instante. Dado que cada plazo se calcula a partir de la hora real, no se acumulan errores
+ *  entre ciclos, y luego de un reinicio el estado de las luces se retoma a partir de la hora actual.
+ *
+ *      Las ventanas se pueden cargar en formato de texto mediante "fotoperiodo_parse_ventanas()", con el formato
+ *  "HH:MM-HH:MM;HH:MM-HH:MM", por ejemplo: "06:00-12:00;14:00-20:00". Una ventana con igual hora de encendido y de
+ *  apagado (por ejemplo, "00:00-24:00") mantiene las luces encendidas todo el día.
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "esp_err.h"
+
+#include "PLANIFICADOR_FOTOPERIODO.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+/* Ventanas de encendido de las luces configuradas. */
+static fotoperiodo_ventana_t fotoperiodo_ventanas[FOTOPERIODO_CANT_MAX_VENTANAS];
+
+/* Cantidad de ventanas configuradas. */
+static unsigned int fotoperiodo_cant_ventanas = 0;
+
+/* Spinlock para proteger el acceso a las ventanas, que se modifican y consultan desde distintas tareas. */
+static portMUX_TYPE fotoperiodo_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static bool FotoperiodoEstadoEnSegundo(const fotoperiodo_ventana_t *ventanas, unsigned int cantidad, uint32_t segundo_del_dia);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función que determina si las luces deben estar encendidas en un segundo del día determinado.
+ *
+ * @param ventanas          Ventanas de encendido.
+ * @param cantidad          Cantidad de ventanas.
+ * @param segundo_del_dia   Segundos desde las 00:00 hs.
+ * @return true     Luces encendidas.
+ * @return false    Luces apagadas.
+ */
+static bool FotoperiodoEstadoEnSegundo(const fotoperiodo_ventana_t *ventanas, unsigned int cantidad, uint32_t segundo_del_dia)
+{
+    for(unsigned int i = 0; i < cantidad; i++)
+    {
+        uint32_t inicio = ventanas[i].inicio_min * 60;
+        uint32_t fin = ventanas[i].fin_min * 60;
+
+        /**
+         *  Una ventana con igual hora de encendido y apagado abarca el día completo (24 hs de luz).
+         */
+        if(inicio == fin)
+        {
+            return 1;
+        }
+
+        if(inicio < fin && segundo_del_dia >= inicio && segundo_del_dia < fin)
+        {
+            return 1;
+        }
+
+        /**
+         *  Ventana que atraviesa la medianoche.
+         */
+        if(inicio > fin && (segundo_del_dia >= inicio || segundo_del_dia < fin))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para cargar las ventanas diarias de encendido de las luces.
+ *
+ * @param ventanas  Lista de ventanas.
+ * @param cantidad  Cantidad de ventanas (como máximo "FOTOPERIODO_CANT_MAX_VENTANAS").
+ * @return esp_err_t
+ */
+esp_err_t fotoperiodo_set_ventanas(const fotoperiodo_ventana_t *ventanas, unsigned int cantidad)
+{
+    if((ventanas == NULL && cantidad > 0) || cantidad > FOTOPERIODO_CANT_MAX_VENTANAS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for(unsigned int i = 0; i < cantidad; i++)
+    {
+        if(ventanas[i].inicio_min >= 24 * 60 || ventanas[i].fin_min >= 24 * 60)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    portENTER_CRITICAL(&fotoperiodo_spinlock);
+    memcpy(fotoperiodo_ventanas, ventanas, cantidad * sizeof(fotoperiodo_ventana_t));
+    fotoperiodo_cant_ventanas = cantidad;
+    portEXIT_CRITICAL(&fotoperiodo_spinlock);
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para obtener una lista de ventanas a partir de un texto con el formato
+ *          "HH:MM-HH:MM;HH:MM-HH:MM". El horario "24:00" se interpreta como las 00:00 hs.
+ *
+ * @param texto     Texto a interpretar.
+ * @param ventanas  Buffer de al menos "FOTOPERIODO_CANT_MAX_VENTANAS" ventanas.
+ * @param cantidad  Variable donde se guardará la cantidad de ventanas obtenidas.
+ * @return esp_err_t
+ */
+esp_err_t fotoperiodo_parse_ventanas(const char *texto, fotoperiodo_ventana_t *ventanas, unsigned int *cantidad)
+{
+    if(texto == NULL || ventanas == NULL || cantidad == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    unsigned int cant_ventanas = 0;
+    const char *cursor = texto;
+
+    while(*cursor != '\0')
+    {
+        unsigned int h_inicio, m_inicio, h_fin, m_fin;
+        int caracteres_leidos = 0;
+
+        if(cant_ventanas >= FOTOPERIODO_CANT_MAX_VENTANAS
+            || sscanf(cursor, "%u:%u-%u:%u%n", &h_inicio, &m_inicio, &h_fin, &m_fin, &caracteres_leidos) != 4
+            || h_inicio > 24 || h_fin > 24 || m_inicio >= 60 || m_fin >= 60)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        ventanas[cant_ventanas].inicio_min = (h_inicio * 60 + m_inicio) % (24 * 60);
+        ventanas[cant_ventanas].fin_min = (h_fin * 60 + m_fin) % (24 * 60);
+        cant_ventanas++;
+
+        cursor += caracteres_leidos;
+
+        if(*cursor == ';')
+        {
+            cursor++;
+        }
+
+        else if(*cursor != '\0')
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    *cantidad = cant_ventanas;
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función que determina si las luces deben estar encendidas en la hora local indicada, y cuántos
+ *          segundos faltan para el próximo cambio de estado.
+ *
+ * @param hora_local                Hora local actual.
+ * @param seg_hasta_proximo_cambio  Variable donde se guardarán los segundos hasta el próximo cambio de estado.
+ *                                  Si el estado no cambia en todo el día, se carga "FOTOPERIODO_SEG_POR_DIA".
+ * @return true     Luces encendidas.
+ * @return false    Luces apagadas.
+ */
+bool fotoperiodo_get_estado(const struct tm *hora_local, uint32_t *seg_hasta_proximo_cambio)
+{
+    fotoperiodo_ventana_t ventanas[FOTOPERIODO_CANT_MAX_VENTANAS];
+    unsigned int cantidad;
+
+    portENTER_CRITICAL(&fotoperiodo_spinlock);
+    cantidad = fotoperiodo_cant_ventanas;
+    memcpy(ventanas, fotoperiodo_ventanas, cantidad * sizeof(fotoperiodo_ventana_t));
+    portEXIT_CRITICAL(&fotoperiodo_spinlock);
+
+    uint32_t segundo_del_dia = hora_local->tm_hour * 3600 + hora_local->tm_min * 60 + hora_local->tm_sec;
+    bool estado = FotoperiodoEstadoEnSegundo(ventanas, cantidad, segundo_del_dia);
+
+    /**
+     *  Se busca, entre todos los bordes de las ventanas, el más próximo en el que efectivamente
+     *  cambie el estado de las luces (ventanas superpuestas o contiguas no producen cambios).
+     */
+    uint32_t seg_hasta_cambio = FOTOPERIODO_SEG_POR_DIA;
+
+    for(unsigned int i = 0; i < cantidad; i++)
+    {
+        uint32_t bordes[2] = {ventanas[i].inicio_min * 60, ventanas[i].fin_min * 60};
+
+        for(int j = 0; j < 2; j++)
+        {
+            uint32_t delta = (bordes[j] + FOTOPERIODO_SEG_POR_DIA - segundo_del_dia) % FOTOPERIODO_SEG_POR_DIA;
+
+            if(delta == 0)
+            {
+                delta = FOTOPERIODO_SEG_POR_DIA;
+            }
+
+            if(delta < seg_hasta_cambio
+                && FotoperiodoEstadoEnSegundo(ventanas, cantidad, (segundo_del_dia + delta) % FOTOPERIODO_SEG_POR_DIA) != estado)
+            {
+                seg_hasta_cambio = delta;
+            }
+        }
+    }
+
+    if(seg_hasta_proximo_cambio != NULL)
+    {
+        *seg_hasta_proximo_cambio = seg_hasta_cambio;
+    }
+
+    return estado;
+}
@@ -0,0 +1,52 @@
+/*
+
+    Planificador del fotoperíodo de las luces de las unidades secundarias, basado en ventanas horarias diarias.
+
+*/
+
+#ifndef PLANIFICADOR_FOTOPERIODO_H_
+#define PLANIFICADOR_FOTOPERIODO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "esp_err.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/* Cantidad máxima de ventanas de encendido de las luces por día. */
+#define FOTOPERIODO_CANT_MAX_VENTANAS   4
+
+/* Cantidad de segundos de un día. */
+#define FOTOPERIODO_SEG_POR_DIA         86400
+
+/**
+ *  Estructura que representa una ventana diaria de encendido de las luces, en minutos desde
+ *  las 00:00 hs. Si "fin_min" es menor que "inicio_min", la ventana atraviesa la medianoche, y si
+ *  son iguales, la ventana abarca el día completo.
+ */
+typedef struct {
+    uint16_t inicio_min;    /* Hora de encendido, en minutos desde las 00:00 hs. */
+    uint16_t fin_min;       /* Hora de apagado, en minutos desde las 00:00 hs. */
+} fotoperiodo_ventana_t;
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+esp_err_t fotoperiodo_set_ventanas(const fotoperiodo_ventana_t *ventanas, unsigned int cantidad);
+esp_err_t fotoperiodo_parse_ventanas(const char *texto, fotoperiodo_ventana_t *ventanas, unsigned int *cantidad);
+bool fotoperiodo_get_estado(const struct tm *hora_local, uint32_t *seg_hasta_proximo_cambio);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLANIFICADOR_FOTOPERIODO_H_
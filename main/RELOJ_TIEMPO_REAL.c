@@ -0,0 +1,255 @@
+/**
+ * @file RELOJ_TIEMPO_REAL.c
+ * @author Franco Bisciglia, David Kündinger
+ * @brief   Librería mediante la cual se mantiene la hora del sistema, sincronizándola por SNTP y utilizando el RTC DS3231
+ *          como respaldo ante cortes de energía o falta de conexión a internet.
+ * @version 0.1
+ * @date 2023-02-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+
+
+/**
+ * =================================================| EXPLICACIÓN DE LIBRERÍA |=================================================
+ *
+ *      Al inicializar la librería mediante "reloj_init()", se lee la hora guardada en el DS3231 y, si su oscilador no se
+ *  detuvo (es decir, la hora que tiene es confiable), se la carga como hora del sistema. De esta forma, luego de un
+ *  reinicio se tiene la hora correcta aunque todavía no haya conexión a internet.
+ *
+ *      Luego, se inicia el cliente SNTP, que sincroniza la hora del sistema periódicamente. En cada sincronización, se
+ *  ejecuta la función callback configurada con "reloj_callback_function_on_sync()" y se marca que la hora del DS3231
+ *  debe actualizarse. Dado que el callback de SNTP se ejecuta en la tarea de TCP/IP, la escritura por I2C no se hace
+ *  allí, sino en "reloj_actualizar_rtc()", que se llama periódicamente desde la tarea de control de las luces.
+ *
+ *      El DS3231 se encuentra en el mismo bus I2C que el MCP23008, y guarda la hora local (no UTC).
+ */
+
+
+
+//==================================| INCLUDES |==================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_sntp.h"
+
+#include "ds3231.h"
+
+#include "MCP23008.h"
+#include "RELOJ_TIEMPO_REAL.h"
+
+//==================================| MACROS AND TYPDEF |==================================//
+
+//==================================| INTERNAL DATA DEFINITION |==================================//
+
+/* Tag para imprimir información en el LOG. */
+static const char *TAG = "RELOJ_TIEMPO_REAL";
+
+/* Descriptor I2C del RTC DS3231. */
+static i2c_dev_t reloj_ds3231_dev = {0};
+
+/* Bandera que indica si la hora del sistema es válida (cargada desde el DS3231 o sincronizada por SNTP). */
+static bool reloj_hora_valida_flag = 0;
+
+/* Bandera que indica que se sincronizó la hora por SNTP y todavía no se actualizó el DS3231. */
+static volatile bool reloj_rtc_pendiente_flag = 0;
+
+/* Puntero a función que apuntará a la función callback pasada como argumento en la función de configuración de callback. */
+static RelojCallbackFunction RelojCallback = NULL;
+
+//==================================| EXTERNAL DATA DEFINITION |==================================//
+
+//==================================| INTERNAL FUNCTIONS DECLARATION |==================================//
+
+static void reloj_sntp_sync_cb(struct timeval *tv);
+
+//==================================| INTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función de callback que se ejecuta cuando el cliente SNTP sincroniza la hora del sistema.
+ *
+ * @param tv    Hora sincronizada.
+ */
+static void reloj_sntp_sync_cb(struct timeval *tv)
+{
+    reloj_hora_valida_flag = 1;
+
+    /**
+     *  La hora del DS3231 se actualiza luego desde "reloj_actualizar_rtc()", para no bloquear la
+     *  tarea de TCP/IP con transacciones I2C.
+     */
+    reloj_rtc_pendiente_flag = 1;
+
+    struct tm hora_local;
+    time_t ahora = tv->tv_sec;
+    localtime_r(&ahora, &hora_local);
+
+    ESP_LOGI(TAG, "SNTP SYNC: %02d/%02d/%04d %02d:%02d:%02d", hora_local.tm_mday, hora_local.tm_mon + 1, hora_local.tm_year + 1900,
+             hora_local.tm_hour, hora_local.tm_min, hora_local.tm_sec);
+
+    /**
+     *  Se ejecuta la función callback configurada.
+     */
+    if(RelojCallback != NULL)
+    {
+        RelojCallback(NULL);
+    }
+}
+
+//==================================| EXTERNAL FUNCTIONS DEFINITION |==================================//
+
+/**
+ * @brief   Función para inicializar el reloj de tiempo real. Se carga la hora del DS3231 como hora del sistema
+ *          (si es confiable) y se inicia la sincronización por SNTP.
+ *
+ *          Previamente debe haberse llamado a "i2cdev_init()".
+ *
+ * @return esp_err_t
+ */
+esp_err_t reloj_init(void)
+{
+    /**
+     *  Se configura la zona horaria local.
+     */
+    setenv("TZ", RELOJ_ZONA_HORARIA, 1);
+    tzset();
+
+    //========================| HORA DEL DS3231 |===========================//
+
+    /**
+     *  Se carga el descriptor I2C del DS3231, con la misma configuración de bus que el MCP23008 para
+     *  que la librería "i2cdev" no reconfigure el driver I2C al alternar entre ambos dispositivos.
+     */
+    ESP_RETURN_ON_ERROR(ds3231_init_desc(&reloj_ds3231_dev, I2C_MASTER_NUM, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO),
+                        TAG, "Failed to initialize DS3231 descriptor.");
+
+    reloj_ds3231_dev.cfg.sda_pullup_en = GPIO_PULLUP_DISABLE;
+    reloj_ds3231_dev.cfg.scl_pullup_en = GPIO_PULLUP_DISABLE;
+    reloj_ds3231_dev.cfg.master.clk_speed = I2C_MASTER_FREQ_HZ;
+
+    /**
+     *  Si el oscilador del DS3231 no se detuvo, la hora que tiene guardada es confiable y se la
+     *  carga como hora del sistema.
+     */
+    bool oscilador_detenido = 1;
+    struct tm hora_rtc;
+
+    if(ds3231_get_oscillator_stop_flag(&reloj_ds3231_dev, &oscilador_detenido) == ESP_OK && !oscilador_detenido
+        && ds3231_get_time(&reloj_ds3231_dev, &hora_rtc) == ESP_OK)
+    {
+        hora_rtc.tm_isdst = -1;
+        struct timeval tv = {
+            .tv_sec = mktime(&hora_rtc),
+            .tv_usec = 0,
+        };
+        settimeofday(&tv, NULL);
+
+        reloj_hora_valida_flag = 1;
+
+        ESP_LOGI(TAG, "TIME LOADED FROM DS3231: %02d:%02d:%02d", hora_rtc.tm_hour, hora_rtc.tm_min, hora_rtc.tm_sec);
+    }
+
+    else
+    {
+        ESP_LOGW(TAG, "DS3231 time not valid, waiting for SNTP sync.");
+    }
+
+    //========================| INICIO SNTP |===========================//
+
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, RELOJ_SERVIDOR_SNTP);
+    sntp_set_time_sync_notification_cb(reloj_sntp_sync_cb);
+    sntp_init();
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para saber si la hora del sistema es válida, es decir, si se la cargó desde el DS3231
+ *          o se la sincronizó por SNTP.
+ *
+ * @return true     Hora válida.
+ * @return false    Hora no válida.
+ */
+bool reloj_hora_valida(void)
+{
+    return reloj_hora_valida_flag;
+}
+
+
+
+/**
+ * @brief   Función que devuelve la hora local actual.
+ *
+ * @param hora_local    Variable donde se guardará la hora local.
+ * @return esp_err_t    ESP_ERR_INVALID_STATE si la hora todavía no es válida.
+ */
+esp_err_t reloj_get_hora_local(struct tm *hora_local)
+{
+    if(!reloj_hora_valida_flag)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    time_t ahora;
+    time(&ahora);
+    localtime_r(&ahora, hora_local);
+
+    return ESP_OK;
+}
+
+
+
+/**
+ * @brief   Función para configurar que, al sincronizarse la hora por SNTP, se ejecute la función
+ *          que se pasa como argumento.
+ *
+ * @param callback_function    Función a ejecutar al sincronizarse la hora.
+ */
+void reloj_callback_function_on_sync(RelojCallbackFunction callback_function)
+{
+    RelojCallback = callback_function;
+}
+
+
+
+/**
+ * @brief   Función para actualizar la hora del DS3231 con la hora del sistema, si hubo una sincronización por
+ *          SNTP desde la última actualización. Debe llamarse periódicamente desde una tarea que pueda realizar
+ *          transacciones I2C.
+ */
+void reloj_actualizar_rtc(void)
+{
+    if(!reloj_rtc_pendiente_flag)
+    {
+        return;
+    }
+
+    reloj_rtc_pendiente_flag = 0;
+
+    /**
+     *  Se actualiza la hora del DS3231 con la hora local actual, y se limpia la bandera de oscilador
+     *  detenido para indicar que la hora guardada es confiable. Si falla, se reintenta en la próxima llamada.
+     */
+    struct tm hora_local;
+    time_t ahora;
+    time(&ahora);
+    localtime_r(&ahora, &hora_local);
+
+    if(ds3231_set_time(&reloj_ds3231_dev, &hora_local) != ESP_OK
+        || ds3231_clear_oscillator_stop_flag(&reloj_ds3231_dev) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to update DS3231 time.");
+        reloj_rtc_pendiente_flag = 1;
+    }
+}
@@ -0,0 +1,49 @@
+/*
+
+    Reloj de tiempo real del sistema, sincronizado mediante SNTP y respaldado por el RTC DS3231.
+
+*/
+
+#ifndef RELOJ_TIEMPO_REAL_H_
+#define RELOJ_TIEMPO_REAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================================[INCLUDES]=============================================*/
+
+#include <stdbool.h>
+#include <time.h>
+#include "esp_err.h"
+
+/*============================[DEFINES AND MACROS]=====================================*/
+
+/* Servidor SNTP utilizado para sincronizar la hora. */
+#define RELOJ_SERVIDOR_SNTP     "pool.ntp.org"
+
+/* Zona horaria local en formato POSIX (Argentina, UTC-3, sin horario de verano). */
+#define RELOJ_ZONA_HORARIA      "<-03>3"
+
+/**
+ *  @brief  Puntero a función que será utilizado para ejecutar la función que se pase
+ *          como callback cuando se sincronice la hora mediante SNTP.
+ */
+typedef void (*RelojCallbackFunction)(void *pvParameters);
+
+/*======================[EXTERNAL DATA DECLARATION]==============================*/
+
+/*=====================[EXTERNAL FUNCTIONS DECLARATION]=========================*/
+
+esp_err_t reloj_init(void);
+bool reloj_hora_valida(void);
+esp_err_t reloj_get_hora_local(struct tm *hora_local);
+void reloj_callback_function_on_sync(RelojCallbackFunction callback_function);
+void reloj_actualizar_rtc(void);
+
+/*==================[END OF FILE]============================================*/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RELOJ_TIEMPO_REAL_H_
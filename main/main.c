@@ -12,10 +12,15 @@
 
 #include "MEF_ALGORITMO_CONTROL_VAR_AMB.h"
 #include "AUXILIARES_ALGORITMO_CONTROL_VAR_AMB.h"
+#include "HISTORIAL_SENSORES.h"
 
 #include "MQTT_PUBL_SUSCR.h"
 #include "WiFi_STA.h"
 #include "MCP23008.h"
+#include "ACTUADORES.h"
+#include "RELOJ_TIEMPO_REAL.h"
+
+#include "i2cdev.h"
 
 #include "DEBUG_DEFINITIONS.h"
 
@@ -46,10 +51,22 @@ void app_main(void)
 
     while(!mqtt_check_connection()){vTaskDelay(pdMS_TO_TICKS(100));}
 
+    //=======================| INIT I2C |=======================//
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(i2cdev_init());
+
     //=======================| INIT MCP23008 |=======================//
 
     ESP_ERROR_CHECK_WITHOUT_ABORT(MCP23008_init());
 
+    //=======================| INIT ACTUADORES |=======================//
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(actuadores_init());
+
+    //=======================| INIT RELOJ TIEMPO REAL |=======================//
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(reloj_init());
+
     //=======================| INIT ALGORITMO CONTROL LUCES |=======================//
 
     #ifdef DEBUG_ALGORITMO_CONTROL_LUCES
@@ -60,8 +77,9 @@ void app_main(void)
     //=======================| INIT ALGORITMO CONTROL VAR AMB |=======================//
 
     #ifdef DEBUG_ALGORITMO_CONTROL_VARIABLES_AMBIENTALES
-    aux_control_var_amb_init(Cliente_MQTT);
+    historial_sensores_init(Cliente_MQTT);
     mef_var_amb_init(Cliente_MQTT);
+    aux_control_var_amb_init(Cliente_MQTT);
     #endif
 
 }